@@ -0,0 +1,119 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/components/constrained_decoding/bitmap.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+
+// SSE2 and NEON are part of the x86-64 and arm64 baselines, so the masking
+// kernel needs no runtime dispatch.
+#if defined(__SSE2__) || defined(_M_X64)
+#define LITERT_LM_BITMAP_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define LITERT_LM_BITMAP_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace litert::lm {
+namespace {
+
+constexpr int kBitsPerWord = 32;
+constexpr uint32_t kAllAllowedWord = 0xFFFFFFFFu;
+
+// Masks the 32 logits of `block` whose bit is not set in `word`.
+void MaskBlock(uint32_t word, float* block) {
+  const float masked_value = std::numeric_limits<float>::lowest();
+#if defined(LITERT_LM_BITMAP_SSE2)
+  const __m128i lane_bits = _mm_setr_epi32(1, 2, 4, 8);
+  const __m128 masked = _mm_set1_ps(masked_value);
+  for (int i = 0; i < kBitsPerWord; i += 4) {
+    const __m128i nibble = _mm_set1_epi32((word >> i) & 0xF);
+    const __m128 allowed = _mm_castsi128_ps(
+        _mm_cmpeq_epi32(_mm_and_si128(nibble, lane_bits), lane_bits));
+    const __m128 logits = _mm_loadu_ps(block + i);
+    _mm_storeu_ps(block + i, _mm_or_ps(_mm_and_ps(allowed, logits),
+                                       _mm_andnot_ps(allowed, masked)));
+  }
+#elif defined(LITERT_LM_BITMAP_NEON)
+  const uint32x4_t lane_bits = {1, 2, 4, 8};
+  const float32x4_t masked = vdupq_n_f32(masked_value);
+  for (int i = 0; i < kBitsPerWord; i += 4) {
+    const uint32x4_t allowed =
+        vtstq_u32(vdupq_n_u32((word >> i) & 0xF), lane_bits);
+    vst1q_f32(block + i, vbslq_f32(allowed, vld1q_f32(block + i), masked));
+  }
+#else
+  for (int i = 0; i < kBitsPerWord; ++i) {
+    block[i] = (word >> i) & 1 ? block[i] : masked_value;
+  }
+#endif
+}
+
+}  // namespace
+
+absl::Status ApplyBitmapToLogits(const Bitmap& bitmap,
+                                 absl::Span<float> logits) {
+  if (bitmap.AreAllAllowed()) {
+    return absl::OkStatus();
+  }
+  const float masked_value = std::numeric_limits<float>::lowest();
+
+  const absl::Span<const uint32_t> words = bitmap.GetPackedWords();
+  if (words.empty()) {
+    for (size_t i = 0; i < logits.size(); ++i) {
+      if (!bitmap.Get(i)) {
+        logits[i] = masked_value;
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  const size_t num_words = (logits.size() + kBitsPerWord - 1) / kBitsPerWord;
+  if (words.size() < num_words) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "The bitmap covers ", words.size() * kBitsPerWord,
+        " tokens but there are ", logits.size(), " logits."));
+  }
+  const size_t num_full_words = logits.size() / kBitsPerWord;
+  for (size_t w = 0; w < num_full_words; ++w) {
+    const uint32_t word = words[w];
+    float* block = logits.data() + w * kBitsPerWord;
+    // Constrained vocabularies are mostly made of fully allowed or fully
+    // disallowed words.
+    if (word == kAllAllowedWord) {
+      continue;
+    }
+    if (word == 0) {
+      std::fill_n(block, kBitsPerWord, masked_value);
+      continue;
+    }
+    MaskBlock(word, block);
+  }
+  for (size_t i = num_full_words * kBitsPerWord; i < logits.size(); ++i) {
+    if (((words[i / kBitsPerWord] >> (i % kBitsPerWord)) & 1) == 0) {
+      logits[i] = masked_value;
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace litert::lm
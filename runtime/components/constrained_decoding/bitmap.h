@@ -15,6 +15,11 @@
 #ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_COMPONENTS_CONSTRAINED_DECODING_BITMAP_H_
 #define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_COMPONENTS_CONSTRAINED_DECODING_BITMAP_H_
 
+#include <cstdint>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+
 namespace litert::lm {
 
 // The bitmap of vocabulary to indicate the allowed tokens.
@@ -23,6 +28,16 @@ class Bitmap {
   // Returns true if the `index`th token is allowed.
   virtual bool Get(int index) const = 0;
 
+  // Returns the bitmap packed in 32 bit words, where the `index`th token is
+  // allowed if bit `index % 32` of word `index / 32` is set, or an empty span
+  // if the bitmap is not stored packed. Implementations backed by packed words
+  // should override this, so that logits can be masked a word at a time
+  // instead of calling Get() for every token.
+  virtual absl::Span<const uint32_t> GetPackedWords() const { return {}; }
+
+  // Returns true if all the tokens are allowed, i.e. masking is a no-op.
+  virtual bool AreAllAllowed() const { return false; }
+
   virtual ~Bitmap() = default;
 };
 
@@ -30,8 +45,15 @@ class Bitmap {
 class AllAllowedBitmap : public Bitmap {
  public:
   bool Get(int index) const override { return true; }
+  bool AreAllAllowed() const override { return true; }
 };
 
+// Sets the logits of the tokens disallowed by `bitmap` to the lowest float.
+// `logits` holds the logits of the first logits.size() tokens of the
+// vocabulary.
+absl::Status ApplyBitmapToLogits(const Bitmap& bitmap,
+                                 absl::Span<float> logits);
+
 }  // namespace litert::lm
 
 #endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_COMPONENTS_CONSTRAINED_DECODING_BITMAP_H_
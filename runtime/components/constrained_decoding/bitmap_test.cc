@@ -0,0 +1,120 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/components/constrained_decoding/bitmap.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+#include "runtime/util/test_utils.h"  // NOLINT
+
+namespace litert::lm {
+namespace {
+
+using ::testing::Each;
+using ::testing::ElementsAreArray;
+
+constexpr float kMasked = std::numeric_limits<float>::lowest();
+
+// A bitmap answering Get() only, i.e. without packed words.
+class UnpackedBitmap : public Bitmap {
+ public:
+  explicit UnpackedBitmap(std::vector<bool> mask) : mask_(std::move(mask)) {}
+  bool Get(int index) const override { return mask_[index]; }
+
+ private:
+  std::vector<bool> mask_;
+};
+
+class PackedBitmap : public Bitmap {
+ public:
+  explicit PackedBitmap(std::vector<uint32_t> words)
+      : words_(std::move(words)) {}
+  bool Get(int index) const override {
+    return (words_[index / 32] >> (index % 32)) & 1;
+  }
+  absl::Span<const uint32_t> GetPackedWords() const override {
+    return words_;
+  }
+
+ private:
+  std::vector<uint32_t> words_;
+};
+
+std::vector<float> Logits(int size) {
+  std::vector<float> logits(size);
+  for (int i = 0; i < size; ++i) {
+    logits[i] = 0.5f * i - 3.0f;
+  }
+  return logits;
+}
+
+TEST(BitmapTest, AllAllowedBitmapKeepsLogits) {
+  std::vector<float> logits = Logits(70);
+  const std::vector<float> expected = logits;
+  EXPECT_OK(ApplyBitmapToLogits(AllAllowedBitmap(), absl::MakeSpan(logits)));
+  EXPECT_THAT(logits, ElementsAreArray(expected));
+}
+
+TEST(BitmapTest, PackedWordsMatchPerTokenMasking) {
+  // Full words, empty words, mixed words and a partial last word.
+  for (int vocab_size : {1, 31, 32, 33, 100, 1000}) {
+    std::mt19937 rng(vocab_size);
+    std::vector<uint32_t> words((vocab_size + 31) / 32);
+    for (size_t w = 0; w < words.size(); ++w) {
+      words[w] = w % 3 == 0 ? 0xFFFFFFFFu : w % 3 == 1 ? 0u : rng();
+    }
+    PackedBitmap packed(words);
+    std::vector<bool> mask(vocab_size);
+    for (int i = 0; i < vocab_size; ++i) {
+      mask[i] = packed.Get(i);
+    }
+
+    std::vector<float> expected = Logits(vocab_size);
+    EXPECT_OK(ApplyBitmapToLogits(UnpackedBitmap(mask),
+                                  absl::MakeSpan(expected)));
+    for (int i = 0; i < vocab_size; ++i) {
+      EXPECT_EQ(expected[i] == kMasked, !mask[i]);
+    }
+    std::vector<float> actual = Logits(vocab_size);
+    EXPECT_OK(ApplyBitmapToLogits(packed, absl::MakeSpan(actual)));
+    EXPECT_THAT(actual, ElementsAreArray(expected)) << vocab_size;
+  }
+}
+
+TEST(BitmapTest, EmptyWordsMaskAllLogits) {
+  std::vector<float> logits = Logits(64);
+  EXPECT_OK(ApplyBitmapToLogits(PackedBitmap({0u, 0u}),
+                                absl::MakeSpan(logits)));
+  EXPECT_THAT(logits, Each(kMasked));
+}
+
+TEST(BitmapTest, PackedWordsTooShort) {
+  std::vector<float> logits = Logits(65);
+  EXPECT_EQ(ApplyBitmapToLogits(PackedBitmap({0u, 0u}),
+                                absl::MakeSpan(logits))
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace litert::lm
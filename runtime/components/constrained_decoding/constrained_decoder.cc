@@ -15,19 +15,27 @@
 #include "runtime/components/constrained_decoding/constrained_decoder.h"
 
 #include <cstdint>
-#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/types/span.h"  // from @com_google_absl
 #include "litert/cc/litert_layout.h"  // from @litert
 #include "litert/cc/litert_macros.h"  // from @litert
 #include "litert/cc/litert_model.h"  // from @litert
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
+#include "runtime/components/constrained_decoding/bitmap.h"
+#include "runtime/components/constrained_decoding/constraint.h"
+#include "runtime/framework/threadpool.h"
 #include "runtime/util/convert_tensor_buffer.h"
 #include "runtime/util/status_macros.h"  //NOLINT
 
 namespace litert::lm {
 
+ConstrainedDecoder::~ConstrainedDecoder() { DiscardPendingBitmaps(); }
+
 absl::Status ConstrainedDecoder::UpdateConstraintState(
     const ::litert::TensorBuffer& next_token_ids) {
   LITERT_ASSIGN_OR_RETURN(auto next_token_ids_span,
@@ -40,6 +48,7 @@ absl::Status ConstrainedDecoder::UpdateConstraintState(
   RET_CHECK_EQ(next_token_ids.size(), batch_size_)
       << "Batch size [" << next_token_ids.size()
       << "] does not match the expected batch size [" << batch_size_ << "].";
+  DiscardPendingBitmaps();
   for (int i = 0; i < batch_size_; ++i) {
     auto& constraint_state = constraint_states_[i];
     ASSIGN_OR_RETURN(
@@ -79,18 +88,60 @@ absl::Status ConstrainedDecoder::MaskLogits(
   RET_CHECK_EQ(batch_size, batch_size_)
       << "Batch size [" << batch_size
       << "] does not match the expected batch size [" << batch_size_ << "].";
+  ASSIGN_OR_RETURN(auto bitmaps, TakeBitmaps());
   for (int b = 0; b < batch_size; ++b) {
-    auto& constraint_state = constraint_states_[b];
+    RETURN_IF_ERROR(ApplyBitmapToLogits(
+        *bitmaps[b], logits.subspan(b * vocab_size, vocab_size)));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ConstrainedDecoder::StartComputingBitmaps() {
+  DiscardPendingBitmaps();
+  if (worker_ == nullptr) {
+    worker_ = std::make_unique<ThreadPool>(/*name_prefix=*/"constraint",
+                                           /*max_num_threads=*/1);
+  }
+  pending_bitmaps_ = std::make_unique<PendingBitmaps>();
+  PendingBitmaps* pending = pending_bitmaps_.get();
+  absl::Status status = worker_->Schedule([this, pending]() {
+    pending->bitmaps = ComputeBitmaps();
+    pending->done.Notify();
+  });
+  if (!status.ok()) {
+    pending_bitmaps_.reset();
+  }
+  return status;
+}
+
+absl::StatusOr<std::vector<std::unique_ptr<Bitmap>>>
+ConstrainedDecoder::ComputeBitmaps() const {
+  std::vector<std::unique_ptr<Bitmap>> bitmaps;
+  bitmaps.reserve(batch_size_);
+  for (const auto& constraint_state : constraint_states_) {
     ASSIGN_OR_RETURN(auto bitmap,
                      constraint_->ComputeBitmap(*constraint_state));
-    for (int i = 0; i < vocab_size; ++i) {
-      if (!bitmap->Get(i)) {
-        logits.data()[b * vocab_size + i] =
-            std::numeric_limits<float>::lowest();
-      }
-    }
+    bitmaps.push_back(std::move(bitmap));
+  }
+  return bitmaps;
+}
+
+absl::StatusOr<std::vector<std::unique_ptr<Bitmap>>>
+ConstrainedDecoder::TakeBitmaps() {
+  if (pending_bitmaps_ == nullptr) {
+    return ComputeBitmaps();
+  }
+  pending_bitmaps_->done.WaitForNotification();
+  auto bitmaps = std::move(pending_bitmaps_->bitmaps);
+  pending_bitmaps_.reset();
+  return bitmaps;
+}
+
+void ConstrainedDecoder::DiscardPendingBitmaps() {
+  if (pending_bitmaps_ != nullptr) {
+    pending_bitmaps_->done.WaitForNotification();
+    pending_bitmaps_.reset();
   }
-  return absl::OkStatus();
 }
 
 }  // namespace litert::lm
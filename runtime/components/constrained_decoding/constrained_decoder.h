@@ -21,10 +21,14 @@
 #include <vector>
 
 #include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/synchronization/notification.h"  // from @com_google_absl
 #include "absl/types/span.h"  // from @com_google_absl
 #include "litert/cc/litert_layout.h"  // from @litert
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
+#include "runtime/components/constrained_decoding/bitmap.h"
 #include "runtime/components/constrained_decoding/constraint.h"
+#include "runtime/framework/threadpool.h"
 
 namespace litert::lm {
 
@@ -44,6 +48,11 @@ namespace litert::lm {
 //     TensorBuffer next_tokens = sampler.Sample(logits);
 //     RETURN_IF_ERROR(decoder.UpdateConstraintState(next_tokens));
 //   }
+//
+// Computing the bitmaps of complex grammars can take milliseconds. To hide
+// that cost behind the model execution, call StartComputingBitmaps() before
+// running the model; the next MaskLogits() then waits for the bitmaps computed
+// on the worker thread instead of computing them.
 class ConstrainedDecoder {
  public:
   // Creates a ConstrainedDecoder.
@@ -57,7 +66,7 @@ class ConstrainedDecoder {
     std::generate_n(std::back_inserter(constraint_states_), batch_size_,
                     [&]() { return constraint_->Start(); });
   };
-  virtual ~ConstrainedDecoder() = default;
+  virtual ~ConstrainedDecoder();
 
   // Updates the internal constraint state for each sequence in the batch based
   // on the newly selected tokens. If a sequence reaches an end state
@@ -90,12 +99,37 @@ class ConstrainedDecoder {
   absl::Status MaskLogits(absl::Span<float> logits,
                           absl::Span<const ::litert::Layout::Dim> logits_dims);
 
+  // Starts computing the allowed tokens bitmaps of the current constraint
+  // states on a worker thread. The next MaskLogits() call waits for and uses
+  // them. The computation is discarded if the states are updated before.
+  absl::Status StartComputingBitmaps();
+
  private:
+  // The bitmaps being computed on the worker thread.
+  struct PendingBitmaps {
+    absl::Notification done;
+    absl::StatusOr<std::vector<std::unique_ptr<Bitmap>>> bitmaps;
+  };
+
+  // Computes the bitmaps of the current constraint states.
+  absl::StatusOr<std::vector<std::unique_ptr<Bitmap>>> ComputeBitmaps() const;
+
+  // Returns the bitmaps started by StartComputingBitmaps() if any, or computes
+  // them.
+  absl::StatusOr<std::vector<std::unique_ptr<Bitmap>>> TakeBitmaps();
+
+  // Waits for the pending bitmaps, if any, and discards them.
+  void DiscardPendingBitmaps();
+
   // The constraint to be applied.
   Constraint* constraint_;
   const int batch_size_;
   // The current constraint states.
   std::vector<std::unique_ptr<Constraint::State>> constraint_states_;
+  std::unique_ptr<PendingBitmaps> pending_bitmaps_;
+  // The thread computing the bitmaps, created on first use. Declared last so
+  // that it is joined before the states are destroyed.
+  std::unique_ptr<ThreadPool> worker_;
 };
 
 }  // namespace litert::lm
@@ -27,6 +27,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/status/status.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "litert/c/litert_model_types.h"  // from @litert
 #include "litert/cc/litert_environment.h"  // from @litert
 #include "litert/cc/litert_expected.h"  // from @litert
@@ -228,6 +229,39 @@ TEST_F(ConstrainedDecoderTest, UpdateStateAndMaskLogitsBatchSize2) {
   }
 }
 
+TEST_F(ConstrainedDecoderTest, MaskLogitsWithBitmapsComputedAhead) {
+  ASSERT_OK_AND_ASSIGN(
+      auto constraint,
+      provider_->CreateConstraint(FstConstraintArg{.constraint_string = "ab"}));
+  ConstrainedDecoder constrained_decoder(constraint.get(), /*batch_size=*/1);
+  const std::vector<::litert::Layout::Dim> logits_dims = {1, 1, vocab_size_};
+
+  // The bitmaps of the start state are computed while "the model runs".
+  ASSERT_OK(constrained_decoder.StartComputingBitmaps());
+  std::vector<float> logits(vocab_size_, 1.0f);
+  ASSERT_OK(
+      constrained_decoder.MaskLogits(absl::MakeSpan(logits), logits_dims));
+  for (int i = 0; i < vocab_size_; ++i) {
+    EXPECT_EQ(logits[i], i == spm_processor_.PieceToId("a")
+                             ? 1.0f
+                             : std::numeric_limits<float>::lowest());
+  }
+
+  // Updating the state discards the bitmaps computed for the previous state.
+  ASSERT_OK(constrained_decoder.StartComputingBitmaps());
+  int new_token_ids[] = {spm_processor_.PieceToId("a")};
+  ASSERT_OK(
+      constrained_decoder.UpdateConstraintState(absl::MakeSpan(new_token_ids)));
+  std::vector<float> new_logits(vocab_size_, 1.0f);
+  ASSERT_OK(
+      constrained_decoder.MaskLogits(absl::MakeSpan(new_logits), logits_dims));
+  for (int i = 0; i < vocab_size_; ++i) {
+    EXPECT_EQ(new_logits[i], i == spm_processor_.PieceToId("b")
+                                 ? 1.0f
+                                 : std::numeric_limits<float>::lowest());
+  }
+}
+
 TEST_F(ConstrainedDecoderTest, UpdateStateFailsWithWrongBatchSize) {
   ASSERT_OK_AND_ASSIGN(
       auto constraint,
@@ -34,29 +34,29 @@ namespace litert::lm {
 
 namespace {
 
-std::vector<bool> SampleMaskToVector(const uint32_t* sample_mask,
-                                     size_t vocab_size, bool is_stop,
-                                     int eos_token_id) {
+std::unique_ptr<Bitmap> SampleMaskToBitmap(const uint32_t* sample_mask,
+                                           size_t vocab_size, bool is_stop,
+                                           int eos_token_id) {
+  const size_t num_words = (vocab_size + 31) / 32;
   if (sample_mask == nullptr) {
     if (is_stop) {
       // If stopped, only allow EOS.
-      std::vector<bool> mask_vector(vocab_size, false);
+      std::vector<uint32_t> words(num_words, 0);
       if (eos_token_id >= 0 && eos_token_id < vocab_size) {
-        mask_vector[eos_token_id] = true;
+        words[eos_token_id / 32] = 1u << (eos_token_id % 32);
       }
-      return mask_vector;
+      return std::make_unique<LlgBitmap>(std::move(words));
     } else {
       // If not stopped but mask is null, it implies no constraints are active
       // (unconstrained), so we allow all tokens.
-      return std::vector<bool>(vocab_size, true);
+      return std::make_unique<LlgBitmap>(std::vector<uint32_t>(),
+                                         /*all_allowed=*/true);
     }
   }
-  std::vector<bool> mask_vector;
-  mask_vector.reserve(vocab_size);
-  for (size_t i = 0; i < vocab_size; ++i) {
-    mask_vector.push_back(sample_mask[i / 32] & (1 << (i % 32)));
-  }
-  return mask_vector;
+  // The mask is owned by the llguidance constraint and overwritten by the next
+  // computation, so it is copied as is instead of being unpacked to bits.
+  return std::make_unique<LlgBitmap>(
+      std::vector<uint32_t>(sample_mask, sample_mask + num_words));
 }
 
 }  // namespace
@@ -107,9 +107,8 @@ absl::StatusOr<std::unique_ptr<Bitmap>> LlgConstraint::ComputeBitmap(
         absl::StrCat("Failed to compute mask: ", error_message));
   }
 
-  std::vector<bool> mask_vector = SampleMaskToVector(
-      mask_res.sample_mask, vocab_size_, mask_res.is_stop, eos_token_id_);
-  return std::make_unique<LlgBitmap>(std::move(mask_vector));
+  return SampleMaskToBitmap(mask_res.sample_mask, vocab_size_,
+                            mask_res.is_stop, eos_token_id_);
 }
 
 }  // namespace litert::lm
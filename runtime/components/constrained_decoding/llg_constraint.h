@@ -15,25 +15,40 @@
 #ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_COMPONENTS_CONSTRAINED_DECODING_LLG_CONSTRAINT_H_
 #define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_COMPONENTS_CONSTRAINED_DECODING_LLG_CONSTRAINT_H_
 
+#include <cstdint>
 #include <memory>
 #include <utility>
 #include <vector>
 
 #include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "runtime/components/constrained_decoding/bitmap.h"
 #include "runtime/components/constrained_decoding/constraint.h"
 #include "llguidance.h"
 
 namespace litert::lm {
 
+// A bitmap holding the sample mask of llguidance, i.e. 32 tokens per word.
 class LlgBitmap : public Bitmap {
  public:
-  explicit LlgBitmap(std::vector<bool>&& mask) : mask_(std::move(mask)) {}
+  // `words` must cover the vocabulary. If `all_allowed` is true, every token
+  // is allowed and `words` may be empty.
+  explicit LlgBitmap(std::vector<uint32_t>&& words, bool all_allowed = false)
+      : words_(std::move(words)), all_allowed_(all_allowed) {}
 
-  bool Get(int index) const override { return mask_[index]; }
+  bool Get(int index) const override {
+    return all_allowed_ || (words_[index / 32] >> (index % 32)) & 1;
+  }
+
+  absl::Span<const uint32_t> GetPackedWords() const override {
+    return words_;
+  }
+
+  bool AreAllAllowed() const override { return all_allowed_; }
 
  private:
-  const std::vector<bool> mask_;
+  const std::vector<uint32_t> words_;
+  const bool all_allowed_;
 };
 
 // A wrapper class to own the ::LlgConstraint* pointer from llguidance.h.
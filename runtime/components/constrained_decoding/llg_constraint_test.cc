@@ -94,6 +94,9 @@ TEST_F(LlgConstraintTest, ComputeBitmap) {
 
   EXPECT_TRUE(bitmap->Get(2));   // a
   EXPECT_FALSE(bitmap->Get(3));  // b
+  // The sample mask of llguidance is kept packed, 32 tokens per word.
+  ASSERT_EQ(bitmap->GetPackedWords().size(), 1);
+  EXPECT_EQ(bitmap->GetPackedWords()[0] & 0b1100, 0b0100);
 }
 
 TEST_F(LlgConstraintTest, TransitionAndEnd) {
@@ -16,6 +16,9 @@
 
 #include <sys/types.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <memory>
@@ -31,6 +34,8 @@
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
 #include "absl/types/span.h"  // from @com_google_absl
+#include "litert/c/litert_model_types.h"  // from @litert
+#include "litert/c/litert_op_code.h"  // from @litert
 #include "litert/cc/litert_common.h"  // from @litert
 #include "litert/cc/litert_compiled_model.h"  // from @litert
 #include "litert/cc/litert_element_type.h"  // from @litert
@@ -39,6 +44,7 @@
 #include "litert/cc/litert_model.h"  // from @litert
 #include "litert/cc/litert_options.h"  // from @litert
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
+#include "runtime/components/embedding_lookup/embedding_table.h"
 #include "runtime/util/status_macros.h"  //NOLINT
 
 namespace litert::lm {
@@ -58,6 +64,16 @@ absl::Status EmbeddingLookupText::LookupInternal(int token,
     return absl::OkStatus();
   }
 
+  if (embedding_table_ != nullptr) {
+    return embedding_table_->Lookup(
+        token, absl::MakeSpan(reinterpret_cast<float*>(buffer.data()),
+                              buffer.size() / sizeof(float)));
+  }
+  return RunModel(token, buffer);
+}
+
+absl::Status EmbeddingLookupText::RunModel(int token,
+                                           absl::Span<uint8_t> buffer) {
   // The input tensor size was verified when the model was loaded.
   input_buffers_[0].Write(absl::MakeSpan(const_cast<const int*>(&token), 1));
 
@@ -241,6 +257,139 @@ absl::Status EmbeddingLookupText::LookupPrefill(absl::Span<const int> tokens,
   return absl::OkStatus();
 }
 
+absl::StatusOr<std::unique_ptr<EmbeddingTable>>
+EmbeddingLookupText::FindEmbeddingTable() const {
+  LITERT_ASSIGN_OR_RETURN(auto subgraph,
+                          model_.Subgraph(signature_key_.value()));
+
+  // Only a single GATHER is allowed, optionally surrounded by ops that do not
+  // change the gathered values.
+  std::optional<litert::Op> gather;
+  for (const auto& op : subgraph.Ops()) {
+    switch (op.Code()) {
+      case kLiteRtOpCodeTflGather:
+        if (gather.has_value()) {
+          return nullptr;
+        }
+        gather = op;
+        break;
+      case kLiteRtOpCodeTflDequantize:
+      case kLiteRtOpCodeTflReshape:
+        break;
+      default:
+        return nullptr;
+    }
+  }
+  if (!gather.has_value()) {
+    return nullptr;
+  }
+
+  const auto gather_inputs = gather->Inputs();
+  if (gather_inputs.empty() || !gather_inputs[0].HasWeights()) {
+    return nullptr;
+  }
+  const litert::Tensor& table = gather_inputs[0];
+  LITERT_ASSIGN_OR_RETURN(auto table_type, table.RankedTensorType());
+  const auto& table_dims = table_type.Layout().Dimensions();
+  if (table_dims.size() < 2) {
+    return nullptr;
+  }
+  const int num_rows = table_dims[0];
+  size_t row_size = 1;
+  for (size_t i = 1; i < table_dims.size(); ++i) {
+    row_size *= table_dims[i];
+  }
+  // Every token must map to exactly one row of the table.
+  LITERT_ASSIGN_OR_RETURN(auto output_buffer_size, output_buffers_[0].Size());
+  if (row_size != floats_per_token_output_ ||
+      output_buffer_size != row_size * sizeof(float)) {
+    return nullptr;
+  }
+
+  EmbeddingTable::Type type;
+  switch (table_type.ElementType()) {
+    case litert::ElementType::Float32:
+      type = EmbeddingTable::Type::kFloat32;
+      break;
+    case litert::ElementType::Int8:
+      type = EmbeddingTable::Type::kInt8;
+      break;
+    case litert::ElementType::Int4:
+      type = EmbeddingTable::Type::kInt4;
+      break;
+    default:
+      return nullptr;
+  }
+
+  std::vector<float> scales;
+  std::vector<int64_t> zero_points;
+  switch (table.QTypeId()) {
+    case kLiteRtQuantizationNone:
+      if (type != EmbeddingTable::Type::kFloat32) {
+        return nullptr;
+      }
+      break;
+    case kLiteRtQuantizationPerTensor: {
+      const auto quantization = table.PerTensorQuantization();
+      scales.push_back(quantization.scale);
+      zero_points.push_back(quantization.zero_point);
+      break;
+    }
+    case kLiteRtQuantizationPerChannel: {
+      const auto quantization = table.PerChannelQuantization();
+      // Only one scale per row is supported.
+      if (quantization.quantized_dimension != 0) {
+        return nullptr;
+      }
+      scales.assign(quantization.scales,
+                    quantization.scales + quantization.num_channels);
+      zero_points.assign(quantization.zero_points,
+                         quantization.zero_points + quantization.num_channels);
+      break;
+    }
+    default:
+      return nullptr;
+  }
+
+  return EmbeddingTable::Create(type, table.Weights().Bytes(), num_rows,
+                                row_size, std::move(scales),
+                                std::move(zero_points));
+}
+
+absl::Status EmbeddingLookupText::InitializeEmbeddingTable() {
+  auto embedding_table = FindEmbeddingTable();
+  if (!embedding_table.ok() || *embedding_table == nullptr) {
+    ABSL_LOG(INFO) << "The Embedding model is not a plain lookup table, "
+                      "running the model for every token.";
+    return absl::OkStatus();
+  }
+
+  // Make sure that the table matches the model on a few rows before bypassing
+  // the model, in case the graph does more than what was recognized, e.g. a
+  // GATHER along another axis.
+  const int num_rows = (*embedding_table)->num_rows();
+  std::vector<float> expected(floats_per_token_output_);
+  std::vector<float> actual(floats_per_token_output_);
+  for (int token : {0, num_rows / 2, num_rows - 1}) {
+    RETURN_IF_ERROR(RunModel(
+        token, absl::MakeSpan(reinterpret_cast<uint8_t*>(expected.data()),
+                              expected.size() * sizeof(float))));
+    RETURN_IF_ERROR((*embedding_table)->Lookup(token, absl::MakeSpan(actual)));
+    for (size_t i = 0; i < expected.size(); ++i) {
+      if (std::abs(expected[i] - actual[i]) >
+          1e-5f * std::max(1.0f, std::abs(expected[i]))) {
+        ABSL_LOG(WARNING) << "The embedding table does not match the output "
+                             "of the Embedding model for token "
+                          << token << ", running the model for every token.";
+        return absl::OkStatus();
+      }
+    }
+  }
+
+  embedding_table_ = std::move(*embedding_table);
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::unique_ptr<EmbeddingLookupText>>
 EmbeddingLookupText::Create(const litert::Model* absl_nonnull model,
                             std::optional<std::string> signature_key) {
@@ -330,7 +479,7 @@ absl::Status EmbeddingLookupText::Initialize() {
              reinterpret_cast<uint8_t*>(default_embedding_vector_.data()),
              floats_per_token_output_ * sizeof(float))));
 
-  return absl::OkStatus();
+  return InitializeEmbeddingTable();
 }
 
 }  // namespace litert::lm
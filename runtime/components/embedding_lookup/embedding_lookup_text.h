@@ -35,6 +35,7 @@
 #include "litert/cc/litert_ranked_tensor_type.h"  // from @litert
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
 #include "runtime/components/embedding_lookup/embedding_lookup.h"
+#include "runtime/components/embedding_lookup/embedding_table.h"
 
 namespace litert::lm {
 
@@ -45,6 +46,11 @@ namespace litert::lm {
 // example, large embedding tables may use too much memory on the accelerator
 // and so they need to be placed on the CPU. Currently there is no mechanism
 // to tell a delegate to move embedding lookups to the CPU.
+//
+// When the model is a plain lookup table, i.e. a single GATHER from a constant
+// float32, int8 or int4 table, the rows are read directly from the table
+// weights, which are memory mapped with the model, instead of running the
+// model once per token.
 class EmbeddingLookupText : public EmbeddingLookup {
  public:
   ~EmbeddingLookupText() override = default;
@@ -126,6 +132,17 @@ class EmbeddingLookupText : public EmbeddingLookup {
   // cases.
   absl::Status LookupInternal(int token, absl::Span<uint8_t> buffer);
 
+  // Looks up the embedding of a non-negative token by running the model.
+  absl::Status RunModel(int token, absl::Span<uint8_t> buffer);
+
+  // Returns the embedding table of the model if the model is a plain lookup
+  // table, or nullptr otherwise.
+  absl::StatusOr<std::unique_ptr<EmbeddingTable>> FindEmbeddingTable() const;
+
+  // Enables direct lookups from the embedding table of the model, if any, once
+  // it is verified to match the model output.
+  absl::Status InitializeEmbeddingTable();
+
   // The environment for the embedding lookup.
   litert::Environment env_;
   // The model for the embedding lookup. The actual model instance is owned by
@@ -142,6 +159,10 @@ class EmbeddingLookupText : public EmbeddingLookup {
   // The output buffer type for the embedding model.
   std::optional<litert::RankedTensorType> output_buffer_type_;
 
+  // The embedding table read directly from the model weights, if the model is
+  // a plain lookup table. When set, the compiled model is not run anymore.
+  std::unique_ptr<EmbeddingTable> embedding_table_;
+
   // The size of the output tensor needed for a single token.
   size_t floats_per_token_output_;
 
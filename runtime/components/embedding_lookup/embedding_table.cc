@@ -0,0 +1,152 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/components/embedding_lookup/embedding_table.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+
+namespace litert::lm {
+namespace {
+
+// Returns the number of bytes holding `num_elements` elements of `type`.
+size_t NumBytes(EmbeddingTable::Type type, size_t num_elements) {
+  switch (type) {
+    case EmbeddingTable::Type::kFloat32:
+      return num_elements * sizeof(float);
+    case EmbeddingTable::Type::kInt8:
+      return num_elements;
+    case EmbeddingTable::Type::kInt4:
+      return (num_elements + 1) / 2;
+  }
+  return 0;
+}
+
+// Sign extends the lower and upper nibbles of `byte`.
+inline int8_t LowerNibble(uint8_t byte) {
+  return static_cast<int8_t>(static_cast<uint8_t>(byte << 4)) >> 4;
+}
+inline int8_t UpperNibble(uint8_t byte) {
+  return static_cast<int8_t>(byte) >> 4;
+}
+
+// The loops below are kept branch free so that the compiler vectorizes them.
+void DequantizeInt8(const int8_t* input, float scale, float zero_point,
+                    absl::Span<float> output) {
+  for (size_t i = 0; i < output.size(); ++i) {
+    output[i] = (static_cast<float>(input[i]) - zero_point) * scale;
+  }
+}
+
+// Dequantizes `output.size()` int4 elements starting at element `offset` of
+// the packed `input`.
+void DequantizeInt4(const uint8_t* input, size_t offset, float scale,
+                    float zero_point, absl::Span<float> output) {
+  input += offset / 2;
+  size_t i = 0;
+  if (offset % 2 == 1 && !output.empty()) {
+    output[i++] = (UpperNibble(*input++) - zero_point) * scale;
+  }
+  for (; i + 1 < output.size(); i += 2, ++input) {
+    output[i] = (LowerNibble(*input) - zero_point) * scale;
+    output[i + 1] = (UpperNibble(*input) - zero_point) * scale;
+  }
+  if (i < output.size()) {
+    output[i] = (LowerNibble(*input) - zero_point) * scale;
+  }
+}
+
+}  // namespace
+
+// static
+absl::StatusOr<std::unique_ptr<EmbeddingTable>> EmbeddingTable::Create(
+    Type type, absl::Span<const uint8_t> data, int num_rows, int row_size,
+    std::vector<float> scales, std::vector<int64_t> zero_points) {
+  if (num_rows <= 0 || row_size <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("The embedding table must not be empty, got ", num_rows,
+                     " rows of ", row_size, " elements."));
+  }
+  const size_t expected_size =
+      NumBytes(type, static_cast<size_t>(num_rows) * row_size);
+  if (data.size() != expected_size) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("The embedding table must hold ", expected_size,
+                     " bytes but got ", data.size()));
+  }
+  if (type == Type::kFloat32) {
+    if (!scales.empty() || !zero_points.empty()) {
+      return absl::InvalidArgumentError(
+          "A float32 embedding table must not have quantization parameters.");
+    }
+  } else {
+    if (scales.size() != 1 && scales.size() != static_cast<size_t>(num_rows)) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "A quantized embedding table must have 1 or ", num_rows,
+          " scales but got ", scales.size()));
+    }
+    if (!zero_points.empty() && zero_points.size() != scales.size()) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "The embedding table must have as many zero points as scales, got ",
+          zero_points.size(), " zero points and ", scales.size(), " scales."));
+    }
+  }
+  return absl::WrapUnique(new EmbeddingTable(type, data, num_rows, row_size,
+                                             std::move(scales),
+                                             std::move(zero_points)));
+}
+
+absl::Status EmbeddingTable::Lookup(int row, absl::Span<float> output) const {
+  if (row < 0 || row >= num_rows_) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Row ", row, " is out of range of the embedding table of ", num_rows_,
+        " rows."));
+  }
+  if (output.size() != static_cast<size_t>(row_size_)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("The embedding table output must hold ", row_size_,
+                     " floats but got ", output.size()));
+  }
+
+  const size_t offset = static_cast<size_t>(row) * row_size_;
+  if (type_ == Type::kFloat32) {
+    memcpy(output.data(), data_.data() + offset * sizeof(float),
+           row_size_ * sizeof(float));
+    return absl::OkStatus();
+  }
+
+  const int param_index = scales_.size() == 1 ? 0 : row;
+  const float scale = scales_[param_index];
+  const float zero_point =
+      zero_points_.empty() ? 0.0f : zero_points_[param_index];
+  if (type_ == Type::kInt8) {
+    DequantizeInt8(reinterpret_cast<const int8_t*>(data_.data()) + offset,
+                   scale, zero_point, output);
+  } else {
+    DequantizeInt4(data_.data(), offset, scale, zero_point, output);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace litert::lm
@@ -0,0 +1,86 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_COMPONENTS_EMBEDDING_LOOKUP_EMBEDDING_TABLE_H_
+#define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_COMPONENTS_EMBEDDING_LOOKUP_EMBEDDING_TABLE_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+
+namespace litert::lm {
+
+// A read-only view of a constant embedding table, e.g. the weights of an
+// embedding model that are memory mapped together with the model file.
+//
+// Looking up a row copies it, or dequantizes it on the fly for quantized
+// tables, without running the model. The table does not own its data, so the
+// caller must ensure that the data outlives the table.
+class EmbeddingTable {
+ public:
+  // The storage type of the table elements.
+  enum class Type {
+    kFloat32,
+    kInt8,
+    // Signed 4 bit integers, packed two per byte with the lower nibble first.
+    kInt4,
+  };
+
+  // Creates a table of `num_rows` rows of `row_size` elements, stored in
+  // row-major order in `data`.
+  //
+  // Float32 tables must not have quantization parameters. Quantized tables
+  // must have either one scale for the whole table or one scale per row, and
+  // the same number of zero points, or none if all the zero points are 0. An
+  // element q of row r is dequantized as (q - zero_points[r]) * scales[r].
+  static absl::StatusOr<std::unique_ptr<EmbeddingTable>> Create(
+      Type type, absl::Span<const uint8_t> data, int num_rows, int row_size,
+      std::vector<float> scales = {}, std::vector<int64_t> zero_points = {});
+
+  // Writes the (dequantized) row `row` to `output`, which must hold exactly
+  // row_size() floats.
+  absl::Status Lookup(int row, absl::Span<float> output) const;
+
+  int num_rows() const { return num_rows_; }
+  int row_size() const { return row_size_; }
+
+ private:
+  EmbeddingTable(Type type, absl::Span<const uint8_t> data, int num_rows,
+                 int row_size, std::vector<float> scales,
+                 std::vector<int64_t> zero_points)
+      : type_(type),
+        data_(data),
+        num_rows_(num_rows),
+        row_size_(row_size),
+        scales_(std::move(scales)),
+        zero_points_(std::move(zero_points)) {}
+
+  const Type type_;
+  const absl::Span<const uint8_t> data_;
+  const int num_rows_;
+  const int row_size_;
+  // Empty for float32 tables, otherwise of size 1 or num_rows_.
+  const std::vector<float> scales_;
+  // Empty, or of the same size as scales_.
+  const std::vector<int64_t> zero_points_;
+};
+
+}  // namespace litert::lm
+
+#endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_COMPONENTS_EMBEDDING_LOOKUP_EMBEDDING_TABLE_H_
@@ -0,0 +1,147 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/components/embedding_lookup/embedding_table.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+#include "runtime/util/test_utils.h"  // IWYU pragma: keep
+
+namespace litert::lm {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::status::StatusIs;
+
+absl::Span<const uint8_t> AsBytes(const std::vector<float>& data) {
+  return absl::MakeConstSpan(reinterpret_cast<const uint8_t*>(data.data()),
+                             data.size() * sizeof(float));
+}
+
+absl::Span<const uint8_t> AsBytes(const std::vector<int8_t>& data) {
+  return absl::MakeConstSpan(reinterpret_cast<const uint8_t*>(data.data()),
+                             data.size());
+}
+
+TEST(EmbeddingTableTest, CreateFailsWithInvalidArguments) {
+  const std::vector<float> data = {1, 2, 3, 4, 5, 6};
+  // Empty table.
+  EXPECT_THAT(EmbeddingTable::Create(EmbeddingTable::Type::kFloat32, {},
+                                     /*num_rows=*/0, /*row_size=*/3),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  // Size mismatch.
+  EXPECT_THAT(EmbeddingTable::Create(EmbeddingTable::Type::kFloat32,
+                                     AsBytes(data), /*num_rows=*/3,
+                                     /*row_size=*/3),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  // Quantization parameters on a float table.
+  EXPECT_THAT(EmbeddingTable::Create(EmbeddingTable::Type::kFloat32,
+                                     AsBytes(data), /*num_rows=*/2,
+                                     /*row_size=*/3, /*scales=*/{1.0f}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  const std::vector<int8_t> quantized = {1, 2, 3, 4, 5, 6};
+  // Missing scales.
+  EXPECT_THAT(EmbeddingTable::Create(EmbeddingTable::Type::kInt8,
+                                     AsBytes(quantized), /*num_rows=*/2,
+                                     /*row_size=*/3),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  // Zero points not matching the scales.
+  EXPECT_THAT(EmbeddingTable::Create(EmbeddingTable::Type::kInt8,
+                                     AsBytes(quantized), /*num_rows=*/2,
+                                     /*row_size=*/3, /*scales=*/{1.0f, 2.0f},
+                                     /*zero_points=*/{0}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(EmbeddingTableTest, LookupFloat32) {
+  const std::vector<float> data = {1, 2, 3, 4, 5, 6};
+  ASSERT_OK_AND_ASSIGN(
+      auto table, EmbeddingTable::Create(EmbeddingTable::Type::kFloat32,
+                                         AsBytes(data), /*num_rows=*/2,
+                                         /*row_size=*/3));
+  std::vector<float> output(3);
+  EXPECT_OK(table->Lookup(1, absl::MakeSpan(output)));
+  EXPECT_THAT(output, ElementsAre(4, 5, 6));
+  EXPECT_OK(table->Lookup(0, absl::MakeSpan(output)));
+  EXPECT_THAT(output, ElementsAre(1, 2, 3));
+}
+
+TEST(EmbeddingTableTest, LookupFailsWithInvalidArguments) {
+  const std::vector<float> data = {1, 2, 3, 4, 5, 6};
+  ASSERT_OK_AND_ASSIGN(
+      auto table, EmbeddingTable::Create(EmbeddingTable::Type::kFloat32,
+                                         AsBytes(data), /*num_rows=*/2,
+                                         /*row_size=*/3));
+  std::vector<float> output(3);
+  EXPECT_THAT(table->Lookup(2, absl::MakeSpan(output)),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(table->Lookup(-1, absl::MakeSpan(output)),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  std::vector<float> too_small(2);
+  EXPECT_THAT(table->Lookup(0, absl::MakeSpan(too_small)),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(EmbeddingTableTest, LookupInt8PerTensor) {
+  const std::vector<int8_t> data = {-4, 0, 4, 10, -128, 127};
+  ASSERT_OK_AND_ASSIGN(
+      auto table,
+      EmbeddingTable::Create(EmbeddingTable::Type::kInt8, AsBytes(data),
+                             /*num_rows=*/2, /*row_size=*/3,
+                             /*scales=*/{0.5f}, /*zero_points=*/{2}));
+  std::vector<float> output(3);
+  EXPECT_OK(table->Lookup(0, absl::MakeSpan(output)));
+  EXPECT_THAT(output, ElementsAre(-3.0f, -1.0f, 1.0f));
+  EXPECT_OK(table->Lookup(1, absl::MakeSpan(output)));
+  EXPECT_THAT(output, ElementsAre(4.0f, -65.0f, 62.5f));
+}
+
+TEST(EmbeddingTableTest, LookupInt8PerRow) {
+  const std::vector<int8_t> data = {1, 2, 3, 1, 2, 3};
+  ASSERT_OK_AND_ASSIGN(
+      auto table,
+      EmbeddingTable::Create(EmbeddingTable::Type::kInt8, AsBytes(data),
+                             /*num_rows=*/2, /*row_size=*/3,
+                             /*scales=*/{1.0f, 0.25f}));
+  std::vector<float> output(3);
+  EXPECT_OK(table->Lookup(0, absl::MakeSpan(output)));
+  EXPECT_THAT(output, ElementsAre(1.0f, 2.0f, 3.0f));
+  EXPECT_OK(table->Lookup(1, absl::MakeSpan(output)));
+  EXPECT_THAT(output, ElementsAre(0.25f, 0.5f, 0.75f));
+}
+
+TEST(EmbeddingTableTest, LookupInt4WithOddRowSize) {
+  // Elements 1, -2, 3, -8, 7, 0 packed with the lower nibble first.
+  const std::vector<uint8_t> data = {0xE1, 0x83, 0x07};
+  ASSERT_OK_AND_ASSIGN(
+      auto table,
+      EmbeddingTable::Create(EmbeddingTable::Type::kInt4, data,
+                             /*num_rows=*/2, /*row_size=*/3,
+                             /*scales=*/{2.0f}));
+  std::vector<float> output(3);
+  EXPECT_OK(table->Lookup(0, absl::MakeSpan(output)));
+  EXPECT_THAT(output, ElementsAre(2.0f, -4.0f, 6.0f));
+  // The second row starts in the middle of a byte.
+  EXPECT_OK(table->Lookup(1, absl::MakeSpan(output)));
+  EXPECT_THAT(output, ElementsAre(-16.0f, 14.0f, 0.0f));
+}
+
+}  // namespace
+}  // namespace litert::lm
@@ -0,0 +1,705 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/components/sampling_cpu_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+#include "absl/types/span.h"  // from @com_google_absl
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__)) && !defined(_MSC_VER)
+#define LITERT_LM_SAMPLING_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define LITERT_LM_SAMPLING_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace litert::lm {
+namespace {
+
+// The number of values scanned by TopKIndices() between two compactions of
+// the candidates.
+constexpr int kTopKChunkSize = 1024;
+
+// The range of the vectorized exp(). Inputs below kExpMin underflow to 0. The
+// sampling kernels only compute exp() of non positive values, so the upper
+// bound only has to keep the exponent in range.
+constexpr float kExpMin = -87.3365478515625f;
+constexpr float kExpMax = 88.0f;
+constexpr float kLog2e = 1.44269504088896341f;
+// ln(2) split in a part exactly representable in float and a remainder.
+constexpr float kLn2Hi = 0.693359375f;
+constexpr float kLn2Lo = -2.12194440e-4f;
+// Polynomial approximation of exp() on [-ln(2) / 2, ln(2) / 2].
+constexpr float kExpP0 = 1.9875691500e-4f;
+constexpr float kExpP1 = 1.3981999507e-3f;
+constexpr float kExpP2 = 8.3334519073e-3f;
+constexpr float kExpP3 = 4.1665795894e-2f;
+constexpr float kExpP4 = 1.6666665459e-1f;
+constexpr float kExpP5 = 5.0000001201e-1f;
+
+// ---------------------------------------------------------------------------
+// Scalar kernels.
+// ---------------------------------------------------------------------------
+
+int ArgMaxScalar(const float* values, int size) {
+  return std::max_element(values, values + size) - values;
+}
+
+int SelectGreaterScalar(const float* values, int size, float threshold,
+                        int* indices) {
+  int num_selected = 0;
+  for (int i = 0; i < size; ++i) {
+    indices[num_selected] = i;
+    num_selected += values[i] > threshold;
+  }
+  return num_selected;
+}
+
+float ExpAndSumScalar(const float* values, int size, float offset,
+                      float temperature, float* output) {
+  float sum = 0.0f;
+  for (int i = 0; i < size; ++i) {
+    output[i] = std::exp((values[i] - offset) / temperature);
+    sum += output[i];
+  }
+  return sum;
+}
+
+float SumExpScalar(const float* values, int size, float offset,
+                   float temperature) {
+  float sum = 0.0f;
+  for (int i = 0; i < size; ++i) {
+    sum += std::exp((values[i] - offset) / temperature);
+  }
+  return sum;
+}
+
+void ScaleScalar(float* values, int size, float scale) {
+  for (int i = 0; i < size; ++i) {
+    values[i] *= scale;
+  }
+}
+
+int CumulativeCutoffScalar(const float* values, int size, double threshold,
+                           double* cumulative) {
+  double sum = 0.0;
+  for (int i = 0; i < size; ++i) {
+    sum += values[i];
+    if (sum >= threshold) {
+      *cumulative = sum;
+      return i + 1;
+    }
+  }
+  *cumulative = sum;
+  return size;
+}
+
+constexpr SamplingCpuKernels kScalarKernels = {
+    .name = "scalar",
+    .arg_max = ArgMaxScalar,
+    .select_greater = SelectGreaterScalar,
+    .exp_and_sum = ExpAndSumScalar,
+    .sum_exp = SumExpScalar,
+    .scale = ScaleScalar,
+    .cumulative_cutoff = CumulativeCutoffScalar,
+};
+
+#if defined(LITERT_LM_SAMPLING_X86)
+
+// ---------------------------------------------------------------------------
+// AVX2 kernels.
+// ---------------------------------------------------------------------------
+
+#define LITERT_LM_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define LITERT_LM_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+
+LITERT_LM_TARGET_AVX2 inline float ReduceMaxAvx2(__m256 x) {
+  __m128 m = _mm_max_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+  m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+  m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+  return _mm_cvtss_f32(m);
+}
+
+LITERT_LM_TARGET_AVX2 inline float ReduceAddAvx2(__m256 x) {
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+  return _mm_cvtss_f32(s);
+}
+
+LITERT_LM_TARGET_AVX2 inline __m256 ExpAvx2(__m256 x) {
+  const __m256 underflow =
+      _mm256_cmp_ps(x, _mm256_set1_ps(kExpMin), _CMP_LT_OQ);
+  x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(kExpMin)),
+                    _mm256_set1_ps(kExpMax));
+  // exp(x) = 2^n * exp(r) with r = x - n * ln(2) in [-ln(2) / 2, ln(2) / 2].
+  const __m256 n =
+      _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(kLog2e)),
+                      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  x = _mm256_fnmadd_ps(n, _mm256_set1_ps(kLn2Hi), x);
+  x = _mm256_fnmadd_ps(n, _mm256_set1_ps(kLn2Lo), x);
+  __m256 y = _mm256_set1_ps(kExpP0);
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP1));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP2));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP3));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP4));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP5));
+  y = _mm256_fmadd_ps(y, _mm256_mul_ps(x, x), x);
+  y = _mm256_add_ps(y, _mm256_set1_ps(1.0f));
+  const __m256i pow2n = _mm256_slli_epi32(
+      _mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+  y = _mm256_mul_ps(y, _mm256_castsi256_ps(pow2n));
+  return _mm256_andnot_ps(underflow, y);
+}
+
+LITERT_LM_TARGET_AVX2 int ArgMaxAvx2(const float* values, int size) {
+  float max_value = values[0];
+  int i = 0;
+  if (size >= 8) {
+    __m256 max_vec = _mm256_loadu_ps(values);
+    for (i = 8; i + 8 <= size; i += 8) {
+      max_vec = _mm256_max_ps(max_vec, _mm256_loadu_ps(values + i));
+    }
+    max_value = ReduceMaxAvx2(max_vec);
+  }
+  for (; i < size; ++i) {
+    max_value = std::max(max_value, values[i]);
+  }
+  // Find the first occurrence of the maximum.
+  const __m256 max_vec = _mm256_set1_ps(max_value);
+  for (i = 0; i + 8 <= size; i += 8) {
+    const int mask = _mm256_movemask_ps(
+        _mm256_cmp_ps(_mm256_loadu_ps(values + i), max_vec, _CMP_EQ_OQ));
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  for (; i < size; ++i) {
+    if (values[i] == max_value) {
+      return i;
+    }
+  }
+  return 0;
+}
+
+LITERT_LM_TARGET_AVX2 int SelectGreaterAvx2(const float* values, int size,
+                                            float threshold, int* indices) {
+  const __m256 threshold_vec = _mm256_set1_ps(threshold);
+  int num_selected = 0;
+  int i = 0;
+  for (; i + 8 <= size; i += 8) {
+    unsigned mask = _mm256_movemask_ps(_mm256_cmp_ps(
+        _mm256_loadu_ps(values + i), threshold_vec, _CMP_GT_OQ));
+    // Most blocks have no value above the threshold.
+    while (mask != 0) {
+      indices[num_selected++] = i + __builtin_ctz(mask);
+      mask &= mask - 1;
+    }
+  }
+  for (; i < size; ++i) {
+    indices[num_selected] = i;
+    num_selected += values[i] > threshold;
+  }
+  return num_selected;
+}
+
+LITERT_LM_TARGET_AVX2 float ExpAndSumAvx2(const float* values, int size,
+                                          float offset, float temperature,
+                                          float* output) {
+  const __m256 offset_vec = _mm256_set1_ps(offset);
+  const __m256 temperature_vec = _mm256_set1_ps(temperature);
+  __m256 sum_vec = _mm256_setzero_ps();
+  int i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m256 y = ExpAvx2(_mm256_div_ps(
+        _mm256_sub_ps(_mm256_loadu_ps(values + i), offset_vec),
+        temperature_vec));
+    _mm256_storeu_ps(output + i, y);
+    sum_vec = _mm256_add_ps(sum_vec, y);
+  }
+  float sum = ReduceAddAvx2(sum_vec);
+  for (; i < size; ++i) {
+    output[i] = std::exp((values[i] - offset) / temperature);
+    sum += output[i];
+  }
+  return sum;
+}
+
+LITERT_LM_TARGET_AVX2 float SumExpAvx2(const float* values, int size,
+                                       float offset, float temperature) {
+  const __m256 offset_vec = _mm256_set1_ps(offset);
+  const __m256 temperature_vec = _mm256_set1_ps(temperature);
+  __m256 sum_vec = _mm256_setzero_ps();
+  int i = 0;
+  for (; i + 8 <= size; i += 8) {
+    sum_vec = _mm256_add_ps(
+        sum_vec, ExpAvx2(_mm256_div_ps(
+                     _mm256_sub_ps(_mm256_loadu_ps(values + i), offset_vec),
+                     temperature_vec)));
+  }
+  float sum = ReduceAddAvx2(sum_vec);
+  for (; i < size; ++i) {
+    sum += std::exp((values[i] - offset) / temperature);
+  }
+  return sum;
+}
+
+LITERT_LM_TARGET_AVX2 void ScaleAvx2(float* values, int size, float scale) {
+  const __m256 scale_vec = _mm256_set1_ps(scale);
+  int i = 0;
+  for (; i + 8 <= size; i += 8) {
+    _mm256_storeu_ps(values + i,
+                     _mm256_mul_ps(_mm256_loadu_ps(values + i), scale_vec));
+  }
+  for (; i < size; ++i) {
+    values[i] *= scale;
+  }
+}
+
+// The prefix sums are computed 4 values at a time with in-register shifts, on
+// top of the running total of the previous blocks.
+LITERT_LM_TARGET_AVX2 int CumulativeCutoffAvx2(const float* values, int size,
+                                               double threshold,
+                                               double* cumulative) {
+  const float threshold_f = threshold;
+  const __m128 threshold_vec = _mm_set1_ps(threshold_f);
+  __m128 carry = _mm_setzero_ps();
+  int i = 0;
+  for (; i + 4 <= size; i += 4) {
+    __m128 x = _mm_loadu_ps(values + i);
+    x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)));
+    x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 8)));
+    x = _mm_add_ps(x, carry);
+    const int mask = _mm_movemask_ps(_mm_cmpge_ps(x, threshold_vec));
+    if (mask != 0) {
+      alignas(16) float prefix_sums[4];
+      _mm_store_ps(prefix_sums, x);
+      const int lane = __builtin_ctz(mask);
+      *cumulative = prefix_sums[lane];
+      return i + lane + 1;
+    }
+    carry = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+  }
+  float sum = _mm_cvtss_f32(carry);
+  for (; i < size; ++i) {
+    sum += values[i];
+    if (sum >= threshold_f) {
+      *cumulative = sum;
+      return i + 1;
+    }
+  }
+  *cumulative = sum;
+  return size;
+}
+
+constexpr SamplingCpuKernels kAvx2Kernels = {
+    .name = "avx2",
+    .arg_max = ArgMaxAvx2,
+    .select_greater = SelectGreaterAvx2,
+    .exp_and_sum = ExpAndSumAvx2,
+    .sum_exp = SumExpAvx2,
+    .scale = ScaleAvx2,
+    .cumulative_cutoff = CumulativeCutoffAvx2,
+};
+
+// ---------------------------------------------------------------------------
+// AVX-512 kernels.
+// ---------------------------------------------------------------------------
+
+LITERT_LM_TARGET_AVX512 inline __m512 ExpAvx512(__m512 x) {
+  const __mmask16 underflow =
+      _mm512_cmp_ps_mask(x, _mm512_set1_ps(kExpMin), _CMP_LT_OQ);
+  x = _mm512_min_ps(_mm512_max_ps(x, _mm512_set1_ps(kExpMin)),
+                    _mm512_set1_ps(kExpMax));
+  const __m512 n =
+      _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(kLog2e)),
+                           _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  x = _mm512_fnmadd_ps(n, _mm512_set1_ps(kLn2Hi), x);
+  x = _mm512_fnmadd_ps(n, _mm512_set1_ps(kLn2Lo), x);
+  __m512 y = _mm512_set1_ps(kExpP0);
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP1));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP2));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP3));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP4));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP5));
+  y = _mm512_fmadd_ps(y, _mm512_mul_ps(x, x), x);
+  y = _mm512_add_ps(y, _mm512_set1_ps(1.0f));
+  const __m512i pow2n = _mm512_slli_epi32(
+      _mm512_add_epi32(_mm512_cvtps_epi32(n), _mm512_set1_epi32(127)), 23);
+  y = _mm512_mul_ps(y, _mm512_castsi512_ps(pow2n));
+  return _mm512_maskz_mov_ps(static_cast<__mmask16>(~underflow), y);
+}
+
+LITERT_LM_TARGET_AVX512 int ArgMaxAvx512(const float* values, int size) {
+  float max_value = values[0];
+  int i = 0;
+  if (size >= 16) {
+    __m512 max_vec = _mm512_loadu_ps(values);
+    for (i = 16; i + 16 <= size; i += 16) {
+      max_vec = _mm512_max_ps(max_vec, _mm512_loadu_ps(values + i));
+    }
+    max_value = _mm512_reduce_max_ps(max_vec);
+  }
+  for (; i < size; ++i) {
+    max_value = std::max(max_value, values[i]);
+  }
+  const __m512 max_vec = _mm512_set1_ps(max_value);
+  for (i = 0; i + 16 <= size; i += 16) {
+    const __mmask16 mask = _mm512_cmp_ps_mask(_mm512_loadu_ps(values + i),
+                                              max_vec, _CMP_EQ_OQ);
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  for (; i < size; ++i) {
+    if (values[i] == max_value) {
+      return i;
+    }
+  }
+  return 0;
+}
+
+LITERT_LM_TARGET_AVX512 int SelectGreaterAvx512(const float* values, int size,
+                                                float threshold,
+                                                int* indices) {
+  const __m512 threshold_vec = _mm512_set1_ps(threshold);
+  const __m512i lane_indices = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+                                                 10, 11, 12, 13, 14, 15);
+  int num_selected = 0;
+  int i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const __mmask16 mask = _mm512_cmp_ps_mask(_mm512_loadu_ps(values + i),
+                                              threshold_vec, _CMP_GT_OQ);
+    if (mask != 0) {
+      _mm512_mask_compressstoreu_epi32(
+          indices + num_selected, mask,
+          _mm512_add_epi32(lane_indices, _mm512_set1_epi32(i)));
+      num_selected += __builtin_popcount(mask);
+    }
+  }
+  for (; i < size; ++i) {
+    indices[num_selected] = i;
+    num_selected += values[i] > threshold;
+  }
+  return num_selected;
+}
+
+LITERT_LM_TARGET_AVX512 float ExpAndSumAvx512(const float* values, int size,
+                                              float offset, float temperature,
+                                              float* output) {
+  const __m512 offset_vec = _mm512_set1_ps(offset);
+  const __m512 temperature_vec = _mm512_set1_ps(temperature);
+  __m512 sum_vec = _mm512_setzero_ps();
+  int i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const __m512 y = ExpAvx512(_mm512_div_ps(
+        _mm512_sub_ps(_mm512_loadu_ps(values + i), offset_vec),
+        temperature_vec));
+    _mm512_storeu_ps(output + i, y);
+    sum_vec = _mm512_add_ps(sum_vec, y);
+  }
+  float sum = _mm512_reduce_add_ps(sum_vec);
+  for (; i < size; ++i) {
+    output[i] = std::exp((values[i] - offset) / temperature);
+    sum += output[i];
+  }
+  return sum;
+}
+
+LITERT_LM_TARGET_AVX512 float SumExpAvx512(const float* values, int size,
+                                           float offset, float temperature) {
+  const __m512 offset_vec = _mm512_set1_ps(offset);
+  const __m512 temperature_vec = _mm512_set1_ps(temperature);
+  __m512 sum_vec = _mm512_setzero_ps();
+  int i = 0;
+  for (; i + 16 <= size; i += 16) {
+    sum_vec = _mm512_add_ps(
+        sum_vec, ExpAvx512(_mm512_div_ps(
+                     _mm512_sub_ps(_mm512_loadu_ps(values + i), offset_vec),
+                     temperature_vec)));
+  }
+  float sum = _mm512_reduce_add_ps(sum_vec);
+  for (; i < size; ++i) {
+    sum += std::exp((values[i] - offset) / temperature);
+  }
+  return sum;
+}
+
+// Scaling is memory bound and the prefix sums are latency bound, AVX-512 does
+// not help there.
+constexpr SamplingCpuKernels kAvx512Kernels = {
+    .name = "avx512",
+    .arg_max = ArgMaxAvx512,
+    .select_greater = SelectGreaterAvx512,
+    .exp_and_sum = ExpAndSumAvx512,
+    .sum_exp = SumExpAvx512,
+    .scale = ScaleAvx2,
+    .cumulative_cutoff = CumulativeCutoffAvx2,
+};
+
+#elif defined(LITERT_LM_SAMPLING_NEON)
+
+// ---------------------------------------------------------------------------
+// NEON kernels.
+// ---------------------------------------------------------------------------
+
+inline float32x4_t ExpNeon(float32x4_t x) {
+  const uint32x4_t underflow = vcltq_f32(x, vdupq_n_f32(kExpMin));
+  x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(kExpMin)), vdupq_n_f32(kExpMax));
+  const float32x4_t n = vrndnq_f32(vmulq_n_f32(x, kLog2e));
+  x = vfmsq_f32(x, n, vdupq_n_f32(kLn2Hi));
+  x = vfmsq_f32(x, n, vdupq_n_f32(kLn2Lo));
+  float32x4_t y = vdupq_n_f32(kExpP0);
+  y = vfmaq_f32(vdupq_n_f32(kExpP1), y, x);
+  y = vfmaq_f32(vdupq_n_f32(kExpP2), y, x);
+  y = vfmaq_f32(vdupq_n_f32(kExpP3), y, x);
+  y = vfmaq_f32(vdupq_n_f32(kExpP4), y, x);
+  y = vfmaq_f32(vdupq_n_f32(kExpP5), y, x);
+  y = vfmaq_f32(x, y, vmulq_f32(x, x));
+  y = vaddq_f32(y, vdupq_n_f32(1.0f));
+  const int32x4_t pow2n =
+      vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(127)), 23);
+  y = vmulq_f32(y, vreinterpretq_f32_s32(pow2n));
+  return vreinterpretq_f32_u32(
+      vbicq_u32(vreinterpretq_u32_f32(y), underflow));
+}
+
+int ArgMaxNeon(const float* values, int size) {
+  float max_value = values[0];
+  int i = 0;
+  if (size >= 4) {
+    float32x4_t max_vec = vld1q_f32(values);
+    for (i = 4; i + 4 <= size; i += 4) {
+      max_vec = vmaxq_f32(max_vec, vld1q_f32(values + i));
+    }
+    max_value = vmaxvq_f32(max_vec);
+  }
+  for (; i < size; ++i) {
+    max_value = std::max(max_value, values[i]);
+  }
+  const float32x4_t max_vec = vdupq_n_f32(max_value);
+  for (i = 0; i + 4 <= size; i += 4) {
+    if (vmaxvq_u32(vceqq_f32(vld1q_f32(values + i), max_vec)) != 0) {
+      break;
+    }
+  }
+  for (; i < size; ++i) {
+    if (values[i] == max_value) {
+      return i;
+    }
+  }
+  return 0;
+}
+
+int SelectGreaterNeon(const float* values, int size, float threshold,
+                      int* indices) {
+  const float32x4_t threshold_vec = vdupq_n_f32(threshold);
+  int num_selected = 0;
+  int i = 0;
+  for (; i + 4 <= size; i += 4) {
+    // Most blocks have no value above the threshold.
+    if (vmaxvq_u32(vcgtq_f32(vld1q_f32(values + i), threshold_vec)) == 0) {
+      continue;
+    }
+    for (int j = i; j < i + 4; ++j) {
+      indices[num_selected] = j;
+      num_selected += values[j] > threshold;
+    }
+  }
+  for (; i < size; ++i) {
+    indices[num_selected] = i;
+    num_selected += values[i] > threshold;
+  }
+  return num_selected;
+}
+
+float ExpAndSumNeon(const float* values, int size, float offset,
+                    float temperature, float* output) {
+  const float32x4_t offset_vec = vdupq_n_f32(offset);
+  const float32x4_t temperature_vec = vdupq_n_f32(temperature);
+  float32x4_t sum_vec = vdupq_n_f32(0.0f);
+  int i = 0;
+  for (; i + 4 <= size; i += 4) {
+    const float32x4_t y = ExpNeon(vdivq_f32(
+        vsubq_f32(vld1q_f32(values + i), offset_vec), temperature_vec));
+    vst1q_f32(output + i, y);
+    sum_vec = vaddq_f32(sum_vec, y);
+  }
+  float sum = vaddvq_f32(sum_vec);
+  for (; i < size; ++i) {
+    output[i] = std::exp((values[i] - offset) / temperature);
+    sum += output[i];
+  }
+  return sum;
+}
+
+float SumExpNeon(const float* values, int size, float offset,
+                 float temperature) {
+  const float32x4_t offset_vec = vdupq_n_f32(offset);
+  const float32x4_t temperature_vec = vdupq_n_f32(temperature);
+  float32x4_t sum_vec = vdupq_n_f32(0.0f);
+  int i = 0;
+  for (; i + 4 <= size; i += 4) {
+    sum_vec = vaddq_f32(sum_vec,
+                        ExpNeon(vdivq_f32(
+                            vsubq_f32(vld1q_f32(values + i), offset_vec),
+                            temperature_vec)));
+  }
+  float sum = vaddvq_f32(sum_vec);
+  for (; i < size; ++i) {
+    sum += std::exp((values[i] - offset) / temperature);
+  }
+  return sum;
+}
+
+void ScaleNeon(float* values, int size, float scale) {
+  int i = 0;
+  for (; i + 4 <= size; i += 4) {
+    vst1q_f32(values + i, vmulq_n_f32(vld1q_f32(values + i), scale));
+  }
+  for (; i < size; ++i) {
+    values[i] *= scale;
+  }
+}
+
+int CumulativeCutoffNeon(const float* values, int size, double threshold,
+                         double* cumulative) {
+  const float threshold_f = threshold;
+  const float32x4_t threshold_vec = vdupq_n_f32(threshold_f);
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  float32x4_t carry = zero;
+  int i = 0;
+  for (; i + 4 <= size; i += 4) {
+    float32x4_t x = vld1q_f32(values + i);
+    x = vaddq_f32(x, vextq_f32(zero, x, 3));
+    x = vaddq_f32(x, vextq_f32(zero, x, 2));
+    x = vaddq_f32(x, carry);
+    if (vmaxvq_u32(vcgeq_f32(x, threshold_vec)) != 0) {
+      float prefix_sums[4];
+      vst1q_f32(prefix_sums, x);
+      for (int lane = 0; lane < 4; ++lane) {
+        if (prefix_sums[lane] >= threshold_f) {
+          *cumulative = prefix_sums[lane];
+          return i + lane + 1;
+        }
+      }
+    }
+    carry = vdupq_laneq_f32(x, 3);
+  }
+  float sum = vgetq_lane_f32(carry, 0);
+  for (; i < size; ++i) {
+    sum += values[i];
+    if (sum >= threshold_f) {
+      *cumulative = sum;
+      return i + 1;
+    }
+  }
+  *cumulative = sum;
+  return size;
+}
+
+constexpr SamplingCpuKernels kNeonKernels = {
+    .name = "neon",
+    .arg_max = ArgMaxNeon,
+    .select_greater = SelectGreaterNeon,
+    .exp_and_sum = ExpAndSumNeon,
+    .sum_exp = SumExpNeon,
+    .scale = ScaleNeon,
+    .cumulative_cutoff = CumulativeCutoffNeon,
+};
+
+#endif
+
+}  // namespace
+
+const SamplingCpuKernels& GetScalarSamplingCpuKernels() {
+  return kScalarKernels;
+}
+
+const SamplingCpuKernels& GetSamplingCpuKernels() {
+  static const SamplingCpuKernels* const kernels =
+      GetSupportedSamplingCpuKernels().back();
+  return *kernels;
+}
+
+std::vector<const SamplingCpuKernels*> GetSupportedSamplingCpuKernels() {
+  std::vector<const SamplingCpuKernels*> kernels = {&kScalarKernels};
+#if defined(LITERT_LM_SAMPLING_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    kernels.push_back(&kAvx2Kernels);
+    if (__builtin_cpu_supports("avx512f")) {
+      kernels.push_back(&kAvx512Kernels);
+    }
+  }
+#elif defined(LITERT_LM_SAMPLING_NEON)
+  kernels.push_back(&kNeonKernels);
+#endif
+  return kernels;
+}
+
+void TopKIndices(const SamplingCpuKernels& kernels,
+                 absl::Span<const float> values, absl::Span<int> output) {
+  const int size = values.size();
+  const int k = output.size();
+  if (k >= size) {
+    std::iota(output.begin(), output.end(), 0);
+    return;
+  }
+  auto greater = [&values](int i1, int i2) { return values[i1] > values[i2]; };
+
+  // Seed the candidates with the first k values. The threshold is always the
+  // smallest of k candidates, so that any value not above it can be skipped.
+  std::vector<int> candidates(k);
+  std::iota(candidates.begin(), candidates.end(), 0);
+  float threshold = values[*std::min_element(
+      candidates.begin(), candidates.end(),
+      [&values](int i1, int i2) { return values[i1] < values[i2]; })];
+
+  const size_t max_num_candidates = std::max(2 * k, kTopKChunkSize);
+  candidates.reserve(max_num_candidates + kTopKChunkSize);
+  for (int begin = k; begin < size; begin += kTopKChunkSize) {
+    const int chunk_size = std::min(kTopKChunkSize, size - begin);
+    const int num_candidates = candidates.size();
+    candidates.resize(num_candidates + chunk_size);
+    const int num_selected =
+        kernels.select_greater(values.data() + begin, chunk_size, threshold,
+                               candidates.data() + num_candidates);
+    candidates.resize(num_candidates + num_selected);
+    for (size_t i = num_candidates; i < candidates.size(); ++i) {
+      candidates[i] += begin;
+    }
+    // Keep the best k candidates and raise the threshold.
+    if (candidates.size() >= max_num_candidates) {
+      std::nth_element(candidates.begin(), candidates.begin() + k - 1,
+                       candidates.end(), greater);
+      candidates.resize(k);
+      threshold = values[candidates[k - 1]];
+    }
+  }
+  if (candidates.size() > static_cast<size_t>(k)) {
+    std::nth_element(candidates.begin(), candidates.begin() + k - 1,
+                     candidates.end(), greater);
+  }
+  std::copy(candidates.begin(), candidates.begin() + k, output.begin());
+}
+
+}  // namespace litert::lm
@@ -0,0 +1,87 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_COMPONENTS_SAMPLING_CPU_KERNELS_H_
+#define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_COMPONENTS_SAMPLING_CPU_KERNELS_H_
+
+#include <vector>
+
+#include "absl/types/span.h"  // from @com_google_absl
+
+namespace litert::lm {
+
+// The vectorized building blocks of the CPU sampling utilities.
+//
+// Every instruction set has its own table of kernels. The scalar kernels are
+// always available and define the reference behavior; the vectorized kernels
+// return the same indices and, up to floating point rounding, the same values.
+// The best table for the running CPU is picked once at runtime, so that a
+// single binary uses AVX-512 or AVX2 where available on x86, and NEON on
+// arm64.
+struct SamplingCpuKernels {
+  // The name of the instruction set, e.g. "avx2".
+  const char* name;
+
+  // Returns the index of the first maximum of values[0, size). `size` must be
+  // positive.
+  int (*arg_max)(const float* values, int size);
+
+  // Writes the indices of the values greater than `threshold` to `indices`, in
+  // increasing order, and returns their number. `indices` must have room for
+  // `size` entries.
+  int (*select_greater)(const float* values, int size, float threshold,
+                        int* indices);
+
+  // Writes exp((values[i] - offset) / temperature) to output[i] and returns
+  // the sum of the outputs. `output` may alias `values`.
+  float (*exp_and_sum)(const float* values, int size, float offset,
+                       float temperature, float* output);
+
+  // Returns the sum of exp((values[i] - offset) / temperature), i.e. the same
+  // sum as exp_and_sum() without storing the exponentials.
+  float (*sum_exp)(const float* values, int size, float offset,
+                   float temperature);
+
+  // Multiplies values[0, size) by `scale` in place.
+  void (*scale)(float* values, int size, float scale);
+
+  // Returns the smallest n such that the sum of values[0, n) is at least
+  // `threshold`, or `size` if there is no such n, and stores that sum in
+  // `cumulative`.
+  int (*cumulative_cutoff)(const float* values, int size, double threshold,
+                           double* cumulative);
+};
+
+// Returns the scalar kernels.
+const SamplingCpuKernels& GetScalarSamplingCpuKernels();
+
+// Returns the fastest kernels supported by the running CPU.
+const SamplingCpuKernels& GetSamplingCpuKernels();
+
+// Returns all the kernels supported by the running CPU, from the scalar ones
+// to the fastest ones.
+std::vector<const SamplingCpuKernels*> GetSupportedSamplingCpuKernels();
+
+// Writes the indices of the `output.size()` largest `values` to `output`, in no
+// particular order. `output.size()` must be in [1, values.size()].
+//
+// Instead of partitioning an index vector of the whole vocabulary, the values
+// are scanned against a threshold, the smallest of the best candidates found
+// so far, and only the few values above it are kept as candidates.
+void TopKIndices(const SamplingCpuKernels& kernels,
+                 absl::Span<const float> values, absl::Span<int> output);
+
+}  // namespace litert::lm
+
+#endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_COMPONENTS_SAMPLING_CPU_KERNELS_H_
@@ -0,0 +1,207 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/components/sampling_cpu_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/types/span.h"  // from @com_google_absl
+
+namespace litert::lm {
+namespace {
+
+using ::testing::ElementsAreArray;
+using ::testing::UnorderedElementsAreArray;
+
+// Odd sizes exercise the scalar tails of the vectorized kernels.
+constexpr int kSizes[] = {1, 3, 8, 17, 64, 1000, 4099};
+
+std::vector<float> RandomValues(int size, float min, float max) {
+  std::mt19937 rng(size);
+  std::uniform_real_distribution<float> dist(min, max);
+  std::vector<float> values(size);
+  for (float& value : values) {
+    value = dist(rng);
+  }
+  return values;
+}
+
+class SamplingCpuKernelsTest
+    : public ::testing::TestWithParam<const SamplingCpuKernels*> {
+ protected:
+  const SamplingCpuKernels& kernels() const { return *GetParam(); }
+  const SamplingCpuKernels& scalar() const {
+    return GetScalarSamplingCpuKernels();
+  }
+};
+
+TEST_P(SamplingCpuKernelsTest, ArgMaxReturnsFirstMaximum) {
+  for (int size : kSizes) {
+    std::vector<float> values = RandomValues(size, -10.0f, 10.0f);
+    EXPECT_EQ(kernels().arg_max(values.data(), size),
+              scalar().arg_max(values.data(), size));
+    // Duplicate the maximum at the end.
+    values.back() = *std::max_element(values.begin(), values.end());
+    EXPECT_EQ(kernels().arg_max(values.data(), size),
+              scalar().arg_max(values.data(), size));
+  }
+}
+
+TEST_P(SamplingCpuKernelsTest, ArgMaxWithNegativeInfinity) {
+  std::vector<float> values(37, -std::numeric_limits<float>::infinity());
+  EXPECT_EQ(kernels().arg_max(values.data(), values.size()), 0);
+  values[33] = -1e30f;
+  EXPECT_EQ(kernels().arg_max(values.data(), values.size()), 33);
+}
+
+TEST_P(SamplingCpuKernelsTest, SelectGreater) {
+  for (int size : kSizes) {
+    const std::vector<float> values = RandomValues(size, -10.0f, 10.0f);
+    std::vector<int> expected(size);
+    expected.resize(
+        scalar().select_greater(values.data(), size, 7.5f, expected.data()));
+    std::vector<int> actual(size);
+    actual.resize(
+        kernels().select_greater(values.data(), size, 7.5f, actual.data()));
+    EXPECT_THAT(actual, ElementsAreArray(expected));
+  }
+}
+
+TEST_P(SamplingCpuKernelsTest, ExpAndSum) {
+  for (int size : kSizes) {
+    std::vector<float> values = RandomValues(size, -100.0f, 0.0f);
+    values[0] = -std::numeric_limits<float>::infinity();
+    std::vector<float> expected(size);
+    const float expected_sum = scalar().exp_and_sum(
+        values.data(), size, /*offset=*/-1.0f, /*temperature=*/0.7f,
+        expected.data());
+    std::vector<float> actual(size);
+    const float actual_sum = kernels().exp_and_sum(
+        values.data(), size, /*offset=*/-1.0f, /*temperature=*/0.7f,
+        actual.data());
+    EXPECT_NEAR(actual_sum, expected_sum, 1e-5f * expected_sum);
+    for (int i = 0; i < size; ++i) {
+      EXPECT_NEAR(actual[i], expected[i], 1e-6f * expected[i] + 1e-37f);
+    }
+    EXPECT_EQ(actual[0], 0.0f);
+  }
+}
+
+TEST_P(SamplingCpuKernelsTest, ExpAndSumInPlace) {
+  std::vector<float> values = {0.0f, -1.0f, -2.0f, -3.0f, 0.0f, -1.0f,
+                               -2.0f, -3.0f, 0.0f, -1.0f};
+  const float sum = kernels().exp_and_sum(values.data(), values.size(),
+                                          /*offset=*/0.0f,
+                                          /*temperature=*/1.0f, values.data());
+  EXPECT_NEAR(values[3], std::exp(-3.0f), 1e-6f);
+  EXPECT_NEAR(sum, 3.0f + 3 * std::exp(-1.0f) + 2 * std::exp(-2.0f) +
+                       2 * std::exp(-3.0f),
+              1e-5f);
+}
+
+TEST_P(SamplingCpuKernelsTest, SumExp) {
+  for (int size : kSizes) {
+    const std::vector<float> values = RandomValues(size, -100.0f, 0.0f);
+    std::vector<float> output(size);
+    const float expected_sum = scalar().exp_and_sum(
+        values.data(), size, /*offset=*/-1.0f, /*temperature=*/0.7f,
+        output.data());
+    EXPECT_NEAR(kernels().sum_exp(values.data(), size, /*offset=*/-1.0f,
+                                  /*temperature=*/0.7f),
+                expected_sum, 1e-5f * expected_sum);
+  }
+}
+
+TEST_P(SamplingCpuKernelsTest, Scale) {
+  for (int size : kSizes) {
+    std::vector<float> expected = RandomValues(size, -10.0f, 10.0f);
+    std::vector<float> actual = expected;
+    scalar().scale(expected.data(), size, 0.25f);
+    kernels().scale(actual.data(), size, 0.25f);
+    EXPECT_THAT(actual, ElementsAreArray(expected));
+  }
+}
+
+TEST_P(SamplingCpuKernelsTest, CumulativeCutoff) {
+  for (int size : kSizes) {
+    std::vector<float> values = RandomValues(size, 0.0f, 1.0f);
+    const float total = std::accumulate(values.begin(), values.end(), 0.0f);
+    for (float p : {0.0f, 0.3f, 0.9f}) {
+      double expected_cumulative = 0.0;
+      const int expected = scalar().cumulative_cutoff(
+          values.data(), size, p * total, &expected_cumulative);
+      double actual_cumulative = 0.0;
+      const int actual = kernels().cumulative_cutoff(
+          values.data(), size, p * total, &actual_cumulative);
+      // Rounding may move the cutoff by one element at most.
+      EXPECT_NEAR(actual, expected, 1) << "size " << size << " p " << p;
+      EXPECT_NEAR(actual_cumulative, expected_cumulative, 1e-4 * total + 1.0);
+    }
+    // The threshold is never reached.
+    double cumulative = 0.0;
+    EXPECT_EQ(kernels().cumulative_cutoff(values.data(), size, 2 * total + 1,
+                                          &cumulative),
+              size);
+    EXPECT_NEAR(cumulative, total, 1e-4 * total);
+  }
+}
+
+TEST_P(SamplingCpuKernelsTest, TopKIndices) {
+  for (int size : kSizes) {
+    // Distinct values, so that the top k set is unique.
+    std::vector<float> values(size);
+    std::iota(values.begin(), values.end(), 0.0f);
+    std::shuffle(values.begin(), values.end(), std::mt19937(size));
+    for (int k : {1, 2, 40, 1024, size}) {
+      if (k > size) {
+        continue;
+      }
+      std::vector<int> expected;
+      for (int i = 0; i < size; ++i) {
+        if (values[i] >= size - k) {
+          expected.push_back(i);
+        }
+      }
+      std::vector<int> actual(k);
+      TopKIndices(kernels(), values, absl::MakeSpan(actual));
+      EXPECT_THAT(actual, UnorderedElementsAreArray(expected))
+          << "size " << size << " k " << k;
+    }
+  }
+}
+
+TEST(SamplingCpuKernelsDispatchTest, FastestKernelsAreSupported) {
+  const auto supported = GetSupportedSamplingCpuKernels();
+  ASSERT_FALSE(supported.empty());
+  EXPECT_EQ(supported.front(), &GetScalarSamplingCpuKernels());
+  EXPECT_EQ(supported.back(), &GetSamplingCpuKernels());
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    SamplingCpuKernelsTests, SamplingCpuKernelsTest,
+    ::testing::ValuesIn(GetSupportedSamplingCpuKernels()),
+    [](const ::testing::TestParamInfo<const SamplingCpuKernels*>& info) {
+      return std::string(info.param->name);
+    });
+
+}  // namespace
+}  // namespace litert::lm
@@ -17,7 +17,6 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
-#include <iterator>
 #include <limits>
 #include <memory>
 #include <numeric>
@@ -29,8 +28,22 @@
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/strings/str_format.h"  // from @com_google_absl
 #include "absl/types/span.h"  // from @com_google_absl
+#include "runtime/components/sampling_cpu_kernels.h"
 
 namespace litert::lm {
+namespace {
+
+// The vectorized exp() and prefix sums round differently from the scalar
+// ones. Below this size they are not worth it, and the scalar kernels keep the
+// results of the common small k exactly reproducible.
+constexpr int kMinVectorizedSize = 64;
+
+const SamplingCpuKernels& GetKernelsForSize(int size) {
+  return size < kMinVectorizedSize ? GetScalarSamplingCpuKernels()
+                                   : GetSamplingCpuKernels();
+}
+
+}  // namespace
 
 absl::StatusOr<std::vector<int>> TopKTokenIds(absl::Span<const float> logits,
                                               int k, int batch_size) {
@@ -42,36 +55,17 @@ absl::StatusOr<std::vector<int>> TopKTokenIds(absl::Span<const float> logits,
                         logits.size(), batch_size));
   }
   const int vocab_size = logits.size() / batch_size;
+  const SamplingCpuKernels& kernels = GetSamplingCpuKernels();
   std::vector<int> output_indices(batch_size * k);
-  if (k == 1) {  // Greedy sampling. Use std::max_element to be more efficient.
-    for (int b = 0; b < batch_size; ++b) {
-      auto max_iterator =
-          std::max_element(logits.begin() + b * vocab_size,
-                           logits.begin() + (b + 1) * vocab_size);
-      // Gets the index of the max element in the logits of each batch.
-      const int max_logit_idx =
-          std::distance(logits.begin() + b * vocab_size, max_iterator);
-      output_indices[b] = max_logit_idx;
-    }
-  } else {
-    std::vector<int> indices(vocab_size);
-    for (int b = 0; b < batch_size; ++b) {
-      // Fill with 0, 1, 2,...
-      std::iota(indices.begin(), indices.end(), 0);
-
-      // Define the comparator for descending probability
-      auto desc_prob_comp = [&logits, vocab_size, b](int i1, int i2) {
-        return logits[b * vocab_size + i1] > logits[b * vocab_size + i2];
-      };
-      // Partition Top-K.
-      // O(N) average time complexity.
-      // Rearranges 'indices' such that the k elements with the highest
-      // probabilities are in the range [indices.begin(), indices.begin() +
-      // k). The element at indices[k] is not necessarily the (k+1)th largest.
-      std::nth_element(indices.begin(), indices.begin() + k, indices.end(),
-                       desc_prob_comp);
-      std::copy(indices.begin(), indices.begin() + k,
-                output_indices.begin() + b * k);
+  for (int b = 0; b < batch_size; ++b) {
+    if (k == 1) {  // Greedy sampling. Only the max element is needed.
+      output_indices[b] =
+          kernels.arg_max(logits.data() + b * vocab_size, vocab_size);
+    } else {
+      // Threshold based selection. O(N) time complexity, and only the few
+      // candidates above the threshold are partitioned.
+      TopKIndices(kernels, logits.subspan(b * vocab_size, vocab_size),
+                  absl::MakeSpan(output_indices).subspan(b * k, k));
     }
   }
   return output_indices;
@@ -99,53 +93,37 @@ absl::StatusOr<std::vector<float>> Softmax(
   const int k = topk_token_ids.size() / batch_size;
   std::vector<float> probabilities(topk_token_ids.size());
   max_logit_values.resize(batch_size);
+  const SamplingCpuKernels& kernels = GetKernelsForSize(k);
+  const float current_temp =
+      std::max(temperature, std::numeric_limits<float>::epsilon());
   for (size_t b = 0; b < batch_size; ++b) {
-    // Define the comparator for ascending logit to be used with
-    // std::max_element. The comparator takes two indices from topk_token_ids
-    // and compares the corresponding logit values.
-    auto logit_comp = [&logits, vocab_size, b](int topk_idx1, int topk_idx2) {
-      return logits[b * vocab_size + topk_idx1] <
-             logits[b * vocab_size + topk_idx2];
-    };
-
-    // Use std::max_element to find the index in topk_token_ids that corresponds
-    // to the maximum logit value.
-    auto max_iterator =
-        std::max_element(topk_token_ids.begin() + b * k,
-                         topk_token_ids.begin() + (b + 1) * k, logit_comp);
-    const int max_logit_idx =
-        std::distance(topk_token_ids.begin() + b * k, max_iterator);
-    max_logit_values[b] =
-        logits[b * vocab_size + topk_token_ids[b * k + max_logit_idx]];
-
-    float sum_of_exps = 0.0;
-    float current_temp =
-        std::max(temperature, std::numeric_limits<float>::epsilon());
-    for (size_t i = b * k; i < (b + 1) * k; ++i) {
-      probabilities[i] = std::exp(
-          (logits[b * vocab_size + topk_token_ids[i]] - max_logit_values[b]) /
-          current_temp);
-      sum_of_exps += probabilities[i];
+    // Gather the top k logits, so that the kernels work on contiguous values.
+    float* topk_probabilities = probabilities.data() + b * k;
+    for (int i = 0; i < k; ++i) {
+      topk_probabilities[i] =
+          logits[b * vocab_size + topk_token_ids[b * k + i]];
     }
+    const int max_logit_idx = kernels.arg_max(topk_probabilities, k);
+    max_logit_values[b] = topk_probabilities[max_logit_idx];
+
+    const float sum_of_exps =
+        kernels.exp_and_sum(topk_probabilities, k, max_logit_values[b],
+                            current_temp, topk_probabilities);
 
     if (sum_of_exps <= std::numeric_limits<float>::epsilon()) {
       // Handle potential zero sum (uniform distribution fallback)
       float uniform_prob = 1.0 / static_cast<float>(k);
-      std::fill(probabilities.begin() + b * k,
-                probabilities.begin() + (b + 1) * k, uniform_prob);
+      std::fill(topk_probabilities, topk_probabilities + k, uniform_prob);
     } else if (std::isinf(sum_of_exps)) {
       // Handle inf sum which is caused by very small temperature.
       // This is to avoid inf sum in the softmax calculation.
-      std::fill(probabilities.begin() + b * k,
-                probabilities.begin() + (b + 1) * k, 0.0f);
-      probabilities[b * k + max_logit_idx] = 1.0f;
+      std::fill(topk_probabilities, topk_probabilities + k, 0.0f);
+      topk_probabilities[max_logit_idx] = 1.0f;
     } else {
       // Normalize probabilities
       float inv_sum =
           1.0 / sum_of_exps;  // Calculate inverse once for slight speedup
-      for (size_t i = b * k; i < (b + 1) * k; ++i) {
-        probabilities[i] *= inv_sum;
-      }
+      kernels.scale(topk_probabilities, k, inv_sum);
     }
   }
   return probabilities;
@@ -194,6 +172,7 @@ absl::StatusOr<std::vector<int>> TopKTopPSampling(
   }
   sampled_ids.resize(batch_size);
   sampled_scores.resize(batch_size);
+  const SamplingCpuKernels& kernels = GetKernelsForSize(k);
   float current_temp =
       std::max(temperature, std::numeric_limits<float>::epsilon());
   for (int b = 0; b < batch_size; ++b) {
@@ -215,21 +194,19 @@ absl::StatusOr<std::vector<int>> TopKTopPSampling(
     std::iota(index_of_topk.begin(), index_of_topk.end(), 0);
     std::sort(index_of_topk.begin(), index_of_topk.end(), desc_prob_comp);
 
+    std::vector<float> sorted_probabilities(k);
+    for (int i = 0; i < k; ++i) {
+      sorted_probabilities[i] = (*probabilities)[b * k + index_of_topk[i]];
+    }
+
     // Determine Top-P Cutoff Index within Top-K.
     // O(k) time complexity.
+    // It stops at the smallest set within Top-K satisfying Top-P, i.e. when
+    // cumulative_prob >= p.
     double cumulative_prob = 0.0;
-    int final_sample_size = 0;  // Actual number of elements to sample from
-
-    for (int i = 0; i < k; ++i) {
-      // Check if adding this probability would exceed the threshold p. It
-      // stops when cumulative_prob >= p.
-      cumulative_prob += (*probabilities)[b * k + index_of_topk[i]];
-      final_sample_size = i + 1;  // Include this element
-
-      if (cumulative_prob >= p) {
-        break;  // Found the smallest set within Top-K satisfying Top-P
-      }
-    }
+    // Actual number of elements to sample from.
+    const int final_sample_size = kernels.cumulative_cutoff(
+        sorted_probabilities.data(), k, p, &cumulative_prob);
     // final_sample_size now holds min(p_cutoff_within_top_k, k)
 
     // Handle Edge Case: Cumulative Probability is Zero.
@@ -244,17 +221,18 @@ absl::StatusOr<std::vector<int>> TopKTopPSampling(
     }
 
     // O(final_sample_size) which is O(k) time complexity.
+    // The sampled element is the first one whose cumulative probability
+    // reaches the random sample.
     std::uniform_real_distribution<double> dist(0.0, cumulative_prob);
     double random_sample = dist(*rng);
     double current_cumulative = 0.0;
-    for (int i = 0; i < final_sample_size; ++i) {
-      current_cumulative += (*probabilities)[b * k + index_of_topk[i]];
-      if (random_sample <= current_cumulative) {
-        sampled_ids[b] = (*topk_token_ids)[b * k + index_of_topk[i]];
-        sampled_scores[b] = (*probabilities)[b * k + index_of_topk[i]];
-        break;
-      }
-    }
+    const int i =
+        kernels.cumulative_cutoff(sorted_probabilities.data(),
+                                  final_sample_size, random_sample,
+                                  &current_cumulative) -
+        1;
+    sampled_ids[b] = (*topk_token_ids)[b * k + index_of_topk[i]];
+    sampled_scores[b] = sorted_probabilities[i];
   }
   return sampled_ids;
 }
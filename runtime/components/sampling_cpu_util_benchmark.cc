@@ -0,0 +1,159 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Micro-benchmark of the CPU sampling kernels.
+//
+// Compares the vectorized kernels supported by the running CPU with the scalar
+// kernels, and the threshold based top-k selection with the previous
+// std::nth_element over an index vector of the whole vocabulary, e.g.
+//
+//   sampling_cpu_util_benchmark --vocab_size=262144 --k=64
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "absl/flags/flag.h"  // from @com_google_absl
+#include "absl/flags/parse.h"  // from @com_google_absl
+#include "absl/strings/str_format.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+#include "runtime/components/sampling_cpu_kernels.h"
+#include "runtime/util/benchmark_utils.h"
+
+ABSL_FLAG(int, vocab_size, 262144, "Number of logits per sampling step.");
+ABSL_FLAG(int, k, 64, "Number of top k logits.");
+ABSL_FLAG(int, iterations, 200, "Number of timed runs of every kernel.");
+
+namespace litert::lm {
+namespace {
+
+// The top-k selection before the threshold based one.
+void LegacyTopK(absl::Span<const float> logits, int k,
+                std::vector<int>& indices, absl::Span<int> output) {
+  std::iota(indices.begin(), indices.end(), 0);
+  std::nth_element(
+      indices.begin(), indices.begin() + k, indices.end(),
+      [&logits](int i1, int i2) { return logits[i1] > logits[i2]; });
+  std::copy(indices.begin(), indices.begin() + k, output.begin());
+}
+
+void Run() {
+  const int vocab_size = absl::GetFlag(FLAGS_vocab_size);
+  const int k = std::min(absl::GetFlag(FLAGS_k), vocab_size);
+  const int iterations = absl::GetFlag(FLAGS_iterations);
+
+  // Logits of a peaked distribution, like the ones of a trained model.
+  std::mt19937 rng(0);
+  std::normal_distribution<float> dist(0.0f, 2.0f);
+  std::vector<float> logits(vocab_size);
+  for (float& logit : logits) {
+    logit = dist(rng);
+  }
+  std::vector<float> output(vocab_size);
+  std::vector<int> indices(vocab_size);
+  std::vector<int> topk(k);
+  const float max_logit = *std::max_element(logits.begin(), logits.end());
+
+  std::cout << absl::StrFormat("vocab_size=%d k=%d iterations=%d\n",
+                               vocab_size, k, iterations);
+  PrintSpeedupHeader("kernels");
+
+  const double legacy_arg_max = TimeMicros(
+      [&] {
+        AddToChecksum(std::max_element(logits.begin(), logits.end()) -
+                      logits.begin());
+      },
+      iterations);
+  ReportSpeedup("arg_max", "legacy", legacy_arg_max, legacy_arg_max);
+  for (const SamplingCpuKernels* kernels : GetSupportedSamplingCpuKernels()) {
+    ReportSpeedup(
+        "arg_max", kernels->name,
+        TimeMicros(
+            [&] { AddToChecksum(kernels->arg_max(logits.data(), vocab_size)); },
+            iterations),
+        legacy_arg_max);
+  }
+
+  const double legacy_top_k = TimeMicros(
+      [&] {
+        LegacyTopK(logits, k, indices, absl::MakeSpan(topk));
+        AddToChecksum(topk[0]);
+      },
+      iterations);
+  ReportSpeedup("top_k", "legacy", legacy_top_k, legacy_top_k);
+  for (const SamplingCpuKernels* kernels : GetSupportedSamplingCpuKernels()) {
+    ReportSpeedup("top_k", kernels->name,
+                  TimeMicros(
+                      [&] {
+                        TopKIndices(*kernels, logits, absl::MakeSpan(topk));
+                        AddToChecksum(topk[0]);
+                      },
+                      iterations),
+                  legacy_top_k);
+  }
+
+  // Softmax over the whole vocabulary, i.e. the worst case of a large k.
+  const double scalar_exp = TimeMicros(
+      [&] {
+        AddToChecksum(GetScalarSamplingCpuKernels().exp_and_sum(
+            logits.data(), vocab_size, max_logit, 0.8f, output.data()));
+      },
+      iterations);
+  for (const SamplingCpuKernels* kernels : GetSupportedSamplingCpuKernels()) {
+    ReportSpeedup("exp_and_sum", kernels->name,
+                  TimeMicros(
+                      [&] {
+                        AddToChecksum(kernels->exp_and_sum(
+                            logits.data(), vocab_size, max_logit, 0.8f,
+                            output.data()));
+                      },
+                      iterations),
+                  scalar_exp);
+  }
+
+  // Top-p scan over sorted probabilities.
+  std::vector<float> probabilities(vocab_size, 1.0f / vocab_size);
+  const double scalar_top_p = TimeMicros(
+      [&] {
+        double cumulative;
+        AddToChecksum(GetScalarSamplingCpuKernels().cumulative_cutoff(
+            probabilities.data(), vocab_size, 0.95, &cumulative));
+      },
+      iterations);
+  for (const SamplingCpuKernels* kernels : GetSupportedSamplingCpuKernels()) {
+    ReportSpeedup("cumulative_cutoff", kernels->name,
+                  TimeMicros(
+                      [&] {
+                        double cumulative;
+                        AddToChecksum(kernels->cumulative_cutoff(
+                            probabilities.data(), vocab_size, 0.95,
+                            &cumulative));
+                      },
+                      iterations),
+                  scalar_top_p);
+  }
+
+  PrintChecksum();
+}
+
+}  // namespace
+}  // namespace litert::lm
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+  litert::lm::Run();
+  return 0;
+}
@@ -14,15 +14,16 @@
 
 #include "runtime/components/scoring_cpu_util.h"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 #include <vector>
 
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/types/span.h"  // from @com_google_absl
-#include "runtime/components/sampling_cpu_util.h"
-#include "runtime/util/status_macros.h"  // IWYU pragma: keep
+#include "runtime/components/sampling_cpu_kernels.h"
 
 namespace litert::lm {
 
@@ -30,6 +31,15 @@ absl::StatusOr<std::vector<float>> ComputeLogLikelihood(
     absl::Span<const float> logits, absl::Span<const int> sampled_ids,
     float temperature) {
   const int batch_size = sampled_ids.size();
+  if (batch_size == 0 || logits.empty() || logits.size() % batch_size != 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Logits size ", logits.size(),
+                     " is not a multiple of the batch size ", batch_size));
+  }
+  if (temperature < 0.0f) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Temperature must be >= 0, but got ", temperature));
+  }
   const int vocab_size = logits.size() / batch_size;
   for (int i = 0; i < batch_size; ++i) {
     if (sampled_ids[i] < 0 || sampled_ids[i] >= vocab_size) {
@@ -37,19 +47,19 @@ absl::StatusOr<std::vector<float>> ComputeLogLikelihood(
           absl::StrCat("Invalid sampled id: ", sampled_ids[i]));
     }
   }
-  // Get all indices and their probabilities for calculating perplexity.
-  ASSIGN_OR_RETURN(auto all_token_ids,
-                   TopKTokenIds(logits, vocab_size, batch_size));
-  std::vector<float> all_logit_values;
-  ASSIGN_OR_RETURN(auto all_probabilities,
-                   Softmax(logits, all_token_ids, temperature, batch_size,
-                           all_logit_values));
+  // log(softmax(x / t)[id]) = (x[id] - max) / t - log(sum(exp((x - max) / t))),
+  // so a max and a sum of exponentials over the vocabulary are all it takes.
+  const SamplingCpuKernels& kernels = GetSamplingCpuKernels();
+  const float current_temp =
+      std::max(temperature, std::numeric_limits<float>::epsilon());
   std::vector<float> batch_confidence(batch_size);
   for (int b = 0; b < batch_size; ++b) {
-    if (sampled_ids[b] >= 0 && sampled_ids[b] < vocab_size) {
-      const int sampled_index = b * vocab_size + sampled_ids[b];
-      batch_confidence[b] = std::log(all_probabilities[sampled_index]);
-    }
+    const float* row = logits.data() + b * vocab_size;
+    const float max_logit = row[kernels.arg_max(row, vocab_size)];
+    const float sum_of_exps =
+        kernels.sum_exp(row, vocab_size, max_logit, current_temp);
+    batch_confidence[b] = (row[sampled_ids[b]] - max_logit) / current_temp -
+                          std::log(sum_of_exps);
   }
   return batch_confidence;
 }
@@ -73,5 +73,39 @@ TEST(ScoringCpuUtilTest, ComputeLogLikelihood_BatchSize2_OneStreamEnded) {
       (*batchconfidence)[0],
       testing::FloatNear(std::log(exp(0.3f) / (2 + std::exp(0.3f))), 1e-6f));
 }
+
+TEST(ScoringCpuUtilTest, ComputeLogLikelihood_LargeVocabWithTemperature) {
+  constexpr int kVocabSize = 4099;
+  std::vector<float> logits(2 * kVocabSize);
+  for (int i = 0; i < logits.size(); ++i) {
+    logits[i] = std::sin(0.37f * i) * 8.0f;
+  }
+  const std::vector<int> sampled_ids = {17, kVocabSize - 1};
+  constexpr float kTemperature = 0.7f;
+  auto batchconfidence = ComputeLogLikelihood(
+      logits, sampled_ids, /*temperature=*/kTemperature);
+  ASSERT_OK(batchconfidence);
+  ASSERT_EQ(batchconfidence->size(), 2);
+  for (int b = 0; b < 2; ++b) {
+    double sum = 0.0;
+    for (int i = 0; i < kVocabSize; ++i) {
+      sum += std::exp(logits[b * kVocabSize + i] / kTemperature);
+    }
+    const double expected =
+        logits[b * kVocabSize + sampled_ids[b]] / kTemperature - std::log(sum);
+    EXPECT_NEAR((*batchconfidence)[b], expected, 1e-4);
+  }
+}
+
+TEST(ScoringCpuUtilTest, ComputeLogLikelihood_InvalidShape) {
+  const std::vector<float> logits = {0.0, 0.0, 0.3};
+  EXPECT_FALSE(ComputeLogLikelihood(logits, std::vector<int>{0, 1},
+                                    /*temperature=*/1.0)
+                   .ok());
+  EXPECT_FALSE(ComputeLogLikelihood(logits, std::vector<int>{},
+                                    /*temperature=*/1.0)
+                   .ok());
+}
+
 }  // namespace
 }  // namespace litert::lm
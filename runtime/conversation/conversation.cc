@@ -31,6 +31,7 @@
 #include "absl/synchronization/mutex.h"  // from @com_google_absl
 #include "absl/time/clock.h"  // from @com_google_absl
 #include "absl/time/time.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "nlohmann/json.hpp"  // from @nlohmann_json
 #include "runtime/components/constrained_decoding/constraint_provider.h"
 #include "runtime/components/constrained_decoding/constraint_provider_config.h"
@@ -53,6 +54,10 @@ namespace litert::lm {
 
 namespace {
 
+// The minimum number of trailing history messages rendered before the new
+// messages of a turn when the prompt template is prefix stable.
+constexpr int kNumTrailingContextMessages = 2;
+
 bool IsEmptyInputError(const absl::Status& status) {
   return absl::IsInvalidArgument(status) &&
          absl::StrContains(status.message(), "Input is empty");
@@ -143,56 +148,122 @@ Conversation::GetSingleTurnTextFromSingleTurnTemplate(
 
 absl::StatusOr<std::string> Conversation::GetSingleTurnTextFromFullHistory(
     const JsonMessage& json_message, const OptionalArgs& optional_args) {
-  PromptTemplateInput old_tmpl_input;
-  RETURN_IF_ERROR(FillPrefaceForPromptTemplateInput(
-      preface_, model_data_processor_.get(), old_tmpl_input));
-
-  absl::MutexLock lock(history_mutex_);  // NOLINT
-  for (const auto& history_msg : history_) {
-    if (std::holds_alternative<nlohmann::ordered_json>(history_msg)) {
-      ASSIGN_OR_RETURN(nlohmann::ordered_json message_tmpl_input,
-                       model_data_processor_->MessageToTemplateInput(
-                           std::get<nlohmann::ordered_json>(history_msg)));
-      old_tmpl_input.messages.push_back(message_tmpl_input);
-    } else {
-      return absl::UnimplementedError("Message type is not supported yet");
-    }
-  }
   nlohmann::ordered_json messages =
       json_message.is_array() ? json_message
                               : nlohmann::ordered_json::array({json_message});
+  std::vector<nlohmann::ordered_json> new_tmpl_messages;
+  new_tmpl_messages.reserve(messages.size());
+  for (const auto& message : messages) {
+    ASSIGN_OR_RETURN(nlohmann::ordered_json message_tmpl_input,
+                     model_data_processor_->MessageToTemplateInput(message));
+    new_tmpl_messages.push_back(std::move(message_tmpl_input));
+  }
+
+  absl::MutexLock lock(history_mutex_);  // NOLINT
+  if (!preface_tmpl_input_.has_value()) {
+    PromptTemplateInput preface_tmpl_input;
+    RETURN_IF_ERROR(FillPrefaceForPromptTemplateInput(
+        preface_, model_data_processor_.get(), preface_tmpl_input));
+    preface_tmpl_input_ = std::move(preface_tmpl_input);
+  }
+  RETURN_IF_ERROR(SyncHistoryTmplMessages());
   if (history_.empty() && !config_.prefill_preface_on_init()) {
-    PromptTemplateInput new_tmpl_input = std::move(old_tmpl_input);
-    for (const auto& message : messages) {
-      ASSIGN_OR_RETURN(nlohmann::ordered_json message_tmpl_input,
-                       model_data_processor_->MessageToTemplateInput(message));
-      new_tmpl_input.messages.push_back(message_tmpl_input);
+    PromptTemplateInput new_tmpl_input = *preface_tmpl_input_;
+    new_tmpl_input.now = absl::Now();
+    for (auto& message_tmpl_input : new_tmpl_messages) {
+      new_tmpl_input.messages.push_back(std::move(message_tmpl_input));
     }
     new_tmpl_input.add_generation_prompt = true;
     return prompt_template_.Apply(new_tmpl_input);
   }
 
-  old_tmpl_input.add_generation_prompt = false;
+  // Rendering the whole history twice per turn is quadratic in the length of
+  // the conversation. When the template is prefix stable, render the new
+  // messages after the last few history messages only. An even number of
+  // messages is skipped so that templates checking the alternation of roles
+  // see the same parity.
+  const absl::Span<const nlohmann::ordered_json> history_tmpl_messages =
+      history_tmpl_messages_;
+  const int num_history_messages = history_tmpl_messages.size();
+  const int num_skipped_messages =
+      num_history_messages > kNumTrailingContextMessages
+          ? (num_history_messages - kNumTrailingContextMessages) & ~1
+          : 0;
+  if (num_skipped_messages == 0 ||
+      (is_prompt_template_prefix_stable_.has_value() &&
+       !*is_prompt_template_prefix_stable_)) {
+    return RenderNewMessages(history_tmpl_messages, new_tmpl_messages);
+  }
+  absl::StatusOr<std::string> trailing_text = RenderNewMessages(
+      history_tmpl_messages.subspan(num_skipped_messages), new_tmpl_messages);
+  if (trailing_text.ok() && is_prompt_template_prefix_stable_.has_value()) {
+    return trailing_text;
+  }
+  // Check once against the full rendering whether the template is prefix
+  // stable, and fall back to the full rendering for good if it is not.
+  ASSIGN_OR_RETURN(std::string full_text,
+                   RenderNewMessages(history_tmpl_messages, new_tmpl_messages));
+  if (!is_prompt_template_prefix_stable_.has_value()) {
+    is_prompt_template_prefix_stable_ =
+        trailing_text.ok() && *trailing_text == full_text;
+  }
+  return full_text;
+}
+
+absl::StatusOr<std::string> Conversation::RenderNewMessages(
+    absl::Span<const nlohmann::ordered_json> context_tmpl_messages,
+    absl::Span<const nlohmann::ordered_json> new_tmpl_messages) {
+  PromptTemplateInput tmpl_input = *preface_tmpl_input_;
+  tmpl_input.now = absl::Now();
+  for (const auto& message_tmpl_input : context_tmpl_messages) {
+    tmpl_input.messages.push_back(message_tmpl_input);
+  }
+  tmpl_input.add_generation_prompt = false;
   ASSIGN_OR_RETURN(const std::string old_string,
-                   prompt_template_.Apply(old_tmpl_input));
+                   prompt_template_.Apply(tmpl_input));
 
-  PromptTemplateInput new_tmpl_input = std::move(old_tmpl_input);
-  for (const auto& message : messages) {
-    ASSIGN_OR_RETURN(nlohmann::ordered_json message_tmpl_input,
-                     model_data_processor_->MessageToTemplateInput(message));
-    new_tmpl_input.messages.push_back(message_tmpl_input);
+  for (const auto& message_tmpl_input : new_tmpl_messages) {
+    tmpl_input.messages.push_back(message_tmpl_input);
   }
-  new_tmpl_input.add_generation_prompt = true;
-  ASSIGN_OR_RETURN(const std::string& new_string,
-                   prompt_template_.Apply(new_tmpl_input));
-  if (new_string.substr(0, old_string.size()) != old_string) {
+  tmpl_input.add_generation_prompt = true;
+  ASSIGN_OR_RETURN(const std::string new_string,
+                   prompt_template_.Apply(tmpl_input));
+  if (!absl::StartsWith(new_string, old_string)) {
     return absl::InternalError(absl::StrCat(
         "The new rendered template string does not start with the previous "
         "rendered template string. \nold_string: ",
         old_string, "\nnew_string: ", new_string));
   }
-  return {new_string.substr(old_string.size(),
-                            new_string.size() - old_string.size())};
+  return new_string.substr(old_string.size());
+}
+
+absl::Status Conversation::SyncHistoryTmplMessages() {
+  // The history only grows or shrinks at its end. Drop the cached inputs of
+  // the removed messages, including a replaced last message.
+  if (history_tmpl_messages_.size() > history_.size()) {
+    history_tmpl_messages_.resize(history_.size());
+    last_history_tmpl_source_ = nullptr;
+  }
+  if (!history_tmpl_messages_.empty() &&
+      (!std::holds_alternative<nlohmann::ordered_json>(
+           history_[history_tmpl_messages_.size() - 1]) ||
+       std::get<nlohmann::ordered_json>(
+           history_[history_tmpl_messages_.size() - 1]) !=
+           last_history_tmpl_source_)) {
+    history_tmpl_messages_.pop_back();
+  }
+  for (int i = history_tmpl_messages_.size();
+       i < static_cast<int>(history_.size()); ++i) {
+    if (!std::holds_alternative<nlohmann::ordered_json>(history_[i])) {
+      return absl::UnimplementedError("Message type is not supported yet");
+    }
+    const auto& history_msg = std::get<nlohmann::ordered_json>(history_[i]);
+    ASSIGN_OR_RETURN(nlohmann::ordered_json message_tmpl_input,
+                     model_data_processor_->MessageToTemplateInput(history_msg));
+    history_tmpl_messages_.push_back(std::move(message_tmpl_input));
+    last_history_tmpl_source_ = history_msg;
+  }
+  return absl::OkStatus();
 }
 
 absl::StatusOr<std::string> Conversation::GetSingleTurnText(
@@ -28,6 +28,8 @@
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
 #include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+#include "nlohmann/json.hpp"  // from @nlohmann_json
 #include "runtime/components/constrained_decoding/constraint.h"
 #include "runtime/components/constrained_decoding/constraint_provider.h"
 #include "runtime/components/constrained_decoding/constraint_provider_config.h"
@@ -492,6 +494,18 @@ class Conversation {
   absl::StatusOr<std::string> GetSingleTurnTextFromSingleTurnTemplate(
       const JsonMessage& json_message, const OptionalArgs& optional_args);
 
+  // Renders the preface, `context_tmpl_messages` and `new_tmpl_messages`, and
+  // returns the text added by the new messages and the generation prompt.
+  absl::StatusOr<std::string> RenderNewMessages(
+      absl::Span<const nlohmann::ordered_json> context_tmpl_messages,
+      absl::Span<const nlohmann::ordered_json> new_tmpl_messages)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(history_mutex_);
+
+  // Converts the history messages that are not cached in
+  // history_tmpl_messages_ yet to prompt template inputs.
+  absl::Status SyncHistoryTmplMessages()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(history_mutex_);
+
   absl::StatusOr<DecodeConfig> CreateDecodeConfig(
       std::optional<ConstraintArg> decoding_constraint = std::nullopt,
       std::optional<int> max_output_tokens = std::nullopt);
@@ -516,6 +530,20 @@ class Conversation {
   std::unique_ptr<ConstraintProvider> constraint_provider_ = nullptr;
   mutable absl::Mutex history_mutex_;
   std::vector<Message> history_ ABSL_GUARDED_BY(history_mutex_);
+  // The preface and the history messages converted to prompt template inputs,
+  // cached so that every turn only converts its new messages.
+  std::optional<PromptTemplateInput> preface_tmpl_input_
+      ABSL_GUARDED_BY(history_mutex_);
+  std::vector<nlohmann::ordered_json> history_tmpl_messages_
+      ABSL_GUARDED_BY(history_mutex_);
+  // The history message the last cached template input was converted from.
+  nlohmann::ordered_json last_history_tmpl_source_
+      ABSL_GUARDED_BY(history_mutex_);
+  // Whether rendering the new messages after the last few history messages
+  // gives the same text as after the whole history. Unset until checked on the
+  // first turn with a long enough history.
+  std::optional<bool> is_prompt_template_prefix_stable_
+      ABSL_GUARDED_BY(history_mutex_);
 
   // Whether the current conversation is in message appending state.
   bool is_appending_message_ = false;
@@ -584,6 +584,90 @@ TEST_P(ConversationTest, SendMultipleMessagesWithHistory) {
                                    assistant_message_2));
 }
 
+TEST_P(ConversationTest, SendMessagesWithLongHistory) {
+  // Set up mock Session.
+  auto mock_session = CreateMockSession();
+  MockSession* mock_session_ptr = mock_session.get();
+  auto mock_engine = CreateMockEngine(std::move(mock_session));
+
+  ASSERT_OK_AND_ASSIGN(
+      auto conversation_config,
+      ConversationConfig::Builder()
+          .SetSessionConfig(session_config_)
+          .SetEnableConstrainedDecoding(enable_constrained_decoding_)
+          .SetOverwritePromptTemplate(PromptTemplate(kTestJinjaPromptTemplate))
+          .SetPrefillPrefaceOnInit(prefill_preface_on_init_)
+          .Build(*mock_engine));
+  ASSERT_OK_AND_ASSIGN(auto conversation,
+                       Conversation::Create(*mock_engine, conversation_config));
+
+  // Every turn only prefills its own message, whether the history is rendered
+  // in full or not.
+  for (int turn = 0; turn < 5; ++turn) {
+    const std::string user_text = absl::StrCat("Turn ", turn);
+    JsonMessage user_message = {{"role", "user"}, {"content", user_text}};
+    const std::string expected_input_text =
+        absl::StrCat("<start_of_turn>user\n", user_text, "<end_of_turn>\n");
+    EXPECT_CALL(*mock_session_ptr,
+                RunPrefill(testing::ElementsAre(
+                    testing::VariantWith<InputText>(testing::Property(
+                        &InputText::GetRawTextString, expected_input_text)))))
+        .WillOnce(testing::Return(absl::OkStatus()));
+    EXPECT_CALL(*mock_session_ptr, RunDecode(testing::_))
+        .WillOnce(testing::Return(
+            Responses(TaskState::kProcessing, {absl::StrCat("Reply ", turn)})));
+    ASSERT_OK(conversation->SendMessage(user_message));
+  }
+  EXPECT_THAT(conversation->GetHistory().size(), testing::Eq(10));
+}
+
+TEST_P(ConversationTest, SendMessagesWithPrefixUnstableTemplate) {
+  // Set up mock Session.
+  auto mock_session = CreateMockSession();
+  MockSession* mock_session_ptr = mock_session.get();
+  auto mock_engine = CreateMockEngine(std::move(mock_session));
+
+  // The rendering of a message depends on its index in the whole history, so
+  // it cannot be rendered after the last few history messages only.
+  constexpr absl::string_view kIndexedJinjaPromptTemplate = R"jinja(
+{%- for message in messages -%}
+  {{- loop.index ~ ':' + message.role + '\n' -}}
+  {%- if message.content is string -%}
+    {{- message.content + '\n' -}}
+  {%- else -%}
+    {{- message.content[0].text + '\n' -}}
+  {%- endif -%}
+{%- endfor -%}
+)jinja";
+  ASSERT_OK_AND_ASSIGN(
+      auto conversation_config,
+      ConversationConfig::Builder()
+          .SetSessionConfig(session_config_)
+          .SetEnableConstrainedDecoding(enable_constrained_decoding_)
+          .SetOverwritePromptTemplate(
+              PromptTemplate(kIndexedJinjaPromptTemplate))
+          .SetPrefillPrefaceOnInit(prefill_preface_on_init_)
+          .Build(*mock_engine));
+  ASSERT_OK_AND_ASSIGN(auto conversation,
+                       Conversation::Create(*mock_engine, conversation_config));
+
+  for (int turn = 0; turn < 4; ++turn) {
+    const std::string user_text = absl::StrCat("Turn ", turn);
+    JsonMessage user_message = {{"role", "user"}, {"content", user_text}};
+    const std::string expected_input_text =
+        absl::StrCat(2 * turn + 1, ":user\n", user_text, "\n");
+    EXPECT_CALL(*mock_session_ptr,
+                RunPrefill(testing::ElementsAre(
+                    testing::VariantWith<InputText>(testing::Property(
+                        &InputText::GetRawTextString, expected_input_text)))))
+        .WillOnce(testing::Return(absl::OkStatus()));
+    EXPECT_CALL(*mock_session_ptr, RunDecode(testing::_))
+        .WillOnce(testing::Return(
+            Responses(TaskState::kProcessing, {absl::StrCat("Reply ", turn)})));
+    ASSERT_OK(conversation->SendMessage(user_message));
+  }
+}
+
 TEST_P(ConversationTest, RunTextScoring) {
   // Set up mock Session.
   auto mock_session = CreateMockSession();
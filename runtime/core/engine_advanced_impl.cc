@@ -14,6 +14,7 @@
 
 // TODO(b/417209286): Remove this once the model assets are stored in the
 // litertlm file format.
+#include <algorithm>
 #include <filesystem>  // NOLINT: Required for path manipulation.
 #include <memory>
 #include <optional>
@@ -134,6 +135,28 @@ absl::StatusOr<Environment&> GetEnvironment(EngineSettings& engine_settings,
   return **kEnvironment;
 }
 
+// Returns the settings of the executor `index` of the `num_executors` created
+// from `executor_settings`. On CPU, the executors run concurrently, so they
+// split CpuConfig::number_of_threads between them instead of each starting as
+// many threads. The first executors get the remaining threads, and every
+// executor gets at least one.
+absl::StatusOr<LlmExecutorSettings> GetPoolExecutorSettings(
+    const LlmExecutorSettings& executor_settings, int index,
+    int num_executors) {
+  LlmExecutorSettings settings = executor_settings;
+  if (num_executors <= 1 || settings.GetBackend() != Backend::CPU) {
+    return settings;
+  }
+  ASSIGN_OR_RETURN(CpuConfig cpu_config,
+                   settings.MutableBackendConfig<CpuConfig>());
+  const int num_threads = cpu_config.number_of_threads;
+  const int num_executor_threads =
+      num_threads / num_executors + (index < num_threads % num_executors);
+  cpu_config.number_of_threads = std::max(num_executor_threads, 1);
+  settings.SetBackendConfig(cpu_config);
+  return settings;
+}
+
 }  // namespace
 
 class EngineAdvancedImpl : public Engine {
@@ -280,15 +303,39 @@ absl::StatusOr<std::unique_ptr<Engine>> EngineAdvancedImpl::Create(
   std::unique_ptr<LlmExecutor> executor;
   const auto& main_executor_settings =
       engine_settings.GetMainExecutorSettings();
+  const int num_executors =
+      main_executor_settings.GetAdvancedSettings().has_value()
+          ? std::max<int>(
+                main_executor_settings.GetAdvancedSettings()->num_executors, 1)
+          : 1;
 
   switch (main_executor_settings.GetBackend()) {
     default: {
+      ASSIGN_OR_RETURN(auto executor_settings,
+                       GetPoolExecutorSettings(main_executor_settings,
+                                               /*index=*/0, num_executors));
       ASSIGN_OR_RETURN(
           executor, CreateLlmLiteRtCompiledModelExecutor(
-                        main_executor_settings, litert_env, *model_resources));
+                        std::move(executor_settings), litert_env,
+                        *model_resources));
     }
   };
 
+  // The additional executors are created from the same model resources, which
+  // keeps a single copy of the mmapped weights, and after the first one, which
+  // already populated the weight cache.
+  std::vector<std::unique_ptr<LlmExecutor>> additional_executors;
+  for (int i = 1; i < num_executors; ++i) {
+    ASSIGN_OR_RETURN(
+        auto executor_settings,
+        GetPoolExecutorSettings(main_executor_settings, i, num_executors));
+    ASSIGN_OR_RETURN(auto additional_executor,
+                     CreateLlmLiteRtCompiledModelExecutor(
+                         std::move(executor_settings), litert_env,
+                         *model_resources));
+    additional_executors.push_back(std::move(additional_executor));
+  }
+
   std::unique_ptr<VisionExecutorSettings> vision_executor_settings_ptr;
   if (engine_settings.GetVisionExecutorSettings().has_value()) {
     ASSIGN_OR_RETURN(
@@ -320,7 +367,8 @@ absl::StatusOr<std::unique_ptr<Engine>> EngineAdvancedImpl::Create(
                    ExecutionManager::Create(
                        tokenizer, model_resources.get(), std::move(executor),
                        std::move(vision_executor_settings_ptr),
-                       std::move(audio_executor_settings_ptr), &litert_env));
+                       std::move(audio_executor_settings_ptr), &litert_env,
+                       std::move(additional_executors)));
 
   if (benchmark_info.has_value()) {
     RETURN_IF_ERROR(
@@ -48,6 +48,8 @@
 #include "runtime/executor/magic_number_configs_helper.h"
 #include "runtime/executor/vision_executor.h"
 #include "runtime/executor/vision_litert_compiled_model_executor.h"
+#include "runtime/framework/cpu_topology.h"
+#include "runtime/framework/thread_options.h"
 #include "runtime/framework/threadpool.h"
 #include "runtime/proto/llm_metadata.pb.h"
 #include "runtime/proto/sampler_params.pb.h"
@@ -320,9 +322,15 @@ absl::StatusOr<std::unique_ptr<Engine>> EngineImpl::Create(
   }
 
   // Creating the thread pool of a single thread to execute the works.
-  auto worker_thread_pool =
-      std::make_unique<ThreadPool>(/*name_prefix=*/"engine",
-                                   /*max_num_threads=*/1);
+  const auto& advanced_settings =
+      engine_settings.GetMainExecutorSettings().GetAdvancedSettings();
+  auto worker_thread_pool = std::make_unique<ThreadPool>(
+      /*name_prefix=*/"engine",
+      /*max_num_threads=*/1,
+      advanced_settings.has_value() &&
+              advanced_settings->pin_threads_to_performance_cores
+          ? GetPerformanceCoreThreadOptions()
+          : ThreadOptions());
   auto llm_impl = std::make_unique<EngineImpl>(
       std::move(engine_settings), std::move(model_resources),
       std::move(executor), std::move(vision_executor),
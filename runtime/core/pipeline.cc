@@ -140,4 +140,23 @@ absl::StatusOr<Responses> ScoreCustomSampling(
                       std::move(decoded_ids), store_token_lengths);
 }
 
+absl::Status ScoreCustomSamplingStreaming(
+    LlmExecutor& executor, Tokenizer& tokenizer,
+    const std::vector<absl::string_view>& target_texts, const float temperature,
+    int last_token_id, int num_output_candidates, bool store_token_lengths,
+    absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback,
+    std::atomic<bool>* cancelled) {
+  if (callback == nullptr) {
+    return absl::InvalidArgumentError(
+        "Callback must not be null for streaming.");
+  }
+  absl::StatusOr<Responses> task_responses = Tasks::ScoreCandidates(
+      executor, tokenizer, target_texts, temperature, last_token_id,
+      num_output_candidates, store_token_lengths, callback, cancelled);
+
+  // Trigger the callback with the final result.
+  callback(task_responses);
+  return task_responses.status();
+}
+
 }  // namespace litert::lm
@@ -131,6 +131,28 @@ absl::StatusOr<Responses> ScoreCustomSampling(
     LlmExecutor& executor, Tokenizer& tokenizer,
     const std::vector<absl::string_view>& target_text, float temperature,
     litert::TensorBuffer decoded_ids, bool store_token_lengths = false);
+
+// Runs the pipeline to score any number of target texts against the prefilled
+// context, `num_output_candidates` targets at a time. The scores of every
+// batch are streamed through the callback, and the scores of all the targets
+// are passed to it when done.
+// - executor: The executor that calls the core LLM model.
+// - tokenizer: The tokenizer to encode the text into token ids.
+// - target_texts: The target texts to score.
+// - temperature: The temperature to use for softmax calculations.
+// - last_token_id: The last token id of the prefilled context.
+// - num_output_candidates: The batch size of the executor.
+// - store_token_lengths: Whether to store the token lengths of the target
+//   texts in `Responses`.
+// - callback: Callback to receive the scoring results.
+// - cancelled: A pointer to an atomic boolean. If the boolean is set to true,
+//   the scoring process will be cancelled.
+absl::Status ScoreCustomSamplingStreaming(
+    LlmExecutor& executor, Tokenizer& tokenizer,
+    const std::vector<absl::string_view>& target_texts, float temperature,
+    int last_token_id, int num_output_candidates, bool store_token_lengths,
+    absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback,
+    std::atomic<bool>* cancelled = nullptr);
 }  // namespace litert::lm
 
 #endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_ENGINE_PIPELINE_H_
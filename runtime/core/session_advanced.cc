@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -32,11 +33,13 @@
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "runtime/components/tokenizer.h"
 #include "runtime/core/session_utils.h"
 #include "runtime/engine/engine.h"
 #include "runtime/engine/engine_settings.h"
 #include "runtime/engine/io_types.h"
+#include "runtime/executor/llm_context_snapshot.h"
 #include "runtime/framework/resource_management/execution_manager.h"
 #include "runtime/proto/sampler_params.pb.h"
 #include "runtime/util/status_macros.h"  // IWYU pragma: keep
@@ -46,6 +49,10 @@ namespace {
 
 using TaskController = Engine::Session::TaskController;
 
+// Name of the snapshot entry of the session state, the same as the one
+// SessionBasic saves. The execution manager saves the rest of the session.
+constexpr absl::string_view kSnapshotSessionState = "session/state";
+
 }  // namespace
 
 // static
@@ -261,10 +268,6 @@ absl::StatusOr<std::unique_ptr<TaskController>> SessionAdvanced::RunDecodeAsync(
 absl::StatusOr<Responses> SessionAdvanced::RunTextScoring(
     const std::vector<absl::string_view>& target_text,
     bool store_token_lengths) {
-  if (target_text.size() != 1) {
-    // Batch scoring is not supported yet.
-    return absl::InvalidArgumentError("Target text size should be 1.");
-  }
   auto execution_manager_lock = execution_manager_.lock();
   if (execution_manager_lock == nullptr) {
     return absl::FailedPreconditionError("Execution manager is not available.");
@@ -289,8 +292,8 @@ SessionAdvanced::RunTextScoringAsync(
     const std::vector<absl::string_view>& target_text,
     absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback,
     bool store_token_lengths) {
-  if (target_text.size() != 1) {
-    return absl::InvalidArgumentError("Target text size should be 1.");
+  if (target_text.empty()) {
+    return absl::InvalidArgumentError("Target text should not be empty.");
   }
   auto execution_manager_lock = execution_manager_.lock();
   if (execution_manager_lock == nullptr) {
@@ -367,6 +370,48 @@ absl::StatusOr<BenchmarkInfo*> SessionAdvanced::GetMutableBenchmarkInfo() {
   return execution_manager_lock->GetMutableBenchmarkInfo(session_id_);
 }
 
+absl::Status SessionAdvanced::SaveSnapshot(absl::string_view path) {
+  RETURN_IF_ERROR(WaitUntilDone());
+  auto execution_manager_lock = execution_manager_.lock();
+  if (execution_manager_lock == nullptr) {
+    return absl::FailedPreconditionError("Execution manager is not available.");
+  }
+  ASSIGN_OR_RETURN(uint64_t model_fingerprint,
+                   execution_manager_lock->GetModelFingerprint(session_id_));
+  ASSIGN_OR_RETURN(auto writer,
+                   LlmContextSnapshotWriter::Create(path, model_fingerprint));
+  RETURN_IF_ERROR(
+      execution_manager_lock->SaveSessionSnapshot(session_id_, *writer));
+  const int session_state = static_cast<int>(session_state_);
+  RETURN_IF_ERROR(writer->AddValues<int>(
+      kSnapshotSessionState, absl::MakeConstSpan(&session_state, 1)));
+  return writer->Finish();
+}
+
+absl::Status SessionAdvanced::LoadSnapshot(absl::string_view path) {
+  RETURN_IF_ERROR(WaitUntilDone());
+  auto execution_manager_lock = execution_manager_.lock();
+  if (execution_manager_lock == nullptr) {
+    return absl::FailedPreconditionError("Execution manager is not available.");
+  }
+  ASSIGN_OR_RETURN(uint64_t model_fingerprint,
+                   execution_manager_lock->GetModelFingerprint(session_id_));
+  ASSIGN_OR_RETURN(std::shared_ptr<LlmContextSnapshot> snapshot,
+                   LlmContextSnapshot::Open(path, model_fingerprint));
+  ASSIGN_OR_RETURN(std::vector<int> session_state,
+                   snapshot->ReadValues<int>(kSnapshotSessionState));
+  if (session_state.size() != 1 ||
+      session_state[0] < static_cast<int>(SessionState::kFresh) ||
+      session_state[0] > static_cast<int>(SessionState::kDecoded)) {
+    return absl::DataLossError(
+        absl::StrCat("Invalid session state in the snapshot ", path));
+  }
+  RETURN_IF_ERROR(execution_manager_lock->LoadSessionSnapshot(
+      session_id_, std::move(snapshot)));
+  session_state_ = static_cast<SessionState>(session_state[0]);
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::unique_ptr<Engine::Session>> SessionAdvanced::Clone() {
   absl::Status status = absl::OkStatus();
   ASSIGN_OR_RETURN(auto session,
@@ -148,6 +148,10 @@ class SessionAdvanced : public Engine::Session {
 
   absl::StatusOr<BenchmarkInfo*> GetMutableBenchmarkInfo() override;
 
+  absl::Status SaveSnapshot(absl::string_view path) override;
+
+  absl::Status LoadSnapshot(absl::string_view path) override;
+
   absl::StatusOr<AudioExecutorProperties> GetAudioExecutorProperties()
       const override {
     if (audio_executor_properties_.has_value()) {
@@ -188,7 +188,10 @@ class SessionAdvancedTest : public testing::Test {
     sampler_params_.set_type(proto::SamplerParameters::TYPE_UNSPECIFIED);
   }
 
-  absl::StatusOr<std::unique_ptr<SessionAdvanced>> CreateTestSession() {
+  absl::StatusOr<std::unique_ptr<SessionAdvanced>> CreateTestSession(
+      // "How's it going?"
+      std::vector<std::vector<int>> decode_tokens = {
+          {224}, {24}, {8}, {66}, {246}, {18}, {2295}, {2294}}) {
     const std::vector<std::vector<int>> stop_token_ids = {{2294}};
     SessionConfig session_config = SessionConfig::CreateDefault();
     session_config.GetMutableSamplerParams() = sampler_params_;
@@ -201,9 +204,7 @@ class SessionAdvancedTest : public testing::Test {
         CreateFakeLlmExecutor(
             // "Hello World!"
             /*prefill_tokens=*/{{2, 90, 547, 58, 735, 210, 466, 2294}},
-            // "How's it going?"
-            /*decode_tokens=*/{
-                {224}, {24}, {8}, {66}, {246}, {18}, {2295}, {2294}}));
+            std::move(decode_tokens)));
     ASSIGN_OR_RETURN(
         execution_manager_,
         ExecutionManager::Create(tokenizer_.get(), model_resources_.get(),
@@ -2076,18 +2077,31 @@ TEST_F(SessionAdvancedTest, RunTextScoringEmptyTargetTextFailure) {
   EXPECT_THAT(session->RunTextScoring(target_text,
                                       /*store_token_lengths=*/false),
               StatusIs(absl::StatusCode::kInvalidArgument,
-                       "Target text size should be 1."));
+                       "Target text should not be empty."));
 }
 
-TEST_F(SessionAdvancedTest, RunTextScoringMultipleTargetTextFailure) {
-  ASSERT_OK_AND_ASSIGN(auto session, CreateTestSession());
+TEST_F(SessionAdvancedTest, RunTextScoringMultipleTargetTextSuccess) {
+  // The targets are scored one at a time from the same context, and the last
+  // token of the first target, "!", is also the last token of the context.
+  ASSERT_OK_AND_ASSIGN(
+      auto session,
+      CreateTestSession(
+          // "How's it going!" and "How's it going?"
+          /*decode_tokens=*/{{224}, {24}, {8}, {66}, {246}, {18}, {2294},
+                             {224}, {24}, {8}, {66}, {246}, {18}, {2295}}));
+  std::vector<InputData> inputs;
+  inputs.emplace_back(InputText("Hello World!"));
+  EXPECT_OK(session->RunPrefill(inputs));
   std::vector<absl::string_view> target_text;
+  target_text.push_back("How's it going!");
   target_text.push_back("How's it going?");
-  target_text.push_back("How are you?");
-  EXPECT_THAT(
-      session->RunTextScoring(target_text, /*store_token_lengths=*/false),
-      StatusIs(absl::StatusCode::kInvalidArgument,
-               "Target text size should be 1."));
+  const auto responses =
+      session->RunTextScoring(target_text, /*store_token_lengths=*/true);
+  EXPECT_OK(responses);
+  // Expect a score of 0.0f and a token length of 7 for each target.
+  EXPECT_THAT(responses->GetScores(), testing::ElementsAre(0.0f, 0.0f));
+  EXPECT_THAT(responses->GetTokenLengths(),
+              testing::Optional(testing::ElementsAre(7, 7)));
 }
 
 TEST_F(SessionAdvancedTest, RunTextScoringWithoutTokenLengthsSuccess) {
@@ -2130,20 +2144,9 @@ TEST_F(SessionAdvancedTest, RunTextScoringAsyncEmptyTargetTextFailure) {
   auto controller = session->RunTextScoringAsync(
       target_text, [](absl::StatusOr<Responses> r) {},
       /*store_token_lengths=*/false);
-  EXPECT_THAT(controller.status(), StatusIs(absl::StatusCode::kInvalidArgument,
-                                            "Target text size should be 1."));
-}
-
-TEST_F(SessionAdvancedTest, RunTextScoringAsyncMultipleTargetTextFailure) {
-  ASSERT_OK_AND_ASSIGN(auto session, CreateTestSession());
-  std::vector<absl::string_view> target_text;
-  target_text.push_back("How's it going?");
-  target_text.push_back("How are you?");
-  auto controller = session->RunTextScoringAsync(
-      target_text, [](absl::StatusOr<Responses> r) {},
-      /*store_token_lengths=*/false);
-  EXPECT_THAT(controller.status(), StatusIs(absl::StatusCode::kInvalidArgument,
-                                            "Target text size should be 1."));
+  EXPECT_THAT(controller.status(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       "Target text should not be empty."));
 }
 
 TEST_F(SessionAdvancedTest, RunTextScoringAsyncWithoutTokenLengthsSuccess) {
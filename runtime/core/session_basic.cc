@@ -34,6 +34,7 @@
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
 #include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "litert/cc/litert_layout.h"  // from @litert
 #include "litert/cc/litert_macros.h"  // from @litert
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
@@ -48,6 +49,7 @@
 #include "runtime/engine/io_types.h"
 #include "runtime/executor/audio_executor.h"
 #include "runtime/executor/executor_settings_base.h"
+#include "runtime/executor/llm_context_snapshot.h"
 #include "runtime/executor/llm_executor.h"
 #include "runtime/executor/llm_executor_io_types.h"
 #include "runtime/executor/vision_executor.h"
@@ -63,6 +65,12 @@ namespace {
 
 using TaskController = Engine::Session::TaskController;
 
+// Names of the snapshot entries of the session, next to the ones of the
+// executor.
+constexpr absl::string_view kSnapshotSessionState = "session/state";
+constexpr absl::string_view kSnapshotLastPrefillTokenId =
+    "session/last_prefill_token_id";
+
 }
 
 absl::flat_hash_set<LlmExecutor*>* SessionBasic::occupied_executors_ =
@@ -499,8 +507,12 @@ SessionBasic::RunTextScoringAsync(
     const std::vector<absl::string_view>& target_text,
     absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback,
     bool store_token_lengths) {
-  if (target_text.size() != 1) {
-    return absl::InvalidArgumentError("Target text size should be 1.");
+  if (target_text.empty()) {
+    return absl::InvalidArgumentError("Target text should not be empty.");
+  }
+  if (cancelled_.load()) {
+    // Reset the cancelled flag before processing the next turn.
+    cancelled_ = false;
   }
 
   // TODO(b/435040163): Handle the temperature. Should it be calculated from
@@ -510,17 +522,11 @@ SessionBasic::RunTextScoringAsync(
   RETURN_IF_ERROR(worker_thread_pool_.Schedule(
       [this, callback = std::move(callback), target_text, store_token_lengths,
        temperature]() mutable {
-        std::vector<int> decoded_ids(session_config_.GetNumOutputCandidates(),
-                                     last_prefill_token_id_);
-        auto decoded_ids_buffer = CopyToTensorBuffer<int>(
-            decoded_ids, {session_config_.GetNumOutputCandidates(), 1});
-        if (!decoded_ids_buffer.HasValue()) {
-          callback(absl::InternalError(decoded_ids_buffer.Error().Message()));
-          return;
-        }
-        callback(ScoreCustomSampling(
+        ScoreCustomSamplingStreaming(
             executor_, tokenizer_, target_text, temperature,
-            std::move(decoded_ids_buffer.Value()), store_token_lengths));
+            last_prefill_token_id_, session_config_.GetNumOutputCandidates(),
+            store_token_lengths, std::move(callback), &cancelled_)
+            .IgnoreError();
       }));
   return nullptr;
 }
@@ -561,6 +567,46 @@ absl::Status SessionBasic::GenerateContentStream(
   return absl::OkStatus();
 }
 
+absl::Status SessionBasic::SaveSnapshot(absl::string_view path) {
+  RETURN_IF_ERROR(WaitUntilDone());
+  ASSIGN_OR_RETURN(auto executor_settings, executor_.GetExecutorSettings());
+  ASSIGN_OR_RETURN(uint64_t model_fingerprint,
+                   ComputeModelFingerprint(executor_settings.GetModelAssets()));
+  ASSIGN_OR_RETURN(auto writer,
+                   LlmContextSnapshotWriter::Create(path, model_fingerprint));
+  RETURN_IF_ERROR(executor_.SaveContextSnapshot(*writer));
+  const int session_state = static_cast<int>(session_state_);
+  RETURN_IF_ERROR(writer->AddValues<int>(
+      kSnapshotSessionState, absl::MakeConstSpan(&session_state, 1)));
+  RETURN_IF_ERROR(writer->AddValues<int>(
+      kSnapshotLastPrefillTokenId,
+      absl::MakeConstSpan(&last_prefill_token_id_, 1)));
+  return writer->Finish();
+}
+
+absl::Status SessionBasic::LoadSnapshot(absl::string_view path) {
+  RETURN_IF_ERROR(WaitUntilDone());
+  ASSIGN_OR_RETURN(auto executor_settings, executor_.GetExecutorSettings());
+  ASSIGN_OR_RETURN(uint64_t model_fingerprint,
+                   ComputeModelFingerprint(executor_settings.GetModelAssets()));
+  ASSIGN_OR_RETURN(std::shared_ptr<LlmContextSnapshot> snapshot,
+                   LlmContextSnapshot::Open(path, model_fingerprint));
+  ASSIGN_OR_RETURN(std::vector<int> session_state,
+                   snapshot->ReadValues<int>(kSnapshotSessionState));
+  ASSIGN_OR_RETURN(std::vector<int> last_prefill_token_id,
+                   snapshot->ReadValues<int>(kSnapshotLastPrefillTokenId));
+  if (session_state.size() != 1 || last_prefill_token_id.size() != 1 ||
+      session_state[0] < static_cast<int>(SessionState::kFresh) ||
+      session_state[0] > static_cast<int>(SessionState::kDecoded)) {
+    return absl::DataLossError(
+        absl::StrCat("Invalid session state in the snapshot ", path));
+  }
+  RETURN_IF_ERROR(executor_.LoadContextSnapshot(std::move(snapshot)));
+  session_state_ = static_cast<SessionState>(session_state[0]);
+  last_prefill_token_id_ = last_prefill_token_id[0];
+  return absl::OkStatus();
+}
+
 absl::StatusOr<BenchmarkInfo> SessionBasic::GetBenchmarkInfo() {
   if (benchmark_info_.has_value()) {
     return benchmark_info_.value();
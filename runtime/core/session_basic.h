@@ -123,6 +123,13 @@ class SessionBasic : public Engine::Session {
 
   absl::StatusOr<BenchmarkInfo*> GetMutableBenchmarkInfo() override;
 
+  // Saves the processed tokens and the kv-cache of the executor, along with
+  // the state of the session which selects the prompt templates of the next
+  // turn.
+  absl::Status SaveSnapshot(absl::string_view path) override;
+
+  absl::Status LoadSnapshot(absl::string_view path) override;
+
   // TODO(b/450903294): Add rollback history support for Session and
   // Conversation.
   void CancelProcess() override {
@@ -209,7 +216,7 @@ class SessionBasic : public Engine::Session {
 
   // The last token id of the prefill ids. It is used for the first decode
   // process to determine the token id to start from.
-  int last_prefill_token_id_;
+  int last_prefill_token_id_ = 0;
 
   // The benchmark info used for the session.
   std::optional<BenchmarkInfo> benchmark_info_;
@@ -718,35 +718,43 @@ TEST_F(SessionBasicTest, RunTextScoringEmptyTargetTextFailure) {
   EXPECT_THAT((*session)->RunTextScoring(target_text,
                                          /*store_token_lengths=*/false),
               StatusIs(absl::StatusCode::kInvalidArgument,
-                       "Target text size should be 1."));
+                       "Target text should not be empty."));
 }
 
-TEST_F(SessionBasicTest, RunTextScoringMultipleTargetTextFailure) {
+TEST_F(SessionBasicTest, RunTextScoringMultipleTargetTextSuccess) {
   const std::vector<std::vector<int>> stop_token_ids = {{2294}};
   SessionConfig session_config = SessionConfig::CreateDefault();
   session_config.GetMutableSamplerParams() = sampler_params_;
   session_config.GetMutableStopTokenIds() = stop_token_ids;
   session_config.SetStartTokenId(2);
   session_config.SetSamplerBackend(Backend::CPU);
+  // The targets are scored one at a time from the same context, and the last
+  // token of the first target, "!", is also the last token of the context.
   ASSERT_OK_AND_ASSIGN(
       auto executor,
       CreateFakeLlmExecutor(
           // "Hello World!"
           /*prefill_tokens=*/{{2, 90, 547, 58, 735, 210, 466, 2294}},
-          // "How's it going?"
-          /*decode_tokens=*/{
-              {224}, {24}, {8}, {66}, {246}, {18}, {2295}, {2294}}));
+          // "How's it going!" and "How's it going?"
+          /*decode_tokens=*/{{224}, {24}, {8}, {66}, {246}, {18}, {2294},
+                             {224}, {24}, {8}, {66}, {246}, {18}, {2295}}));
   auto session = SessionBasic::Create(
       executor.get(), tokenizer_.get(), /*vision_executor=*/nullptr,
       /*audio_executor=*/nullptr, session_config, std::nullopt,
       worker_thread_pool_.get());
+  std::vector<InputData> inputs;
+  inputs.emplace_back(InputText("Hello World!"));
+  EXPECT_OK((*session)->RunPrefill(inputs));
   std::vector<absl::string_view> target_text;
+  target_text.push_back("How's it going!");
   target_text.push_back("How's it going?");
-  target_text.push_back("How are you?");
-  EXPECT_THAT(
-      (*session)->RunTextScoring(target_text, /*store_token_lengths=*/false),
-      StatusIs(absl::StatusCode::kInvalidArgument,
-               "Target text size should be 1."));
+  const auto responses =
+      (*session)->RunTextScoring(target_text, /*store_token_lengths=*/true);
+  EXPECT_OK(responses);
+  // Expect a score of 0.0f and a token length of 7 for each target.
+  EXPECT_THAT(responses->GetScores(), testing::ElementsAre(0.0f, 0.0f));
+  EXPECT_THAT(responses->GetTokenLengths(),
+              testing::Optional(testing::ElementsAre(7, 7)));
 }
 
 TEST_F(SessionBasicTest, RunTextScoringWithoutTokenLengthsSuccess) {
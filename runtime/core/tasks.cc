@@ -16,6 +16,8 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cstdint>
+#include <iterator>
 #include <limits>
 #include <memory>
 #include <optional>
@@ -94,6 +96,8 @@ bool ShouldStop(bool hit_stop_tokens, int benchmark_decode_token_count,
   return false;
 }
 
+}  // namespace
+
 // A wrapper class to run one step of the decode process, handling both internal
 // and external sampling.
 class DecodeOneStep {
@@ -103,7 +107,7 @@ class DecodeOneStep {
                 const StopTokenDetector& stop_token_detector,
                 std::optional<BenchmarkInfo>& benchmark_info,
                 std::optional<Sampler*> sampler, Constraint* constraint)
-      : executor_(*executor),
+      : executor_(executor),
         tokenizer_(*tokenizer),
         num_output_candidates_(num_output_candidates),
         sampler_(sampler),
@@ -189,6 +193,12 @@ class DecodeOneStep {
     return stop_token_detector_.AllDone();
   }
 
+  // Sets the executor used by the following steps. The executor must hold
+  // the same context as the previous one.
+  void SetExecutor(LlmExecutor* absl_nonnull executor) {
+    executor_ = executor;
+  }
+
   absl::Span<float> GetScores() { return scores_span_; }
 
   const std::vector<std::string>& GetResultText() const { return result_text_; }
@@ -213,7 +223,7 @@ class DecodeOneStep {
     if (benchmark_info_.has_value()) {
       RETURN_IF_ERROR(benchmark_info_->TimeMarkDelta("executor_decode"));
     }
-    ASSIGN_OR_RETURN(auto output_logits, executor_.DecodeLogits(inputs));
+    ASSIGN_OR_RETURN(auto output_logits, executor_->DecodeLogits(inputs));
     if (benchmark_info_.has_value()) {
       RETURN_IF_ERROR(benchmark_info_->TimeMarkDelta("executor_decode"));
     }
@@ -257,11 +267,16 @@ class DecodeOneStep {
         RETURN_IF_ERROR(
             constrained_decoder_->UpdateConstraintState(last_token_ids));
       }
+      // Computes the constraint mask on a worker thread while the model runs,
+      // so that complex grammars do not delay sampling.
+      if (constrained_decoder_) {
+        RETURN_IF_ERROR(constrained_decoder_->StartComputingBitmaps());
+      }
       // Decoding section.
       if (benchmark_info_.has_value()) {
         RETURN_IF_ERROR(benchmark_info_->TimeMarkDelta("executor_decode"));
       }
-      ASSIGN_OR_RETURN(auto output_logits, executor_.DecodeLogits(inputs));
+      ASSIGN_OR_RETURN(auto output_logits, executor_->DecodeLogits(inputs));
       if (benchmark_info_.has_value()) {
         RETURN_IF_ERROR(benchmark_info_->TimeMarkDelta("executor_decode"));
       }
@@ -291,9 +306,9 @@ class DecodeOneStep {
       if (constrained_decoder_) {
         auto decode_params = ExecutorDecodeParams();
         decode_params.SetConstraintDecoder(constrained_decoder_.get());
-        RETURN_IF_ERROR(executor_.Decode(output_tokens_, decode_params));
+        RETURN_IF_ERROR(executor_->Decode(output_tokens_, decode_params));
       } else {
-        RETURN_IF_ERROR(executor_.Decode(output_tokens_));
+        RETURN_IF_ERROR(executor_->Decode(output_tokens_));
       }
       if (benchmark_info_.has_value()) {
         RETURN_IF_ERROR(
@@ -305,7 +320,7 @@ class DecodeOneStep {
     }
   }
 
-  LlmExecutor& executor_;
+  LlmExecutor* absl_nonnull executor_;
   Tokenizer& tokenizer_;
   const int num_output_candidates_;
   std::optional<Sampler*> sampler_;
@@ -330,8 +345,6 @@ class DecodeOneStep {
   bool is_first_step_ = true;
 };
 
-}  // namespace
-
 absl::StatusOr<Responses> Prefill(
     LlmExecutor& executor, ExecutorInputs& inputs, bool wait_for_completion,
     std::optional<BenchmarkInfo>& benchmark_info) {
@@ -355,99 +368,105 @@ absl::StatusOr<Responses> Prefill(
   ExecutorPrefillParams params;
   // Wait for prefill to complete if benchmark mode is enabled.
   params.SetWaitForCompletion(wait_for_completion | benchmark_info.has_value());
+  const uint64_t num_kv_cache_bytes_copied =
+      executor.GetNumKvCacheBytesCopied();
   if (benchmark_info.has_value()) {
     RETURN_IF_ERROR(benchmark_info->TimePrefillTurnStart());
   }
   RETURN_IF_ERROR(executor.Prefill(inputs, params));
   if (benchmark_info.has_value()) {
     RETURN_IF_ERROR(benchmark_info->TimePrefillTurnEnd(ids_buffer_span.size()));
+    benchmark_info->RecordKvCacheBytesCopied(
+        executor.GetNumKvCacheBytesCopied() - num_kv_cache_bytes_copied);
   }
   return Responses(TaskState::kDone);
 }
 
-absl::StatusOr<Responses> Decode(
-    LlmExecutor& executor, Tokenizer& tokenizer,
-    const StopTokenDetector& stop_token_detector, int num_output_candidates,
-    std::optional<BenchmarkInfo>& benchmark_info,
+IncrementalDecode::IncrementalDecode(
+    Tokenizer& tokenizer, const StopTokenDetector& stop_token_detector,
+    int num_output_candidates, std::optional<BenchmarkInfo>& benchmark_info,
     std::optional<Sampler*> sampler, Constraint* constraint,
     std::optional<litert::TensorBuffer> decoded_ids,
     absl::AnyInvocable<void(absl::StatusOr<Responses>)>& callback,
-    std::atomic<bool>* cancelled, int max_output_tokens) {
-  const bool is_streaming = callback != nullptr;
-  const bool is_custom_sampling = sampler.has_value();
-
-  int benchmark_decode_token_count = 0;
-  if (benchmark_info.has_value()) {
-    // Initialize sampler early if the executor supports it.
-    auto* compiled_model_executor =
-        dynamic_cast<LlmLiteRtCompiledModelExecutorBase*>(&executor);
-    if (compiled_model_executor != nullptr) {
-      compiled_model_executor->InitializeSampler().IgnoreError();
+    std::atomic<bool>* cancelled, int max_output_tokens)
+    : tokenizer_(tokenizer),
+      stop_token_detector_(stop_token_detector),
+      num_output_candidates_(num_output_candidates),
+      benchmark_info_(benchmark_info),
+      sampler_(sampler),
+      constraint_(constraint),
+      decoded_ids_(std::move(decoded_ids)),
+      callback_(callback),
+      cancelled_(cancelled),
+      max_output_tokens_(max_output_tokens),
+      final_texts_(num_output_candidates),
+      accumulated_scores_(num_output_candidates),
+      num_decoded_tokens_(num_output_candidates) {}
+
+IncrementalDecode::~IncrementalDecode() = default;
+
+absl::StatusOr<std::optional<Responses>> IncrementalDecode::Run(
+    LlmExecutor& executor, int max_num_steps) {
+  const bool is_streaming = callback_ != nullptr;
+  const bool is_custom_sampling = sampler_.has_value();
+
+  if (run_one_step_ == nullptr) {
+    if (benchmark_info_.has_value()) {
+      // Initialize sampler early if the executor supports it.
+      auto* compiled_model_executor =
+          dynamic_cast<LlmLiteRtCompiledModelExecutorBase*>(&executor);
+      if (compiled_model_executor != nullptr) {
+        compiled_model_executor->InitializeSampler().IgnoreError();
+      }
+      benchmark_decode_token_count_ =
+          benchmark_info_->GetBenchmarkParams().num_decode_tokens();
+      RETURN_IF_ERROR(benchmark_info_->TimeDecodeTurnStart());
+      num_kv_cache_bytes_copied_at_start_ = executor.GetNumKvCacheBytesCopied();
     }
-    benchmark_decode_token_count =
-        benchmark_info->GetBenchmarkParams().num_decode_tokens();
-    RETURN_IF_ERROR(benchmark_info->TimeDecodeTurnStart());
+    max_num_tokens_ = TryGetMaxNumTokens(executor);
+    run_one_step_ = std::make_unique<DecodeOneStep>(
+        &executor, &tokenizer_, num_output_candidates_, stop_token_detector_,
+        benchmark_info_, sampler_, constraint_);
+  } else {
+    run_one_step_->SetExecutor(&executor);
   }
 
-  // The final decoded texts for each candidate.
-  std::vector<std::string> final_texts(num_output_candidates);
-  // The final scores for each candidate.
-  std::vector<float> final_scores(num_output_candidates);
-  // The accumulated scores for each candidate (for custom sampling).
-  std::vector<float> accumulated_scores(num_output_candidates);
-  // The number of decoded tokens for each candidate (for custom sampling).
-  std::vector<int> num_decoded_tokens(num_output_candidates);
-
-  int num_decode_steps = 0;
-  const int max_num_tokens = TryGetMaxNumTokens(executor);
-  DecodeOneStep run_one_step(&executor, &tokenizer, num_output_candidates,
-                             stop_token_detector, benchmark_info, sampler,
-                             constraint);
-  while (true) {
-    if (cancelled != nullptr && cancelled->load()) {
-      if (benchmark_info.has_value()) {
+  for (int num_steps_in_run = 0; num_steps_in_run < max_num_steps;
+       ++num_steps_in_run) {
+    if (cancelled_ != nullptr && cancelled_->load()) {
+      if (benchmark_info_.has_value()) {
         // If the process is cancelled, we need to end this benchmark phase.
-        RETURN_IF_ERROR(benchmark_info->TimeDecodeTurnEnd(
-            num_decode_steps * num_output_candidates));
+        RETURN_IF_ERROR(benchmark_info_->TimeDecodeTurnEnd(
+            num_decode_steps_ * num_output_candidates_));
+        RecordKvCacheBytesCopied(executor);
       }
       if (is_custom_sampling) {
         // For external sampling, the sampled tokens are provided by the
         // sampler. We must run one prefill to add the last token as pending
         // token in the LLM Executor when cancellation happens.
-        LITERT_ASSIGN_OR_RETURN(auto duplicated_decoded_ids,
-                                decoded_ids->Duplicate());
-        ExecutorInputs inputs;
-        inputs.SetTextData(ExecutorTextData(std::move(duplicated_decoded_ids)));
-        std::optional<BenchmarkInfo> unused_benchmark_info;
-        ASSIGN_OR_RETURN(auto current_step, executor.GetCurrentStep());
-        RETURN_IF_ERROR(executor.SetCurrentStep(current_step - 1));
-        auto status = Prefill(executor, inputs, /*wait_for_completion=*/true,
-                              unused_benchmark_info);
-        if (!status.ok()) {
-          return status.status();
-        }
+        RETURN_IF_ERROR(PrefillLastDecodedIds(executor));
       }
       return absl::CancelledError("Process cancelled.");
     }
     std::optional<litert::TensorBuffer> decoded_ids_to_use = std::nullopt;
-    if (decoded_ids.has_value()) {
-      LITERT_ASSIGN_OR_RETURN(decoded_ids_to_use, decoded_ids->Duplicate());
+    if (decoded_ids_.has_value()) {
+      LITERT_ASSIGN_OR_RETURN(decoded_ids_to_use, decoded_ids_->Duplicate());
     }
     absl::StatusOr<bool> all_done =
-        run_one_step.Run(std::move(decoded_ids_to_use));
+        run_one_step_->Run(std::move(decoded_ids_to_use));
     if (!all_done.ok()) {
       return all_done.status();
     }
-    num_decode_steps++;
+    num_decode_steps_++;
     std::vector<std::string> step_texts;
     std::vector<float> step_scores;
     if (is_streaming) {
-      step_texts.resize(num_output_candidates);
-      step_scores.resize(num_output_candidates);
+      step_texts.resize(num_output_candidates_);
+      step_scores.resize(num_output_candidates_);
     }
     bool any_updates = false;
-    for (int j = 0; j < num_output_candidates; ++j) {
-      std::string output_text = run_one_step.GetResultText()[j];
+    for (int j = 0; j < num_output_candidates_; ++j) {
+      std::string output_text = run_one_step_->GetResultText()[j];
       if (output_text.empty()) {
         // No output text for this candidate - could be due to
         // 1. early stopping.
@@ -462,76 +481,117 @@ absl::StatusOr<Responses> Decode(
       if (is_streaming) {
         step_texts[j] = result_text;
         if (is_custom_sampling) {
-          step_scores[j] = run_one_step.GetScores()[j];
+          step_scores[j] = run_one_step_->GetScores()[j];
         }
       } else {
-        final_texts[j] += result_text;
+        final_texts_[j] += result_text;
         if (is_custom_sampling) {
-          accumulated_scores[j] += run_one_step.GetScores()[j];
-          num_decoded_tokens[j]++;
+          accumulated_scores_[j] += run_one_step_->GetScores()[j];
+          num_decoded_tokens_[j]++;
         }
       }
     }
 
     if (is_streaming && any_updates && !*all_done) {
-      callback(Responses(TaskState::kProcessing, std::move(step_texts),
-                         std::move(step_scores)));
+      callback_(Responses(TaskState::kProcessing, std::move(step_texts),
+                          std::move(step_scores)));
     }
 
-    if (ShouldStop(*all_done, benchmark_decode_token_count, num_decode_steps,
-                   executor.GetCurrentStep().value(), max_num_tokens,
-                   max_output_tokens)) {
-      break;
+    if (ShouldStop(*all_done, benchmark_decode_token_count_, num_decode_steps_,
+                   executor.GetCurrentStep().value(), max_num_tokens_,
+                   max_output_tokens_)) {
+      ASSIGN_OR_RETURN(auto responses, Finish(executor));
+      return responses;
     }
   }
+  return std::nullopt;
+}
+
+absl::Status IncrementalDecode::PrefillLastDecodedIds(LlmExecutor& executor) {
+  LITERT_ASSIGN_OR_RETURN(auto duplicated_decoded_ids,
+                          decoded_ids_->Duplicate());
+  ExecutorInputs inputs;
+  inputs.SetTextData(ExecutorTextData(std::move(duplicated_decoded_ids)));
+  std::optional<BenchmarkInfo> unused_benchmark_info;
+  ASSIGN_OR_RETURN(auto current_step, executor.GetCurrentStep());
+  RETURN_IF_ERROR(executor.SetCurrentStep(current_step - 1));
+  return Prefill(executor, inputs, /*wait_for_completion=*/true,
+                 unused_benchmark_info)
+      .status();
+}
+
+void IncrementalDecode::RecordKvCacheBytesCopied(
+    const LlmExecutor& executor) {
+  const uint64_t num_kv_cache_bytes_copied =
+      executor.GetNumKvCacheBytesCopied();
+  // The executor may have been replaced between the runs of the turn, e.g. by
+  // an executor pool, in which case its counter is unrelated.
+  if (num_kv_cache_bytes_copied >= num_kv_cache_bytes_copied_at_start_) {
+    benchmark_info_->RecordKvCacheBytesCopied(
+        num_kv_cache_bytes_copied - num_kv_cache_bytes_copied_at_start_);
+  }
+}
 
-  if (benchmark_info.has_value()) {
-    RETURN_IF_ERROR(benchmark_info->TimeDecodeTurnEnd(num_decode_steps *
-                                                      num_output_candidates));
+absl::StatusOr<Responses> IncrementalDecode::Finish(LlmExecutor& executor) {
+  const bool is_streaming = callback_ != nullptr;
+  const bool is_custom_sampling = sampler_.has_value();
+
+  if (benchmark_info_.has_value()) {
+    RETURN_IF_ERROR(benchmark_info_->TimeDecodeTurnEnd(num_decode_steps_ *
+                                                       num_output_candidates_));
+    RecordKvCacheBytesCopied(executor);
   }
 
   if (is_custom_sampling) {
     // For external sampling, the sampled tokens are provided by the sampler. We
     // must run one prefill to add the stop token as pending token in the LLM
     // Executor when stop condition is met.
-    LITERT_ASSIGN_OR_RETURN(auto duplicated_decoded_ids,
-                            decoded_ids->Duplicate());
-    ExecutorInputs inputs;
-    inputs.SetTextData(ExecutorTextData(std::move(duplicated_decoded_ids)));
-    std::optional<BenchmarkInfo> unused_benchmark_info;
-    ASSIGN_OR_RETURN(auto current_step, executor.GetCurrentStep());
-    RETURN_IF_ERROR(executor.SetCurrentStep(current_step - 1));
-    auto status = Prefill(executor, inputs, /*wait_for_completion=*/true,
-                          unused_benchmark_info);
-    if (!status.ok()) {
-      return status.status();
-    }
+    RETURN_IF_ERROR(PrefillLastDecodedIds(executor));
   }
 
   if (is_streaming) {
-    if (executor.GetCurrentStep().value() >= max_num_tokens) {
+    if (executor.GetCurrentStep().value() >= max_num_tokens_) {
       return Responses(TaskState::kMaxNumTokensReached);
     }
     return Responses(TaskState::kDone);
   }
 
   // Finalize scores for non-streaming custom sampling.
+  std::vector<float> final_scores(num_output_candidates_);
   if (is_custom_sampling) {
-    for (int j = 0; j < num_output_candidates; ++j) {
-      if (num_decoded_tokens[j] > 0) {
-        final_scores[j] = accumulated_scores[j] / num_decoded_tokens[j];
+    for (int j = 0; j < num_output_candidates_; ++j) {
+      if (num_decoded_tokens_[j] > 0) {
+        final_scores[j] = accumulated_scores_[j] / num_decoded_tokens_[j];
       } else {
         final_scores[j] = -std::numeric_limits<float>::infinity();
       }
     }
   }
-  TaskState task_state = executor.GetCurrentStep().value() >= max_num_tokens
+  TaskState task_state = executor.GetCurrentStep().value() >= max_num_tokens_
                              ? TaskState::kMaxNumTokensReached
                              : TaskState::kDone;
-  return Responses(std::move(task_state), std::move(final_texts),
+  return Responses(std::move(task_state), std::move(final_texts_),
                    std::move(final_scores));
 }
 
+absl::StatusOr<Responses> Decode(
+    LlmExecutor& executor, Tokenizer& tokenizer,
+    const StopTokenDetector& stop_token_detector, int num_output_candidates,
+    std::optional<BenchmarkInfo>& benchmark_info,
+    std::optional<Sampler*> sampler, Constraint* constraint,
+    std::optional<litert::TensorBuffer> decoded_ids,
+    absl::AnyInvocable<void(absl::StatusOr<Responses>)>& callback,
+    std::atomic<bool>* cancelled, int max_output_tokens) {
+  IncrementalDecode decode(tokenizer, stop_token_detector,
+                           num_output_candidates, benchmark_info, sampler,
+                           constraint, std::move(decoded_ids), callback,
+                           cancelled, max_output_tokens);
+  ASSIGN_OR_RETURN(std::optional<Responses> responses,
+                   decode.Run(executor, std::numeric_limits<int>::max()));
+  RET_CHECK(responses.has_value()) << "Decoding did not finish.";
+  return *std::move(responses);
+}
+
 absl::StatusOr<Responses> Score(
     LlmExecutor& executor, Tokenizer& tokenizer,
     const std::vector<absl::string_view>& target_texts, const float temperature,
@@ -611,4 +671,87 @@ absl::StatusOr<Responses> Score(
   return responses;
 }
 
+absl::StatusOr<Responses> ScoreCandidates(
+    LlmExecutor& executor, Tokenizer& tokenizer,
+    const std::vector<absl::string_view>& target_texts, const float temperature,
+    int last_token_id, int batch_size, bool store_token_lengths,
+    absl::AnyInvocable<void(absl::StatusOr<Responses>)>& callback,
+    std::atomic<bool>* cancelled) {
+  if (target_texts.empty()) {
+    return absl::InvalidArgumentError("No target text to score.");
+  }
+  if (batch_size <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Invalid batch size: ", batch_size));
+  }
+  const int num_targets = target_texts.size();
+  int context_end_step = 0;
+  if (num_targets > batch_size) {
+    ASSIGN_OR_RETURN(context_end_step, executor.GetCurrentStep());
+  }
+  std::vector<float> scores;
+  std::vector<int> token_lengths;
+  std::vector<std::vector<float>> token_scores;
+  scores.reserve(num_targets);
+  token_scores.reserve(num_targets);
+  for (int begin = 0; begin < num_targets; begin += batch_size) {
+    if (cancelled != nullptr && cancelled->load()) {
+      return absl::CancelledError("Process cancelled.");
+    }
+    if (begin > 0) {
+      // Drop the KV entries of the previous batch so that this batch is
+      // scored right after the shared context.
+      RETURN_IF_ERROR(executor.SetCurrentStep(context_end_step));
+    }
+    const int num_batch_targets = std::min(batch_size, num_targets - begin);
+    std::vector<absl::string_view> batch_targets(
+        target_texts.begin() + begin,
+        target_texts.begin() + begin + num_batch_targets);
+    batch_targets.resize(batch_size);
+
+    LITERT_ASSIGN_OR_RETURN(
+        auto decoded_ids,
+        CopyToTensorBuffer<int>(std::vector<int>(batch_size, last_token_id),
+                                {batch_size, 1}));
+    ASSIGN_OR_RETURN(Responses batch_responses,
+                     Score(executor, tokenizer, batch_targets, temperature,
+                           std::move(decoded_ids), store_token_lengths));
+
+    // Drop the scores of the padding targets.
+    std::vector<float> batch_scores =
+        std::move(batch_responses.GetMutableScores());
+    batch_scores.resize(num_batch_targets);
+    std::vector<int> batch_token_lengths =
+        std::move(batch_responses.GetMutableTokenLengths())
+            .value_or(std::vector<int>());
+    batch_token_lengths.resize(
+        std::min<int>(batch_token_lengths.size(), num_batch_targets));
+    std::vector<std::vector<float>> batch_token_scores =
+        std::move(batch_responses.GetMutableTokenScores())
+            .value_or(std::vector<std::vector<float>>());
+    batch_token_scores.resize(
+        std::min<int>(batch_token_scores.size(), num_batch_targets));
+
+    // Stream the scores of the batch when there are several of them.
+    if (num_targets > batch_size && callback != nullptr) {
+      Responses partial_responses(TaskState::kProcessing,
+                                  /*response_texts=*/{}, batch_scores,
+                                  batch_token_lengths);
+      partial_responses.GetMutableTokenScores() = batch_token_scores;
+      callback(std::move(partial_responses));
+    }
+    scores.insert(scores.end(), batch_scores.begin(), batch_scores.end());
+    token_lengths.insert(token_lengths.end(), batch_token_lengths.begin(),
+                         batch_token_lengths.end());
+    token_scores.insert(token_scores.end(),
+                        std::make_move_iterator(batch_token_scores.begin()),
+                        std::make_move_iterator(batch_token_scores.end()));
+  }
+
+  auto responses = Responses(TaskState::kDone, /*response_texts=*/{},
+                             std::move(scores), std::move(token_lengths));
+  responses.GetMutableTokenScores() = std::move(token_scores);
+  return responses;
+}
+
 }  // namespace litert::lm::Tasks
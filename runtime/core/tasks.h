@@ -16,11 +16,15 @@
 #define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CORE_TASKS_H_
 
 #include <atomic>
+#include <cstdint>
 #include <limits>
+#include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
 #include "absl/functional/any_invocable.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
@@ -48,11 +52,101 @@ absl::StatusOr<Responses> Decode(
     std::atomic<bool>* cancelled,
     int max_output_tokens = std::numeric_limits<int>::max());
 
+class DecodeOneStep;
+
+// Incremental version of Decode(). Runs the decoding loop in chunks of steps
+// and keeps the decoding state in between, so that the caller can release the
+// executor between chunks, e.g. to interleave the decode steps of several
+// sessions. The arguments are the same as Decode(); the referenced objects must
+// outlive the IncrementalDecode.
+class IncrementalDecode {
+ public:
+  IncrementalDecode(
+      Tokenizer& tokenizer, const StopTokenDetector& stop_token_detector,
+      int num_output_candidates, std::optional<BenchmarkInfo>& benchmark_info,
+      std::optional<Sampler*> sampler, Constraint* constraint,
+      std::optional<litert::TensorBuffer> decoded_ids,
+      absl::AnyInvocable<void(absl::StatusOr<Responses>)>& callback,
+      std::atomic<bool>* cancelled,
+      int max_output_tokens = std::numeric_limits<int>::max());
+  ~IncrementalDecode();
+
+  // Runs at most `max_num_steps` decode steps. Returns the final responses,
+  // as Decode() would, once the decoding is finished, or std::nullopt if more
+  // steps are needed. Every call must pass an executor holding the context of
+  // the session being decoded.
+  absl::StatusOr<std::optional<Responses>> Run(LlmExecutor& executor,
+                                               int max_num_steps);
+
+  // Returns the number of decode steps run so far, each of which decodes one
+  // token per output candidate.
+  int num_decode_steps() const { return num_decode_steps_; }
+
+ private:
+  // Prefills the last decoded ids so that they become the pending token of the
+  // executor. Only used with external sampling.
+  absl::Status PrefillLastDecodedIds(LlmExecutor& executor);
+
+  // Records in the benchmark the kv-cache bytes copied by `executor` since the
+  // decode turn started.
+  void RecordKvCacheBytesCopied(const LlmExecutor& executor);
+
+  // Ends the decoding and builds the final responses.
+  absl::StatusOr<Responses> Finish(LlmExecutor& executor);
+
+  Tokenizer& tokenizer_;
+  const StopTokenDetector& stop_token_detector_;
+  const int num_output_candidates_;
+  std::optional<BenchmarkInfo>& benchmark_info_;
+  std::optional<Sampler*> sampler_;
+  Constraint* constraint_;
+  std::optional<litert::TensorBuffer> decoded_ids_;
+  absl::AnyInvocable<void(absl::StatusOr<Responses>)>& callback_;
+  std::atomic<bool>* cancelled_;
+  const int max_output_tokens_;
+
+  // Created by the first Run() call.
+  std::unique_ptr<DecodeOneStep> run_one_step_;
+  int max_num_tokens_ = 0;
+  int benchmark_decode_token_count_ = 0;
+  int num_decode_steps_ = 0;
+  // The kv-cache bytes copied by the executor when the benchmarked decode
+  // turn started.
+  uint64_t num_kv_cache_bytes_copied_at_start_ = 0;
+
+  // The final decoded texts for each candidate.
+  std::vector<std::string> final_texts_;
+  // The accumulated scores for each candidate (for custom sampling).
+  std::vector<float> accumulated_scores_;
+  // The number of decoded tokens for each candidate (for custom sampling).
+  std::vector<int> num_decoded_tokens_;
+};
+
 absl::StatusOr<Responses> Score(
     LlmExecutor& executor, Tokenizer& tokenizer,
     const std::vector<absl::string_view>& target_texts, float temperature,
     litert::TensorBuffer decoded_ids, bool store_token_lengths = false);
 
+// Scores any number of target texts against the same prefilled context.
+//
+// The targets are scored `batch_size` at a time, where `batch_size` is the
+// number of output candidates the executor was created with, and the last
+// batch is padded with empty targets. Before every batch but the first, the
+// executor is rolled back to the end of the context, so the context is
+// prefilled once and its KV cache is shared by all the targets.
+// - last_token_id: The last token of the context, i.e. the decode input of
+//   the first target token.
+// - callback: If there are several batches, receives the scores of every
+//   batch as a kProcessing response, in the order of `target_texts`.
+// - cancelled: If set to true, scoring stops after the current batch.
+// Returns the scores of all the targets as a kDone response.
+absl::StatusOr<Responses> ScoreCandidates(
+    LlmExecutor& executor, Tokenizer& tokenizer,
+    const std::vector<absl::string_view>& target_texts, float temperature,
+    int last_token_id, int batch_size, bool store_token_lengths,
+    absl::AnyInvocable<void(absl::StatusOr<Responses>)>& callback,
+    std::atomic<bool>* cancelled = nullptr);
+
 }  // namespace litert::lm::Tasks
 
 #endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CORE_TASKS_H_
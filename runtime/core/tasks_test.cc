@@ -15,6 +15,7 @@
 #include "runtime/core/tasks.h"
 
 #include <atomic>
+#include <cmath>
 #include <filesystem>  // NOLINT: Required for path manipulation.
 #include <limits>
 #include <memory>
@@ -25,12 +26,15 @@
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/container/flat_hash_map.h"  // from @com_google_absl
 #include "absl/functional/any_invocable.h"  // from @com_google_absl
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
 #include "absl/time/clock.h"  // from @com_google_absl
 #include "absl/time/time.h"  // from @com_google_absl
+#include "litert/cc/litert_macros.h"  // from @litert
+#include "litert/cc/litert_tensor_buffer.h"  // from @litert
 #include "runtime/components/constrained_decoding/fake_constraint.h"
 #include "runtime/components/sentencepiece_tokenizer.h"
 #include "runtime/components/stop_token_detector.h"
@@ -38,6 +42,7 @@
 #include "runtime/components/top_p_cpu_sampler.h"
 #include "runtime/engine/io_types.h"
 #include "runtime/executor/fake_llm_executor.h"
+#include "runtime/executor/llm_executor.h"
 #include "runtime/executor/llm_executor_io_types.h"
 #include "runtime/framework/threadpool.h"
 #include "runtime/util/convert_tensor_buffer.h"
@@ -47,6 +52,7 @@
 namespace litert::lm {
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::status::StatusIs;
 
 constexpr char kTestdataDir[] =
@@ -200,6 +206,45 @@ TEST_F(TasksTest, DecodeSucceed) {
   EXPECT_EQ(task_responses->GetTexts()[0], " How's it going?");
 }
 
+TEST_F(TasksTest, IncrementalDecodeOneStepAtATime) {
+  std::optional<BenchmarkInfo> benchmark_info;
+
+  // Run prefill first.
+  std::vector<int> prefill_token_ids = {2, 90, 547, 58, 735, 210, 466, 2294};
+  ASSERT_OK_AND_ASSIGN(auto token_ids_buffer,
+                       tokenizer_->TokenIdsToTensorBuffer(prefill_token_ids));
+  ExecutorTextData text_data(std::move(token_ids_buffer));
+  ExecutorInputs inputs(std::move(text_data), std::nullopt, std::nullopt);
+  auto prefill_responses = Tasks::Prefill(
+      *executor_, inputs, /*wait_for_completion=*/true, benchmark_info);
+  EXPECT_OK(prefill_responses);
+
+  constexpr int kNumOutputCandidates = 1;
+  StopTokenDetector stop_token_detector(kNumOutputCandidates);
+  EXPECT_OK(stop_token_detector.AddStopTokenSequence({2294}));
+  absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback = nullptr;
+
+  Tasks::IncrementalDecode decode(
+      *tokenizer_, stop_token_detector, kNumOutputCandidates, benchmark_info,
+      /*sampler=*/std::nullopt, /*constraint=*/nullptr,
+      /*decoded_ids=*/std::nullopt, callback, /*cancelled=*/nullptr);
+
+  // The response takes 8 decode steps, the last one producing the stop token.
+  int num_runs = 0;
+  std::optional<Responses> task_responses;
+  while (!task_responses.has_value()) {
+    ASSERT_LT(num_runs, 8);
+    ASSERT_OK_AND_ASSIGN(task_responses,
+                         decode.Run(*executor_, /*max_num_steps=*/1));
+    ++num_runs;
+  }
+
+  EXPECT_EQ(num_runs, 8);
+  EXPECT_EQ(task_responses->GetTaskState(), TaskState::kDone);
+  EXPECT_EQ(task_responses->GetTexts().size(), 1);
+  EXPECT_EQ(task_responses->GetTexts()[0], " How's it going?");
+}
+
 TEST_F(TasksTest, DecodeWithTwoStopTokens) {
   std::optional<BenchmarkInfo> benchmark_info;
 
@@ -1438,6 +1483,135 @@ TEST_F(TasksCustomSamplingTest, DecodeStopTokenAndBPEDetector) {
   EXPECT_EQ(task_responses->GetTexts()[1], "a");
 }
 
+// An executor whose logits after every token select the next token from a
+// fixed table.
+class NextTokenLlmExecutor : public LlmExecutor {
+ public:
+  NextTokenLlmExecutor(int vocab_size,
+                       absl::flat_hash_map<int, int> next_tokens)
+      : vocab_size_(vocab_size), next_tokens_(std::move(next_tokens)) {}
+
+  absl::Status Prefill(const ExecutorInputs& inputs) override {
+    ASSIGN_OR_RETURN(auto token_ids, inputs.GetTextTokenIdsPtr());
+    LITERT_ASSIGN_OR_RETURN(auto ids, CopyFromTensorBuffer<int>(*token_ids));
+    processed_token_ids_.insert(processed_token_ids_.end(), ids.begin(),
+                                ids.end());
+    return absl::OkStatus();
+  }
+
+  absl::Status Prefill(const ExecutorInputs& inputs,
+                       const ExecutorPrefillParams& prefill_params) override {
+    return Prefill(inputs);
+  }
+
+  absl::Status Decode(::litert::TensorBuffer& output_tokens) override {
+    return absl::UnimplementedError("Only DecodeLogits is supported.");
+  }
+
+  absl::StatusOr<::litert::TensorBuffer> DecodeLogits(
+      const ExecutorInputs& inputs) override {
+    ASSIGN_OR_RETURN(auto token_ids, inputs.GetTextTokenIdsPtr());
+    LITERT_ASSIGN_OR_RETURN(auto ids, CopyFromTensorBuffer<int>(*token_ids));
+    const int num_tokens = ids.size();
+    std::vector<float> logits(num_tokens * vocab_size_, 0.0f);
+    for (int i = 0; i < num_tokens; ++i) {
+      // Unknown tokens are followed by token 0.
+      auto it = next_tokens_.find(ids[i]);
+      logits[i * vocab_size_ + (it == next_tokens_.end() ? 0 : it->second)] =
+          1.0f;
+    }
+    processed_token_ids_.insert(processed_token_ids_.end(), ids.begin(),
+                                ids.end());
+    ++num_decode_logits_calls_;
+    LITERT_ASSIGN_OR_RETURN(
+        auto output_logits,
+        CopyToTensorBuffer<float>(absl::MakeConstSpan(logits),
+                                  {1, num_tokens, vocab_size_}));
+    return output_logits;
+  }
+
+  absl::string_view ExecutorBackendName() const override {
+    return "NextTokenLlmExecutor";
+  }
+
+  absl::StatusOr<int> GetVocabSize() override { return vocab_size_; }
+
+  absl::StatusOr<int> GetCurrentStep() const override {
+    return processed_token_ids_.size();
+  }
+
+  absl::Status SetCurrentStep(int current_step) override {
+    if (current_step > static_cast<int>(processed_token_ids_.size())) {
+      return absl::InvalidArgumentError("Cannot move past processed tokens.");
+    }
+    processed_token_ids_.resize(current_step);
+    return absl::OkStatus();
+  }
+
+  const std::vector<int>& processed_token_ids() const {
+    return processed_token_ids_;
+  }
+
+  int num_decode_logits_calls() const { return num_decode_logits_calls_; }
+
+ private:
+  const int vocab_size_;
+  const absl::flat_hash_map<int, int> next_tokens_;
+  std::vector<int> processed_token_ids_;
+  int num_decode_logits_calls_ = 0;
+};
+
+TEST_F(TasksCustomSamplingTest, ScoreCandidatesFromSharedContext) {
+  // "Hello World!" follows <bos>.
+  absl::flat_hash_map<int, int> next_tokens = {
+      {2, 90},    {90, 547},  {547, 58},   {58, 735},
+      {735, 210}, {210, 466}, {466, 2294}};
+  NextTokenLlmExecutor executor(/*vocab_size=*/2560, next_tokens);
+  std::optional<BenchmarkInfo> benchmark_info;
+  ASSERT_OK_AND_ASSIGN(auto token_ids_buffer,
+                       tokenizer_->TokenIdsToTensorBuffer({2}));
+  ExecutorInputs inputs(ExecutorTextData(std::move(token_ids_buffer)),
+                        std::nullopt, std::nullopt);
+  EXPECT_OK(Tasks::Prefill(executor, inputs, /*wait_for_completion=*/true,
+                           benchmark_info));
+
+  std::vector<Responses> partial_responses;
+  absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback =
+      [&partial_responses](absl::StatusOr<Responses> responses) {
+        ASSERT_OK(responses);
+        partial_responses.push_back(*std::move(responses));
+      };
+  ASSERT_OK_AND_ASSIGN(
+      auto responses,
+      Tasks::ScoreCandidates(
+          executor, *tokenizer_,
+          {"Hello World!", "Hello World!", "Hello World!"},
+          /*temperature=*/1.0f, /*last_token_id=*/2, /*batch_size=*/1,
+          /*store_token_lengths=*/true, callback));
+
+  // One decode step per token of every target, each target scored right after
+  // the shared context, so only the last target is left after it.
+  EXPECT_EQ(executor.num_decode_logits_calls(), 3 * 7);
+  EXPECT_THAT(executor.processed_token_ids(),
+              ElementsAre(2, 2, 90, 547, 58, 735, 210, 466));
+  ASSERT_EQ(partial_responses.size(), 3);
+  for (const Responses& partial : partial_responses) {
+    EXPECT_EQ(partial.GetTaskState(), TaskState::kProcessing);
+    EXPECT_EQ(partial.GetScores().size(), 1);
+  }
+
+  const float expected_score = 7 * (1.0f - std::log(std::exp(1.0f) + 2559.0f));
+  EXPECT_EQ(responses.GetTaskState(), TaskState::kDone);
+  EXPECT_THAT(responses.GetScores(),
+              ElementsAre(testing::FloatNear(expected_score, 1e-4),
+                          testing::FloatNear(expected_score, 1e-4),
+                          testing::FloatNear(expected_score, 1e-4)));
+  EXPECT_THAT(responses.GetTokenLengths(),
+              testing::Optional(ElementsAre(7, 7, 7)));
+  ASSERT_TRUE(responses.GetTokenScores().has_value());
+  EXPECT_EQ(responses.GetTokenScores()->size(), 3);
+}
+
 using TasksCallbackTest = TasksTest;
 
 TEST_F(TasksCallbackTest, DecodeStreaming_SuccessfulCompletion) {
@@ -142,7 +142,9 @@ class Engine {
     // is used to calculate the target text's score and update the model memory
     // using the target_text tokens.
     // This function should be called after the prefill process is done.
-    // - target_text: The target text to score.
+    // - target_text: The target texts to score. Any number of targets can be
+    //   scored against the same prefilled context: they are scored
+    //   num_output_candidates at a time, each batch right after the context.
     // - store_token_lengths: Whether to store the token lengths of the target
     //   texts in `Responses`.
     // - returns: This function returns the score associated with the target
@@ -155,8 +157,10 @@ class Engine {
     // Similar to the above RunTextScoring function, but this is a not blocking
     // call and the function will return right away. The processing status will
     // be signaled through the callback.
-    // - target_text: The target text to score.
-    // - callback: Callback to receive the scoring results.
+    // - target_text: The target texts to score.
+    // - callback: Callback to receive the scoring results. If the targets do
+    //   not fit in one batch, the scores of every batch are passed as
+    //   kProcessing responses before the scores of all of them.
     // - store_token_lengths: Whether to store the token lengths of the target
     //   texts in `Responses`.
     virtual absl::StatusOr<std::unique_ptr<TaskController>> RunTextScoringAsync(
@@ -266,6 +270,29 @@ class Engine {
       return absl::UnimplementedError("Not implemented.");
     };
 
+    // Saves the context of the session, i.e. its processed tokens and
+    // kv-cache, to the file at `path` after the pending tasks are done. A
+    // session of the same model continues from it with LoadSnapshot(),
+    // possibly in another process, without prefilling the tokens again.
+    //
+    // Example usage:
+    //   session1->RunPrefill(long_conversation);
+    //   session1->SaveSnapshot("/data/conversation.snapshot");
+    //   ... the process restarts ...
+    //   auto session2 = engine->CreateSessionFromSnapshot(
+    //       session_config, "/data/conversation.snapshot");
+    //   session2->RunPrefill(next_message);
+    virtual absl::Status SaveSnapshot(absl::string_view path) {
+      return absl::UnimplementedError("Not implemented.");
+    }
+
+    // Replaces the context of the session with the one saved at `path`.
+    // Returns a FailedPreconditionError if the snapshot was saved with another
+    // model.
+    virtual absl::Status LoadSnapshot(absl::string_view path) {
+      return absl::UnimplementedError("Not implemented.");
+    }
+
     // Get the reference to the session config for the session.
     virtual const SessionConfig& GetSessionConfig() const = 0;
 
@@ -284,6 +311,22 @@ class Engine {
   virtual absl::StatusOr<std::unique_ptr<Session>> CreateSession(
       const SessionConfig& session_config) = 0;
 
+  // Creates a Session which continues from the context saved at `path` by
+  // Session::SaveSnapshot().
+  virtual absl::StatusOr<std::unique_ptr<Session>> CreateSessionFromSnapshot(
+      const SessionConfig& session_config, absl::string_view path) {
+    absl::StatusOr<std::unique_ptr<Session>> session =
+        CreateSession(session_config);
+    if (!session.ok()) {
+      return session.status();
+    }
+    absl::Status status = (*session)->LoadSnapshot(path);
+    if (!status.ok()) {
+      return status;
+    }
+    return session;
+  }
+
   // Waits until the engine is done with all the tasks. The function will
   // return error if the timeout is reached.
   virtual absl::Status WaitUntilDone(absl::Duration timeout) {
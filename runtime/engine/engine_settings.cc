@@ -30,6 +30,7 @@
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/strings/str_split.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
 #include "litert/cc/internal/scoped_file.h"  // from @litert
 #include "runtime/components/tokenizer.h"
 #include "runtime/executor/audio_executor_settings.h"
@@ -540,6 +541,18 @@ void SessionConfig::SetScopedLoraFile(
   scoped_lora_file_ = std::move(scoped_lora_file);
 }
 
+std::ostream& operator<<(std::ostream& os, SessionPriority priority) {
+  switch (priority) {
+    case SessionPriority::kBackground:
+      return os << "BACKGROUND";
+    case SessionPriority::kNormal:
+      return os << "NORMAL";
+    case SessionPriority::kInteractive:
+      return os << "INTERACTIVE";
+  }
+  return os << "UNKNOWN";
+}
+
 std::ostream& operator<<(std::ostream& os, const SessionConfig& config) {
   os << "SessionConfig: " << std::endl;
   os << "  AudioModalityEnabled: " << config.AudioModalityEnabled()
@@ -565,6 +578,22 @@ std::ostream& operator<<(std::ostream& os, const SessionConfig& config) {
   os << "  ScopedLoraFile: "
      << (config.GetScopedLoraFile() != nullptr ? "Present" : "Not present")
      << std::endl;
+  os << "  Priority: " << config.GetPriority() << std::endl;
+  os << "  TaskDeadline: "
+     << (config.GetTaskDeadline().has_value()
+             ? absl::FormatDuration(*config.GetTaskDeadline())
+             : "Not set")
+     << std::endl;
+  os << "  DecodeQuantum: "
+     << (config.GetDecodeQuantum().has_value()
+             ? std::to_string(*config.GetDecodeQuantum())
+             : "Not set")
+     << std::endl;
+  os << "  PrefillQuantum: "
+     << (config.GetPrefillQuantum().has_value()
+             ? std::to_string(*config.GetPrefillQuantum())
+             : "Not set")
+     << std::endl;
   return os;
 }
 
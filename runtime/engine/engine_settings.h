@@ -26,6 +26,7 @@
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
 #include "litert/cc/internal/scoped_file.h"  // from @litert
 #include "runtime/components/tokenizer.h"
 #include "runtime/executor/audio_executor_settings.h"
@@ -149,6 +150,17 @@ class EngineSettings {
 };
 std::ostream& operator<<(std::ostream& os, const EngineSettings& settings);
 
+// The priority class of a session. The ready tasks of the sessions of a higher
+// class run before the ones of the sessions of a lower class.
+enum class SessionPriority {
+  // E.g. batch summarization, which only runs when no other task is ready.
+  kBackground = 0,
+  kNormal = 1,
+  // E.g. a chat, whose user waits for every token.
+  kInteractive = 2,
+};
+std::ostream& operator<<(std::ostream& os, SessionPriority priority);
+
 // Configurations used for the session.
 // This class encapsulates the session-specific configurations that are used for
 // creating a LiteRT LM session.
@@ -235,6 +247,37 @@ class SessionConfig {
     max_output_tokens_ = max_output_tokens;
   }
 
+  // The priority class of the session:
+  // Getters for the priority of the session.
+  SessionPriority GetPriority() const { return priority_; }
+  void SetPriority(SessionPriority priority) { priority_ = priority; }
+
+  // The deadline of the tasks of the session:
+  // Getters for the time within which a task of the session should run once it
+  // is ready, e.g. the time between two tokens of a streamed response.
+  std::optional<absl::Duration> GetTaskDeadline() const {
+    return task_deadline_;
+  }
+  void SetTaskDeadline(std::optional<absl::Duration> task_deadline) {
+    task_deadline_ = task_deadline;
+  }
+
+  // The decode quantum of the session:
+  // Getters for the number of tokens the session decodes per scheduling round
+  // when several sessions decode concurrently.
+  std::optional<int> GetDecodeQuantum() const { return decode_quantum_; }
+  void SetDecodeQuantum(std::optional<int> decode_quantum) {
+    decode_quantum_ = decode_quantum;
+  }
+
+  // The prefill quantum of the session:
+  // Getters for the maximum number of tokens the session prefills per turn
+  // before yielding the executor to the other sessions.
+  std::optional<int> GetPrefillQuantum() const { return prefill_quantum_; }
+  void SetPrefillQuantum(std::optional<int> prefill_quantum) {
+    prefill_quantum_ = prefill_quantum;
+  }
+
  private:
   // Private constructor for the SessionConfig. The user should use the
   // CreateDefault() method to create a SessionConfig.
@@ -291,6 +334,27 @@ class SessionConfig {
   // tokens (input + output) stored in the KV cache over the lifetime of a
   // session.
   int max_output_tokens_ = std::numeric_limits<int>::max();
+
+  // The priority class of the session.
+  SessionPriority priority_ = SessionPriority::kNormal;
+
+  // The deadline of the tasks of the session, relative to the time they are
+  // ready to run. Among the ready tasks of the same priority class, the one
+  // with the earliest deadline runs first, and the tasks without a deadline run
+  // last.
+  std::optional<absl::Duration> task_deadline_;
+
+  // The number of tokens, over all the output candidates, the session decodes
+  // per scheduling round, i.e. its share of the executor among the sessions of
+  // the same priority class decoding concurrently. When not set,
+  // AdvancedSettings::decode_quantum_tokens is used.
+  std::optional<int> decode_quantum_;
+
+  // The maximum number of tokens of a text prefill the session processes per
+  // turn, e.g. a small one for a background session prefilling long documents
+  // next to interactive sessions. 0 runs its prefills to completion. When not
+  // set, AdvancedSettings::num_prefill_tokens_per_turn is used.
+  std::optional<int> prefill_quantum_;
 };
 
 std::ostream& operator<<(std::ostream& os, const SessionConfig& config);
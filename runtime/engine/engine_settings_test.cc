@@ -27,6 +27,7 @@
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
 #include "absl/types/optional.h"  // from @com_google_absl
 #include "runtime/components/tokenizer.h"
 #include "runtime/executor/executor_settings_base.h"
@@ -915,6 +916,36 @@ TEST(SessionConfigTest, MaybeUpdateAndValidateLlmGemma3) {
             proto::LlmModelType::kGemma3);
 }
 
+TEST(SessionConfigTest, SetAndGetPriority) {
+  SessionConfig session_config = SessionConfig::CreateDefault();
+  EXPECT_EQ(session_config.GetPriority(), SessionPriority::kNormal);
+  session_config.SetPriority(SessionPriority::kInteractive);
+  EXPECT_EQ(session_config.GetPriority(), SessionPriority::kInteractive);
+}
+
+TEST(SessionConfigTest, SetAndGetTaskDeadline) {
+  SessionConfig session_config = SessionConfig::CreateDefault();
+  EXPECT_EQ(session_config.GetTaskDeadline(), std::nullopt);
+  session_config.SetTaskDeadline(absl::Milliseconds(100));
+  EXPECT_EQ(session_config.GetTaskDeadline(), absl::Milliseconds(100));
+  session_config.SetTaskDeadline(std::nullopt);
+  EXPECT_EQ(session_config.GetTaskDeadline(), std::nullopt);
+}
+
+TEST(SessionConfigTest, SetAndGetDecodeQuantum) {
+  SessionConfig session_config = SessionConfig::CreateDefault();
+  EXPECT_EQ(session_config.GetDecodeQuantum(), std::nullopt);
+  session_config.SetDecodeQuantum(32);
+  EXPECT_EQ(session_config.GetDecodeQuantum(), 32);
+}
+
+TEST(SessionConfigTest, SetAndGetPrefillQuantum) {
+  SessionConfig session_config = SessionConfig::CreateDefault();
+  EXPECT_EQ(session_config.GetPrefillQuantum(), std::nullopt);
+  session_config.SetPrefillQuantum(256);
+  EXPECT_EQ(session_config.GetPrefillQuantum(), 256);
+}
+
 TEST(SessionConfigTest, PrintOperator) {
   SessionConfig session_config = SessionConfig::CreateDefault();
   session_config.GetMutableSamplerParams().set_type(
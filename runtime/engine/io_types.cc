@@ -392,6 +392,14 @@ double BenchmarkInfo::GetTimeToFirstToken() const {
   return first_decode_token_seconds + first_prefill_token_seconds;
 }
 
+void BenchmarkInfo::RecordKvCacheBytesCopied(uint64_t num_bytes) {
+  total_kv_cache_bytes_copied_ += num_bytes;
+}
+
+uint64_t BenchmarkInfo::GetTotalKvCacheBytesCopied() const {
+  return total_kv_cache_bytes_copied_;
+}
+
 std::ostream& operator<<(std::ostream& os, const BenchmarkTurnData& data) {
   os << "Processed " << data.num_tokens << " tokens in " << data.duration
      << " duration." << std::endl;
@@ -467,6 +475,14 @@ std::ostream& operator<<(std::ostream& os, const BenchmarkInfo& info) {
   }
   os << "--------------------------------------------------" << std::endl;
 
+  if (info.GetTotalKvCacheBytesCopied() > 0) {
+    os << "  KV Cache Copies:" << std::endl;
+    os << "    Copied "
+       << info.GetTotalKvCacheBytesCopied() / (1024.0 * 1024.0) << " MB."
+       << std::endl;
+    os << "--------------------------------------------------" << std::endl;
+  }
+
   if (!info.GetMarkDurations().empty()) {
     os << "  Mark Durations (" << info.GetMarkDurations().size()
        << "):" << std::endl;
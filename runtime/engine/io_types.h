@@ -430,6 +430,12 @@ class BenchmarkInfo {
   // the time spent for decoding the first token.
   double GetTimeToFirstToken() const;
 
+  // --- KV cache copies ---
+  // Records `num_bytes` of kv-cache copied by the executor between buffers,
+  // e.g. to broadcast it to the decode batch or to grow it.
+  void RecordKvCacheBytesCopied(uint64_t num_bytes);
+  uint64_t GetTotalKvCacheBytesCopied() const;
+
  private:
   proto::BenchmarkParams benchmark_params_;
 
@@ -444,6 +450,7 @@ class BenchmarkInfo {
   std::map<std::string, absl::Duration> mark_durations_;
   std::vector<BenchmarkTurnData> prefill_turns_;
   std::vector<BenchmarkTurnData> decode_turns_;
+  uint64_t total_kv_cache_bytes_copied_ = 0;
 };
 std::ostream& operator<<(std::ostream& os, const BenchmarkInfo& info);
 
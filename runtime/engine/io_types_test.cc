@@ -45,6 +45,8 @@ namespace {
 using ::testing::ContainsRegex;
 using ::testing::ElementsAre;
 using ::testing::ElementsAreArray;
+using ::testing::HasSubstr;
+using ::testing::Not;
 using ::testing::status::IsOkAndHolds;
 using ::testing::status::StatusIs;
 
@@ -901,6 +903,21 @@ TEST(BenchmarkInfoTests, OperatorOutputWithData) {
   EXPECT_THAT(ss.str(), ContainsRegex(expected_output));
 }
 
+TEST(BenchmarkInfoTests, RecordKvCacheBytesCopied) {
+  BenchmarkInfo benchmark_info(GetBenchmarkParams());
+  std::stringstream empty_ss;
+  empty_ss << benchmark_info;
+  EXPECT_THAT(empty_ss.str(), Not(HasSubstr("KV Cache Copies")));
+
+  benchmark_info.RecordKvCacheBytesCopied(1024 * 1024);
+  benchmark_info.RecordKvCacheBytesCopied(512 * 1024);
+  EXPECT_EQ(benchmark_info.GetTotalKvCacheBytesCopied(), 1536 * 1024);
+
+  std::stringstream ss;
+  ss << benchmark_info;
+  EXPECT_THAT(ss.str(), HasSubstr("Copied 1.50 MB."));
+}
+
 TEST(DecodeConfigTest, CreateDefault) {
   DecodeConfig decode_config = DecodeConfig::CreateDefault();
   EXPECT_EQ(decode_config.GetConstraint(), nullptr);
@@ -0,0 +1,139 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/executor/kv_cache_copy.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "absl/types/span.h"  // from @com_google_absl
+#include "runtime/framework/work_stealing_threadpool.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__)) && !defined(_MSC_VER)
+#define LITERT_LM_KV_CACHE_COPY_X86 1
+#include <immintrin.h>
+#endif
+
+namespace litert::lm {
+namespace {
+
+#if defined(LITERT_LM_KV_CACHE_COPY_X86)
+
+// Copies or zero-fills `size` bytes with 16-byte streaming stores. The ends of
+// the range not aligned to 16 bytes are written with regular stores.
+__attribute__((target("sse2"))) void NonTemporalCopy(void* dst,
+                                                     const void* src,
+                                                     size_t size) {
+  auto* dst_bytes = static_cast<uint8_t*>(dst);
+  const auto* src_bytes = static_cast<const uint8_t*>(src);
+  const size_t head =
+      std::min(size, (16 - reinterpret_cast<uintptr_t>(dst_bytes) % 16) % 16);
+  if (src_bytes != nullptr) {
+    std::memcpy(dst_bytes, src_bytes, head);
+  } else {
+    std::memset(dst_bytes, 0, head);
+  }
+  size_t offset = head;
+  const __m128i zero = _mm_setzero_si128();
+  for (; offset + 64 <= size; offset += 64) {
+    auto* out = reinterpret_cast<__m128i*>(dst_bytes + offset);
+    if (src_bytes != nullptr) {
+      const auto* in = reinterpret_cast<const __m128i*>(src_bytes + offset);
+      const __m128i v0 = _mm_loadu_si128(in);
+      const __m128i v1 = _mm_loadu_si128(in + 1);
+      const __m128i v2 = _mm_loadu_si128(in + 2);
+      const __m128i v3 = _mm_loadu_si128(in + 3);
+      _mm_stream_si128(out, v0);
+      _mm_stream_si128(out + 1, v1);
+      _mm_stream_si128(out + 2, v2);
+      _mm_stream_si128(out + 3, v3);
+    } else {
+      _mm_stream_si128(out, zero);
+      _mm_stream_si128(out + 1, zero);
+      _mm_stream_si128(out + 2, zero);
+      _mm_stream_si128(out + 3, zero);
+    }
+  }
+  if (src_bytes != nullptr) {
+    std::memcpy(dst_bytes + offset, src_bytes + offset, size - offset);
+  } else {
+    std::memset(dst_bytes + offset, 0, size - offset);
+  }
+  // Streaming stores are weakly ordered, make them visible to the threads
+  // reading the cache next.
+  _mm_sfence();
+}
+
+#endif  // LITERT_LM_KV_CACHE_COPY_X86
+
+}  // namespace
+
+void CopyKvCacheMemory(void* dst, const void* src, size_t size,
+                       bool non_temporal) {
+#if defined(LITERT_LM_KV_CACHE_COPY_X86)
+  if (non_temporal) {
+    NonTemporalCopy(dst, src, size);
+    return;
+  }
+#endif
+  if (src != nullptr) {
+    std::memcpy(dst, src, size);
+  } else {
+    std::memset(dst, 0, size);
+  }
+}
+
+size_t RunKvCacheCopies(absl::Span<const KvCacheCopy> copies,
+                        WorkStealingThreadPool* thread_pool) {
+  size_t total_size = 0;
+  for (const KvCacheCopy& copy : copies) {
+    total_size += copy.size;
+  }
+  const bool non_temporal = total_size >= kNonTemporalKvCacheCopySize;
+  if (thread_pool == nullptr || total_size < 2 * kMinParallelKvCacheCopySize) {
+    for (const KvCacheCopy& copy : copies) {
+      CopyKvCacheMemory(copy.dst, copy.src, copy.size, non_temporal);
+    }
+    return total_size;
+  }
+
+  // Split the copies in chunks so that a few large tensors, e.g. the ones of a
+  // model with few layers, still keep all the threads busy.
+  const size_t num_threads = thread_pool->max_num_threads() + 1;
+  const size_t chunk_size =
+      std::max(kMinParallelKvCacheCopySize, total_size / (4 * num_threads));
+  std::vector<KvCacheCopy> chunks;
+  chunks.reserve(total_size / chunk_size + copies.size());
+  for (const KvCacheCopy& copy : copies) {
+    for (size_t offset = 0; offset < copy.size; offset += chunk_size) {
+      chunks.push_back(
+          {.dst = static_cast<uint8_t*>(copy.dst) + offset,
+           .src = copy.src == nullptr
+                      ? nullptr
+                      : static_cast<const uint8_t*>(copy.src) + offset,
+           .size = std::min(chunk_size, copy.size - offset)});
+    }
+  }
+  thread_pool->ParallelFor(chunks.size(), [&](int i) {
+    CopyKvCacheMemory(chunks[i].dst, chunks[i].src, chunks[i].size,
+                      non_temporal);
+  });
+  return total_size;
+}
+
+}  // namespace litert::lm
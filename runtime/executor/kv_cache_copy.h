@@ -0,0 +1,55 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_EXECUTOR_KV_CACHE_COPY_H_
+#define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_EXECUTOR_KV_CACHE_COPY_H_
+
+#include <cstddef>
+
+#include "absl/types/span.h"  // from @com_google_absl
+#include "runtime/framework/work_stealing_threadpool.h"
+
+namespace litert::lm {
+
+// A copy of `size` bytes from `src` to `dst`, or a fill of `size` zero bytes
+// at `dst` if `src` is null. The source and the destination must not overlap.
+struct KvCacheCopy {
+  void* dst;
+  const void* src;
+  size_t size;
+};
+
+// The copies of fewer bytes than this are not split between threads.
+inline constexpr size_t kMinParallelKvCacheCopySize = 256 * 1024;
+
+// From this number of bytes in total, the copies are done with non-temporal
+// stores. The KV cache is then too large to stay in the caches anyway, and
+// writing it around them keeps the weights and activations there.
+inline constexpr size_t kNonTemporalKvCacheCopySize = 4 * 1024 * 1024;
+
+// Copies `size` bytes from `src` to `dst`, or fills them with zeros if `src`
+// is null, with non-temporal stores if `non_temporal` and the CPU has them.
+void CopyKvCacheMemory(void* dst, const void* src, size_t size,
+                       bool non_temporal);
+
+// Runs all the `copies`, split into chunks of at least
+// kMinParallelKvCacheCopySize bytes, on `thread_pool` and the calling thread,
+// or only on the calling thread if `thread_pool` is null. Returns the number of
+// bytes written.
+size_t RunKvCacheCopies(absl::Span<const KvCacheCopy> copies,
+                        WorkStealingThreadPool* thread_pool);
+
+}  // namespace litert::lm
+
+#endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_EXECUTOR_KV_CACHE_COPY_H_
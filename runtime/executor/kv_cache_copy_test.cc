@@ -0,0 +1,83 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/executor/kv_cache_copy.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "runtime/framework/work_stealing_threadpool.h"
+
+namespace litert::lm {
+namespace {
+
+using ::testing::Each;
+
+std::vector<uint8_t> Iota(size_t size) {
+  std::vector<uint8_t> values(size);
+  for (size_t i = 0; i < size; ++i) {
+    values[i] = static_cast<uint8_t>(i * 7 + 3);
+  }
+  return values;
+}
+
+TEST(KvCacheCopyTest, CopyKvCacheMemoryUnaligned) {
+  const std::vector<uint8_t> src = Iota(1000);
+  for (bool non_temporal : {false, true}) {
+    // Neither end of the destination is aligned.
+    std::vector<uint8_t> dst(1003, 0xFF);
+    CopyKvCacheMemory(dst.data() + 1, src.data() + 2, 997, non_temporal);
+    EXPECT_EQ(dst[0], 0xFF);
+    EXPECT_EQ(std::vector<uint8_t>(dst.begin() + 1, dst.begin() + 998),
+              std::vector<uint8_t>(src.begin() + 2, src.end() - 1));
+    EXPECT_EQ(dst[998], 0xFF);
+
+    CopyKvCacheMemory(dst.data() + 3, /*src=*/nullptr, 990, non_temporal);
+    EXPECT_THAT(std::vector<uint8_t>(dst.begin() + 3, dst.begin() + 993),
+                Each(0));
+    EXPECT_NE(dst[993], 0);
+  }
+}
+
+TEST(KvCacheCopyTest, RunKvCacheCopies) {
+  WorkStealingThreadPool thread_pool("testpool", 4);
+  // Large enough to be split between the threads and copied with
+  // non-temporal stores.
+  const size_t size = kNonTemporalKvCacheCopySize / 2 + 13;
+  const std::vector<uint8_t> src = Iota(size);
+  for (WorkStealingThreadPool* pool :
+       {static_cast<WorkStealingThreadPool*>(nullptr), &thread_pool}) {
+    std::vector<uint8_t> dst(size, 0);
+    std::vector<uint8_t> zeros(size, 0xFF);
+    const std::vector<KvCacheCopy> copies = {
+        {.dst = dst.data(), .src = src.data(), .size = size},
+        {.dst = zeros.data(), .src = nullptr, .size = size},
+    };
+    EXPECT_EQ(RunKvCacheCopies(copies, pool), 2 * size);
+    EXPECT_EQ(dst, src);
+    EXPECT_EQ(std::count(zeros.begin(), zeros.end(), 0), size);
+  }
+}
+
+TEST(KvCacheCopyTest, RunNoCopies) {
+  WorkStealingThreadPool thread_pool("testpool", 4);
+  EXPECT_EQ(RunKvCacheCopies({}, &thread_pool), 0);
+}
+
+}  // namespace
+}  // namespace litert::lm
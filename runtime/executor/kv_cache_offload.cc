@@ -0,0 +1,177 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/executor/kv_cache_offload.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17) for std::filesystem::remove
+#include <memory>
+#include <string>
+#include <system_error>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"  // from @com_google_absl
+#include "absl/memory/memory.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+#include "litert/cc/litert_element_type.h"  // from @litert
+#include "litert/cc/litert_macros.h"  // from @litert
+#include "litert/cc/litert_ranked_tensor_type.h"  // from @litert
+#include "litert/cc/litert_tensor_buffer.h"  // from @litert
+#include "litert/cc/litert_tensor_buffer_types.h"  // from @litert
+#include "runtime/executor/kv_cache_quantization.h"
+#include "runtime/executor/llm_context_snapshot.h"
+#include "runtime/executor/llm_executor_io_types.h"
+#include "runtime/util/status_macros.h"  // IWYU pragma: keep
+
+namespace litert::lm {
+namespace {
+
+// Spill files are only read back by the process which wrote them, so they
+// don't need the fingerprint of the model.
+constexpr uint64_t kSpillFileFingerprint = 0;
+
+// Returns the number of values sharing a quantization scale, i.e. the size of
+// the innermost dimension, the head dimension of the usual kv-cache layout.
+int GetRowSize(const RankedTensorType& tensor_type, size_t num_values) {
+  const auto dimensions = tensor_type.Layout().Dimensions();
+  if (!dimensions.empty() && dimensions.back() > 0 &&
+      num_values % dimensions.back() == 0) {
+    return dimensions.back();
+  }
+  return static_cast<int>(num_values);
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<OffloadedKvCache>> OffloadedKvCache::Create(
+    absl::flat_hash_map<absl::string_view, TensorBuffer>& kv_cache_buffers,
+    const KvCacheOffloadOptions& options) {
+  if (!options.quantization.has_value() && options.spill_path.empty()) {
+    return absl::InvalidArgumentError(
+        "Offloading a kv-cache needs either a quantization or a spill path.");
+  }
+  auto offloaded_kv_cache =
+      absl::WrapUnique(new OffloadedKvCache(options.spill_path));
+  std::unique_ptr<LlmContextSnapshotWriter> writer;
+  if (!options.spill_path.empty()) {
+    ASSIGN_OR_RETURN(writer, LlmContextSnapshotWriter::Create(
+                                 options.spill_path, kSpillFileFingerprint));
+  }
+
+  for (auto& [name, buffer] : kv_cache_buffers) {
+    LITERT_ASSIGN_OR_RETURN(TensorBufferType buffer_type, buffer.BufferType());
+    if (buffer_type != TensorBufferType::kHostMemory) {
+      continue;
+    }
+    LITERT_ASSIGN_OR_RETURN(RankedTensorType tensor_type, buffer.TensorType());
+    if (writer == nullptr &&
+        tensor_type.ElementType() != ElementType::Float32) {
+      continue;
+    }
+    LITERT_ASSIGN_OR_RETURN(size_t size, buffer.PackedSize());
+    LITERT_ASSIGN_OR_RETURN(
+        auto buffer_lock_and_addr,
+        TensorBufferScopedLock::Create(buffer, TensorBuffer::LockMode::kRead));
+    Tensor tensor{.name = name, .tensor_type = tensor_type, .size = size};
+    if (writer != nullptr) {
+      RETURN_IF_ERROR(writer->AddEntry(
+          name, absl::MakeConstSpan(
+                    static_cast<const uint8_t*>(buffer_lock_and_addr.second),
+                    size)));
+    } else {
+      const size_t num_values = size / sizeof(float);
+      ASSIGN_OR_RETURN(
+          tensor.quantized,
+          QuantizeKvCache(
+              absl::MakeConstSpan(
+                  static_cast<const float*>(buffer_lock_and_addr.second),
+                  num_values),
+              GetRowSize(tensor_type, num_values), *options.quantization));
+    }
+    offloaded_kv_cache->size_in_bytes_ += size;
+    offloaded_kv_cache->tensors_.push_back(std::move(tensor));
+  }
+  if (writer != nullptr) {
+    RETURN_IF_ERROR(writer->Finish());
+  }
+
+  // Only release the buffers once all of them are offloaded.
+  for (const Tensor& tensor : offloaded_kv_cache->tensors_) {
+    kv_cache_buffers.erase(tensor.name);
+  }
+  return offloaded_kv_cache;
+}
+
+OffloadedKvCache::~OffloadedKvCache() {
+  if (!spill_path_.empty()) {
+    std::error_code error;
+    std::filesystem::remove(spill_path_, error);
+  }
+}
+
+absl::Status OffloadedKvCache::Reload(
+    absl::flat_hash_map<absl::string_view, TensorBuffer>& kv_cache_buffers) {
+  std::unique_ptr<LlmContextSnapshot> spill_file;
+  if (!spill_path_.empty() && !tensors_.empty()) {
+    ASSIGN_OR_RETURN(spill_file, LlmContextSnapshot::Open(
+                                     spill_path_, kSpillFileFingerprint));
+  }
+
+  std::vector<TensorBuffer> buffers;
+  buffers.reserve(tensors_.size());
+  for (const Tensor& tensor : tensors_) {
+    LITERT_ASSIGN_OR_RETURN(
+        TensorBuffer buffer,
+        TensorBuffer::CreateManagedHostMemory(tensor.tensor_type, tensor.size));
+    {
+      LITERT_ASSIGN_OR_RETURN(auto buffer_lock_and_addr,
+                              TensorBufferScopedLock::Create(
+                                  buffer, TensorBuffer::LockMode::kWrite));
+      if (spill_file != nullptr) {
+        RETURN_IF_ERROR(spill_file->ReadEntry(
+            tensor.name,
+            absl::MakeSpan(static_cast<uint8_t*>(buffer_lock_and_addr.second),
+                           tensor.size)));
+      } else {
+        RETURN_IF_ERROR(DequantizeKvCache(
+            *tensor.quantized,
+            absl::MakeSpan(static_cast<float*>(buffer_lock_and_addr.second),
+                           tensor.size / sizeof(float))));
+      }
+    }
+    buffers.push_back(std::move(buffer));
+  }
+
+  for (size_t i = 0; i < tensors_.size(); ++i) {
+    kv_cache_buffers[tensors_[i].name] = std::move(buffers[i]);
+  }
+  return absl::OkStatus();
+}
+
+size_t OffloadedKvCache::GetMemorySizeInBytes() const {
+  size_t size = 0;
+  for (const Tensor& tensor : tensors_) {
+    if (tensor.quantized.has_value()) {
+      size += tensor.quantized->SizeInBytes();
+    }
+  }
+  return size;
+}
+
+}  // namespace litert::lm
@@ -0,0 +1,93 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_EXECUTOR_KV_CACHE_OFFLOAD_H_
+#define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_EXECUTOR_KV_CACHE_OFFLOAD_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "litert/cc/litert_ranked_tensor_type.h"  // from @litert
+#include "litert/cc/litert_tensor_buffer.h"  // from @litert
+#include "runtime/executor/kv_cache_quantization.h"
+#include "runtime/executor/llm_executor_io_types.h"
+
+namespace litert::lm {
+
+// The kv-cache buffers of a processed context moved out of their tensor
+// buffers while no executor uses the context, either quantized in RAM or
+// written as they are to a spill file.
+//
+// Only host memory buffers are offloaded, as they are the only ones which can
+// be recreated without the executor. In RAM, only the float buffers are, since
+// quantizing them is what saves memory. The other buffers stay where they are.
+class OffloadedKvCache {
+ public:
+  // Moves the buffers of `kv_cache_buffers` which can be offloaded out of the
+  // map, to the storage set by `options`. `kv_cache_buffers` is left unchanged
+  // on failure.
+  static absl::StatusOr<std::unique_ptr<OffloadedKvCache>> Create(
+      absl::flat_hash_map<absl::string_view, ::litert::TensorBuffer>&
+          kv_cache_buffers,
+      const KvCacheOffloadOptions& options);
+
+  // Removes the spill file, if any.
+  ~OffloadedKvCache();
+
+  // Moves the offloaded tensors back into new host memory buffers of
+  // `kv_cache_buffers`. `kv_cache_buffers` is left unchanged on failure.
+  absl::Status Reload(
+      absl::flat_hash_map<absl::string_view, ::litert::TensorBuffer>&
+          kv_cache_buffers);
+
+  // Returns the size in bytes of the offloaded buffers.
+  size_t GetSizeInBytes() const { return size_in_bytes_; }
+
+  // Returns the number of bytes the offloaded tensors still take in RAM.
+  size_t GetMemorySizeInBytes() const;
+
+  // Returns true if no buffer was offloaded.
+  bool empty() const { return tensors_.empty(); }
+
+ private:
+  // An offloaded tensor buffer.
+  struct Tensor {
+    absl::string_view name;
+    ::litert::RankedTensorType tensor_type;
+    size_t size;
+    // The quantized values, unless the tensor is in the spill file.
+    std::optional<QuantizedKvCache> quantized;
+  };
+
+  explicit OffloadedKvCache(std::string spill_path)
+      : spill_path_(std::move(spill_path)) {}
+
+  // Empty if the tensors are quantized in RAM.
+  const std::string spill_path_;
+  std::vector<Tensor> tensors_;
+  size_t size_in_bytes_ = 0;
+};
+
+}  // namespace litert::lm
+
+#endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_EXECUTOR_KV_CACHE_OFFLOAD_H_
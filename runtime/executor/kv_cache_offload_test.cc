@@ -0,0 +1,179 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/executor/kv_cache_offload.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT: Required for path manipulation.
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/container/flat_hash_map.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "litert/cc/litert_tensor_buffer.h"  // from @litert
+#include "runtime/executor/kv_cache_quantization.h"
+#include "runtime/executor/llm_executor_io_types.h"
+#include "runtime/executor/llm_processed_context.h"
+#include "runtime/util/convert_tensor_buffer.h"
+#include "runtime/util/test_utils.h"  // IWYU pragma: keep
+
+namespace litert::lm {
+namespace {
+
+using ::testing::ElementsAreArray;
+using ::testing::FloatNear;
+using ::testing::Pointwise;
+using ::testing::SizeIs;
+using ::testing::status::IsOkAndHolds;
+using ::testing::status::StatusIs;
+
+// Layout of [batch, tokens, heads, head_dim].
+constexpr int kNumTokens = 16;
+constexpr int kNumHeads = 2;
+constexpr int kHeadDim = 8;
+constexpr int kNumValues = kNumTokens * kNumHeads * kHeadDim;
+
+std::vector<float> KvCacheValues(float offset) {
+  std::vector<float> values(kNumValues);
+  for (int i = 0; i < kNumValues; ++i) {
+    values[i] = offset + 0.01f * (i % 97) - 0.3f;
+  }
+  return values;
+}
+
+absl::flat_hash_map<absl::string_view, TensorBuffer> CreateKvCacheBuffers(
+    const std::vector<float>& k_values, const std::vector<float>& v_values,
+    const std::vector<int8_t>& quantized_values) {
+  absl::flat_hash_map<absl::string_view, TensorBuffer> kv_cache_buffers;
+  auto k_cache = CopyToTensorBuffer<float>(
+      k_values, {1, kNumTokens, kNumHeads, kHeadDim});
+  auto v_cache = CopyToTensorBuffer<float>(
+      v_values, {1, kNumTokens, kNumHeads, kHeadDim});
+  auto int8_cache = CopyToTensorBuffer<int8_t>(
+      quantized_values, {1, kNumTokens, kNumHeads, kHeadDim});
+  EXPECT_TRUE(k_cache.HasValue());
+  EXPECT_TRUE(v_cache.HasValue());
+  EXPECT_TRUE(int8_cache.HasValue());
+  kv_cache_buffers["k_cache_0"] = std::move(*k_cache);
+  kv_cache_buffers["v_cache_0"] = std::move(*v_cache);
+  kv_cache_buffers["int8_cache_0"] = std::move(*int8_cache);
+  return kv_cache_buffers;
+}
+
+std::vector<float> ReadFloats(const TensorBuffer& buffer) {
+  auto values = CopyFromTensorBuffer<float>(buffer);
+  EXPECT_TRUE(values.HasValue());
+  return *values;
+}
+
+TEST(KvCacheOffloadTest, QuantizesFloatBuffersInMemory) {
+  const std::vector<float> k_values = KvCacheValues(0.0f);
+  const std::vector<float> v_values = KvCacheValues(1.0f);
+  const std::vector<int8_t> int8_values(kNumValues, 7);
+  auto kv_cache_buffers = CreateKvCacheBuffers(k_values, v_values, int8_values);
+
+  ASSERT_OK_AND_ASSIGN(
+      auto offloaded_kv_cache,
+      OffloadedKvCache::Create(kv_cache_buffers,
+                               {.quantization = KvCacheQuantization::kInt8}));
+  // The int8 buffer wouldn't get any smaller and stays in place.
+  EXPECT_THAT(kv_cache_buffers, SizeIs(1));
+  EXPECT_TRUE(kv_cache_buffers.contains("int8_cache_0"));
+  EXPECT_EQ(offloaded_kv_cache->GetSizeInBytes(),
+            2 * kNumValues * sizeof(float));
+  EXPECT_LT(offloaded_kv_cache->GetMemorySizeInBytes(),
+            offloaded_kv_cache->GetSizeInBytes() / 2);
+
+  EXPECT_OK(offloaded_kv_cache->Reload(kv_cache_buffers));
+  EXPECT_THAT(kv_cache_buffers, SizeIs(3));
+  EXPECT_THAT(ReadFloats(kv_cache_buffers["k_cache_0"]),
+              Pointwise(FloatNear(0.01f), k_values));
+  EXPECT_THAT(ReadFloats(kv_cache_buffers["v_cache_0"]),
+              Pointwise(FloatNear(0.01f), v_values));
+}
+
+TEST(KvCacheOffloadTest, SpillsAllBuffersToFile) {
+  const std::string spill_path =
+      (std::filesystem::path(::testing::TempDir()) / "kv_cache.spill")
+          .string();
+  const std::vector<float> k_values = KvCacheValues(0.0f);
+  const std::vector<float> v_values = KvCacheValues(1.0f);
+  const std::vector<int8_t> int8_values(kNumValues, 7);
+  auto kv_cache_buffers = CreateKvCacheBuffers(k_values, v_values, int8_values);
+
+  ASSERT_OK_AND_ASSIGN(
+      auto offloaded_kv_cache,
+      OffloadedKvCache::Create(kv_cache_buffers, {.spill_path = spill_path}));
+  EXPECT_TRUE(kv_cache_buffers.empty());
+  EXPECT_TRUE(std::filesystem::exists(spill_path));
+  EXPECT_EQ(offloaded_kv_cache->GetMemorySizeInBytes(), 0);
+
+  // The spilled buffers are reloaded as they were.
+  EXPECT_OK(offloaded_kv_cache->Reload(kv_cache_buffers));
+  EXPECT_THAT(ReadFloats(kv_cache_buffers["k_cache_0"]),
+              ElementsAreArray(k_values));
+  EXPECT_THAT(ReadFloats(kv_cache_buffers["v_cache_0"]),
+              ElementsAreArray(v_values));
+  auto reloaded_int8_values =
+      CopyFromTensorBuffer<int8_t>(kv_cache_buffers["int8_cache_0"]);
+  ASSERT_TRUE(reloaded_int8_values.HasValue());
+  EXPECT_THAT(*reloaded_int8_values, ElementsAreArray(int8_values));
+
+  offloaded_kv_cache.reset();
+  EXPECT_FALSE(std::filesystem::exists(spill_path));
+}
+
+TEST(KvCacheOffloadTest, NeedsQuantizationOrSpillPath) {
+  auto kv_cache_buffers =
+      CreateKvCacheBuffers(KvCacheValues(0.0f), KvCacheValues(1.0f),
+                           std::vector<int8_t>(kNumValues, 7));
+  EXPECT_THAT(OffloadedKvCache::Create(kv_cache_buffers, {}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(kv_cache_buffers, SizeIs(3));
+}
+
+TEST(KvCacheOffloadTest, LlmProcessedContextOffloadsAndReloads) {
+  const std::vector<float> k_values = KvCacheValues(0.0f);
+  const std::vector<float> v_values = KvCacheValues(1.0f);
+  const std::vector<int8_t> int8_values(kNumValues, 7);
+  LlmProcessedContext processed_context(
+      /*lora_id=*/std::nullopt,
+      CreateKvCacheBuffers(k_values, v_values, int8_values));
+  const size_t kv_cache_size = processed_context.GetKvCacheSizeInBytes();
+
+  // The float buffers are released, less one byte per value and one scale
+  // per head that the quantized kv-cache keeps.
+  const size_t quantized_size =
+      kNumValues + kNumValues / kHeadDim * sizeof(float);
+  EXPECT_THAT(processed_context.OffloadKvCache(
+                  {.quantization = KvCacheQuantization::kFp8E4M3}),
+              IsOkAndHolds(2 * (kNumValues * sizeof(float) - quantized_size)));
+  EXPECT_EQ(processed_context.GetKvCacheSizeInBytes(), kNumValues);
+  // Offloading twice is a no-op.
+  EXPECT_THAT(processed_context.OffloadKvCache({}), IsOkAndHolds(0));
+
+  EXPECT_THAT(processed_context.ReloadKvCache(),
+              IsOkAndHolds(2 * kNumValues * sizeof(float)));
+  EXPECT_EQ(processed_context.GetKvCacheSizeInBytes(), kv_cache_size);
+  EXPECT_THAT(processed_context.ReloadKvCache(), IsOkAndHolds(0));
+}
+
+}  // namespace
+}  // namespace litert::lm
@@ -0,0 +1,205 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/executor/kv_cache_quantization.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+#include "absl/base/casts.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+
+namespace litert::lm {
+namespace {
+
+constexpr float kInt8Max = 127.0f;
+// The largest finite fp8 E4M3 value, 1.75 * 2^8, and its encoding.
+constexpr float kFp8E4M3Max = 448.0f;
+constexpr uint32_t kFp8E4M3MaxCode = 0x7E;
+// The smallest normal fp8 E4M3 value, 2^-6.
+constexpr float kFp8E4M3MinNormal = 0.015625f;
+
+// Rounds `value`, whose magnitude must be below 2^22, to the nearest integer,
+// ties to even. Unlike std::lrint, it is vectorized.
+inline float RoundToNearestEven(float value) {
+  // 1.5 * 2^23, adding it leaves no fractional bits in the mantissa.
+  constexpr float kMagic = 12582912.0f;
+  return (value + kMagic) - kMagic;
+}
+
+float MaxAbs(absl::Span<const float> row) {
+  float max_abs = 0.0f;
+  for (float value : row) {
+    max_abs = std::max(max_abs, std::abs(value));
+  }
+  return max_abs;
+}
+
+// Encodes `value`, already scaled to [-448, 448], rounding to nearest even.
+uint8_t EncodeFp8E4M3(float value) {
+  const uint32_t bits = absl::bit_cast<uint32_t>(value);
+  const uint32_t sign = (bits >> 24) & 0x80;
+  const float abs_value = std::abs(value);
+  uint32_t code;
+  if (abs_value < kFp8E4M3MinNormal) {
+    // Subnormals are multiples of 2^-9. Rounding up to 8 gives the smallest
+    // normal value, whose encoding is 8 as well.
+    code = static_cast<uint32_t>(RoundToNearestEven(abs_value * 512.0f));
+  } else {
+    // Round the 23-bit mantissa to 3 bits, then rebias the exponent from 127
+    // to 7.
+    uint32_t abs_bits = bits & 0x7FFFFFFF;
+    abs_bits += 0x7FFFF + ((abs_bits >> 20) & 1);
+    code = (((abs_bits >> 23) - 120) << 3) | ((abs_bits >> 20) & 7);
+  }
+  return static_cast<uint8_t>(sign | std::min(code, kFp8E4M3MaxCode));
+}
+
+// Returns the values of all the fp8 E4M3 encodings.
+const std::array<float, 256>& Fp8E4M3Values() {
+  static const std::array<float, 256> values = [] {
+    std::array<float, 256> values;
+    for (int code = 0; code < 256; ++code) {
+      const int exponent = (code >> 3) & 0xF;
+      const int mantissa = code & 7;
+      float value;
+      if (exponent == 0xF && mantissa == 7) {
+        value = std::numeric_limits<float>::quiet_NaN();
+      } else if (exponent == 0) {
+        value = std::ldexp(static_cast<float>(mantissa), -9);
+      } else {
+        value = std::ldexp(1.0f + mantissa / 8.0f, exponent - 7);
+      }
+      values[code] = (code & 0x80) ? -value : value;
+    }
+    return values;
+  }();
+  return values;
+}
+
+void QuantizeRowInt8(absl::Span<const float> row, uint8_t* data,
+                     float& scale) {
+  const float max_abs = MaxAbs(row);
+  scale = max_abs / kInt8Max;
+  const float inverse_scale = max_abs > 0.0f ? kInt8Max / max_abs : 0.0f;
+  for (size_t i = 0; i < row.size(); ++i) {
+    const float quantized = std::clamp(
+        RoundToNearestEven(row[i] * inverse_scale), -kInt8Max, kInt8Max);
+    data[i] = static_cast<uint8_t>(static_cast<int8_t>(quantized));
+  }
+}
+
+void QuantizeRowFp8E4M3(absl::Span<const float> row, uint8_t* data,
+                        float& scale) {
+  const float max_abs = MaxAbs(row);
+  scale = max_abs / kFp8E4M3Max;
+  const float inverse_scale = max_abs > 0.0f ? kFp8E4M3Max / max_abs : 0.0f;
+  for (size_t i = 0; i < row.size(); ++i) {
+    data[i] = EncodeFp8E4M3(row[i] * inverse_scale);
+  }
+}
+
+}  // namespace
+
+std::ostream& operator<<(std::ostream& os, KvCacheQuantization quantization) {
+  switch (quantization) {
+    case KvCacheQuantization::kInt8:
+      return os << "INT8";
+    case KvCacheQuantization::kFp8E4M3:
+      return os << "FP8_E4M3";
+  }
+  return os << "UNKNOWN";
+}
+
+absl::StatusOr<QuantizedKvCache> QuantizeKvCache(
+    absl::Span<const float> values, int row_size,
+    KvCacheQuantization quantization) {
+  if (row_size <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Row size must be positive, got ", row_size));
+  }
+  if (values.size() % row_size != 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("The number of values, ", values.size(),
+                     ", is not a multiple of the row size, ", row_size));
+  }
+
+  QuantizedKvCache cache{
+      .quantization = quantization,
+      .row_size = row_size,
+      .data = std::vector<uint8_t>(values.size()),
+      .scales = std::vector<float>(values.size() / row_size),
+  };
+  for (size_t row = 0; row < cache.scales.size(); ++row) {
+    const absl::Span<const float> row_values =
+        values.subspan(row * row_size, row_size);
+    uint8_t* row_data = cache.data.data() + row * row_size;
+    switch (quantization) {
+      case KvCacheQuantization::kInt8:
+        QuantizeRowInt8(row_values, row_data, cache.scales[row]);
+        break;
+      case KvCacheQuantization::kFp8E4M3:
+        QuantizeRowFp8E4M3(row_values, row_data, cache.scales[row]);
+        break;
+    }
+  }
+  return cache;
+}
+
+absl::Status DequantizeKvCache(const QuantizedKvCache& cache,
+                               absl::Span<float> values) {
+  if (values.size() != cache.data.size()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Expected ", cache.data.size(), " values, got ", values.size()));
+  }
+  if (cache.row_size <= 0 ||
+      cache.scales.size() * cache.row_size != cache.data.size()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Quantized KV cache of ", cache.data.size(),
+                     " values has ", cache.scales.size(),
+                     " scales for rows of ", cache.row_size));
+  }
+
+  for (size_t row = 0; row < cache.scales.size(); ++row) {
+    const float scale = cache.scales[row];
+    const uint8_t* row_data = cache.data.data() + row * cache.row_size;
+    float* row_values = values.data() + row * cache.row_size;
+    switch (cache.quantization) {
+      case KvCacheQuantization::kInt8:
+        for (int i = 0; i < cache.row_size; ++i) {
+          row_values[i] = static_cast<int8_t>(row_data[i]) * scale;
+        }
+        break;
+      case KvCacheQuantization::kFp8E4M3: {
+        const std::array<float, 256>& fp8_values = Fp8E4M3Values();
+        for (int i = 0; i < cache.row_size; ++i) {
+          row_values[i] = fp8_values[row_data[i]] * scale;
+        }
+        break;
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace litert::lm
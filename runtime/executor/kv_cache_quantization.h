@@ -0,0 +1,69 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_EXECUTOR_KV_CACHE_QUANTIZATION_H_
+#define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_EXECUTOR_KV_CACHE_QUANTIZATION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+
+namespace litert::lm {
+
+// The 8-bit formats a float KV cache can be stored in while the model doesn't
+// read it, e.g. while its session is switched out.
+enum class KvCacheQuantization {
+  // Symmetric int8, i.e. values are round(x / scale) in [-127, 127].
+  kInt8,
+  // OCP fp8 E4M3 (no infinities, max 448) of x / scale. Keeps more relative
+  // precision than int8 on small values, e.g. the ones next to outliers.
+  kFp8E4M3,
+};
+std::ostream& operator<<(std::ostream& os, KvCacheQuantization quantization);
+
+// A quantized KV cache tensor. Every row of `row_size` contiguous values, i.e.
+// one head of one token for the usual [batch, tokens, heads, head_dim] layout,
+// has its own scale so that an outlier only costs precision to its own row.
+struct QuantizedKvCache {
+  KvCacheQuantization quantization;
+  int row_size;
+  // One byte per value, int8 or fp8 E4M3 depending on `quantization`.
+  std::vector<uint8_t> data;
+  // One scale per row.
+  std::vector<float> scales;
+
+  // The number of bytes the quantized tensor takes.
+  size_t SizeInBytes() const {
+    return data.size() + scales.size() * sizeof(float);
+  }
+};
+
+// Quantizes `values`, whose size must be a multiple of `row_size`.
+absl::StatusOr<QuantizedKvCache> QuantizeKvCache(
+    absl::Span<const float> values, int row_size,
+    KvCacheQuantization quantization);
+
+// Dequantizes `cache` into `values`, which must have as many values as the
+// quantized tensor.
+absl::Status DequantizeKvCache(const QuantizedKvCache& cache,
+                               absl::Span<float> values);
+
+}  // namespace litert::lm
+
+#endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_EXECUTOR_KV_CACHE_QUANTIZATION_H_
@@ -0,0 +1,163 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Accuracy and throughput benchmark of the KV cache quantization.
+//
+// Quantizes a synthetic [tokens, heads, head_dim] key cache, with a few outlier
+// channels like the ones of real keys, and reports for every format how fast it
+// is quantized and dequantized, how much memory it saves, and how much the
+// attention of a random query over the dequantized keys drifts, e.g.
+//
+//   kv_cache_quantization_benchmark --num_tokens=4096 --head_dim=128
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"  // from @com_google_absl
+#include "absl/flags/parse.h"  // from @com_google_absl
+#include "absl/log/absl_check.h"  // from @com_google_absl
+#include "absl/strings/str_format.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+#include "runtime/executor/kv_cache_quantization.h"
+#include "runtime/util/benchmark_utils.h"
+
+ABSL_FLAG(int, num_tokens, 4096, "Number of tokens in the KV cache.");
+ABSL_FLAG(int, num_heads, 8, "Number of KV heads.");
+ABSL_FLAG(int, head_dim, 128, "Dimension of every head.");
+ABSL_FLAG(int, num_outlier_channels, 4,
+          "Number of channels of every head whose values are 10x larger.");
+ABSL_FLAG(int, iterations, 10, "Number of timed runs of every benchmark.");
+
+namespace litert::lm {
+namespace {
+
+// Returns the softmax of the scaled dot products of `query` with the keys of
+// `head`, i.e. the attention probabilities of a single query.
+std::vector<float> Attention(absl::Span<const float> keys,
+                             absl::Span<const float> query, int num_heads,
+                             int head, int head_dim) {
+  const int num_tokens = keys.size() / (num_heads * head_dim);
+  const float scale = 1.0f / std::sqrt(static_cast<float>(head_dim));
+  std::vector<float> probabilities(num_tokens);
+  for (int token = 0; token < num_tokens; ++token) {
+    const float* key = keys.data() + (token * num_heads + head) * head_dim;
+    float dot = 0.0f;
+    for (int i = 0; i < head_dim; ++i) {
+      dot += key[i] * query[i];
+    }
+    probabilities[token] = dot * scale;
+  }
+  const float max_logit =
+      *std::max_element(probabilities.begin(), probabilities.end());
+  float sum = 0.0f;
+  for (float& probability : probabilities) {
+    probability = std::exp(probability - max_logit);
+    sum += probability;
+  }
+  for (float& probability : probabilities) {
+    probability /= sum;
+  }
+  return probabilities;
+}
+
+void Run() {
+  const int num_tokens = absl::GetFlag(FLAGS_num_tokens);
+  const int num_heads = absl::GetFlag(FLAGS_num_heads);
+  const int head_dim = absl::GetFlag(FLAGS_head_dim);
+  const int num_outlier_channels = absl::GetFlag(FLAGS_num_outlier_channels);
+  const int iterations = absl::GetFlag(FLAGS_iterations);
+
+  std::mt19937 rng(42);
+  std::normal_distribution<float> normal(0.0f, 1.0f);
+  std::vector<float> keys(static_cast<size_t>(num_tokens) * num_heads *
+                          head_dim);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    const bool outlier = i % head_dim < num_outlier_channels;
+    keys[i] = normal(rng) * (outlier ? 10.0f : 1.0f);
+  }
+  std::vector<float> query(head_dim);
+  for (float& value : query) {
+    value = normal(rng);
+  }
+  const double num_bytes = keys.size() * sizeof(float);
+
+  std::cout << absl::StrFormat(
+      "num_tokens=%d num_heads=%d head_dim=%d num_outlier_channels=%d "
+      "iterations=%d\n",
+      num_tokens, num_heads, head_dim, num_outlier_channels, iterations);
+  std::cout << absl::StrFormat("%-10s %12s %12s %8s %12s %12s\n", "format",
+                               "quantize", "dequantize", "size",
+                               "rel_rms_err", "attn_l1_err");
+
+  for (auto quantization :
+       {KvCacheQuantization::kInt8, KvCacheQuantization::kFp8E4M3}) {
+    QuantizedKvCache cache;
+    const double quantize_micros = TimeMicros(
+        [&] {
+          auto quantized = QuantizeKvCache(keys, head_dim, quantization);
+          ABSL_CHECK_OK(quantized);
+          cache = *std::move(quantized);
+        },
+        iterations);
+    std::vector<float> dequantized(keys.size());
+    const double dequantize_micros = TimeMicros(
+        [&] {
+          ABSL_CHECK_OK(DequantizeKvCache(cache, absl::MakeSpan(dequantized)));
+        },
+        iterations);
+
+    double squared_error = 0;
+    double squared_norm = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+      squared_error += (dequantized[i] - keys[i]) * (dequantized[i] - keys[i]);
+      squared_norm += keys[i] * keys[i];
+    }
+    // The L1 distance between the attention probabilities, averaged over the
+    // heads. 0 means the same attention, 2 means disjoint attention.
+    double attention_error = 0;
+    for (int head = 0; head < num_heads; ++head) {
+      const std::vector<float> expected =
+          Attention(keys, query, num_heads, head, head_dim);
+      const std::vector<float> actual =
+          Attention(dequantized, query, num_heads, head, head_dim);
+      for (int token = 0; token < num_tokens; ++token) {
+        attention_error += std::abs(actual[token] - expected[token]);
+      }
+    }
+    attention_error /= num_heads;
+
+    std::ostringstream format;
+    format << quantization;
+    std::cout << absl::StrFormat(
+        "%-10s %7.2f GB/s %7.2f GB/s %7.3fx %12.2e %12.2e\n", format.str(),
+        num_bytes / quantize_micros / 1e3, num_bytes / dequantize_micros / 1e3,
+        cache.SizeInBytes() / num_bytes,
+        std::sqrt(squared_error / squared_norm), attention_error);
+  }
+}
+
+}  // namespace
+}  // namespace litert::lm
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+  litert::lm::Run();
+  return 0;
+}
@@ -0,0 +1,146 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/executor/kv_cache_quantization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <sstream>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"  // from @com_google_absl
+#include "runtime/util/test_utils.h"  // NOLINT
+
+namespace litert::lm {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::FloatEq;
+using ::testing::Pointwise;
+using ::testing::SizeIs;
+using ::testing::status::StatusIs;
+
+TEST(KvCacheQuantizationTest, Int8RoundTrip) {
+  // Two rows, the second one with an outlier.
+  const std::vector<float> values = {0.5f, -0.25f, 0.125f, -1.0f,
+                                     100.0f, 0.5f, -0.5f,  1.0f};
+  ASSERT_OK_AND_ASSIGN(
+      QuantizedKvCache cache,
+      QuantizeKvCache(values, /*row_size=*/4, KvCacheQuantization::kInt8));
+  EXPECT_THAT(cache.data, SizeIs(8));
+  EXPECT_THAT(cache.scales,
+              ElementsAre(FloatEq(1.0f / 127), FloatEq(100.0f / 127)));
+  EXPECT_EQ(cache.SizeInBytes(), 8 + 2 * sizeof(float));
+
+  std::vector<float> dequantized(values.size());
+  EXPECT_OK(DequantizeKvCache(cache, absl::MakeSpan(dequantized)));
+  for (size_t i = 0; i < values.size(); ++i) {
+    // Off by at most half a step of the row.
+    EXPECT_NEAR(dequantized[i], values[i], cache.scales[i / 4] / 2) << i;
+  }
+  // The row maxima are exact.
+  EXPECT_FLOAT_EQ(dequantized[3], -1.0f);
+  EXPECT_FLOAT_EQ(dequantized[4], 100.0f);
+}
+
+TEST(KvCacheQuantizationTest, Fp8E4M3RoundTrip) {
+  const std::vector<float> values = {448.0f, 1.0f,  -0.5f,   0.0009f,
+                                     -3.0f,  20.0f, 250.0f, -448.0f};
+  ASSERT_OK_AND_ASSIGN(
+      QuantizedKvCache cache,
+      QuantizeKvCache(values, /*row_size=*/8, KvCacheQuantization::kFp8E4M3));
+  EXPECT_THAT(cache.scales, ElementsAre(FloatEq(1.0f)));
+  // 448 is the largest value, 1 and -0.5 are exact, 0.0009 rounds to 0.
+  EXPECT_THAT(cache.data, ElementsAre(0x7E, 0x38, 0xB0, 0x00, 0xC4, 0x5A,
+                                      0x78, 0xFE));
+
+  std::vector<float> dequantized(values.size());
+  EXPECT_OK(DequantizeKvCache(cache, absl::MakeSpan(dequantized)));
+  // 250 rounds to 256, the others are representable.
+  EXPECT_THAT(dequantized,
+              Pointwise(FloatEq(), std::vector<float>{448.0f, 1.0f, -0.5f,
+                                                      0.0f, -3.0f, 20.0f,
+                                                      256.0f, -448.0f}));
+}
+
+TEST(KvCacheQuantizationTest, Fp8E4M3KeepsSmallValuesNextToOutliers) {
+  std::vector<float> values = {1000.0f};
+  for (int i = 1; i < 64; ++i) {
+    values.push_back(0.01f * i);
+  }
+  ASSERT_OK_AND_ASSIGN(
+      QuantizedKvCache fp8_cache,
+      QuantizeKvCache(values, /*row_size=*/64, KvCacheQuantization::kFp8E4M3));
+  ASSERT_OK_AND_ASSIGN(
+      QuantizedKvCache int8_cache,
+      QuantizeKvCache(values, /*row_size=*/64, KvCacheQuantization::kInt8));
+  std::vector<float> fp8_values(values.size());
+  std::vector<float> int8_values(values.size());
+  EXPECT_OK(DequantizeKvCache(fp8_cache, absl::MakeSpan(fp8_values)));
+  EXPECT_OK(DequantizeKvCache(int8_cache, absl::MakeSpan(int8_values)));
+
+  double fp8_error = 0;
+  double int8_error = 0;
+  for (size_t i = 1; i < values.size(); ++i) {
+    fp8_error += std::abs(fp8_values[i] - values[i]);
+    int8_error += std::abs(int8_values[i] - values[i]);
+    // 3 bits of mantissa, down to the subnormals.
+    EXPECT_NEAR(fp8_values[i], values[i],
+                std::max(values[i] / 16, fp8_cache.scales[0] / 1024))
+        << i;
+  }
+  EXPECT_LT(fp8_error, int8_error);
+}
+
+TEST(KvCacheQuantizationTest, ZeroRow) {
+  const std::vector<float> values(16, 0.0f);
+  for (auto quantization :
+       {KvCacheQuantization::kInt8, KvCacheQuantization::kFp8E4M3}) {
+    ASSERT_OK_AND_ASSIGN(QuantizedKvCache cache,
+                         QuantizeKvCache(values, /*row_size=*/16,
+                                         quantization));
+    std::vector<float> dequantized(values.size(), 1.0f);
+    EXPECT_OK(DequantizeKvCache(cache, absl::MakeSpan(dequantized)));
+    EXPECT_THAT(dequantized, Pointwise(FloatEq(), values)) << quantization;
+  }
+}
+
+TEST(KvCacheQuantizationTest, InvalidShapes) {
+  const std::vector<float> values(10, 1.0f);
+  EXPECT_THAT(QuantizeKvCache(values, /*row_size=*/4,
+                              KvCacheQuantization::kInt8),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(QuantizeKvCache(values, /*row_size=*/0,
+                              KvCacheQuantization::kInt8),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  ASSERT_OK_AND_ASSIGN(
+      QuantizedKvCache cache,
+      QuantizeKvCache(values, /*row_size=*/5, KvCacheQuantization::kInt8));
+  std::vector<float> dequantized(8);
+  EXPECT_THAT(DequantizeKvCache(cache, absl::MakeSpan(dequantized)),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(KvCacheQuantizationTest, Print) {
+  std::stringstream ss;
+  ss << KvCacheQuantization::kInt8 << " " << KvCacheQuantization::kFp8E4M3;
+  EXPECT_EQ(ss.str(), "INT8 FP8_E4M3");
+}
+
+}  // namespace
+}  // namespace litert::lm
@@ -0,0 +1,344 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/executor/llm_context_snapshot.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>  // NOLINT(build/c++17) for std::filesystem::rename
+#include <fstream>
+#include <ios>
+#include <memory>
+#include <string>
+#include <system_error>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"  // from @com_google_absl
+#include "absl/memory/memory.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+#include "runtime/executor/executor_settings_base.h"
+#include "runtime/util/memory_mapped_file.h"
+#include "runtime/util/scoped_file.h"
+#include "runtime/util/status_macros.h"  // IWYU pragma: keep
+
+namespace litert::lm {
+namespace {
+
+constexpr char kMagic[8] = {'L', 'L', 'M', 'S', 'N', 'A', 'P', '\0'};
+constexpr uint32_t kVersion = 1;
+
+// The number of bytes at each end of the model file in its fingerprint.
+constexpr uint64_t kFingerprintSampleSize = 1 << 20;
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_entries;
+  uint64_t model_fingerprint;
+  uint64_t index_offset;
+  uint64_t index_size;
+};
+
+// 64-bit FNV-1a, which unlike absl::Hash is stable across processes.
+constexpr uint64_t kFnvOffsetBasis = 0xcbf29ce484222325ULL;
+constexpr uint64_t kFnvPrime = 0x100000001b3ULL;
+
+uint64_t Fnv1a(uint64_t hash, absl::string_view data) {
+  for (unsigned char c : data) {
+    hash = (hash ^ c) * kFnvPrime;
+  }
+  return hash;
+}
+
+uint64_t AlignUp(uint64_t value) {
+  return (value + kLlmContextSnapshotAlignment - 1) /
+         kLlmContextSnapshotAlignment * kLlmContextSnapshotAlignment;
+}
+
+template <typename T>
+void WriteValue(std::ofstream& file, const T& value) {
+  file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool ReadValue(absl::string_view& data, T& value) {
+  if (data.size() < sizeof(T)) {
+    return false;
+  }
+  std::memcpy(&value, data.data(), sizeof(T));
+  data.remove_prefix(sizeof(T));
+  return true;
+}
+
+}  // namespace
+
+uint64_t ComputeModelFingerprint(uint64_t size, absl::string_view head,
+                                 absl::string_view tail) {
+  uint64_t hash = Fnv1a(
+      kFnvOffsetBasis,
+      absl::string_view(reinterpret_cast<const char*>(&size), sizeof(size)));
+  hash = Fnv1a(hash, head);
+  return Fnv1a(hash, tail);
+}
+
+absl::StatusOr<uint64_t> ComputeModelFingerprint(
+    const ModelAssets& model_assets) {
+  if (model_assets.HasMemoryMappedFile()) {
+    ASSIGN_OR_RETURN(auto model_file, model_assets.GetMemoryMappedFile());
+    absl::string_view data(static_cast<const char*>(model_file->data()),
+                           model_file->length());
+    const size_t sample_size = std::min(data.size(), kFingerprintSampleSize);
+    return ComputeModelFingerprint(data.size(), data.substr(0, sample_size),
+                                   data.substr(data.size() - sample_size));
+  }
+
+  // Only the two ends of the file are mapped, at offsets aligned as mmap
+  // requires.
+  ASSIGN_OR_RETURN(auto scoped_file, model_assets.GetOrCreateScopedFile());
+  ASSIGN_OR_RETURN(const size_t size, ScopedFile::GetSize(scoped_file->file()));
+  if (size == 0) {
+    return absl::InvalidArgumentError("The model file is empty.");
+  }
+  const uint64_t sample_size = std::min<uint64_t>(size, kFingerprintSampleSize);
+  ASSIGN_OR_RETURN(auto head, MemoryMappedFile::Create(scoped_file->file(),
+                                                       /*offset=*/0,
+                                                       sample_size));
+  const uint64_t alignment = MemoryMappedFile::GetOffsetAlignment();
+  const uint64_t tail_offset = (size - sample_size) / alignment * alignment;
+  ASSIGN_OR_RETURN(auto tail,
+                   MemoryMappedFile::Create(scoped_file->file(), tail_offset,
+                                            size - tail_offset));
+  return ComputeModelFingerprint(
+      size, absl::string_view(static_cast<const char*>(head->data()),
+                              sample_size),
+      absl::string_view(static_cast<const char*>(tail->data()) +
+                            (size - sample_size - tail_offset),
+                        sample_size));
+}
+
+absl::StatusOr<std::unique_ptr<LlmContextSnapshotWriter>>
+LlmContextSnapshotWriter::Create(absl::string_view path,
+                                 uint64_t model_fingerprint) {
+  std::string temp_path = absl::StrCat(path, ".tmp");
+  std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    return absl::InternalError(
+        absl::StrCat("Failed to create the snapshot file ", temp_path));
+  }
+  // The header is written by Finish(), once the index location is known.
+  const Header header = {};
+  WriteValue(file, header);
+  auto writer = absl::WrapUnique(new LlmContextSnapshotWriter(
+      std::string(path), std::move(temp_path), std::move(file),
+      model_fingerprint));
+  RETURN_IF_ERROR(writer->Pad());
+  return writer;
+}
+
+LlmContextSnapshotWriter::LlmContextSnapshotWriter(std::string path,
+                                                   std::string temp_path,
+                                                   std::ofstream file,
+                                                   uint64_t model_fingerprint)
+    : path_(std::move(path)),
+      temp_path_(std::move(temp_path)),
+      file_(std::move(file)),
+      model_fingerprint_(model_fingerprint),
+      offset_(sizeof(Header)) {}
+
+LlmContextSnapshotWriter::~LlmContextSnapshotWriter() {
+  if (!finished_) {
+    file_.close();
+    std::error_code error;
+    std::filesystem::remove(temp_path_, error);
+  }
+}
+
+absl::Status LlmContextSnapshotWriter::Pad() {
+  const uint64_t padding = AlignUp(offset_) - offset_;
+  static constexpr char kZeros[kLlmContextSnapshotAlignment] = {};
+  file_.write(kZeros, padding);
+  offset_ += padding;
+  if (!file_.good()) {
+    return absl::InternalError(
+        absl::StrCat("Failed to write the snapshot file ", temp_path_));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status LlmContextSnapshotWriter::AddEntry(
+    absl::string_view name, absl::Span<const uint8_t> data) {
+  if (finished_) {
+    return absl::FailedPreconditionError("The snapshot is already finished.");
+  }
+  for (const Entry& entry : entries_) {
+    if (entry.name == name) {
+      return absl::AlreadyExistsError(
+          absl::StrCat("Snapshot entry ", name, " already exists."));
+    }
+  }
+  entries_.push_back(
+      {.name = std::string(name), .offset = offset_, .size = data.size()});
+  file_.write(reinterpret_cast<const char*>(data.data()), data.size());
+  offset_ += data.size();
+  return Pad();
+}
+
+absl::Status LlmContextSnapshotWriter::Finish() {
+  if (finished_) {
+    return absl::FailedPreconditionError("The snapshot is already finished.");
+  }
+  const uint64_t index_offset = offset_;
+  for (const Entry& entry : entries_) {
+    WriteValue(file_, static_cast<uint32_t>(entry.name.size()));
+    file_.write(entry.name.data(), entry.name.size());
+    WriteValue(file_, entry.offset);
+    WriteValue(file_, entry.size);
+    offset_ += sizeof(uint32_t) + entry.name.size() + 2 * sizeof(uint64_t);
+  }
+
+  Header header = {
+      .version = kVersion,
+      .num_entries = static_cast<uint32_t>(entries_.size()),
+      .model_fingerprint = model_fingerprint_,
+      .index_offset = index_offset,
+      .index_size = offset_ - index_offset,
+  };
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  file_.seekp(0);
+  WriteValue(file_, header);
+  file_.close();
+  if (file_.fail()) {
+    return absl::InternalError(
+        absl::StrCat("Failed to write the snapshot file ", temp_path_));
+  }
+
+  std::error_code error;
+  std::filesystem::rename(temp_path_, path_, error);
+  if (error) {
+    return absl::InternalError(absl::StrCat("Failed to move the snapshot to ",
+                                            path_, ": ", error.message()));
+  }
+  finished_ = true;
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::unique_ptr<LlmContextSnapshot>> LlmContextSnapshot::Open(
+    absl::string_view path, uint64_t model_fingerprint) {
+  std::ifstream file(std::string(path), std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    return absl::NotFoundError(
+        absl::StrCat("Failed to open the snapshot file ", path));
+  }
+  const uint64_t file_size = file.tellg();
+  file.seekg(0);
+
+  Header header;
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+      std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    return absl::DataLossError(absl::StrCat(path, " is not a snapshot."));
+  }
+  if (header.version != kVersion) {
+    return absl::DataLossError(absl::StrCat("Unsupported snapshot version ",
+                                            header.version, " in ", path));
+  }
+  if (header.model_fingerprint != model_fingerprint) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("The snapshot ", path, " was saved with another model."));
+  }
+  if (header.index_offset > file_size ||
+      header.index_size > file_size - header.index_offset) {
+    return absl::DataLossError(absl::StrCat("Truncated snapshot ", path));
+  }
+
+  std::string index(header.index_size, '\0');
+  file.seekg(header.index_offset);
+  if (!file.read(index.data(), index.size())) {
+    return absl::DataLossError(absl::StrCat("Truncated snapshot ", path));
+  }
+  absl::string_view remaining = index;
+  absl::flat_hash_map<std::string, Entry> entries;
+  for (uint32_t i = 0; i < header.num_entries; ++i) {
+    uint32_t name_size;
+    Entry entry;
+    if (!ReadValue(remaining, name_size) || remaining.size() < name_size) {
+      return absl::DataLossError(absl::StrCat("Corrupted snapshot ", path));
+    }
+    std::string name(remaining.substr(0, name_size));
+    remaining.remove_prefix(name_size);
+    if (!ReadValue(remaining, entry.offset) ||
+        !ReadValue(remaining, entry.size) ||
+        entry.offset % kLlmContextSnapshotAlignment != 0 ||
+        entry.offset > header.index_offset ||
+        entry.size > header.index_offset - entry.offset) {
+      return absl::DataLossError(absl::StrCat("Corrupted snapshot ", path));
+    }
+    entries[std::move(name)] = entry;
+  }
+  return absl::WrapUnique(new LlmContextSnapshot(
+      std::string(path), std::move(file), std::move(entries)));
+}
+
+absl::StatusOr<LlmContextSnapshot::Entry> LlmContextSnapshot::GetEntry(
+    absl::string_view name) const {
+  auto it = entries_.find(name);
+  if (it == entries_.end()) {
+    return absl::NotFoundError(
+        absl::StrCat("Snapshot entry ", name, " not found."));
+  }
+  return it->second;
+}
+
+absl::StatusOr<size_t> LlmContextSnapshot::GetEntrySize(
+    absl::string_view name) const {
+  ASSIGN_OR_RETURN(const Entry entry, GetEntry(name));
+  return entry.size;
+}
+
+absl::Status LlmContextSnapshot::ReadEntry(absl::string_view name,
+                                           absl::Span<uint8_t> data) {
+  ASSIGN_OR_RETURN(const Entry entry, GetEntry(name));
+  if (data.size() != entry.size) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Snapshot entry ", name, " has ", entry.size,
+                     " bytes, but ", data.size(), " bytes are read."));
+  }
+  file_.clear();
+  file_.seekg(entry.offset);
+  if (!file_.read(reinterpret_cast<char*>(data.data()), data.size())) {
+    return absl::DataLossError(
+        absl::StrCat("Failed to read snapshot entry ", name, " from ", path_));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<absl::Span<uint8_t>> LlmContextSnapshot::MapEntry(
+    absl::string_view name) {
+  ASSIGN_OR_RETURN(const Entry entry, GetEntry(name));
+  if (mapped_file_ == nullptr) {
+    // A private mapping, so that the entries can back buffers which are
+    // written to without changing the snapshot.
+    ASSIGN_OR_RETURN(mapped_file_, MemoryMappedFile::Create(path_));
+  }
+  return absl::Span<uint8_t>(
+      static_cast<uint8_t*>(mapped_file_->data()) + entry.offset, entry.size);
+}
+
+}  // namespace litert::lm
@@ -0,0 +1,204 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_EXECUTOR_LLM_CONTEXT_SNAPSHOT_H_
+#define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_EXECUTOR_LLM_CONTEXT_SNAPSHOT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+#include "runtime/executor/executor_settings_base.h"
+#include "runtime/util/memory_mapped_file.h"
+
+namespace litert::lm {
+
+// A snapshot file holds the state of a session, e.g. its kv-cache and its
+// processed tokens, so that the session can be restored later, possibly by
+// another process, without prefilling its tokens again.
+//
+// The file is a list of named entries of raw bytes:
+//   - a header with a magic number, the format version, the fingerprint of the
+//     model the snapshot belongs to, and the location of the index;
+//   - the data of the entries, every one of them starting at a multiple of
+//     kLlmContextSnapshotAlignment so that it can be used in place once the
+//     file is memory mapped;
+//   - the index of the entries, i.e. their names, offsets and sizes.
+// The values are stored in the byte order of the machine, so a snapshot is
+// only meant to be restored on the kind of machine that saved it.
+
+// The alignment of the data of every entry in the file. A multiple of the page
+// size of the common platforms, and of the alignment of the host memory
+// tensor buffers.
+inline constexpr size_t kLlmContextSnapshotAlignment = 4096;
+
+// Returns the fingerprint of the model in `model_assets`, which a snapshot
+// must match to be restored. It depends on the size of the model file and on
+// its first and last bytes, where the flatbuffers keep their metadata, so that
+// it is cheap to compute even for models of several gigabytes.
+absl::StatusOr<uint64_t> ComputeModelFingerprint(
+    const ModelAssets& model_assets);
+
+// Same as above on the `head` and `tail` bytes of a model file of `size`
+// bytes.
+uint64_t ComputeModelFingerprint(uint64_t size, absl::string_view head,
+                                 absl::string_view tail);
+
+// Writes a snapshot file. The entries are streamed to a temporary file, which
+// replaces the file at `path` only when Finish() succeeds, so that a failed or
+// interrupted save never leaves a truncated snapshot behind.
+//
+// Sample usage:
+//
+//   ASSIGN_OR_RETURN(auto writer,
+//                    LlmContextSnapshotWriter::Create(path, fingerprint));
+//   RETURN_IF_ERROR(writer->AddValues<int>("token_ids", token_ids));
+//   RETURN_IF_ERROR(writer->Finish());
+//
+class LlmContextSnapshotWriter {
+ public:
+  static absl::StatusOr<std::unique_ptr<LlmContextSnapshotWriter>> Create(
+      absl::string_view path, uint64_t model_fingerprint);
+
+  // Removes the temporary file if Finish() was not called or failed.
+  ~LlmContextSnapshotWriter();
+
+  // Appends an entry named `name`, which must be unique in the snapshot.
+  absl::Status AddEntry(absl::string_view name,
+                        absl::Span<const uint8_t> data);
+
+  // Appends an entry with the bytes of `values`.
+  template <typename T>
+  absl::Status AddValues(absl::string_view name, absl::Span<const T> values) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return AddEntry(name, absl::Span<const uint8_t>(
+                              reinterpret_cast<const uint8_t*>(values.data()),
+                              values.size() * sizeof(T)));
+  }
+
+  // Writes the index and moves the snapshot to its path. No entry may be added
+  // afterwards.
+  absl::Status Finish();
+
+ private:
+  struct Entry {
+    std::string name;
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  LlmContextSnapshotWriter(std::string path, std::string temp_path,
+                           std::ofstream file, uint64_t model_fingerprint);
+
+  // Writes zeros up to the next multiple of kLlmContextSnapshotAlignment.
+  absl::Status Pad();
+
+  const std::string path_;
+  const std::string temp_path_;
+  std::ofstream file_;
+  const uint64_t model_fingerprint_;
+  // The size of the file written so far.
+  uint64_t offset_;
+  std::vector<Entry> entries_;
+  bool finished_ = false;
+};
+
+// Reads a snapshot file written by LlmContextSnapshotWriter.
+//
+// The entries are either read into memory owned by the caller, or used in
+// place from a copy-on-write memory mapping of the file which lives as long as
+// this object. Writes to the mapped entries are never carried over to the
+// file.
+class LlmContextSnapshot {
+ public:
+  // Opens the snapshot at `path` and reads its index. Returns a
+  // FailedPreconditionError if the snapshot was saved with another model than
+  // the one of `model_fingerprint`, and a DataLossError if the file is not a
+  // valid snapshot.
+  static absl::StatusOr<std::unique_ptr<LlmContextSnapshot>> Open(
+      absl::string_view path, uint64_t model_fingerprint);
+
+  bool HasEntry(absl::string_view name) const {
+    return entries_.contains(name);
+  }
+
+  // Returns the size in bytes of the entry `name`.
+  absl::StatusOr<size_t> GetEntrySize(absl::string_view name) const;
+
+  // Reads the entry `name` into `data`, whose size must be the entry size.
+  absl::Status ReadEntry(absl::string_view name, absl::Span<uint8_t> data);
+
+  // Reads the entry `name` as values of type `T`.
+  template <typename T>
+  absl::StatusOr<std::vector<T>> ReadValues(absl::string_view name) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    auto size = GetEntrySize(name);
+    if (!size.ok()) {
+      return size.status();
+    }
+    if (*size % sizeof(T) != 0) {
+      return absl::DataLossError(
+          absl::StrCat("The size of snapshot entry ", name, ", ", *size,
+                       ", is not a multiple of ", sizeof(T), "."));
+    }
+    std::vector<T> values(*size / sizeof(T));
+    absl::Status status =
+        ReadEntry(name, absl::Span<uint8_t>(
+                            reinterpret_cast<uint8_t*>(values.data()), *size));
+    if (!status.ok()) {
+      return status;
+    }
+    return values;
+  }
+
+  // Returns the bytes of the entry `name` in the memory mapping of the file,
+  // aligned to kLlmContextSnapshotAlignment, mapping the file on the first
+  // call. The span is writable, see the class comment.
+  absl::StatusOr<absl::Span<uint8_t>> MapEntry(absl::string_view name);
+
+ private:
+  struct Entry {
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  LlmContextSnapshot(std::string path, std::ifstream file,
+                     absl::flat_hash_map<std::string, Entry> entries)
+      : path_(std::move(path)),
+        file_(std::move(file)),
+        entries_(std::move(entries)) {}
+
+  absl::StatusOr<Entry> GetEntry(absl::string_view name) const;
+
+  const std::string path_;
+  std::ifstream file_;
+  const absl::flat_hash_map<std::string, Entry> entries_;
+  // Null until MapEntry() is called.
+  std::unique_ptr<MemoryMappedFile> mapped_file_;
+};
+
+}  // namespace litert::lm
+
+#endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_EXECUTOR_LLM_CONTEXT_SNAPSHOT_H_
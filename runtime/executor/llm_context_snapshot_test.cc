@@ -0,0 +1,168 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/executor/llm_context_snapshot.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT: Required for path manipulation.
+#include <fstream>
+#include <ios>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+#include "runtime/executor/executor_settings_base.h"
+#include "runtime/util/memory_mapped_file.h"
+#include "runtime/util/test_utils.h"  // NOLINT
+
+namespace litert::lm {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::status::IsOkAndHolds;
+using ::testing::status::StatusIs;
+
+constexpr uint64_t kFingerprint = 0x1234;
+
+std::string GetSnapshotPath(absl::string_view name) {
+  return (std::filesystem::path(::testing::TempDir()) / std::string(name))
+      .string();
+}
+
+void WriteSnapshot(const std::string& path) {
+  ASSERT_OK_AND_ASSIGN(auto writer,
+                       LlmContextSnapshotWriter::Create(path, kFingerprint));
+  const std::vector<int> token_ids = {2, 105, 7};
+  const std::vector<uint8_t> kv_cache(5000, 0xAB);
+  EXPECT_OK(writer->AddValues<int>("token_ids", token_ids));
+  EXPECT_OK(writer->AddEntry("kv_cache", kv_cache));
+  EXPECT_OK(writer->AddEntry("empty", {}));
+  EXPECT_THAT(writer->AddEntry("empty", {}),
+              StatusIs(absl::StatusCode::kAlreadyExists));
+  EXPECT_OK(writer->Finish());
+}
+
+TEST(LlmContextSnapshotTest, RoundTrip) {
+  const std::string path = GetSnapshotPath("round_trip.snapshot");
+  WriteSnapshot(path);
+
+  ASSERT_OK_AND_ASSIGN(auto snapshot,
+                       LlmContextSnapshot::Open(path, kFingerprint));
+  EXPECT_TRUE(snapshot->HasEntry("kv_cache"));
+  EXPECT_FALSE(snapshot->HasEntry("kv_cache_dims"));
+  EXPECT_THAT(snapshot->ReadValues<int>("token_ids"),
+              IsOkAndHolds(ElementsAre(2, 105, 7)));
+  EXPECT_THAT(snapshot->ReadValues<int>("empty"),
+              IsOkAndHolds(ElementsAre()));
+
+  std::vector<uint8_t> kv_cache(5000);
+  EXPECT_OK(snapshot->ReadEntry("kv_cache", absl::MakeSpan(kv_cache)));
+  EXPECT_EQ(kv_cache, std::vector<uint8_t>(5000, 0xAB));
+  EXPECT_THAT(
+      snapshot->ReadEntry("kv_cache", absl::MakeSpan(kv_cache).first(4)),
+      StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(snapshot->ReadValues<int>("missing"),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(LlmContextSnapshotTest, MapEntry) {
+  const std::string path = GetSnapshotPath("map_entry.snapshot");
+  WriteSnapshot(path);
+
+  ASSERT_OK_AND_ASSIGN(auto snapshot,
+                       LlmContextSnapshot::Open(path, kFingerprint));
+  ASSERT_OK_AND_ASSIGN(auto kv_cache, snapshot->MapEntry("kv_cache"));
+  ASSERT_EQ(kv_cache.size(), 5000);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(kv_cache.data()) %
+                kLlmContextSnapshotAlignment,
+            0);
+  EXPECT_EQ(kv_cache[4999], 0xAB);
+
+  // The mapping is private, writing to it leaves the file unchanged.
+  kv_cache[0] = 0;
+  ASSERT_OK_AND_ASSIGN(auto other_snapshot,
+                       LlmContextSnapshot::Open(path, kFingerprint));
+  std::vector<uint8_t> contents(5000);
+  EXPECT_OK(other_snapshot->ReadEntry("kv_cache", absl::MakeSpan(contents)));
+  EXPECT_EQ(contents[0], 0xAB);
+}
+
+TEST(LlmContextSnapshotTest, FingerprintMismatch) {
+  const std::string path = GetSnapshotPath("mismatch.snapshot");
+  WriteSnapshot(path);
+  EXPECT_THAT(LlmContextSnapshot::Open(path, kFingerprint + 1),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+TEST(LlmContextSnapshotTest, CorruptedSnapshot) {
+  const std::string path = GetSnapshotPath("corrupted.snapshot");
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << "not a snapshot";
+  }
+  EXPECT_THAT(LlmContextSnapshot::Open(path, kFingerprint),
+              StatusIs(absl::StatusCode::kDataLoss));
+
+  WriteSnapshot(path);
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+  EXPECT_THAT(LlmContextSnapshot::Open(path, kFingerprint),
+              StatusIs(absl::StatusCode::kDataLoss));
+}
+
+TEST(LlmContextSnapshotTest, UnfinishedSnapshotIsRemoved) {
+  const std::string path = GetSnapshotPath("unfinished.snapshot");
+  {
+    ASSERT_OK_AND_ASSIGN(auto writer,
+                         LlmContextSnapshotWriter::Create(path, kFingerprint));
+    EXPECT_OK(writer->AddValues<int>("token_ids", std::vector<int>{1, 2}));
+    // The snapshot only appears once it is finished.
+    EXPECT_FALSE(std::filesystem::exists(path));
+  }
+  EXPECT_FALSE(std::filesystem::exists(path));
+  EXPECT_FALSE(std::filesystem::exists(path + ".tmp"));
+  EXPECT_THAT(LlmContextSnapshot::Open(path, kFingerprint),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(LlmContextSnapshotTest, ComputeModelFingerprint) {
+  const uint64_t fingerprint = ComputeModelFingerprint(10, "head", "tail");
+  EXPECT_EQ(ComputeModelFingerprint(10, "head", "tail"), fingerprint);
+  EXPECT_NE(ComputeModelFingerprint(11, "head", "tail"), fingerprint);
+  EXPECT_NE(ComputeModelFingerprint(10, "head", "tall"), fingerprint);
+}
+
+TEST(LlmContextSnapshotTest, ComputeModelFingerprintOfModelAssets) {
+  const std::string path = GetSnapshotPath("model.tflite");
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << std::string(3 << 20, 'x') << "end";
+  }
+  ASSERT_OK_AND_ASSIGN(auto model_assets, ModelAssets::Create(path));
+  ASSERT_OK_AND_ASSIGN(auto mapped_file, MemoryMappedFile::Create(path));
+  ASSERT_OK_AND_ASSIGN(auto mapped_model_assets,
+                       ModelAssets::Create(std::move(mapped_file)));
+  ASSERT_OK_AND_ASSIGN(const uint64_t fingerprint,
+                       ComputeModelFingerprint(model_assets));
+  EXPECT_THAT(ComputeModelFingerprint(mapped_model_assets),
+              IsOkAndHolds(fingerprint));
+}
+
+}  // namespace
+}  // namespace litert::lm
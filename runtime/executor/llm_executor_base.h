@@ -15,11 +15,15 @@
 #ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_EXECUTOR_LLM_EXECUTOR_BASE_H_
 #define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_EXECUTOR_LLM_EXECUTOR_BASE_H_
 
+#include <cstdint>
+#include <memory>
+
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
+#include "runtime/executor/llm_context_snapshot.h"
 #include "runtime/executor/llm_executor_io_types.h"
 #include "runtime/executor/llm_executor_settings.h"
 
@@ -114,6 +118,43 @@ class LlmExecutorBase {
                      ExecutorBackendName()));
   };
 
+  // Returns the number of bytes of kv-cache copied between buffers so far,
+  // e.g. to broadcast it to the decode batch or to grow it. The difference
+  // between two calls is the copy traffic of the calls in between.
+  virtual uint64_t GetNumKvCacheBytesCopied() const { return 0; }
+
+  // Returns true if SwapContext() is supported.
+  virtual bool CanSwapContext() const { return false; }
+
+  // Binds `llm_context` to the executor and returns the context bound so far.
+  // Unlike saving the bound context with a clone before restoring another one,
+  // neither the kv-cache nor the processed tokens are copied: only the buffer
+  // handles are exchanged.
+  virtual absl::StatusOr<std::unique_ptr<LlmContext>> SwapContext(
+      std::unique_ptr<LlmContext> llm_context) {
+    return absl::UnimplementedError(absl::StrCat(
+        "SwapContext not implemented for backend: ", ExecutorBackendName()));
+  };
+
+  // Writes the kv-cache and the processed tokens of the bound context to
+  // `writer`, so that LoadContextSnapshot() can restore them later, possibly
+  // in another process.
+  virtual absl::Status SaveContextSnapshot(LlmContextSnapshotWriter& writer) {
+    return absl::UnimplementedError(
+        absl::StrCat("SaveContextSnapshot not implemented for backend: ",
+                     ExecutorBackendName()));
+  };
+
+  // Replaces the kv-cache and the processed tokens of the bound context with
+  // the ones saved in `snapshot`. The executor may keep `snapshot` to use its
+  // entries in place instead of copying them.
+  virtual absl::Status LoadContextSnapshot(
+      std::shared_ptr<LlmContextSnapshot> snapshot) {
+    return absl::UnimplementedError(
+        absl::StrCat("LoadContextSnapshot not implemented for backend: ",
+                     ExecutorBackendName()));
+  };
+
   // ------------Vision APIs------------:
   // This function will populate the GPU tensors with the vision embeddings and
   // vision per layer embeddings. This should only be used before the
@@ -16,22 +16,36 @@
 #define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_EXECUTOR_LLM_EXECUTOR_IO_TYPES_H_
 
 #include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <optional>
 #include <ostream>
 #include <random>
+#include <string>
 #include <utility>
 
 #include "absl/base/nullability.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
 #include "runtime/components/constrained_decoding/constrained_decoder.h"
+#include "runtime/executor/kv_cache_quantization.h"
 #include "runtime/executor/llm_executor_processed_tokens.h"
 #include "runtime/executor/llm_executor_settings.h"
 
 namespace litert::lm {
 
+// Where ProcessedContext::OffloadKvCache() moves a kv-cache to. Either
+// `quantization` or `spill_path` must be set.
+struct KvCacheOffloadOptions {
+  // If set, the format the float kv-cache tensors kept in RAM are quantized
+  // to. The quantization is lossy, so it is only used when asked for.
+  std::optional<KvCacheQuantization> quantization;
+  // If not empty, the path of the file the kv-cache is written to as it is,
+  // instead of being quantized in RAM.
+  std::string spill_path;
+};
+
 // KVCache direct related context container.
 class ProcessedContext {
  public:
@@ -46,6 +60,24 @@ class ProcessedContext {
   // Gets the processed tokens.
   virtual ProcessedTokens& processed_tokens() = 0;
 
+  // Gets the size in bytes of the kv-cache held by the context, 0 if the
+  // backend doesn't report it.
+  virtual size_t GetKvCacheSizeInBytes() const { return 0; }
+
+  // Moves the kv-cache of the context out of its buffers as set by `options`,
+  // e.g. while no executor uses the context, and returns the number of bytes
+  // of memory released, i.e. the size of the buffers released less the size of
+  // the quantized kv-cache kept in RAM. Returns 0 if the backend can't offload
+  // its kv-cache.
+  virtual absl::StatusOr<size_t> OffloadKvCache(
+      const KvCacheOffloadOptions& options) {
+    return 0;
+  }
+
+  // Moves the offloaded kv-cache back into buffers and returns their size in
+  // bytes, 0 if the kv-cache is not offloaded.
+  virtual absl::StatusOr<size_t> ReloadKvCache() { return 0; }
+
  protected:
   ProcessedContext() = default;
   ProcessedContext(const ProcessedContext&) = default;
@@ -83,6 +83,24 @@ std::ostream& operator<<(std::ostream& os, const AdvancedSettings& settings) {
   } else {
     os << "allow_src_quantized_fc_conv_ops: Not set\n";
   }
+  os << "prefix_cache_max_num_entries: "
+     << settings.prefix_cache_max_num_entries << "\n";
+  os << "decode_quantum_tokens: " << settings.decode_quantum_tokens << "\n";
+  os << "num_prefill_tokens_per_turn: "
+     << settings.num_prefill_tokens_per_turn << "\n";
+  os << "pin_threads_to_performance_cores: "
+     << settings.pin_threads_to_performance_cores << "\n";
+  os << "num_executors: " << settings.num_executors << "\n";
+  os << "max_idle_kv_cache_size_bytes: "
+     << settings.max_idle_kv_cache_size_bytes << "\n";
+  if (settings.idle_kv_cache_quantization.has_value()) {
+    os << "idle_kv_cache_quantization: "
+       << settings.idle_kv_cache_quantization.value() << "\n";
+  } else {
+    os << "idle_kv_cache_quantization: Not set\n";
+  }
+  os << "idle_kv_cache_spill_directory: "
+     << settings.idle_kv_cache_spill_directory << "\n";
   return os;
 }
 
@@ -32,6 +32,7 @@
 #include "absl/log/absl_log.h"  // from @com_google_absl
 #include "absl/log/log.h"  // from @com_google_absl
 #include "runtime/executor/executor_settings_base.h"
+#include "runtime/executor/kv_cache_quantization.h"
 
 namespace litert::lm {
 
@@ -196,6 +197,64 @@ struct AdvancedSettings {
   // performance at the risk of reducing quality.
   std::optional<bool> allow_src_quantized_fc_conv_ops;
 
+  // The maximum number of prefilled prefixes kept in the prefix cache of each
+  // executor. New sessions whose input starts with a prefix cached on their
+  // executor only prefill the remaining tokens. With several executors, see
+  // num_executors, the executors don't share their caches. 0 disables the
+  // caches.
+  uint32_t prefix_cache_max_num_entries = 0;
+
+  // The number of tokens, over all the output candidates, a session decodes
+  // per turn before yielding the executor to the other sessions with pending
+  // tasks, unless the session sets its own SessionConfig::GetDecodeQuantum().
+  // Concurrent sessions then decode in a deficit round robin fashion instead of
+  // one after the other. 0 runs every decode to completion.
+  uint32_t decode_quantum_tokens = 0;
+
+  // The maximum number of tokens of a text prefill processed before yielding
+  // the executor to the other sessions with pending tasks, so that e.g. the
+  // decode of an interactive session isn't stalled by the long prefill of a
+  // background one, unless the session sets its own
+  // SessionConfig::GetPrefillQuantum(). It is rounded up to a multiple of
+  // CpuConfig::prefill_chunk_size when the executor prefills in chunks. 0 runs
+  // every prefill to completion.
+  uint32_t num_prefill_tokens_per_turn = 0;
+
+  // If true, the threads running the model are pinned to the performance
+  // cores, and the threads running the callbacks to the efficiency cores, of a
+  // CPU with cores of different performance, e.g. big.LITTLE. Ignored when the
+  // cores are all alike or the topology of the CPU can't be read.
+  bool pin_threads_to_performance_cores = false;
+
+  // The number of executors the advanced engine creates to run sessions in
+  // parallel, e.g. on a CPU with more cores than one executor keeps busy. The
+  // executors share the model weights and the weight cache, but each has its
+  // own kv-cache. On CPU, they split CpuConfig::number_of_threads between
+  // them, with at least one thread each. A session stays on the executor it is
+  // routed to when created.
+  uint32_t num_executors = 1;
+
+  // The maximum number of bytes of kv-cache the idle sessions of an executor,
+  // i.e. the ones not loaded in it, keep in memory, in their buffers or
+  // quantized. Beyond it, the kv-caches of the sessions idle for the longest
+  // time are offloaded, and loaded back when the sessions run again. Only
+  // kv-caches in host memory, e.g. the ones of the CPU backend, are offloaded.
+  // 0 never offloads them. Otherwise, idle_kv_cache_quantization or
+  // idle_kv_cache_spill_directory must be set.
+  uint64_t max_idle_kv_cache_size_bytes = 0;
+
+  // If set, the format the offloaded float kv-caches are quantized to when
+  // they are kept in RAM. The quantization is lossy: a session whose kv-cache
+  // was offloaded may continue slightly differently than if it had stayed idle
+  // in its buffers, so it is opt-in. Ignored when
+  // idle_kv_cache_spill_directory is set.
+  std::optional<KvCacheQuantization> idle_kv_cache_quantization;
+
+  // If not empty, the directory the offloaded kv-caches are written to, one
+  // spill file per session, instead of being quantized in RAM. The spill files
+  // keep the kv-caches as they are and are removed once loaded back.
+  std::string idle_kv_cache_spill_directory;
+
   bool operator==(const AdvancedSettings& other) const {
     return prefill_batch_sizes == other.prefill_batch_sizes &&
            num_output_candidates == other.num_output_candidates &&
@@ -216,7 +275,19 @@ struct AdvancedSettings {
            share_constant_tensors == other.share_constant_tensors &&
            sampler_handles_input == other.sampler_handles_input &&
            allow_src_quantized_fc_conv_ops ==
-               other.allow_src_quantized_fc_conv_ops;
+               other.allow_src_quantized_fc_conv_ops &&
+           prefix_cache_max_num_entries ==
+               other.prefix_cache_max_num_entries &&
+           decode_quantum_tokens == other.decode_quantum_tokens &&
+           num_prefill_tokens_per_turn == other.num_prefill_tokens_per_turn &&
+           pin_threads_to_performance_cores ==
+               other.pin_threads_to_performance_cores &&
+           num_executors == other.num_executors &&
+           max_idle_kv_cache_size_bytes ==
+               other.max_idle_kv_cache_size_bytes &&
+           idle_kv_cache_quantization == other.idle_kv_cache_quantization &&
+           idle_kv_cache_spill_directory ==
+               other.idle_kv_cache_spill_directory;
   }
 };
 std::ostream& operator<<(std::ostream& os, const AdvancedSettings& settings);
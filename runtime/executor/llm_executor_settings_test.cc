@@ -26,6 +26,7 @@
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
 #include "runtime/executor/executor_settings_base.h"
+#include "runtime/executor/kv_cache_quantization.h"
 #include "runtime/util/scoped_file.h"
 #include "runtime/util/test_utils.h"  // IWYU pragma: keep
 
@@ -271,6 +272,14 @@ TEST(LlmExecutorConfigTest, LlmExecutorSettingsWithAdvancedSettings) {
       .share_constant_tensors = false,
       .sampler_handles_input = false,
       .allow_src_quantized_fc_conv_ops = true,
+      .prefix_cache_max_num_entries = 8,
+      .decode_quantum_tokens = 16,
+      .num_prefill_tokens_per_turn = 256,
+      .pin_threads_to_performance_cores = true,
+      .num_executors = 4,
+      .max_idle_kv_cache_size_bytes = 1 << 30,
+      .idle_kv_cache_quantization = KvCacheQuantization::kFp8E4M3,
+      .idle_kv_cache_spill_directory = "/tmp/spill",
   });
 
   std::stringstream oss;
@@ -315,6 +324,14 @@ optimize_shader_compilation: 0
 share_constant_tensors: 0
 sampler_handles_input: 0
 allow_src_quantized_fc_conv_ops: 1
+prefix_cache_max_num_entries: 8
+decode_quantum_tokens: 16
+num_prefill_tokens_per_turn: 256
+pin_threads_to_performance_cores: 1
+num_executors: 4
+max_idle_kv_cache_size_bytes: 1073741824
+idle_kv_cache_quantization: FP8_E4M3
+idle_kv_cache_spill_directory: /tmp/spill
 
 )");
   EXPECT_EQ(oss.str(), expected_output);
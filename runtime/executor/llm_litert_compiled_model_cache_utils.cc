@@ -14,9 +14,10 @@
 
 #include "runtime/executor/llm_litert_compiled_model_cache_utils.h"
 
+#include <cstddef>
 #include <cstdint>
-#include <cstring>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"  // from @com_google_absl
 #include "absl/status/status.h"  // from @com_google_absl
@@ -28,6 +29,8 @@
 #include "litert/cc/litert_macros.h"  // from @litert
 #include "litert/cc/litert_model.h"  // from @litert
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
+#include "runtime/executor/kv_cache_copy.h"
+#include "runtime/framework/work_stealing_threadpool.h"
 #include "runtime/util/convert_tensor_buffer.h"
 #include "runtime/util/status_macros.h"  // IWYU pragma: keep
 
@@ -58,17 +61,47 @@ using ::litert::TensorBuffer;
   return false;
 }
 
+namespace {
+
+// Drops the tokens along `axis` of a single KV cache buffer.
+::litert::Expected<void> DropTokensFromKvCacheBuffer(
+    ::litert::TensorBuffer& buffer, int axis, int num_tokens_to_drop,
+    int init_tokens_to_retain) {
+  LITERT_ASSIGN_OR_RETURN(auto type, buffer.TensorType());
+  switch (type.ElementType()) {
+    case ::litert::ElementType::Int8:
+      return DropTokensfromTensorBuffer<int8_t>(
+          buffer, num_tokens_to_drop, axis, init_tokens_to_retain);
+    case ::litert::ElementType::Int16:
+      return DropTokensfromTensorBuffer<int16_t>(
+          buffer, num_tokens_to_drop, axis, init_tokens_to_retain);
+    case ::litert::ElementType::Int32:
+      return DropTokensfromTensorBuffer<int32_t>(
+          buffer, num_tokens_to_drop, axis, init_tokens_to_retain);
+    case ::litert::ElementType::Float32:
+      return DropTokensfromTensorBuffer<float>(
+          buffer, num_tokens_to_drop, axis, init_tokens_to_retain);
+    default:
+      return ::litert::Unexpected(kLiteRtStatusErrorInvalidArgument,
+                                  "Unsupported element type.");
+  }
+}
+
+}  // namespace
+
 // Function to dump the ring buffer.
 ::litert::Expected<void> DeleteTokensFromKvCache(
     absl::flat_hash_map<absl::string_view, ::litert::TensorBuffer>*
         input_kv_cache_buffers,
-    int num_tokens_to_drop, int init_tokens_to_retain) {
+    int num_tokens_to_drop, int init_tokens_to_retain,
+    WorkStealingThreadPool* thread_pool) {
   // A k cache buffer is a 4D tensor with shape
   // [1, heads, context_size, embedding_size]
   // A v cache buffer is a 4D tensor with shape
   // [1, heads, embedding_size, context_size]
+  std::vector<std::pair<::litert::TensorBuffer*, int>> buffers_and_axes;
+  buffers_and_axes.reserve(input_kv_cache_buffers->size());
   for (auto& [input_name, input_buffer] : *input_kv_cache_buffers) {
-    LITERT_ASSIGN_OR_RETURN(auto type, input_buffer.TensorType());
     const int axis = absl::StrContains(input_name, "cache_k_")   ? 2
                      : absl::StrContains(input_name, "cache_v_") ? 3
                                                                  : -1;
@@ -76,28 +109,27 @@ using ::litert::TensorBuffer;
       return ::litert::Unexpected(kLiteRtStatusErrorInvalidArgument,
                                   "Unsupported input name.");
     }
-    switch (type.ElementType()) {
-      case ::litert::ElementType::Int8:
-        LITERT_RETURN_IF_ERROR(DropTokensfromTensorBuffer<int8_t>(
-            input_buffer, num_tokens_to_drop, axis, init_tokens_to_retain));
-        break;
-      case ::litert::ElementType::Int16:
-        LITERT_RETURN_IF_ERROR(DropTokensfromTensorBuffer<int16_t>(
-            input_buffer, num_tokens_to_drop, axis, init_tokens_to_retain));
-        break;
-      case ::litert::ElementType::Int32:
-        LITERT_RETURN_IF_ERROR(DropTokensfromTensorBuffer<int32_t>(
-            input_buffer, num_tokens_to_drop, axis, init_tokens_to_retain));
-        break;
-      case ::litert::ElementType::Float32:
-        LITERT_RETURN_IF_ERROR(DropTokensfromTensorBuffer<float>(
-            input_buffer, num_tokens_to_drop, axis, init_tokens_to_retain));
-        break;
-      default:
-        return ::litert::Unexpected(kLiteRtStatusErrorInvalidArgument,
-                                    "Unsupported element type.");
+    buffers_and_axes.push_back({&input_buffer, axis});
+  }
+
+  // The buffers are independent, so they are compacted in parallel, one
+  // layer per iteration.
+  std::vector<::litert::Expected<void>> results(buffers_and_axes.size());
+  auto drop_tokens = [&](size_t i) {
+    results[i] = DropTokensFromKvCacheBuffer(
+        *buffers_and_axes[i].first, buffers_and_axes[i].second,
+        num_tokens_to_drop, init_tokens_to_retain);
+  };
+  if (thread_pool != nullptr) {
+    thread_pool->ParallelFor(buffers_and_axes.size(), drop_tokens);
+  } else {
+    for (size_t i = 0; i < buffers_and_axes.size(); ++i) {
+      drop_tokens(i);
     }
   }
+  for (auto& result : results) {
+    LITERT_RETURN_IF_ERROR(result);
+  }
   return {};
 }
 
@@ -105,7 +137,8 @@ using ::litert::TensorBuffer;
     absl::flat_hash_map<absl::string_view, ::litert::TensorBuffer>*
         input_kv_cache_buffers,
     int num_tokens_to_drop, int init_tokens_to_retain, int current_step,
-    int& start_position, size_t context_size) {
+    int& start_position, size_t context_size,
+    WorkStealingThreadPool* thread_pool) {
   LITERT_ASSIGN_OR_RETURN(
       bool should_delete_tokens,
       ShouldDeleteKVCacheTokens(current_step, start_position, context_size));
@@ -113,7 +146,7 @@ using ::litert::TensorBuffer;
     LITERT_RETURN_IF_ERROR(DeleteTokensFromKvCache(
         input_kv_cache_buffers,
         /*num_tokens_to_drop=*/num_tokens_to_drop,
-        /*init_tokens_to_retain=*/init_tokens_to_retain));
+        /*init_tokens_to_retain=*/init_tokens_to_retain, thread_pool));
     start_position += num_tokens_to_drop;
     return true;
   }
@@ -122,8 +155,8 @@ using ::litert::TensorBuffer;
 
 absl::Status ExpandBuffer(const uint8_t* src_data,
                           absl::Span<const int> src_shape, uint8_t* dst_data,
-                          absl::Span<const int> dst_shape,
-                          size_t element_size) {
+                          absl::Span<const int> dst_shape, size_t element_size,
+                          WorkStealingThreadPool* thread_pool) {
   RET_CHECK_EQ(src_shape.size(), dst_shape.size());
   int expansion_axis = -1;
   for (int i = 0; i < src_shape.size(); ++i) {
@@ -144,45 +177,35 @@ absl::Status ExpandBuffer(const uint8_t* src_data,
     return absl::InvalidArgumentError("No expansion axis found.");
   }
 
-  int64_t dest_total_elements = 1;
-  for (int dim : dst_shape) {
-    dest_total_elements *= dim;
-  }
-  memset(dst_data, 0, dest_total_elements * element_size);
-
   int64_t inner_block_size_in_elements = 1;
   for (int i = expansion_axis + 1; i < src_shape.size(); ++i) {
     inner_block_size_in_elements *= src_shape[i];
   }
-  const size_t inner_block_size_in_bytes =
-      inner_block_size_in_elements * element_size;
 
   int64_t outer_block_count = 1;
   for (int i = 0; i < expansion_axis; ++i) {
     outer_block_count *= src_shape[i];
   }
 
-  int64_t src_outer_block_stride_in_elements =
-      src_shape[expansion_axis] * inner_block_size_in_elements;
-  int64_t dest_outer_block_stride_in_elements =
-      dst_shape[expansion_axis] * inner_block_size_in_elements;
-
+  // Every outer block of the source is contiguous, and is copied to the start
+  // of the larger outer block of the destination whose remainder is zeroed.
+  const size_t src_outer_block_size_in_bytes =
+      src_shape[expansion_axis] * inner_block_size_in_elements * element_size;
+  const size_t dst_outer_block_size_in_bytes =
+      dst_shape[expansion_axis] * inner_block_size_in_elements * element_size;
+  std::vector<KvCacheCopy> copies;
+  copies.reserve(2 * outer_block_count);
   for (int64_t i = 0; i < outer_block_count; ++i) {
-    // Calculate the starting pointer for this outer block
-    const uint8_t* src_outer_block_start =
-        src_data + i * src_outer_block_stride_in_elements * element_size;
-    uint8_t* dest_outer_block_start =
-        dst_data + i * dest_outer_block_stride_in_elements * element_size;
-
-    // Copy each inner block from source to destination
-    for (int j = 0; j < src_shape[expansion_axis]; ++j) {
-      const uint8_t* src_inner_block =
-          src_outer_block_start + j * inner_block_size_in_bytes;
-      uint8_t* dest_inner_block =
-          dest_outer_block_start + j * inner_block_size_in_bytes;
-      memcpy(dest_inner_block, src_inner_block, inner_block_size_in_bytes);
-    }
+    uint8_t* dst_outer_block = dst_data + i * dst_outer_block_size_in_bytes;
+    copies.push_back({.dst = dst_outer_block,
+                      .src = src_data + i * src_outer_block_size_in_bytes,
+                      .size = src_outer_block_size_in_bytes});
+    copies.push_back({.dst = dst_outer_block + src_outer_block_size_in_bytes,
+                      .src = nullptr,
+                      .size = dst_outer_block_size_in_bytes -
+                              src_outer_block_size_in_bytes});
   }
+  RunKvCacheCopies(copies, thread_pool);
 
   return absl::OkStatus();
 };
@@ -24,6 +24,7 @@
 #include "absl/types/span.h"  // from @com_google_absl
 #include "litert/cc/litert_expected.h"  // from @litert
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
+#include "runtime/framework/work_stealing_threadpool.h"
 
 namespace litert::lm {
 
@@ -47,12 +48,15 @@ namespace litert::lm {
 //   num_tokens_to_drop: The number of tokens to drop from the KV cache.
 //   init_tokens_to_retain: The number of initial tokens to retain
 //   from the KV cache to implement streamingLLM behavior.
+//   thread_pool: The pool compacting the buffers in parallel, or null to
+//   compact them on the calling thread.
 // Returns:
 //   A void indicating the success of the token deletion from the KV cache.
 ::litert::Expected<void> DeleteTokensFromKvCache(
     absl::flat_hash_map<absl::string_view, ::litert::TensorBuffer>*
         input_kv_cache_buffers,
-    int num_tokens_to_drop, int init_tokens_to_retain);
+    int num_tokens_to_drop, int init_tokens_to_retain,
+    WorkStealingThreadPool* thread_pool = nullptr);
 
 // Function to delete tokens from the KV cache if needed.
 // Args:
@@ -63,6 +67,8 @@ namespace litert::lm {
 //   current_step: The current step of the model.
 //   start_position: The start position of the model.
 //   context_size: The context size of the model.
+//   thread_pool: The pool compacting the buffers in parallel, or null to
+//   compact them on the calling thread.
 // Returns:
 //   A boolean indicating whether the token deletion from the KV cache was
 //   triggered.
@@ -70,7 +76,8 @@ namespace litert::lm {
     absl::flat_hash_map<absl::string_view, ::litert::TensorBuffer>*
         input_kv_cache_buffers,
     int num_tokens_to_drop, int init_tokens_to_retain, int current_step,
-    int& start_position, size_t context_size);
+    int& start_position, size_t context_size,
+    WorkStealingThreadPool* thread_pool = nullptr);
 
 // Function to expand the buffer from src_data to dst_data. This function can
 // only handle a single expansion axis. Args:
@@ -79,11 +86,14 @@ namespace litert::lm {
 //   dst_data: The destination data.
 //   dst_shape: The destination shape.
 //   element_size: The element size of the data.
+//   thread_pool: The pool running the copies in parallel, or null to run them
+//   on the calling thread.
 // Returns:
 //   Status of the expansion.
 absl::Status ExpandBuffer(const uint8_t* src_data,
                           absl::Span<const int> src_shape, uint8_t* dst_data,
-                          absl::Span<const int> dst_shape, size_t element_size);
+                          absl::Span<const int> dst_shape, size_t element_size,
+                          WorkStealingThreadPool* thread_pool = nullptr);
 
 }  // namespace litert::lm
 #endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_EXECUTOR_LLM_LITERT_COMPILED_MODEL_CACHE_UTILS_H_
@@ -27,6 +27,7 @@
 #include "absl/types/span.h"  // from @com_google_absl
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
 #include "litert/test/matchers.h"  // from @litert
+#include "runtime/framework/work_stealing_threadpool.h"
 #include "runtime/util/convert_tensor_buffer.h"
 #include "runtime/util/test_utils.h"  // IWYU pragma: keep
 
@@ -159,6 +160,30 @@ TEST(LlmLiteRtCompiledModelCacheUtilsTest, ExpandBufferFirstDim) {
   EXPECT_THAT(dst_data, testing::ElementsAreArray({1, 2, 3, 4, 0, 0, 0, 0}));
 }
 
+TEST(LlmLiteRtCompiledModelCacheUtilsTest, ExpandBufferWithThreadPool) {
+  // Large enough for the copies to be split between the threads.
+  const std::vector<int> src_shape = {4, 1024, 256};
+  const std::vector<int> dst_shape = {4, 1536, 256};
+  std::vector<int> src_data(4 * 1024 * 256);
+  for (int i = 0; i < src_data.size(); ++i) {
+    src_data[i] = i + 1;
+  }
+  std::vector<int> expected(4 * 1536 * 256);
+  ASSERT_OK(ExpandBuffer(reinterpret_cast<const uint8_t*>(src_data.data()),
+                         src_shape, reinterpret_cast<uint8_t*>(expected.data()),
+                         dst_shape, sizeof(int)));
+
+  WorkStealingThreadPool thread_pool("testpool", 4);
+  std::vector<int> dst_data(expected.size(), -1);
+  ASSERT_OK(ExpandBuffer(reinterpret_cast<const uint8_t*>(src_data.data()),
+                         src_shape, reinterpret_cast<uint8_t*>(dst_data.data()),
+                         dst_shape, sizeof(int), &thread_pool));
+  EXPECT_EQ(dst_data, expected);
+  EXPECT_EQ(dst_data[1024 * 256 - 1], 1024 * 256);
+  EXPECT_EQ(dst_data[1024 * 256], 0);
+  EXPECT_EQ(dst_data[1536 * 256], 1024 * 256 + 1);
+}
+
 TEST(LlmLiteRtCompiledModelCacheUtilsTest, ExpandBufferDifferentRank) {
   std::vector<int> src_data = {1, 2};
   std::vector<int> src_shape = {2};
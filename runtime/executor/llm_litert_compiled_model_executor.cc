@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <filesystem>  // NOLINT(build/c++17) for std::filesystem::path
@@ -56,11 +57,14 @@
 #include "runtime/components/model_resources.h"
 #include "runtime/components/sampler_factory.h"
 #include "runtime/executor/executor_settings_base.h"
+#include "runtime/executor/kv_cache_copy.h"
 #include "runtime/executor/litert_compiled_model_executor_utils.h"
+#include "runtime/executor/llm_context_snapshot.h"
 #include "runtime/executor/llm_executor_io_types.h"
 #include "runtime/executor/llm_executor_processed_tokens.h"
 #include "runtime/executor/llm_executor_settings.h"
 #include "runtime/executor/llm_litert_compiled_model_cache_utils.h"
+#include "runtime/framework/work_stealing_threadpool.h"
 #include "runtime/util/convert_tensor_buffer.h"
 #include "runtime/util/file_util.h"
 #include "runtime/util/lora_util.h"
@@ -79,6 +83,14 @@ constexpr absl::string_view kPrefillSignatureRunner = "prefill";
 constexpr absl::string_view kDecodeSignatureRunner = "decode";
 constexpr int kDynamicDimValue = -1;
 
+// Names of the entries of the context snapshots. The kv-cache entries are
+// suffixed with the name of their model input.
+constexpr absl::string_view kSnapshotCurrentStep = "current_step";
+constexpr absl::string_view kSnapshotProcessedTokenIds = "processed_token_ids";
+constexpr absl::string_view kSnapshotPendingTokenId = "pending_token_id";
+constexpr absl::string_view kSnapshotKvCachePrefix = "kv_cache/";
+constexpr absl::string_view kSnapshotKvCacheDimsPrefix = "kv_cache_dims/";
+
 // Default number of threads for WebGPU weight upload and kernel compilation.
 constexpr int kDefaultNumThreadsToUpload = 2;
 constexpr int kDefaultNumThreadsToCompile = 1;
@@ -116,12 +128,20 @@ absl::Status InitializeEmbeddingLookups(
   return absl::OkStatus();
 }
 
-absl::Status CopyKvCacheBuffers(
+// Copies the KV cache buffers, with `thread_pool` if not null, and returns the
+// number of bytes copied.
+absl::StatusOr<size_t> CopyKvCacheBuffers(
     size_t decode_batch_size, int src_index_to_copy_on_prefill,
     const absl::flat_hash_map<absl::string_view, TensorBuffer>&
         src_kv_cache_buffers,
     const absl::flat_hash_map<absl::string_view, TensorBuffer>&
-        dst_kv_cache_buffers) {
+        dst_kv_cache_buffers,
+    WorkStealingThreadPool* thread_pool) {
+  // The buffers are locked on this thread, and only the copies between the
+  // locked addresses are run in parallel.
+  std::vector<TensorBufferScopedLock> locks;
+  locks.reserve(2 * src_kv_cache_buffers.size());
+  std::vector<KvCacheCopy> copies;
   for (const auto& [name, src_buffer] : src_kv_cache_buffers) {
     if (!dst_kv_cache_buffers.contains(name)) {
       return absl::FailedPreconditionError(
@@ -134,6 +154,7 @@ absl::Status CopyKvCacheBuffers(
     LITERT_ASSIGN_OR_RETURN(size_t src_buffer_size, src_buffer.PackedSize());
     const char* src_buffer_ptr =
         static_cast<const char*>(src_buffer_lock_and_addr.second);
+    locks.push_back(std::move(src_buffer_lock_and_addr.first));
 
     LITERT_ASSIGN_OR_RETURN(auto dst_buffer_lock_and_addr,
                             TensorBufferScopedLock::Create(
@@ -141,6 +162,7 @@ absl::Status CopyKvCacheBuffers(
     LITERT_ASSIGN_OR_RETURN(size_t dst_buffer_size, dst_buffer.PackedSize());
     char* dst_buffer_ptr =
         static_cast<char*>(const_cast<void*>(dst_buffer_lock_and_addr.second));
+    locks.push_back(std::move(dst_buffer_lock_and_addr.first));
     // This copy is based on the assumption that the KV cache buffers are in the
     // layout of [batch * X, ...] or [1, batch * X, ...] where X could be 1 or
     // more and X doesn't make values interleaved across batches which is true
@@ -151,18 +173,22 @@ absl::Status CopyKvCacheBuffers(
       RET_CHECK_EQ(src_buffer_size, dst_buffer_size * decode_batch_size);
       RET_CHECK_LT(src_index_to_copy_on_prefill, decode_batch_size);
       src_buffer_ptr += src_index_to_copy_on_prefill * dst_buffer_size;
-      memcpy(dst_buffer_ptr, src_buffer_ptr, dst_buffer_size);
+      copies.push_back({.dst = dst_buffer_ptr,
+                        .src = src_buffer_ptr,
+                        .size = dst_buffer_size});
     } else {
       // This is the case of the first decode after prefill. It broadcasts the
       // KV cache contents to all the batches.
       RET_CHECK_EQ(src_buffer_size * decode_batch_size, dst_buffer_size);
       for (int i = 0; i < decode_batch_size; ++i) {
-        memcpy(dst_buffer_ptr, src_buffer_ptr, src_buffer_size);
+        copies.push_back({.dst = dst_buffer_ptr,
+                          .src = src_buffer_ptr,
+                          .size = src_buffer_size});
         dst_buffer_ptr += src_buffer_size;
       }
     }
   }
-  return absl::OkStatus();
+  return RunKvCacheCopies(copies, thread_pool);
 }
 
 // Returns the backend to be used for sampling.
@@ -290,9 +316,13 @@ absl::Status ResolveDynamicShape(const Model& model,
   return absl::OkStatus();
 }
 
+// Returns a copy of `tensor_buffer` with `num_entries_to_insert` zero entries
+// appended along `dynamic_dim_index`, and adds the number of bytes written to
+// `num_bytes_copied`.
 absl::StatusOr<TensorBuffer> ResizeKVCacheTensorBuffer(
     Environment& env, TensorBuffer& tensor_buffer, int dynamic_dim_index,
-    int num_entries_to_insert) {
+    int num_entries_to_insert, WorkStealingThreadPool* thread_pool,
+    uint64_t* num_bytes_copied) {
   LITERT_ASSIGN_OR_RETURN(const RankedTensorType& tensor_type,
                           tensor_buffer.TensorType());
   RET_CHECK(!tensor_type.Layout().HasStrides());
@@ -334,7 +364,8 @@ absl::StatusOr<TensorBuffer> ResizeKVCacheTensorBuffer(
 
   RETURN_IF_ERROR(ExpandBuffer(tensor_buffer_ptr, dimensions,
                                new_tensor_buffer_ptr, new_dimensions,
-                               element_size.value()));
+                               element_size.value(), thread_pool));
+  *num_bytes_copied += new_size;
 
   return new_tensor_buffer;
 }
@@ -584,9 +615,12 @@ absl::Status LlmLiteRtCompiledModelExecutorBase::PrepareFirstPrefillAfterDecode(
     LITERT_RETURN_IF_ERROR(llm_context_->processed_context()
                                .processed_tokens()
                                .ReduceTokenCandidates(token_index_to_reduce));
-    LITERT_RETURN_IF_ERROR(
+    ASSIGN_OR_RETURN(
+        size_t num_bytes_copied,
         CopyKvCacheBuffers(output_heads, token_index_to_reduce,
-                           *input_kv_cache_buffers_, kv_cache_buffers_1_));
+                           *input_kv_cache_buffers_, kv_cache_buffers_1_,
+                           kv_cache_copy_thread_pool_.get()));
+    num_kv_cache_bytes_copied_ += num_bytes_copied;
     input_kv_cache_buffers_ = &kv_cache_buffers_1_;
     output_kv_cache_buffers_ = &kv_cache_buffers_2_;
   }
@@ -1035,9 +1069,13 @@ absl::Status LlmLiteRtCompiledModelExecutorBase::PrepareFirstDecode() {
   LITERT_RETURN_IF_ERROR(decode_kv_cache_buffers_2_.has_value());
   // Broadcast the prefill kv cache buffers to the decode kv cache buffers.
   // This is only needed when decode batch size > 1.
-  LITERT_RETURN_IF_ERROR(CopyKvCacheBuffers(
-      output_heads, /*src_index_to_copy_on_prefill=*/-1,
-      *input_kv_cache_buffers_, *decode_kv_cache_buffers_1_));
+  ASSIGN_OR_RETURN(size_t num_bytes_copied,
+                   CopyKvCacheBuffers(output_heads,
+                                      /*src_index_to_copy_on_prefill=*/-1,
+                                      *input_kv_cache_buffers_,
+                                      *decode_kv_cache_buffers_1_,
+                                      kv_cache_copy_thread_pool_.get()));
+  num_kv_cache_bytes_copied_ += num_bytes_copied;
   input_kv_cache_buffers_ = &decode_kv_cache_buffers_1_.value();
   output_kv_cache_buffers_ = &decode_kv_cache_buffers_2_.value();
 
@@ -1321,6 +1359,121 @@ absl::Status LlmLiteRtCompiledModelExecutorBase::Reset() {
   return absl::OkStatus();
 }
 
+absl::Status LlmLiteRtCompiledModelExecutorBase::SaveContextSnapshot(
+    LlmContextSnapshotWriter& writer) {
+  if (llm_context_->runtime_state().ran_decode &&
+      llm_context_->runtime_config().output_heads.value_or(1) > 1) {
+    return absl::FailedPreconditionError(
+        "Cannot save a snapshot while decoding several output candidates.");
+  }
+  RETURN_IF_ERROR(RollBackProcessedTokens());
+
+  const ProcessedTokens& processed_tokens =
+      llm_context_->processed_context().processed_tokens();
+  const int current_step = llm_context_->runtime_state().current_step;
+  std::vector<int> pending_token_id;
+  if (processed_tokens.HasPendingInputToken()) {
+    pending_token_id.push_back(
+        processed_tokens.GetPendingInputToken()[0]->id());
+  }
+  RETURN_IF_ERROR(writer.AddValues<int>(kSnapshotCurrentStep,
+                                        absl::MakeConstSpan(&current_step, 1)));
+  RETURN_IF_ERROR(writer.AddValues<int>(kSnapshotProcessedTokenIds,
+                                        processed_tokens.GetTokensUnsafe()));
+  RETURN_IF_ERROR(
+      writer.AddValues<int>(kSnapshotPendingTokenId, pending_token_id));
+
+  // The latest kv-cache is in the input buffers of the next run. The buffers
+  // are written in name order so that a context always gives the same file.
+  std::vector<absl::string_view> names;
+  names.reserve(input_kv_cache_buffers_->size());
+  for (const auto& [name, buffer] : *input_kv_cache_buffers_) {
+    names.push_back(name);
+  }
+  std::sort(names.begin(), names.end());
+  for (absl::string_view name : names) {
+    const TensorBuffer& buffer = input_kv_cache_buffers_->at(name);
+    LITERT_ASSIGN_OR_RETURN(const RankedTensorType& tensor_type,
+                            buffer.TensorType());
+    auto dimensions = tensor_type.Layout().Dimensions();
+    RETURN_IF_ERROR(writer.AddValues<int>(
+        absl::StrCat(kSnapshotKvCacheDimsPrefix, name),
+        std::vector<int>(dimensions.begin(), dimensions.end())));
+    LITERT_ASSIGN_OR_RETURN(size_t size, buffer.PackedSize());
+    LITERT_ASSIGN_OR_RETURN(
+        auto buffer_lock_and_addr,
+        TensorBufferScopedLock::Create(buffer, TensorBuffer::LockMode::kRead));
+    RETURN_IF_ERROR(writer.AddEntry(
+        absl::StrCat(kSnapshotKvCachePrefix, name),
+        absl::MakeConstSpan(
+            static_cast<const uint8_t*>(buffer_lock_and_addr.second), size)));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status LlmLiteRtCompiledModelExecutorBase::LoadContextSnapshot(
+    std::shared_ptr<LlmContextSnapshot> snapshot) {
+  ASSIGN_OR_RETURN(std::vector<int> current_step,
+                   snapshot->ReadValues<int>(kSnapshotCurrentStep));
+  ASSIGN_OR_RETURN(std::vector<int> token_ids,
+                   snapshot->ReadValues<int>(kSnapshotProcessedTokenIds));
+  ASSIGN_OR_RETURN(std::vector<int> pending_token_id,
+                   snapshot->ReadValues<int>(kSnapshotPendingTokenId));
+  if (current_step.size() != 1 || pending_token_id.size() > 1 ||
+      current_step[0] !=
+          static_cast<int>(token_ids.size() + pending_token_id.size())) {
+    return absl::DataLossError(
+        "The processed tokens of the snapshot do not match its step.");
+  }
+
+  RETURN_IF_ERROR(LoadKvCacheBuffers(std::move(snapshot)));
+
+  ProcessedTokens processed_tokens;
+  processed_tokens.AddProcessedTokens(token_ids);
+  if (!pending_token_id.empty()) {
+    RETURN_IF_ERROR(processed_tokens.AddPendingInputToken(
+        {std::make_shared<TokenData>(pending_token_id[0])}));
+  }
+  llm_context_->processed_context().processed_tokens() =
+      std::move(processed_tokens);
+  llm_context_->runtime_state().current_step = current_step[0];
+  // The loaded kv-cache is the one of a prefill, whatever ran before.
+  llm_context_->runtime_state().ran_decode = false;
+  force_prepare_needed_ = false;
+  if (sampler_ != nullptr && sampler_->HandlesInput()) {
+    RETURN_IF_ERROR(SetSamplerInputHandling(/*reset=*/true));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status LlmLiteRtCompiledModelExecutorBase::LoadKvCacheBuffers(
+    std::shared_ptr<LlmContextSnapshot> snapshot) {
+  for (auto& [name, buffer] : kv_cache_buffers_1_) {
+    ASSIGN_OR_RETURN(std::vector<int> saved_dimensions,
+                     snapshot->ReadValues<int>(
+                         absl::StrCat(kSnapshotKvCacheDimsPrefix, name)));
+    LITERT_ASSIGN_OR_RETURN(const RankedTensorType& tensor_type,
+                            buffer.TensorType());
+    auto dimensions = tensor_type.Layout().Dimensions();
+    if (!std::equal(saved_dimensions.begin(), saved_dimensions.end(),
+                    dimensions.begin(), dimensions.end())) {
+      return absl::FailedPreconditionError(absl::StrCat(
+          "The kv-cache buffer ", name, " of the snapshot has another shape."));
+    }
+    LITERT_ASSIGN_OR_RETURN(size_t size, buffer.PackedSize());
+    LITERT_ASSIGN_OR_RETURN(auto buffer_lock_and_addr,
+                            TensorBufferScopedLock::Create(
+                                buffer, TensorBuffer::LockMode::kWrite));
+    RETURN_IF_ERROR(snapshot->ReadEntry(
+        absl::StrCat(kSnapshotKvCachePrefix, name),
+        absl::MakeSpan(static_cast<uint8_t*>(buffer_lock_and_addr.second),
+                       size)));
+  }
+  input_kv_cache_buffers_ = &kv_cache_buffers_1_;
+  output_kv_cache_buffers_ = &kv_cache_buffers_2_;
+  return absl::OkStatus();
+}
+
 absl::StatusOr<int> LlmLiteRtCompiledModelExecutorBase::GetVocabSize() {
   if (!decode_output_buffers_.contains(signatures_.output_logits)) {
     return absl::NotFoundError("Output logits info not found.");
@@ -1882,7 +2035,9 @@ absl::Status LlmLiteRtCompiledModelExecutorDynamic::PrefillInternal(
         ASSIGN_OR_RETURN(kv_cache_buffers_1_[k_cache_input_name],
                          ResizeKVCacheTensorBuffer(
                              env_, kv_cache_buffers_1_[k_cache_input_name],
-                             key_dynamic_dim_index_, entries_to_add));
+                             key_dynamic_dim_index_, entries_to_add,
+                             kv_cache_copy_thread_pool_.get(),
+                             &num_kv_cache_bytes_copied_));
       }
       for (const auto& v_cache_input_name : value_cache_input_names_) {
         RETURN_IF_ERROR(ResolveDynamicShape(model_, compiled_model_, "prefill",
@@ -1891,7 +2046,9 @@ absl::Status LlmLiteRtCompiledModelExecutorDynamic::PrefillInternal(
         ASSIGN_OR_RETURN(kv_cache_buffers_1_[v_cache_input_name],
                          ResizeKVCacheTensorBuffer(
                              env_, kv_cache_buffers_1_[v_cache_input_name],
-                             value_dynamic_dim_index_, entries_to_add));
+                             value_dynamic_dim_index_, entries_to_add,
+                             kv_cache_copy_thread_pool_.get(),
+                             &num_kv_cache_bytes_copied_));
       }
       kv_length = new_kv_seq_len;
     }
@@ -1932,7 +2089,9 @@ absl::Status LlmLiteRtCompiledModelExecutorDynamic::DecodeInternal(
       ASSIGN_OR_RETURN(kv_cache_buffers_1_[k_cache_input_name],
                        ResizeKVCacheTensorBuffer(
                            env_, kv_cache_buffers_1_[k_cache_input_name],
-                           key_dynamic_dim_index_, entries_to_add));
+                           key_dynamic_dim_index_, entries_to_add,
+                           kv_cache_copy_thread_pool_.get(),
+                           &num_kv_cache_bytes_copied_));
     }
     for (const auto& v_cache_input_name : value_cache_input_names_) {
       RETURN_IF_ERROR(ResolveDynamicShape(model_, compiled_model_, "decode",
@@ -1940,7 +2099,9 @@ absl::Status LlmLiteRtCompiledModelExecutorDynamic::DecodeInternal(
       ASSIGN_OR_RETURN(kv_cache_buffers_1_[v_cache_input_name],
                        ResizeKVCacheTensorBuffer(
                            env_, kv_cache_buffers_1_[v_cache_input_name],
-                           value_dynamic_dim_index_, entries_to_add));
+                           value_dynamic_dim_index_, entries_to_add,
+                           kv_cache_copy_thread_pool_.get(),
+                           &num_kv_cache_bytes_copied_));
     }
     current_kv_len = new_kv_len;
   }
@@ -1957,6 +2118,137 @@ absl::Status LlmLiteRtCompiledModelExecutorDynamic::DecodeInternal(
                                                             output_logits);
 }
 
+LlmLiteRtCompiledModelExecutorDynamic::
+    ~LlmLiteRtCompiledModelExecutorDynamic() {
+  // The kv-cache buffers may be backed by the snapshot held by the bound
+  // context, so they are released before it is.
+  input_kv_cache_buffers_ = nullptr;
+  output_kv_cache_buffers_ = nullptr;
+  kv_cache_buffers_1_.clear();
+}
+
+absl::StatusOr<std::unique_ptr<LlmContext>>
+LlmLiteRtCompiledModelExecutorDynamic::SwapContext(
+    std::unique_ptr<LlmContext> llm_context) {
+  RET_CHECK_NE(llm_context, nullptr);
+  auto* new_processed_context =
+      dynamic_cast<LlmProcessedContext*>(&llm_context->processed_context());
+  RET_CHECK_NE(new_processed_context, nullptr)
+      << "The processed context to swap in must be an LlmProcessedContext.";
+  // The processed tokens of the context leaving the executor must match its
+  // step, as for a snapshot.
+  RETURN_IF_ERROR(RollBackProcessedTokens());
+
+  // The dynamic executor runs on a single set of kv-cache buffers, used both
+  // as input and output.
+  auto& bound_processed_context =
+      static_cast<LlmProcessedContext&>(llm_context_->processed_context());
+  bound_processed_context.kv_cache_buffers() = std::move(kv_cache_buffers_1_);
+  kv_cache_buffers_1_ = std::move(new_processed_context->kv_cache_buffers());
+  new_processed_context->kv_cache_buffers().clear();
+  input_kv_cache_buffers_ = &kv_cache_buffers_1_;
+  output_kv_cache_buffers_ = &kv_cache_buffers_1_;
+  std::swap(llm_context_, llm_context);
+
+  force_prepare_needed_ = false;
+  if (sampler_ != nullptr && sampler_->HandlesInput()) {
+    RETURN_IF_ERROR(SetSamplerInputHandling(/*reset=*/true));
+  }
+  return llm_context;
+}
+
+absl::Status LlmLiteRtCompiledModelExecutorDynamic::LoadKvCacheBuffers(
+    std::shared_ptr<LlmContextSnapshot> snapshot) {
+  RET_CHECK(!key_cache_input_names_.empty());
+  ASSIGN_OR_RETURN(std::vector<int> key_dimensions,
+                   snapshot->ReadValues<int>(absl::StrCat(
+                       kSnapshotKvCacheDimsPrefix, key_cache_input_names_[0])));
+  if (key_dynamic_dim_index_ >= static_cast<int>(key_dimensions.size())) {
+    return absl::FailedPreconditionError(
+        "The kv-cache buffers of the snapshot have another rank.");
+  }
+  // Only the CPU backend runs on host memory which the snapshot can back.
+  const bool in_place = executor_settings_.GetBackend() == Backend::CPU;
+
+  absl::flat_hash_map<absl::string_view, TensorBuffer> kv_cache_buffers;
+  for (const auto& k_cache_input_name : key_cache_input_names_) {
+    ASSIGN_OR_RETURN(kv_cache_buffers[k_cache_input_name],
+                     LoadKvCacheBuffer(*snapshot, k_cache_input_name,
+                                       key_dynamic_dim_index_, in_place));
+  }
+  for (const auto& v_cache_input_name : value_cache_input_names_) {
+    ASSIGN_OR_RETURN(kv_cache_buffers[v_cache_input_name],
+                     LoadKvCacheBuffer(*snapshot, v_cache_input_name,
+                                       value_dynamic_dim_index_, in_place));
+  }
+  // The buffers backed by the previous snapshot of the bound context, if any,
+  // are released before it is. The snapshot is kept by the processed context,
+  // which holds the buffers while the context is swapped out.
+  kv_cache_buffers_1_ = std::move(kv_cache_buffers);
+  input_kv_cache_buffers_ = &kv_cache_buffers_1_;
+  output_kv_cache_buffers_ = &kv_cache_buffers_1_;
+  static_cast<LlmProcessedContext&>(llm_context_->processed_context())
+      .mapped_snapshot() = in_place ? std::move(snapshot) : nullptr;
+  return absl::OkStatus();
+}
+
+absl::StatusOr<TensorBuffer>
+LlmLiteRtCompiledModelExecutorDynamic::LoadKvCacheBuffer(
+    LlmContextSnapshot& snapshot, absl::string_view name,
+    int dynamic_dim_index, bool in_place) {
+  ASSIGN_OR_RETURN(std::vector<int> saved_dimensions,
+                   snapshot.ReadValues<int>(
+                       absl::StrCat(kSnapshotKvCacheDimsPrefix, name)));
+  LITERT_ASSIGN_OR_RETURN(const SimpleSignature& signature,
+                          model_.FindSignature(kPrefillSignatureRunner));
+  LITERT_ASSIGN_OR_RETURN(const SimpleTensor& tensor,
+                          signature.InputTensor(name));
+  LITERT_ASSIGN_OR_RETURN(const RankedTensorType model_tensor_type,
+                          tensor.RankedTensorType());
+  auto model_dimensions = model_tensor_type.Layout().Dimensions();
+  bool same_shape = saved_dimensions.size() == model_dimensions.size() &&
+                    dynamic_dim_index < saved_dimensions.size();
+  for (int i = 0; same_shape && i < saved_dimensions.size(); ++i) {
+    same_shape = model_dimensions[i] == kDynamicDimValue ||
+                 model_dimensions[i] == saved_dimensions[i];
+  }
+  if (!same_shape) {
+    return absl::FailedPreconditionError(absl::StrCat(
+        "The kv-cache buffer ", name, " of the snapshot has another shape."));
+  }
+  RETURN_IF_ERROR(ResolveDynamicShape(
+      model_, compiled_model_, kPrefillSignatureRunner, name,
+      saved_dimensions[dynamic_dim_index]));
+
+  const std::string entry_name = absl::StrCat(kSnapshotKvCachePrefix, name);
+  if (in_place) {
+    ASSIGN_OR_RETURN(absl::Span<uint8_t> data, snapshot.MapEntry(entry_name));
+    RankedTensorType tensor_type(
+        model_tensor_type.ElementType(),
+        Layout(Dimensions(saved_dimensions.begin(), saved_dimensions.end())));
+    LITERT_ASSIGN_OR_RETURN(size_t size, tensor_type.Bytes());
+    if (data.size() == size) {
+      auto wrapped_buffer =
+          TensorBuffer::CreateFromHostMemory(tensor_type, data.data(), size);
+      if (wrapped_buffer.HasValue()) {
+        return std::move(*wrapped_buffer);
+      }
+    }
+  }
+
+  LITERT_ASSIGN_OR_RETURN(
+      TensorBuffer buffer,
+      compiled_model_.CreateInputBuffer(kPrefillSignatureRunner, name));
+  LITERT_ASSIGN_OR_RETURN(
+      auto buffer_lock_and_addr,
+      TensorBufferScopedLock::Create(buffer, TensorBuffer::LockMode::kWrite));
+  auto* buffer_ptr = static_cast<uint8_t*>(buffer_lock_and_addr.second);
+  LITERT_ASSIGN_OR_RETURN(size_t size, buffer.PackedSize());
+  RETURN_IF_ERROR(
+      snapshot.ReadEntry(entry_name, absl::MakeSpan(buffer_ptr, size)));
+  return buffer;
+}
+
 // static
 // Creates a LlmLiteRtCompiledModelExecutorDynamic from a LiteRt model.
 absl::StatusOr<std::unique_ptr<LlmLiteRtCompiledModelExecutorDynamic>>
@@ -38,11 +38,13 @@
 #include "runtime/components/sampler.h"
 #include "runtime/executor/executor_settings_base.h"
 #include "runtime/executor/litert_compiled_model_executor_utils.h"
+#include "runtime/executor/llm_context_snapshot.h"
 #include "runtime/executor/llm_executor.h"
 #include "runtime/executor/llm_executor_io_types.h"
 #include "runtime/executor/llm_executor_processed_tokens.h"
 #include "runtime/executor/llm_executor_settings.h"
 #include "runtime/executor/llm_processed_context.h"
+#include "runtime/framework/work_stealing_threadpool.h"
 
 namespace litert::lm {
 
@@ -109,6 +111,17 @@ class LlmLiteRtCompiledModelExecutorBase : public LlmExecutor {
 
   absl::StatusOr<int> GetVocabSize() override;
 
+  uint64_t GetNumKvCacheBytesCopied() const override {
+    return num_kv_cache_bytes_copied_;
+  }
+
+  // Saves the kv-cache of the prefill. Fails while decoding several output
+  // candidates, whose kv-caches are only reduced to one by the next prefill.
+  absl::Status SaveContextSnapshot(LlmContextSnapshotWriter& writer) override;
+
+  absl::Status LoadContextSnapshot(
+      std::shared_ptr<LlmContextSnapshot> snapshot) override;
+
   // Initializes the sampler.
   // `logits_data_type` is optional because the executor usually knows the
   // logits data type from initialization. If it is not provided, the executor
@@ -169,6 +182,16 @@ class LlmLiteRtCompiledModelExecutorBase : public LlmExecutor {
     llm_context_ = std::make_unique<LlmContext>(std::move(processed_context),
                                                 std::move(runtime_config),
                                                 std::move(runtime_state));
+    // Only the CPU backend copies the kv-cache on the host. The calling thread
+    // takes part in the copies, so the pool has one thread less than the
+    // executor may use.
+    if (executor_settings_.GetBackend() == Backend::CPU) {
+      auto cpu_config = executor_settings_.GetBackendConfig<CpuConfig>();
+      if (cpu_config.ok() && cpu_config->number_of_threads > 1) {
+        kv_cache_copy_thread_pool_ = std::make_unique<WorkStealingThreadPool>(
+            "kv_cache_copy", cpu_config->number_of_threads - 1);
+      }
+    }
   }
 
  protected:
@@ -252,6 +275,12 @@ class LlmLiteRtCompiledModelExecutorBase : public LlmExecutor {
   absl::Status ConsumePendingOrAddProcessedToken(
       const std::vector<std::shared_ptr<TokenData>>& token);
 
+  // Loads the kv-cache saved in `snapshot` into kv_cache_buffers_1_ and makes
+  // it the input of the next run. The kv-cache buffers of the snapshot must
+  // have the shapes of the executor ones.
+  virtual absl::Status LoadKvCacheBuffers(
+      std::shared_ptr<LlmContextSnapshot> snapshot);
+
   LlmExecutorSettings executor_settings_;
   Environment& env_;
   const Model& model_;
@@ -311,6 +340,13 @@ class LlmLiteRtCompiledModelExecutorBase : public LlmExecutor {
 
   // GPU optimized single buffer cache
   bool gpu_optimized_single_buffer_cache_ = false;
+
+  // The threads copying the kv-cache buffers along with the calling thread.
+  // Null if the executor does not run on CPU or runs on a single thread.
+  std::unique_ptr<WorkStealingThreadPool> kv_cache_copy_thread_pool_;
+
+  // The number of bytes of kv-cache copied between buffers so far.
+  uint64_t num_kv_cache_bytes_copied_ = 0;
 };
 
 // The static executor for the prefill-decode compiled model.
@@ -381,11 +417,22 @@ class LlmLiteRtCompiledModelExecutorDynamic
   Create(LlmExecutorSettings executor_settings, Environment& lrt_env,
          ModelResources& resources);
 
+  ~LlmLiteRtCompiledModelExecutorDynamic() override;
+
   using LlmLiteRtCompiledModelExecutorBase::Prefill;
 
   absl::Status Prefill(const ExecutorInputs& inputs,
                        const ExecutorPrefillParams& params) override;
 
+  bool CanSwapContext() const override { return true; }
+
+  // Binds `llm_context`, whose processed context must be an
+  // LlmProcessedContext, and returns the context bound so far with the
+  // kv-cache buffers moved into its processed context. A context which never
+  // ran has no kv-cache buffers, they are allocated by its first prefill.
+  absl::StatusOr<std::unique_ptr<LlmContext>> SwapContext(
+      std::unique_ptr<LlmContext> llm_context) override;
+
  private:
   LlmLiteRtCompiledModelExecutorDynamic(
       LlmExecutorSettings executor_settings, Environment& env,
@@ -429,6 +476,19 @@ class LlmLiteRtCompiledModelExecutorDynamic
       const std::vector<std::shared_ptr<TokenData>>& token,
       TensorBuffer& output_logits) override;
 
+  // Creates the kv-cache buffers at the length of the saved ones. On CPU, the
+  // saved entries are used in place.
+  absl::Status LoadKvCacheBuffers(
+      std::shared_ptr<LlmContextSnapshot> snapshot) override;
+
+  // Returns a kv-cache buffer with the content saved for the input `name` in
+  // `snapshot`, which backs the buffer if `in_place` and the buffer can wrap
+  // it. `dynamic_dim_index` is the dimension along which the kv-cache grows.
+  absl::StatusOr<TensorBuffer> LoadKvCacheBuffer(LlmContextSnapshot& snapshot,
+                                                 absl::string_view name,
+                                                 int dynamic_dim_index,
+                                                 bool in_place);
+
   int prefill_chunk_size_;
   int key_dynamic_dim_index_;
   int value_dynamic_dim_index_;
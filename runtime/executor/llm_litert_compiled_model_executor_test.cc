@@ -31,6 +31,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/cleanup/cleanup.h"  // from @com_google_absl
+#include "absl/container/flat_hash_map.h"  // from @com_google_absl
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/str_cat.h"  // from @com_google_absl
@@ -51,6 +52,7 @@
 #include "runtime/executor/executor_settings_base.h"
 #include "runtime/executor/llm_executor_io_types.h"
 #include "runtime/executor/llm_executor_settings.h"
+#include "runtime/executor/llm_processed_context.h"
 #include "runtime/util/convert_tensor_buffer.h"
 #include "runtime/util/litert_lm_loader.h"
 #include "runtime/util/model_asset_bundle_resources.h"
@@ -853,5 +855,63 @@ TEST(LlmLiteRtCompiledModelExecutorDynamicTest, DecodeTest) {
   }
 }
 
+TEST(LlmLiteRtCompiledModelExecutorDynamicTest, SwapContextTest) {
+  LITERT_ASSERT_OK_AND_ASSIGN(
+      auto env, Environment::Create(std::vector<Environment::Option>()));
+  std::unique_ptr<ModelResources> model_resources;
+  std::unique_ptr<LlmLiteRtCompiledModelExecutorDynamic> executor;
+  {
+    ASSERT_OK_AND_ASSIGN(auto p,
+                         CreateDynamicExecutor(env, kTestDynamicModelPath));
+    std::tie(model_resources, executor) = std::move(p);
+  }
+  ASSERT_TRUE(executor->CanSwapContext());
+
+  ExecutorInputs inputs;
+  const std::vector<int> input_tokens = {1, 2, 0};
+  const int num_input_tokens = input_tokens.size();
+  LITERT_ASSERT_OK_AND_ASSIGN(
+      auto input_tokens_buffer,
+      CopyToTensorBuffer<int>(absl::MakeSpan(input_tokens), {1, 3}));
+  inputs.SetTextData(ExecutorTextData(std::move(input_tokens_buffer)));
+  EXPECT_OK(executor->Prefill(inputs));
+
+  // Swap in a context which never ran.
+  auto runtime_config = std::make_unique<RuntimeConfig>();
+  runtime_config->output_heads = 1;
+  ASSERT_OK_AND_ASSIGN(
+      auto first_context,
+      executor->SwapContext(std::make_unique<LlmContext>(
+          std::make_unique<LlmProcessedContext>(
+              std::nullopt,
+              absl::flat_hash_map<absl::string_view, TensorBuffer>()),
+          std::move(runtime_config), std::make_unique<RuntimeState>())));
+  EXPECT_EQ(first_context->runtime_state().current_step, num_input_tokens);
+  EXPECT_FALSE(static_cast<LlmProcessedContext&>(
+                   first_context->processed_context())
+                   .kv_cache_buffers()
+                   .empty());
+  {
+    ASSERT_OK_AND_ASSIGN(auto current_step, executor->GetCurrentStep());
+    EXPECT_EQ(current_step, 0);
+  }
+  EXPECT_OK(executor->Prefill(inputs));
+  EXPECT_OK(executor->Prefill(inputs));
+
+  // Swap the first context back and keep decoding it.
+  ASSERT_OK_AND_ASSIGN(auto second_context,
+                       executor->SwapContext(std::move(first_context)));
+  EXPECT_EQ(second_context->runtime_state().current_step,
+            2 * num_input_tokens);
+  {
+    ASSERT_OK_AND_ASSIGN(auto current_step, executor->GetCurrentStep());
+    EXPECT_EQ(current_step, num_input_tokens);
+  }
+  LITERT_ASSERT_OK_AND_ASSIGN(auto output_tokens, CreateTensorBuffer<int>({1}));
+  EXPECT_OK(executor->Decode(output_tokens));
+  ASSERT_OK_AND_ASSIGN(auto current_step, executor->GetCurrentStep());
+  EXPECT_EQ(current_step, num_input_tokens + 1);
+}
+
 }  // namespace
 }  // namespace litert::lm
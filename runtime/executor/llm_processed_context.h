@@ -15,13 +15,18 @@
 #ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_EXECUTOR_LLM_PROCESSED_CONTEXT_H_
 #define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_EXECUTOR_LLM_PROCESSED_CONTEXT_H_
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
+#include "runtime/executor/kv_cache_offload.h"
+#include "runtime/executor/llm_context_snapshot.h"
 #include "runtime/executor/llm_executor_io_types.h"
 #include "runtime/executor/llm_executor_processed_tokens.h"
 
@@ -52,11 +57,67 @@ class LlmProcessedContext : public ProcessedContext {
     return kv_cache_buffers_;
   }
 
+  // Gets the snapshot whose memory mapped entries back the kv-cache buffers of
+  // this context, null if the buffers own their memory. It moves along with
+  // the context, so that the buffers stay valid when the context is swapped
+  // out of the executor.
+  std::shared_ptr<LlmContextSnapshot>& mapped_snapshot() {
+    return mapped_snapshot_;
+  }
+
+  size_t GetKvCacheSizeInBytes() const override {
+    size_t size = 0;
+    for (const auto& [name, buffer] : kv_cache_buffers_) {
+      if (auto packed_size = buffer.PackedSize(); packed_size) {
+        size += *packed_size;
+      }
+    }
+    return size;
+  }
+
+  absl::StatusOr<size_t> OffloadKvCache(
+      const KvCacheOffloadOptions& options) override {
+    if (offloaded_kv_cache_ != nullptr) {
+      return 0;
+    }
+    auto offloaded_kv_cache =
+        OffloadedKvCache::Create(kv_cache_buffers_, options);
+    if (!offloaded_kv_cache.ok()) {
+      return offloaded_kv_cache.status();
+    }
+    if ((*offloaded_kv_cache)->empty()) {
+      return 0;
+    }
+    offloaded_kv_cache_ = *std::move(offloaded_kv_cache);
+    const size_t size = offloaded_kv_cache_->GetSizeInBytes();
+    const size_t memory_size = offloaded_kv_cache_->GetMemorySizeInBytes();
+    return size > memory_size ? size - memory_size : 0;
+  }
+
+  absl::StatusOr<size_t> ReloadKvCache() override {
+    if (offloaded_kv_cache_ == nullptr) {
+      return 0;
+    }
+    if (auto status = offloaded_kv_cache_->Reload(kv_cache_buffers_);
+        !status.ok()) {
+      return status;
+    }
+    const size_t size = offloaded_kv_cache_->GetSizeInBytes();
+    offloaded_kv_cache_.reset();
+    return size;
+  }
+
  private:
   std::optional<uint32_t> lora_id_;
   ProcessedTokens processed_tokens_;
+  // Declared before `kv_cache_buffers_` so that the buffers it backs are
+  // released first.
+  std::shared_ptr<LlmContextSnapshot> mapped_snapshot_;
   absl::flat_hash_map<absl::string_view, ::litert::TensorBuffer>
       kv_cache_buffers_;
+  // The kv-cache moved out of `kv_cache_buffers_` by OffloadKvCache(), null
+  // if it is in the buffers.
+  std::unique_ptr<OffloadedKvCache> offloaded_kv_cache_;
 };
 
 }  // namespace litert::lm
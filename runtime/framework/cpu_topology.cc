@@ -0,0 +1,153 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/framework/cpu_topology.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17) for std::filesystem::path
+#include <fstream>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "absl/log/absl_log.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/match.h"  // from @com_google_absl
+#include "absl/strings/numbers.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "runtime/framework/thread_options.h"
+
+namespace litert::lm {
+namespace {
+
+// Returns the integer in the file at `path`, or nullopt if it can't be read.
+std::optional<int64_t> ReadInt(const std::filesystem::path& path) {
+  std::ifstream file(path);
+  std::string content;
+  if (!file || !std::getline(file, content)) {
+    return std::nullopt;
+  }
+  int64_t value;
+  if (!absl::SimpleAtoi(content, &value)) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+// Returns the topology of the CPU running this process, treating all its cores
+// alike if the topology can't be read.
+CpuTopology ReadSystemCpuTopology() {
+  absl::StatusOr<CpuTopology> topology = ReadCpuTopology();
+  if (!topology.ok()) {
+    ABSL_LOG(WARNING) << "Failed to read the CPU topology, threads are not "
+                         "pinned: "
+                      << topology.status();
+    return CpuTopology();
+  }
+  return *std::move(topology);
+}
+
+}  // namespace
+
+absl::StatusOr<CpuTopology> ReadCpuTopology(absl::string_view sysfs_cpu_dir) {
+  const std::filesystem::path dir(std::string{sysfs_cpu_dir});
+  std::error_code error;
+  std::filesystem::directory_iterator it(dir, error);
+  if (error) {
+    return absl::NotFoundError(absl::StrCat("Failed to list ", sysfs_cpu_dir,
+                                            ": ", error.message()));
+  }
+
+  // The performance of every online CPU, if the kernel reports it.
+  std::map<int, std::optional<int64_t>> cpus;
+  for (; it != std::filesystem::directory_iterator(); it.increment(error)) {
+    const std::string name = it->path().filename().string();
+    int cpu;
+    if (!absl::StartsWith(name, "cpu") ||
+        !absl::SimpleAtoi(absl::string_view(name).substr(3), &cpu)) {
+      continue;
+    }
+    // cpu0 usually has no `online` file since it can't be offlined.
+    if (ReadInt(it->path() / "online").value_or(1) == 0) {
+      continue;
+    }
+    std::optional<int64_t> performance = ReadInt(it->path() / "cpu_capacity");
+    if (!performance.has_value()) {
+      performance = ReadInt(it->path() / "cpufreq" / "cpuinfo_max_freq");
+    }
+    cpus[cpu] = performance;
+  }
+  if (error) {
+    return absl::InternalError(absl::StrCat("Failed to list ", sysfs_cpu_dir,
+                                            ": ", error.message()));
+  }
+  if (cpus.empty()) {
+    return absl::NotFoundError(
+        absl::StrCat("No online CPU found in ", sysfs_cpu_dir));
+  }
+
+  CpuTopology topology;
+  std::optional<int64_t> min_performance;
+  bool heterogeneous = false;
+  for (const auto& [cpu, performance] : cpus) {
+    if (!performance.has_value()) {
+      // Without the performance of every CPU, treat them all alike.
+      heterogeneous = false;
+      break;
+    }
+    if (min_performance.has_value() && *performance != *min_performance) {
+      heterogeneous = true;
+    }
+    if (!min_performance.has_value() || *performance < *min_performance) {
+      min_performance = performance;
+    }
+  }
+  for (const auto& [cpu, performance] : cpus) {
+    if (heterogeneous && *performance == *min_performance) {
+      topology.efficiency_cpus.insert(cpu);
+    } else {
+      topology.performance_cpus.insert(cpu);
+    }
+  }
+  return topology;
+}
+
+ThreadOptions GetPerformanceCoreThreadOptions(const CpuTopology& topology) {
+  if (!topology.IsHeterogeneous()) {
+    return ThreadOptions();
+  }
+  return ThreadOptions().set_cpu_set(topology.performance_cpus);
+}
+
+ThreadOptions GetEfficiencyCoreThreadOptions(const CpuTopology& topology) {
+  if (!topology.IsHeterogeneous()) {
+    return ThreadOptions();
+  }
+  return ThreadOptions().set_cpu_set(topology.efficiency_cpus);
+}
+
+ThreadOptions GetPerformanceCoreThreadOptions() {
+  return GetPerformanceCoreThreadOptions(ReadSystemCpuTopology());
+}
+
+ThreadOptions GetEfficiencyCoreThreadOptions() {
+  return GetEfficiencyCoreThreadOptions(ReadSystemCpuTopology());
+}
+
+}  // namespace litert::lm
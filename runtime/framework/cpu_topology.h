@@ -0,0 +1,61 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_LITERT_LM_RUNTIME_FRAMEWORK_CPU_TOPOLOGY_H_
+#define THIRD_PARTY_LITERT_LM_RUNTIME_FRAMEWORK_CPU_TOPOLOGY_H_
+
+#include <set>
+
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "runtime/framework/thread_options.h"
+
+namespace litert::lm {
+
+// The online CPUs split into performance and efficiency cores, e.g. the big and
+// the LITTLE clusters of an Arm SoC.
+struct CpuTopology {
+  // The CPUs of all the clusters but the slowest one, or all the CPUs if they
+  // are all alike.
+  std::set<int> performance_cpus;
+  // The CPUs of the slowest cluster, empty if the CPUs are all alike.
+  std::set<int> efficiency_cpus;
+
+  // Whether the CPU has cores of different performance.
+  bool IsHeterogeneous() const { return !efficiency_cpus.empty(); }
+};
+
+// Reads the topology of the CPU from `sysfs_cpu_dir`. The CPUs are ranked by
+// their `cpu_capacity`, or by their `cpufreq/cpuinfo_max_freq` when the kernel
+// doesn't report capacities.
+absl::StatusOr<CpuTopology> ReadCpuTopology(
+    absl::string_view sysfs_cpu_dir = "/sys/devices/system/cpu");
+
+// Returns the options of the threads whose latency matters, i.e. the ones
+// running the model, which are pinned to the performance cores of a
+// heterogeneous CPU.
+ThreadOptions GetPerformanceCoreThreadOptions(const CpuTopology& topology);
+
+// Returns the options of the background threads, e.g. the ones running the
+// callbacks, which are kept off the performance cores of a heterogeneous CPU.
+ThreadOptions GetEfficiencyCoreThreadOptions(const CpuTopology& topology);
+
+// Same as above for the CPU running this process. The options are the default
+// ones if its topology can't be read.
+ThreadOptions GetPerformanceCoreThreadOptions();
+ThreadOptions GetEfficiencyCoreThreadOptions();
+
+}  // namespace litert::lm
+
+#endif  // THIRD_PARTY_LITERT_LM_RUNTIME_FRAMEWORK_CPU_TOPOLOGY_H_
@@ -0,0 +1,127 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/framework/cpu_topology.h"
+
+#include <filesystem>  // NOLINT(build/c++17) for std::filesystem::path
+#include <fstream>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"  // from @com_google_absl
+#include "runtime/util/test_utils.h"  // NOLINT
+
+namespace litert::lm {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+class CpuTopologyTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = std::filesystem::path(::testing::TempDir()) /
+           ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    std::filesystem::remove_all(dir_);
+    std::filesystem::create_directories(dir_);
+    // Not CPUs.
+    std::filesystem::create_directories(dir_ / "cpufreq");
+    std::filesystem::create_directories(dir_ / "cpuidle");
+  }
+
+  void WriteFile(const std::filesystem::path& path,
+                 const std::string& content) {
+    std::filesystem::create_directories((dir_ / path).parent_path());
+    std::ofstream(dir_ / path) << content << "\n";
+  }
+
+  std::filesystem::path dir_;
+};
+
+TEST_F(CpuTopologyTest, BigLittleByCapacity) {
+  for (int cpu = 0; cpu < 4; ++cpu) {
+    WriteFile("cpu" + std::to_string(cpu) + "/cpu_capacity", "325");
+  }
+  for (int cpu = 4; cpu < 7; ++cpu) {
+    WriteFile("cpu" + std::to_string(cpu) + "/cpu_capacity", "870");
+  }
+  WriteFile("cpu7/cpu_capacity", "1024");
+
+  ASSERT_OK_AND_ASSIGN(auto topology, ReadCpuTopology(dir_.string()));
+  EXPECT_TRUE(topology.IsHeterogeneous());
+  EXPECT_THAT(topology.performance_cpus, ElementsAre(4, 5, 6, 7));
+  EXPECT_THAT(topology.efficiency_cpus, ElementsAre(0, 1, 2, 3));
+  EXPECT_THAT(GetPerformanceCoreThreadOptions(topology).cpu_set(),
+              ElementsAre(4, 5, 6, 7));
+  EXPECT_THAT(GetEfficiencyCoreThreadOptions(topology).cpu_set(),
+              ElementsAre(0, 1, 2, 3));
+}
+
+TEST_F(CpuTopologyTest, BigLittleByMaxFrequency) {
+  WriteFile("cpu0/cpufreq/cpuinfo_max_freq", "1800000");
+  WriteFile("cpu1/cpufreq/cpuinfo_max_freq", "1800000");
+  WriteFile("cpu2/cpufreq/cpuinfo_max_freq", "2800000");
+  WriteFile("cpu3/cpufreq/cpuinfo_max_freq", "2800000");
+
+  ASSERT_OK_AND_ASSIGN(auto topology, ReadCpuTopology(dir_.string()));
+  EXPECT_THAT(topology.performance_cpus, ElementsAre(2, 3));
+  EXPECT_THAT(topology.efficiency_cpus, ElementsAre(0, 1));
+}
+
+TEST_F(CpuTopologyTest, SkipsOfflineCpus) {
+  WriteFile("cpu0/cpu_capacity", "512");
+  WriteFile("cpu1/cpu_capacity", "512");
+  WriteFile("cpu1/online", "0");
+  WriteFile("cpu2/cpu_capacity", "1024");
+  WriteFile("cpu2/online", "1");
+
+  ASSERT_OK_AND_ASSIGN(auto topology, ReadCpuTopology(dir_.string()));
+  EXPECT_THAT(topology.performance_cpus, ElementsAre(2));
+  EXPECT_THAT(topology.efficiency_cpus, ElementsAre(0));
+}
+
+TEST_F(CpuTopologyTest, HomogeneousCpus) {
+  for (int cpu = 0; cpu < 4; ++cpu) {
+    WriteFile("cpu" + std::to_string(cpu) + "/cpu_capacity", "1024");
+  }
+
+  ASSERT_OK_AND_ASSIGN(auto topology, ReadCpuTopology(dir_.string()));
+  EXPECT_FALSE(topology.IsHeterogeneous());
+  EXPECT_THAT(topology.performance_cpus, ElementsAre(0, 1, 2, 3));
+  EXPECT_THAT(topology.efficiency_cpus, IsEmpty());
+  // Nothing to pin.
+  EXPECT_THAT(GetPerformanceCoreThreadOptions(topology).cpu_set(), IsEmpty());
+  EXPECT_THAT(GetEfficiencyCoreThreadOptions(topology).cpu_set(), IsEmpty());
+}
+
+TEST_F(CpuTopologyTest, UnknownPerformanceIsHomogeneous) {
+  WriteFile("cpu0/cpu_capacity", "512");
+  WriteFile("cpu1/cpu_capacity", "1024");
+  std::filesystem::create_directories(dir_ / "cpu2");
+
+  ASSERT_OK_AND_ASSIGN(auto topology, ReadCpuTopology(dir_.string()));
+  EXPECT_FALSE(topology.IsHeterogeneous());
+  EXPECT_THAT(topology.performance_cpus, ElementsAre(0, 1, 2));
+}
+
+TEST_F(CpuTopologyTest, NoCpus) {
+  EXPECT_THAT(ReadCpuTopology(dir_.string()),
+              testing::status::StatusIs(absl::StatusCode::kNotFound));
+  EXPECT_THAT(ReadCpuTopology((dir_ / "missing").string()),
+              testing::status::StatusIs(absl::StatusCode::kNotFound));
+}
+
+}  // namespace
+}  // namespace litert::lm
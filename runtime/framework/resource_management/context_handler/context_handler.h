@@ -16,6 +16,7 @@
 #define THIRD_PARTY_ODML_LITERT_LM_FRAMEWORK_RESOURCE_MANAGEMENT_CONTEXT_HANDLER_CONTEXT_HANDLER_H_
 
 #include <algorithm>
+#include <cstddef>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -194,6 +195,37 @@ class ContextHandler::SharedProcessedContext {
     return std::move(processed_context_);
   }
 
+  // Returns the size in bytes of the kv-cache in the buffers of the processed
+  // context, 0 if the processed context is not set.
+  size_t GetKvCacheSizeInBytes() const {
+    absl::MutexLock lock(&processed_context_mutex_);
+    return processed_context_ == nullptr
+               ? 0
+               : processed_context_->GetKvCacheSizeInBytes();
+  }
+
+  // Moves the kv-cache of the processed context out of its buffers, see
+  // ProcessedContext::OffloadKvCache(). Returns 0 if the processed context is
+  // not set.
+  absl::StatusOr<size_t> OffloadKvCache(const KvCacheOffloadOptions& options) {
+    absl::MutexLock lock(&processed_context_mutex_);
+    if (processed_context_ == nullptr) {
+      return 0;
+    }
+    return processed_context_->OffloadKvCache(options);
+  }
+
+  // Moves the offloaded kv-cache of the processed context back into buffers,
+  // see ProcessedContext::ReloadKvCache(). Returns 0 if the processed context
+  // is not set.
+  absl::StatusOr<size_t> ReloadKvCache() {
+    absl::MutexLock lock(&processed_context_mutex_);
+    if (processed_context_ == nullptr) {
+      return 0;
+    }
+    return processed_context_->ReloadKvCache();
+  }
+
  private:
   // Handlers can be removed outside of the runner lock, so lock them
   // separately.
@@ -14,7 +14,11 @@
 
 #include "runtime/framework/resource_management/execution_manager.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <tuple>
@@ -32,8 +36,11 @@
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
 #include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "absl/time/clock.h"  // from @com_google_absl
 #include "absl/time/time.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "litert/cc/litert_environment.h"  // from @litert
 #include "litert/cc/litert_macros.h"  // from @litert
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
@@ -48,8 +55,10 @@
 #include "runtime/engine/io_types.h"
 #include "runtime/executor/audio_executor_settings.h"
 #include "runtime/executor/executor_settings_base.h"
+#include "runtime/executor/llm_context_snapshot.h"
 #include "runtime/executor/llm_executor.h"
 #include "runtime/executor/llm_executor_io_types.h"
+#include "runtime/executor/llm_executor_settings.h"
 #include "runtime/executor/vision_executor_settings.h"
 #include "runtime/framework/resource_management/resource_manager.h"
 #include "runtime/proto/token.pb.h"
@@ -59,6 +68,26 @@
 #include "runtime/util/tensor_buffer_util.h"
 
 namespace litert::lm {
+namespace {
+
+// Whether the ready task `a` is less urgent than the ready task `b`, ordering
+// the ready tasks as a max heap.
+constexpr auto kIsLessUrgent = [](const auto& a, const auto& b) {
+  if (a.priority != b.priority) {
+    return a.priority < b.priority;
+  }
+  if (a.deadline != b.deadline) {
+    return a.deadline > b.deadline;
+  }
+  return a.sequence > b.sequence;
+};
+
+// Name of the snapshot entry of the last prefill token ID of the session, the
+// same as the one SessionBasic saves.
+constexpr absl::string_view kSnapshotLastPrefillTokenId =
+    "session/last_prefill_token_id";
+
+}  // namespace
 
 // Helper macro to check if the task has been cancelled.
 #define RETURN_IF_CANCELLED(cancelled, task_id, callback)             \
@@ -70,8 +99,15 @@ namespace litert::lm {
 
 absl::StatusOr<SessionId> ExecutionManager::RegisterNewSession(
     SessionConfig session_config, std::optional<BenchmarkInfo> benchmark_info) {
+  int executor_index;
+  {
+    absl::MutexLock lock(session_and_task_lookup_mutex_);
+    executor_index = SelectExecutorIndex(session_config);
+  }
+  ResourceManager& resource_manager =
+      *executor_lanes_[executor_index]->resource_manager;
   ASSIGN_OR_RETURN(auto context_handler,
-                   resource_manager_->CreateContextHandler(session_config));
+                   resource_manager.CreateContextHandler(session_config));
   std::unique_ptr<Sampler> sampler;
   if (session_config.UseExternalSampler()) {
     if (session_config.GetSamplerBackend() != Backend::CPU) {
@@ -99,6 +135,7 @@ absl::StatusOr<SessionId> ExecutionManager::RegisterNewSession(
       .sampler = std::move(sampler),
       .stop_token_detector = std::move(stop_token_detector),
       .benchmark_info = std::move(benchmark_info),
+      .executor_index = executor_index,
   });
   {
     absl::MutexLock lock(session_and_task_lookup_mutex_);
@@ -107,16 +144,53 @@ absl::StatusOr<SessionId> ExecutionManager::RegisterNewSession(
           "Session ", session_id, " already exists in session list."));
     }
     if (session_info->session_config.AudioModalityEnabled()) {
-      RETURN_IF_ERROR(resource_manager_->TryLoadingAudioExecutor());
+      RETURN_IF_ERROR(resource_manager.TryLoadingAudioExecutor());
     }
     if (session_info->session_config.VisionModalityEnabled()) {
-      RETURN_IF_ERROR(resource_manager_->TryLoadingVisionExecutor());
+      RETURN_IF_ERROR(resource_manager.TryLoadingVisionExecutor());
     }
     session_lookup_.insert({session_id, std::move(session_info)});
   }
   return session_id;
 }
 
+int ExecutionManager::SelectExecutorIndex(const SessionConfig& session_config) {
+  if (executor_lanes_.size() == 1 || session_config.AudioModalityEnabled() ||
+      session_config.VisionModalityEnabled()) {
+    return 0;
+  }
+  // The number of sessions with active tasks, and the number of sessions, per
+  // executor.
+  std::vector<std::pair<int, int>> loads(executor_lanes_.size());
+  for (const auto& [session_id, session_info] : session_lookup_) {
+    auto& [num_busy_sessions, num_sessions] =
+        loads[session_info->executor_index];
+    if (!session_info->active_tasks.empty()) {
+      ++num_busy_sessions;
+    }
+    ++num_sessions;
+  }
+  return std::min_element(loads.begin(), loads.end()) - loads.begin();
+}
+
+ContextSwitchStats ExecutionManager::GetContextSwitchStats() {
+  ContextSwitchStats stats;
+  for (const auto& lane : executor_lanes_) {
+    const ContextSwitchStats lane_stats =
+        lane->resource_manager->GetContextSwitchStats();
+    stats.num_context_switches += lane_stats.num_context_switches;
+    stats.num_zero_copy_switches += lane_stats.num_zero_copy_switches;
+    stats.num_bytes_copied += lane_stats.num_bytes_copied;
+    stats.total_duration += lane_stats.total_duration;
+    stats.max_duration = std::max(stats.max_duration, lane_stats.max_duration);
+    stats.num_kv_cache_offloads += lane_stats.num_kv_cache_offloads;
+    stats.num_kv_cache_reloads += lane_stats.num_kv_cache_reloads;
+    stats.num_kv_cache_bytes_offloaded +=
+        lane_stats.num_kv_cache_bytes_offloaded;
+  }
+  return stats;
+}
+
 absl::Status ExecutionManager::CancelAllTasksInSession(SessionId session_id) {
   absl::MutexLock lock(session_and_task_lookup_mutex_);
   if (!session_lookup_.contains(session_id)) {
@@ -153,6 +227,54 @@ absl::StatusOr<BenchmarkInfo*> ExecutionManager::GetMutableBenchmarkInfo(
   return &session_lookup_.at(session_id)->benchmark_info.value();
 }
 
+absl::StatusOr<uint64_t> ExecutionManager::GetModelFingerprint(
+    SessionId session_id) {
+  ASSIGN_OR_RETURN(auto session_info, GetSessionInfo(session_id));
+  ASSIGN_OR_RETURN(auto llm_executor,
+                   GetResourceManager(*session_info).AcquireExecutor());
+  ASSIGN_OR_RETURN(auto executor_settings, llm_executor->GetExecutorSettings());
+  return ComputeModelFingerprint(executor_settings.GetModelAssets());
+}
+
+absl::Status ExecutionManager::SaveSessionSnapshot(
+    SessionId session_id, LlmContextSnapshotWriter& writer) {
+  ASSIGN_OR_RETURN(auto session_info, GetSessionInfo(session_id));
+  ASSIGN_OR_RETURN(
+      auto llm_executor,
+      GetResourceManager(*session_info)
+          .AcquireExecutorWithContextHandler(session_info->context_handler));
+  RETURN_IF_ERROR(llm_executor->SaveContextSnapshot(writer));
+  return writer.AddValues<int>(
+      kSnapshotLastPrefillTokenId,
+      absl::MakeConstSpan(&session_info->last_prefill_token_id, 1));
+}
+
+absl::Status ExecutionManager::LoadSessionSnapshot(
+    SessionId session_id, std::shared_ptr<LlmContextSnapshot> snapshot) {
+  RET_CHECK_NE(snapshot, nullptr);
+  ASSIGN_OR_RETURN(std::vector<int> last_prefill_token_id,
+                   snapshot->ReadValues<int>(kSnapshotLastPrefillTokenId));
+  if (last_prefill_token_id.size() != 1) {
+    return absl::DataLossError(
+        "Invalid last prefill token ID in the session snapshot.");
+  }
+  ASSIGN_OR_RETURN(auto session_info, GetSessionInfo(session_id));
+  ASSIGN_OR_RETURN(
+      auto llm_executor,
+      GetResourceManager(*session_info)
+          .AcquireExecutorWithContextHandler(session_info->context_handler));
+  RETURN_IF_ERROR(llm_executor->LoadContextSnapshot(std::move(snapshot)));
+
+  absl::MutexLock lock(session_and_task_lookup_mutex_);
+  if (!session_lookup_.contains(session_id)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Session ", session_id, " not found in session list."));
+  }
+  session_lookup_.at(session_id)->last_prefill_token_id =
+      last_prefill_token_id[0];
+  return absl::OkStatus();
+}
+
 absl::StatusOr<TaskId> ExecutionManager::GetNewTaskId() {
   return next_task_id_.fetch_add(1);
 }
@@ -270,14 +392,18 @@ absl::Status ExecutionManager::QueueTask(TaskId task_id) {
     return error_status;
   }
 
+  const SessionId session_id = task_lookup_.at(task_id).session_id;
+  if (!session_lookup_.contains(session_id)) {
+    auto error_status = absl::InvalidArgumentError(
+        absl::StrCat("Session ", session_id, " not found in session list."));
+    task_lookup_.at(task_id).callback(error_status);
+    return error_status;
+  }
+
   auto task = std::move(task_lookup_.at(task_id).task);
 
-  if (execution_thread_pool_ != nullptr) {
-    RETURN_IF_ERROR(execution_thread_pool_->Schedule(std::move(task)));
-  } else {
-    ABSL_LOG(ERROR) << "Execution thread pool is null, skipping task: "
-                    << task_id;
-  }
+  RETURN_IF_ERROR(
+      ScheduleReadyTask(*session_lookup_.at(session_id), std::move(task)));
 
   task_lookup_.at(task_id).callback(Responses(TaskState::kQueued));
   RETURN_IF_ERROR(UpdateTaskState(task_id, TaskState::kQueued));
@@ -285,6 +411,51 @@ absl::Status ExecutionManager::QueueTask(TaskId task_id) {
   return absl::OkStatus();
 }
 
+absl::Status ExecutionManager::ScheduleReadyTask(
+    const SessionInfo& session_info, absl::AnyInvocable<void()> task) {
+  const SessionConfig& session_config = session_info.session_config;
+  ExecutorLane& lane = GetExecutorLane(session_info);
+  {
+    absl::MutexLock lock(lane.ready_tasks_mutex);
+    lane.ready_tasks.push_back(ReadyTask{
+        .priority = session_config.GetPriority(),
+        .deadline = session_config.GetTaskDeadline().has_value()
+                        ? absl::Now() + *session_config.GetTaskDeadline()
+                        : absl::InfiniteFuture(),
+        .sequence = lane.next_ready_task_sequence++,
+        .task = std::move(task),
+    });
+    std::push_heap(lane.ready_tasks.begin(), lane.ready_tasks.end(),
+                   kIsLessUrgent);
+  }
+  // Every run picks the most urgent ready task at the time it starts, so there
+  // is exactly one run scheduled per ready task.
+  return lane.execution_thread_pool->Schedule(
+      [this, &lane]() { RunNextReadyTask(lane); });
+}
+
+void ExecutionManager::RunNextReadyTask(ExecutorLane& lane) {
+  absl::AnyInvocable<void()> task;
+  {
+    absl::MutexLock lock(lane.ready_tasks_mutex);
+    if (lane.ready_tasks.empty()) {
+      ABSL_LOG(ERROR) << "No ready task to run.";
+      return;
+    }
+    std::pop_heap(lane.ready_tasks.begin(), lane.ready_tasks.end(),
+                  kIsLessUrgent);
+    task = std::move(lane.ready_tasks.back().task);
+    lane.ready_tasks.pop_back();
+  }
+  task();
+}
+
+bool ExecutionManager::HasReadyTasks(const SessionInfo& session_info) {
+  ExecutorLane& lane = GetExecutorLane(session_info);
+  absl::MutexLock lock(lane.ready_tasks_mutex);
+  return !lane.ready_tasks.empty();
+}
+
 absl::StatusOr<
     std::tuple<std::shared_ptr<SessionInfo>, std::shared_ptr<std::atomic<bool>>,
                absl::AnyInvocable<void(absl::StatusOr<Responses>)>>>
@@ -528,8 +699,10 @@ absl::StatusOr<ExecutorInputs> ExecutionManager::ProcessAndCombineContents(
       if (benchmark_info.has_value()) {
         RETURN_IF_ERROR(benchmark_info->TimeMarkDelta("vision_executor"));
       }
-      ASSIGN_OR_RETURN(auto vision_executor,
-                       resource_manager_->AcquireVisionExecutor());
+      // Only the first executor of the pool has a vision executor.
+      ASSIGN_OR_RETURN(
+          auto vision_executor,
+          executor_lanes_.front()->resource_manager->AcquireVisionExecutor());
       ASSIGN_OR_RETURN(auto single_image_data,
                        vision_executor->Encode(*image_tensor));
       if (benchmark_info.has_value()) {
@@ -550,8 +723,10 @@ absl::StatusOr<ExecutorInputs> ExecutionManager::ProcessAndCombineContents(
       if (benchmark_info.has_value()) {
         RETURN_IF_ERROR(benchmark_info->TimeMarkDelta("audio_executor"));
       }
-      ASSIGN_OR_RETURN(auto audio_executor,
-                       resource_manager_->AcquireAudioExecutor());
+      // Only the first executor of the pool has an audio executor.
+      ASSIGN_OR_RETURN(
+          auto audio_executor,
+          executor_lanes_.front()->resource_manager->AcquireAudioExecutor());
       ASSIGN_OR_RETURN(auto single_audio_data,
                        audio_executor->Encode(*spectrogram_tensor));
       if (benchmark_info.has_value()) {
@@ -586,8 +761,6 @@ absl::StatusOr<ExecutorInputs> ExecutionManager::ProcessAndCombineContents(
                      CombineExecutorAudioData(all_audio_data));
   }
 
-  last_prefill_token_id_ = combined_token_ids.back();
-
   ASSIGN_OR_RETURN(auto token_ids_buffer,
                    tokenizer_->TokenIdsToTensorBuffer(combined_token_ids));
 
@@ -597,6 +770,15 @@ absl::StatusOr<ExecutorInputs> ExecutionManager::ProcessAndCombineContents(
   return inputs;
 }
 
+absl::StatusOr<int> ExecutionManager::AttachToCachedPrefix(
+    const SessionInfo& session_info, const ExecutorInputs& inputs) {
+  ASSIGN_OR_RETURN(auto* token_ids, inputs.GetTextTokenIdsPtr());
+  LITERT_ASSIGN_OR_RETURN(auto token_ids_vec,
+                          CopyFromTensorBuffer<int32_t>(*token_ids));
+  return GetResourceManager(session_info)
+      .AttachToCachedPrefix(session_info.context_handler, token_ids_vec);
+}
+
 absl::StatusOr<std::unique_ptr<ExecutionManager>> ExecutionManager::Create(
     Tokenizer* absl_nonnull tokenizer,
     ModelResources* absl_nullable model_resources,
@@ -605,15 +787,57 @@ absl::StatusOr<std::unique_ptr<ExecutionManager>> ExecutionManager::Create(
     vision_executor_settings,
     std::unique_ptr<AudioExecutorSettings> absl_nullable
     audio_executor_settings,
-    ::litert::Environment* absl_nullable litert_env) {
+    ::litert::Environment* absl_nullable litert_env,
+    std::vector<std::unique_ptr<LlmExecutor>> additional_llm_executors) {
   std::unique_ptr<Sampler> sampler;
+  // Not all the executors expose their settings, those run every decode to
+  // completion.
+  int decode_quantum_tokens = 0;
+  int num_prefill_tokens_per_turn = 0;
+  int prefill_chunk_size = 0;
+  bool pin_threads_to_performance_cores = false;
+  auto executor_settings = llm_executor->GetExecutorSettings();
+  if (executor_settings.ok() &&
+      executor_settings->GetAdvancedSettings().has_value()) {
+    decode_quantum_tokens =
+        executor_settings->GetAdvancedSettings()->decode_quantum_tokens;
+    num_prefill_tokens_per_turn =
+        executor_settings->GetAdvancedSettings()->num_prefill_tokens_per_turn;
+    pin_threads_to_performance_cores =
+        executor_settings->GetAdvancedSettings()
+            ->pin_threads_to_performance_cores;
+  }
+  if (executor_settings.ok() &&
+      executor_settings->GetBackend() == Backend::CPU) {
+    auto cpu_config = executor_settings->GetBackendConfig<CpuConfig>();
+    if (cpu_config.ok()) {
+      prefill_chunk_size = std::max(cpu_config->prefill_chunk_size, 0);
+    }
+  }
+  std::vector<std::unique_ptr<ResourceManager>> resource_managers;
   ASSIGN_OR_RETURN(
       auto resource_manager,
       ResourceManager::Create(model_resources, std::move(llm_executor),
                               std::move(vision_executor_settings),
                               std::move(audio_executor_settings), litert_env));
-  return absl::WrapUnique(
-      new ExecutionManager(tokenizer, std::move(resource_manager), litert_env));
+  resource_managers.push_back(std::move(resource_manager));
+  for (auto& additional_llm_executor : additional_llm_executors) {
+    ASSIGN_OR_RETURN(
+        auto additional_resource_manager,
+        ResourceManager::Create(model_resources,
+                                std::move(additional_llm_executor),
+                                /*vision_executor_settings=*/nullptr,
+                                /*audio_executor_settings=*/nullptr,
+                                litert_env));
+    resource_managers.push_back(std::move(additional_resource_manager));
+  }
+  return absl::WrapUnique(new ExecutionManager(tokenizer,
+                                              std::move(resource_managers),
+                                              litert_env,
+                                              decode_quantum_tokens,
+                                              num_prefill_tokens_per_turn,
+                                              prefill_chunk_size,
+                                              pin_threads_to_performance_cores));
 }
 
 absl::Status ExecutionManager::WaitUntilDone(TaskId task_id,
@@ -650,7 +874,12 @@ absl::Status ExecutionManager::WaitUntilSessionDone(SessionId session_id,
 }
 
 absl::Status ExecutionManager::WaitUntilAllDone(absl::Duration timeout) {
-  return execution_thread_pool_->WaitUntilDone(timeout);
+  const absl::Time deadline = absl::Now() + timeout;
+  for (auto& lane : executor_lanes_) {
+    RETURN_IF_ERROR(
+        lane->execution_thread_pool->WaitUntilDone(deadline - absl::Now()));
+  }
+  return absl::OkStatus();
 }
 
 absl::Status ExecutionManager::AddPrefillTask(
@@ -678,10 +907,44 @@ absl::Status ExecutionManager::AddPrefillTask(
 
     RETURN_IF_CANCELLED(cancelled, task_id, callback);
 
+    // Text only inputs do not depend on the loaded context, so they are
+    // combined before acquiring the executor, which lets a session that has
+    // not processed anything yet attach to a prefix cached by another session
+    // of the same executor.
+    // Sessions with a LoRA are excluded as the cached prefixes are computed
+    // with the base model.
+    const bool text_only =
+        std::all_of(inputs.begin(), inputs.end(), [](const InputData& input) {
+          return std::holds_alternative<InputText>(input);
+        });
+    const bool use_prefix_cache =
+        GetResourceManager(*session_info).HasPrefixCache() &&
+        session_info->session_config.GetScopedLoraFile() == nullptr &&
+        text_only;
+    std::optional<ExecutorInputs> executor_inputs;
+    int num_reused_tokens = 0;
+    if (use_prefix_cache) {
+      auto text_inputs =
+          ProcessAndCombineContents(inputs, session_info->benchmark_info);
+      if (!text_inputs.ok()) {
+        FinishTaskAndLogErrors(task_id, text_inputs.status(),
+                               std::move(callback));
+        return;
+      }
+      auto attached = AttachToCachedPrefix(*session_info, *text_inputs);
+      if (!attached.ok()) {
+        FinishTaskAndLogErrors(task_id, attached.status(), std::move(callback));
+        return;
+      }
+      num_reused_tokens = *attached;
+      executor_inputs = std::move(*text_inputs);
+    }
+
     // Note AcquireExecutorWithContextHandler include context switching logic,
     // so it should be called before any executor running.
-    auto llm_executor = resource_manager_->AcquireExecutorWithContextHandler(
-        session_info->context_handler);
+    auto llm_executor =
+        GetResourceManager(*session_info)
+            .AcquireExecutorWithContextHandler(session_info->context_handler);
     if (!llm_executor.ok()) {
       FinishTaskAndLogErrors(task_id, llm_executor.status(),
                              std::move(callback));
@@ -690,16 +953,69 @@ absl::Status ExecutionManager::AddPrefillTask(
 
     RETURN_IF_CANCELLED(cancelled, task_id, callback);
 
-    auto executor_inputs =
-        ProcessAndCombineContents(inputs, session_info->benchmark_info);
-    if (!executor_inputs.ok()) {
-      FinishTaskAndLogErrors(task_id, executor_inputs.status(),
-                             std::move(callback));
-      return;
+    if (!executor_inputs.has_value()) {
+      auto combined_inputs =
+          ProcessAndCombineContents(inputs, session_info->benchmark_info);
+      if (!combined_inputs.ok()) {
+        FinishTaskAndLogErrors(task_id, combined_inputs.status(),
+                               std::move(callback));
+        return;
+      }
+      executor_inputs = std::move(*combined_inputs);
     }
 
     RETURN_IF_CANCELLED(cancelled, task_id, callback);
 
+    // Only prefills starting from an empty context produce a prefix that
+    // other sessions can share.
+    int start_step = -1;
+    if (use_prefix_cache) {
+      auto current_step = llm_executor.value()->GetCurrentStep();
+      if (!current_step.ok()) {
+        FinishTaskAndLogErrors(task_id, current_step.status(),
+                               std::move(callback));
+        return;
+      }
+      start_step = *current_step;
+    }
+
+    // Long text prefills run in turns, so that the more urgent tasks of the
+    // other sessions, e.g. the decode steps of an interactive session, don't
+    // wait for the whole prefill.
+    const int num_prefill_tokens_per_turn =
+        GetNumPrefillTokensPerTurn(*session_info);
+    if (text_only && num_prefill_tokens_per_turn > 0) {
+      auto token_ids = executor_inputs->GetTextTokenIdsPtr();
+      if (!token_ids.ok()) {
+        FinishTaskAndLogErrors(task_id, token_ids.status(),
+                               std::move(callback));
+        return;
+      }
+      auto token_ids_vec = CopyFromTensorBuffer<int32_t>(**token_ids);
+      if (!token_ids_vec.HasValue()) {
+        FinishTaskAndLogErrors(
+            task_id, absl::InternalError(token_ids_vec.Error().Message()),
+            std::move(callback));
+        return;
+      }
+      if (token_ids_vec->size() >
+          static_cast<size_t>(num_prefill_tokens_per_turn)) {
+        auto state = std::make_shared<PrefillTaskState>();
+        state->num_tokens_per_turn = num_prefill_tokens_per_turn;
+        state->session_info = std::move(session_info);
+        state->cancelled = std::move(cancelled);
+        state->callback = std::move(callback);
+        state->token_ids.assign(token_ids_vec->begin(), token_ids_vec->end());
+        state->start_step = start_step;
+        state->num_reused_tokens = num_reused_tokens;
+        // The first turn acquires the executor again, which doesn't switch the
+        // context.
+        llm_executor.value().reset();
+        RunPrefillTurn(task_id, std::move(state));
+        return;
+      }
+    }
+
     auto responses =
         Tasks::Prefill(*llm_executor.value(), *executor_inputs,
                        /*wait_for_completion=*/true,
@@ -712,23 +1028,12 @@ absl::Status ExecutionManager::AddPrefillTask(
     if (cancelled != nullptr && cancelled->load()) {
       responses = Responses(TaskState::kCancelled);
     } else {
-      // Keep track of the last_prefill_token_id after prefill is done.
-      auto processed_tokens = llm_executor.value()->GetProcessedTokens();
-      if (!processed_tokens.ok()) {
-        FinishTaskAndLogErrors(task_id, processed_tokens.status(),
-                               std::move(callback));
-        return;
-      }
-      auto current_step = llm_executor.value()->GetCurrentStep();
-      if (!current_step.ok()) {
-        FinishTaskAndLogErrors(task_id, current_step.status(),
-                               std::move(callback));
+      auto status = CompletePrefill(*session_info, std::move(*llm_executor),
+                                    start_step, num_reused_tokens);
+      if (!status.ok()) {
+        FinishTaskAndLogErrors(task_id, status, std::move(callback));
         return;
       }
-      session_info->last_prefill_token_id =
-          processed_tokens.value()
-              ->GetTokenAtStep(current_step.value() - 1)
-              .at(0);
     }
 
     FinishTaskAndLogErrors(task_id, std::move(responses), std::move(callback));
@@ -739,6 +1044,148 @@ absl::Status ExecutionManager::AddPrefillTask(
                     cancelled, std::move(callback));
 }
 
+absl::Status ExecutionManager::CompletePrefill(
+    SessionInfo& session_info, std::unique_ptr<LlmExecutor> llm_executor,
+    int start_step, int num_reused_tokens) {
+  // Keep track of the last_prefill_token_id after prefill is done.
+  ASSIGN_OR_RETURN(auto processed_tokens, llm_executor->GetProcessedTokens());
+  ASSIGN_OR_RETURN(int current_step, llm_executor->GetCurrentStep());
+  session_info.last_prefill_token_id =
+      processed_tokens->GetTokenAtStep(current_step - 1).at(0);
+
+  if (start_step == 0 && current_step > num_reused_tokens) {
+    std::vector<int> prefix_token_ids = processed_tokens->GetCopyOfTokens()[0];
+    prefix_token_ids.resize(current_step);
+    // Release the executor first, caching the prefix clones the handler which
+    // needs the executor lock.
+    llm_executor.reset();
+    // The prefix cache is an optimization, failing to populate it does not
+    // fail the prefill.
+    auto status = GetResourceManager(session_info)
+                      .CachePrefix(session_info.context_handler,
+                                   prefix_token_ids);
+    if (!status.ok()) {
+      ABSL_LOG(WARNING) << "Failed to cache the prefix: " << status;
+    }
+  }
+  return absl::OkStatus();
+}
+
+int ExecutionManager::GetNumPrefillTokensPerTurn(
+    const SessionInfo& session_info) const {
+  const int num_tokens =
+      session_info.session_config.GetPrefillQuantum().value_or(
+          num_prefill_tokens_per_turn_);
+  if (num_tokens <= 0 || prefill_chunk_size_ <= 0) {
+    return std::max(num_tokens, 0);
+  }
+  // Turns of whole chunks don't leave the executor a partial chunk to run at
+  // the end of every turn.
+  return (num_tokens + prefill_chunk_size_ - 1) / prefill_chunk_size_ *
+         prefill_chunk_size_;
+}
+
+struct ExecutionManager::PrefillTaskState {
+  std::shared_ptr<SessionInfo> session_info;
+  std::shared_ptr<std::atomic<bool>> cancelled;
+  absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback;
+  // The text tokens to prefill, and the index of the first one not prefilled
+  // yet.
+  std::vector<int> token_ids;
+  int next_token_index = 0;
+  // The maximum number of tokens prefilled per turn.
+  int num_tokens_per_turn = 0;
+  int start_step = -1;
+  int num_reused_tokens = 0;
+};
+
+void ExecutionManager::RunPrefillTurn(
+    TaskId task_id, std::shared_ptr<PrefillTaskState> state) {
+  RETURN_IF_CANCELLED(state->cancelled, task_id, state->callback);
+
+  auto llm_executor =
+      GetResourceManager(*state->session_info)
+          .AcquireExecutorWithContextHandler(
+              state->session_info->context_handler);
+  if (!llm_executor.ok()) {
+    FinishTaskAndLogErrors(task_id, llm_executor.status(),
+                           std::move(state->callback));
+    return;
+  }
+
+  const int num_tokens = state->token_ids.size();
+  if (state->next_token_index == 0) {
+    // The whole input is checked against the context size up front, rather
+    // than failing half way through the prefill.
+    auto settings = llm_executor.value()->GetExecutorSettings();
+    const int max_num_tokens =
+        settings.ok() ? settings->GetMaxNumTokens()
+                      : std::numeric_limits<int>::max();
+    if (num_tokens >= max_num_tokens) {
+      FinishTaskAndLogErrors(
+          task_id,
+          absl::InvalidArgumentError(absl::StrCat(
+              "Input token ids are too long. Exceeding the maximum number of "
+              "tokens allowed: ",
+              num_tokens, " >= ", max_num_tokens)),
+          std::move(state->callback));
+      return;
+    }
+  }
+
+  const int end_token_index = std::min(
+      num_tokens, state->next_token_index + state->num_tokens_per_turn);
+  auto token_ids_buffer = tokenizer_->TokenIdsToTensorBuffer(
+      std::vector<int>(state->token_ids.begin() + state->next_token_index,
+                       state->token_ids.begin() + end_token_index));
+  if (!token_ids_buffer.ok()) {
+    FinishTaskAndLogErrors(task_id, token_ids_buffer.status(),
+                           std::move(state->callback));
+    return;
+  }
+  ExecutorInputs inputs(ExecutorTextData(std::move(*token_ids_buffer)),
+                        std::nullopt, std::nullopt);
+  auto responses =
+      Tasks::Prefill(*llm_executor.value(), inputs,
+                     /*wait_for_completion=*/true,
+                     /*benchmark_info=*/state->session_info->benchmark_info);
+  if (!responses.ok()) {
+    FinishTaskAndLogErrors(task_id, responses.status(),
+                           std::move(state->callback));
+    return;
+  }
+  state->next_token_index = end_token_index;
+
+  if (state->next_token_index < num_tokens) {
+    // The executor is released so that the tasks of other sessions can
+    // acquire it with their own context.
+    llm_executor.value().reset();
+    auto status = ScheduleReadyTask(
+        *state->session_info, [this, task_id, state]() mutable {
+          RunPrefillTurn(task_id, std::move(state));
+        });
+    if (status.ok()) {
+      return;
+    }
+    FinishTaskAndLogErrors(task_id, status, std::move(state->callback));
+    return;
+  }
+
+  if (state->cancelled != nullptr && state->cancelled->load()) {
+    responses = Responses(TaskState::kCancelled);
+  } else {
+    auto status =
+        CompletePrefill(*state->session_info, std::move(*llm_executor),
+                        state->start_step, state->num_reused_tokens);
+    if (!status.ok()) {
+      FinishTaskAndLogErrors(task_id, status, std::move(state->callback));
+      return;
+    }
+  }
+  FinishTaskAndLogErrors(task_id, std::move(responses),
+                         std::move(state->callback));
+}
+
 absl::Status ExecutionManager::AddDecodeTask(
     SessionId session_id, TaskId task_id, absl::flat_hash_set<TaskId> dep_tasks,
     Constraint* absl_nullable constraint,
@@ -766,16 +1213,6 @@ absl::Status ExecutionManager::AddDecodeTask(
 
     RETURN_IF_CANCELLED(cancelled, task_id, callback);
 
-    auto llm_executor = resource_manager_->AcquireExecutorWithContextHandler(
-        session_info->context_handler);
-    if (!llm_executor.ok()) {
-      FinishTaskAndLogErrors(task_id, llm_executor.status(),
-                             std::move(callback));
-      return;
-    }
-
-    RETURN_IF_CANCELLED(cancelled, task_id, callback);
-
     auto num_output_candidates =
         session_info->session_config.GetNumOutputCandidates();
     session_info->stop_token_detector->ResetBatch(num_output_candidates);
@@ -794,25 +1231,105 @@ absl::Status ExecutionManager::AddDecodeTask(
       decoded_ids_buffer = std::move(decoded_ids_buffer_or.Value());
     }
 
-    auto responses = Tasks::Decode(
-        *llm_executor.value(), *tokenizer_, *session_info->stop_token_detector,
-        num_output_candidates, session_info->benchmark_info, optional_sampler,
-        constraint, std::move(decoded_ids_buffer), callback, cancelled.get(),
-        max_output_tokens);
-    if (!responses.ok() && absl::IsCancelled(responses.status())) {
-      responses = Responses(TaskState::kCancelled);
+    // The incremental decode keeps references to the session info and the
+    // callback, which are owned by the state and outlive it.
+    auto state = std::make_shared<DecodeTaskState>();
+    state->session_info = std::move(session_info);
+    state->cancelled = std::move(cancelled);
+    state->callback = std::move(callback);
+    state->decode = std::make_unique<Tasks::IncrementalDecode>(
+        *tokenizer_, *state->session_info->stop_token_detector,
+        num_output_candidates, state->session_info->benchmark_info,
+        optional_sampler, constraint, std::move(decoded_ids_buffer),
+        state->callback, state->cancelled.get(), max_output_tokens);
+    RunDecodeTurn(task_id, std::move(state));
+  };
+
+  return CreateTask(session_id, task_id, std::move(task), std::move(dep_tasks),
+                    cancelled, std::move(callback));
+}
+
+struct ExecutionManager::DecodeTaskState {
+  std::shared_ptr<SessionInfo> session_info;
+  std::shared_ptr<std::atomic<bool>> cancelled;
+  absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback;
+  std::unique_ptr<Tasks::IncrementalDecode> decode;
+};
+
+void ExecutionManager::RunDecodeTurn(TaskId task_id,
+                                     std::shared_ptr<DecodeTaskState> state) {
+  SessionInfo& session_info = *state->session_info;
+  const int quantum = session_info.session_config.GetDecodeQuantum().value_or(
+      decode_quantum_tokens_);
+  const int step_cost = session_info.session_config.GetNumOutputCandidates();
+  if (quantum > 0) {
+    session_info.decode_deficit += quantum;
+  }
+
+  // A session whose deficit doesn't afford a decode step yet skips the turn,
+  // without switching the context.
+  absl::StatusOr<std::optional<Responses>> turn_responses = std::nullopt;
+  if (quantum <= 0 || session_info.decode_deficit >= step_cost) {
+    auto llm_executor =
+        GetResourceManager(session_info)
+            .AcquireExecutorWithContextHandler(session_info.context_handler);
+    if (!llm_executor.ok()) {
+      session_info.decode_deficit = 0;
+      FinishTaskAndLogErrors(task_id, llm_executor.status(),
+                             std::move(state->callback));
+      return;
     }
+    while (true) {
+      const int max_num_steps = quantum > 0
+                                    ? session_info.decode_deficit / step_cost
+                                    : std::numeric_limits<int>::max();
+      const int num_steps_before = state->decode->num_decode_steps();
+      turn_responses =
+          state->decode->Run(*llm_executor.value(), max_num_steps);
+      if (quantum <= 0 || !turn_responses.ok() ||
+          turn_responses->has_value()) {
+        break;
+      }
+      session_info.decode_deficit -=
+          (state->decode->num_decode_steps() - num_steps_before) * step_cost;
+      if (HasReadyTasks(session_info)) {
+        break;
+      }
+      // No other task is waiting for the executor, start the next round right
+      // away.
+      session_info.decode_deficit += quantum;
+    }
+    // The executor is released here so that the tasks queued in the meantime
+    // can acquire it with their own context.
+  }
 
-    if (cancelled != nullptr && cancelled->load()) {
-      responses = Responses(TaskState::kCancelled);
+  if (turn_responses.ok() && !turn_responses->has_value()) {
+    auto status = ScheduleReadyTask(
+        *state->session_info, [this, task_id, state]() mutable {
+          RunDecodeTurn(task_id, std::move(state));
+        });
+    if (status.ok()) {
+      return;
     }
+    turn_responses = status;
+  }
 
-    FinishTaskAndLogErrors(task_id, std::move(responses), std::move(callback));
-    return;
-  };
+  // The deficit isn't carried over to the next decode of the session.
+  session_info.decode_deficit = 0;
+  absl::StatusOr<Responses> responses = turn_responses.status();
+  if (turn_responses.ok()) {
+    responses = std::move(**turn_responses);
+  }
+  if (!responses.ok() && absl::IsCancelled(responses.status())) {
+    responses = Responses(TaskState::kCancelled);
+  }
 
-  return CreateTask(session_id, task_id, std::move(task), std::move(dep_tasks),
-                    cancelled, std::move(callback));
+  if (state->cancelled != nullptr && state->cancelled->load()) {
+    responses = Responses(TaskState::kCancelled);
+  }
+
+  FinishTaskAndLogErrors(task_id, std::move(responses),
+                         std::move(state->callback));
 }
 
 absl::Status ExecutionManager::AddCloneSessionTask(
@@ -853,8 +1370,9 @@ absl::Status ExecutionManager::AddCloneSessionTask(
         original_session_info = session_lookup_.at(session_id);
       }
 
-      auto cloned_context_handler_or = resource_manager_->CloneContextHandler(
-          original_session_info->context_handler);
+      auto cloned_context_handler_or =
+          GetResourceManager(*original_session_info)
+              .CloneContextHandler(original_session_info->context_handler);
       if (!cloned_context_handler_or.ok()) {
         result = cloned_context_handler_or.status();
         return;
@@ -894,6 +1412,10 @@ absl::Status ExecutionManager::AddCloneSessionTask(
         }
         session_lookup_.at(cloned_session_id)->session_config =
             original_session_info->session_config;
+        // The clone shares the processed context of the original session,
+        // which lives on the executor of the original session.
+        session_lookup_.at(cloned_session_id)->executor_index =
+            original_session_info->executor_index;
         session_lookup_.at(cloned_session_id)->context_handler =
             std::move(cloned_context_handler_or.value());
         session_lookup_.at(cloned_session_id)->sampler =
@@ -945,8 +1467,9 @@ absl::Status ExecutionManager::AddTextScoringTask(
 
     RETURN_IF_CANCELLED(cancelled, task_id, callback);
 
-    auto llm_executor = resource_manager_->AcquireExecutorWithContextHandler(
-        session_info->context_handler);
+    auto llm_executor =
+        GetResourceManager(*session_info)
+            .AcquireExecutorWithContextHandler(session_info->context_handler);
     if (!llm_executor.ok()) {
       FinishTaskAndLogErrors(task_id, llm_executor.status(),
                              std::move(callback));
@@ -955,26 +1478,17 @@ absl::Status ExecutionManager::AddTextScoringTask(
 
     RETURN_IF_CANCELLED(cancelled, task_id, callback);
 
-    const int num_output_candidates =
-        session_info->session_config.GetNumOutputCandidates();
-    std::vector<int> decoded_ids(num_output_candidates,
-                                 session_info->last_prefill_token_id);
-    auto decoded_ids_buffer =
-        CopyToTensorBuffer<int>(decoded_ids, {num_output_candidates, 1});
-    if (!decoded_ids_buffer.HasValue()) {
-      FinishTaskAndLogErrors(
-          task_id, absl::InternalError(decoded_ids_buffer.Error().Message()),
-          std::move(callback));
-      return;
-    }
-
     // TODO(b/435040163): Handle the temperature. Should it be calculated from
     // the sampler or the sampler parameters? For now, hardcode it to 1.0f for
     // testing.
     auto temperature = 1.0f;
-    auto responses = Tasks::Score(
+    // Targets beyond the batch size are scored in further batches from the
+    // same prefilled context, and the scores of every batch are streamed.
+    auto responses = Tasks::ScoreCandidates(
         *llm_executor.value(), *tokenizer_, target_text, temperature,
-        std::move(decoded_ids_buffer.Value()), store_token_lengths);
+        session_info->last_prefill_token_id,
+        session_info->session_config.GetNumOutputCandidates(),
+        store_token_lengths, callback, cancelled.get());
 
     if (cancelled != nullptr && cancelled->load()) {
       responses = Responses(TaskState::kCancelled);
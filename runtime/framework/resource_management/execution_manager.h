@@ -16,6 +16,7 @@
 #define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_FRAMEWORK_RESOURCE_MANAGEMENT_EXECUTION_MANAGER_H_
 
 #include <atomic>
+#include <cstdint>
 #include <limits>
 #include <memory>
 #include <optional>
@@ -43,11 +44,14 @@
 #include "runtime/engine/engine_settings.h"
 #include "runtime/engine/io_types.h"
 #include "runtime/executor/audio_executor_settings.h"
+#include "runtime/executor/llm_context_snapshot.h"
 #include "runtime/executor/llm_executor.h"
 #include "runtime/executor/llm_executor_io_types.h"
 #include "runtime/executor/vision_executor_settings.h"
+#include "runtime/framework/cpu_topology.h"
 #include "runtime/framework/resource_management/context_handler/context_handler.h"
 #include "runtime/framework/resource_management/resource_manager.h"
+#include "runtime/framework/thread_options.h"
 #include "runtime/framework/threadpool.h"
 
 namespace litert::lm {
@@ -63,6 +67,10 @@ using TaskId = int;
 // - stop_token_detector: The stop token detector of the session.
 // - benchmark_info: The benchmark info of the session.
 // - active_tasks: The active tasks of the session.
+// - decode_deficit: The number of tokens the session may still decode in the
+//   current round of the deficit round robin among the decoding sessions.
+// - executor_index: The index of the executor of the pool the session runs on.
+//   The session stays on it since its context lives there.
 struct SessionInfo {
   SessionConfig session_config;
   std::shared_ptr<ContextHandler> context_handler;
@@ -71,6 +79,8 @@ struct SessionInfo {
   std::unique_ptr<StopTokenDetector> stop_token_detector;
   std::optional<BenchmarkInfo> benchmark_info = std::nullopt;
   absl::flat_hash_set<TaskId> active_tasks = {};
+  int decode_deficit = 0;
+  int executor_index = 0;
 };
 
 // All the information about a task.
@@ -113,6 +123,10 @@ class ExecutionManager {
   //   the audio executor. This can be null if no audio modality is used.
   // - litert_env: The LIRTER environment used for creating the LLM context.
   //   This can be null if no LLM context is needed.
+  // - additional_llm_executors: More executors of the same model, each with
+  //   its own kv-cache, so that the sessions routed to different executors run
+  //   in parallel. Sessions with vision or audio inputs only run on
+  //   `llm_executor`, the only one with vision and audio executors.
   static absl::StatusOr<std::unique_ptr<ExecutionManager>> Create(
       Tokenizer* absl_nonnull tokenizer,
       ModelResources* absl_nullable model_resources,
@@ -121,7 +135,8 @@ class ExecutionManager {
       vision_executor_settings,
       std::unique_ptr<AudioExecutorSettings> absl_nullable
       audio_executor_settings,
-      ::litert::Environment* absl_nullable litert_env);
+      ::litert::Environment* absl_nullable litert_env,
+      std::vector<std::unique_ptr<LlmExecutor>> additional_llm_executors = {});
 
   ~ExecutionManager() {
     WaitUntilAllDone(Engine::kDefaultTimeout).IgnoreError();
@@ -174,6 +189,31 @@ class ExecutionManager {
   absl::StatusOr<BenchmarkInfo*> GetMutableBenchmarkInfo(SessionId session_id)
       ABSL_LOCKS_EXCLUDED(session_and_task_lookup_mutex_);
 
+  // Returns the fingerprint of the model run by the executor of the session
+  // with the given session ID, which identifies its snapshots.
+  absl::StatusOr<uint64_t> GetModelFingerprint(SessionId session_id)
+      ABSL_LOCKS_EXCLUDED(session_and_task_lookup_mutex_);
+
+  // Saves the context of the session with the given session ID, along with its
+  // last prefill token ID, to `writer`. The session must have no active tasks.
+  absl::Status SaveSessionSnapshot(SessionId session_id,
+                                   LlmContextSnapshotWriter& writer)
+      ABSL_LOCKS_EXCLUDED(session_and_task_lookup_mutex_);
+
+  // Restores the context of the session with the given session ID, along with
+  // its last prefill token ID, from a snapshot saved by SaveSessionSnapshot().
+  // The session must have no active tasks.
+  absl::Status LoadSessionSnapshot(SessionId session_id,
+                                   std::shared_ptr<LlmContextSnapshot> snapshot)
+      ABSL_LOCKS_EXCLUDED(session_and_task_lookup_mutex_);
+
+  // Returns the statistics of the context switches between the sessions, over
+  // all the executors of the pool.
+  ContextSwitchStats GetContextSwitchStats();
+
+  // Returns the number of executors of the pool.
+  int num_executors() const { return executor_lanes_.size(); }
+
   // Returns a new task ID.
   // The returned task ID is guaranteed to be unique.
   absl::StatusOr<TaskId> GetNewTaskId();
@@ -250,19 +290,36 @@ class ExecutionManager {
 
  private:
   // Private constructor. Use the Create function instead.
+  // - resource_managers: The resource managers of the executors of the pool,
+  //   the first one owning the vision and audio executors.
   ExecutionManager(
       Tokenizer* absl_nonnull tokenizer,
-      std::unique_ptr<ResourceManager> absl_nonnull resource_manager,
-      ::litert::Environment* absl_nullable litert_env = nullptr)
+      std::vector<std::unique_ptr<ResourceManager>> resource_managers,
+      ::litert::Environment* absl_nullable litert_env = nullptr,
+      int decode_quantum_tokens = 0, int num_prefill_tokens_per_turn = 0,
+      int prefill_chunk_size = 0, bool pin_threads_to_performance_cores = false)
       : tokenizer_(std::move(tokenizer)),
-        resource_manager_(std::move(resource_manager)),
-        litert_env_(litert_env) {
-    execution_thread_pool_ =
-        std::make_unique<ThreadPool>(/*name_prefix=*/"execution_thread_pool",
-                                     /*max_num_threads=*/1);
-    callback_thread_pool_ =
-        std::make_unique<ThreadPool>(/*name_prefix=*/"callback_thread_pool",
-                                     /*max_num_threads=*/1);
+        litert_env_(litert_env),
+        decode_quantum_tokens_(decode_quantum_tokens),
+        num_prefill_tokens_per_turn_(num_prefill_tokens_per_turn),
+        prefill_chunk_size_(prefill_chunk_size) {
+    // Every execution thread runs the model of its executor, the callback
+    // thread only hands the responses over.
+    for (auto& resource_manager : resource_managers) {
+      auto lane = std::make_unique<ExecutorLane>();
+      lane->resource_manager = std::move(resource_manager);
+      lane->execution_thread_pool = std::make_unique<ThreadPool>(
+          /*name_prefix=*/"execution_thread_pool",
+          /*max_num_threads=*/1,
+          pin_threads_to_performance_cores ? GetPerformanceCoreThreadOptions()
+                                           : ThreadOptions());
+      executor_lanes_.push_back(std::move(lane));
+    }
+    callback_thread_pool_ = std::make_unique<ThreadPool>(
+        /*name_prefix=*/"callback_thread_pool",
+        /*max_num_threads=*/1,
+        pin_threads_to_performance_cores ? GetEfficiencyCoreThreadOptions()
+                                         : ThreadOptions());
   }
 
   // Creates a task with the given task ID, task, dependent tasks, and callback.
@@ -288,6 +345,43 @@ class ExecutionManager {
   absl::Status QueueTask(TaskId task_id)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(session_and_task_lookup_mutex_);
 
+  // An executor of the pool, with the tasks of the sessions routed to it.
+  struct ExecutorLane;
+
+  // Returns the executor of the pool the session runs on.
+  ExecutorLane& GetExecutorLane(const SessionInfo& session_info) {
+    return *executor_lanes_[session_info.executor_index];
+  }
+
+  // Returns the resource manager of the executor the session runs on.
+  ResourceManager& GetResourceManager(const SessionInfo& session_info) {
+    return *GetExecutorLane(session_info).resource_manager;
+  }
+
+  // Returns the index of the executor a new session runs on: the one with the
+  // fewest sessions having active tasks, then with the fewest sessions.
+  // Sessions with vision or audio inputs run on the first executor.
+  int SelectExecutorIndex(const SessionConfig& session_config)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(session_and_task_lookup_mutex_);
+
+  // Adds the task, or the next turn of a task, to the ready tasks of the
+  // executor of the session and schedules a run of the most urgent of them on
+  // its execution thread.
+  // - session_info: The session of the task, whose config gives the priority
+  //   and the deadline of the task.
+  // - task: The task function.
+  absl::Status ScheduleReadyTask(const SessionInfo& session_info,
+                                 absl::AnyInvocable<void()> absl_nonnull task);
+
+  // Runs the most urgent ready task of the executor, i.e. the one of the
+  // highest priority class, then with the earliest deadline, then the first
+  // one to be ready.
+  void RunNextReadyTask(ExecutorLane& lane);
+
+  // Returns whether any ready task is waiting for the execution thread of the
+  // executor the session runs on.
+  bool HasReadyTasks(const SessionInfo& session_info);
+
   // Starts the task with the given task ID, and returns the session info and
   // callback function of the task.
   // - task_id: The task ID of the task.
@@ -356,6 +450,63 @@ class ExecutionManager {
       const std::vector<InputData>& preprocessed_contents,
       std::optional<BenchmarkInfo>& benchmark_info);
 
+  // Attaches the session to the cached prefix sharing the longest prefix with
+  // the text tokens of the inputs.
+  // Returns:
+  // - The number of tokens shared with the cached prefix, 0 if the session is
+  //   not attached.
+  absl::StatusOr<int> AttachToCachedPrefix(const SessionInfo& session_info,
+                                           const ExecutorInputs& inputs);
+
+  // Records the last prefill token of the session once its prefill is done,
+  // and caches the prefilled tokens if the prefill started from an empty
+  // context. The executor is released before caching the prefix.
+  // - session_info: The session info of the prefill task.
+  // - llm_executor: The executor the prefill ran on.
+  // - start_step: The step of the executor before the prefill, -1 if the
+  //   prefix should not be cached.
+  // - num_reused_tokens: The number of tokens reused from a cached prefix.
+  absl::Status CompletePrefill(SessionInfo& session_info,
+                               std::unique_ptr<LlmExecutor> llm_executor,
+                               int start_step, int num_reused_tokens);
+
+  // Returns the maximum number of tokens a text prefill of the session
+  // processes per turn, 0 if its prefills run to completion. The session's
+  // prefill quantum, or num_prefill_tokens_per_turn_ by default, is rounded up
+  // to whole prefill chunks of the executor.
+  // - session_info: The session info of the prefill task.
+  int GetNumPrefillTokensPerTurn(const SessionInfo& session_info) const;
+
+  // The state of a prefill task split in turns, carried over from one turn to
+  // the next.
+  struct PrefillTaskState;
+
+  // Runs one turn of a prefill task, i.e. prefills at most
+  // GetNumPrefillTokensPerTurn() tokens, and finishes the task once all the
+  // tokens are prefilled. Otherwise, the executor is released and the next
+  // turn is added to the ready tasks, so that more urgent tasks of other
+  // sessions can run in between.
+  // - task_id: The task ID of the prefill task.
+  // - state: The state of the prefill task.
+  void RunPrefillTurn(TaskId task_id, std::shared_ptr<PrefillTaskState> state);
+
+  // The state of a decode task carried over from one turn to the next.
+  struct DecodeTaskState;
+
+  // Runs one turn of a decode task, and finishes the task once the decoding is
+  // done. Otherwise, the executor is released and the next turn is queued
+  // behind the tasks scheduled in the meantime, so that the decodes of
+  // concurrent sessions are interleaved, in the order of their priority and
+  // deadline.
+  // The sessions share the executor in a deficit round robin fashion: every
+  // turn adds the decode quantum of the session, in tokens, to its deficit, and
+  // the turn runs as many decode steps as the deficit affords, each costing one
+  // token per output candidate. The turn goes on as long as no other task is
+  // ready, saving the context switches.
+  // - task_id: The task ID of the decode task.
+  // - state: The state of the decode task.
+  void RunDecodeTurn(TaskId task_id, std::shared_ptr<DecodeTaskState> state);
+
   // The session ID.
   std::atomic<SessionId> next_session_id_ = 0;
 
@@ -375,21 +526,55 @@ class ExecutionManager {
   absl::flat_hash_map<TaskId, TaskInfo> task_lookup_
       ABSL_GUARDED_BY(session_and_task_lookup_mutex_) = {};
 
-  // TODO b/409401231 - Use LLM Context which is will be wrapped in a session
-  // state.
-  int last_prefill_token_id_ = 0;
+  // A task ready to run, waiting for the execution thread.
+  struct ReadyTask {
+    SessionPriority priority;
+    // absl::InfiniteFuture() if the session has no task deadline.
+    absl::Time deadline;
+    // The order in which the tasks became ready, breaking the ties.
+    int64_t sequence;
+    absl::AnyInvocable<void()> task;
+  };
+
+  struct ExecutorLane {
+    // The resource manager of the executor.
+    std::unique_ptr<ResourceManager> resource_manager;
+
+    // The mutex for protecting the ready tasks. It is acquired after the
+    // session and task lookup mutex when both are needed.
+    absl::Mutex ready_tasks_mutex;
+    // The ready tasks, as a heap whose front is the most urgent task.
+    std::vector<ReadyTask> ready_tasks ABSL_GUARDED_BY(ready_tasks_mutex);
+    // The sequence number of the next ready task.
+    int64_t next_ready_task_sequence ABSL_GUARDED_BY(ready_tasks_mutex) = 0;
+
+    // The thread pool with a single worker thread used for executing the
+    // tasks. Every task scheduled on it runs the most urgent ready task at
+    // that time, rather than the task it was scheduled for.
+    std::unique_ptr<ThreadPool> execution_thread_pool;
+  };
 
   // The tokenizer used for encoding the text input.
   Tokenizer* absl_nonnull tokenizer_;
 
-  // The resource manager used for managing the resources.
-  std::unique_ptr<ResourceManager> absl_nonnull resource_manager_;
+  // The executors of the pool, which run in parallel.
+  std::vector<std::unique_ptr<ExecutorLane>> executor_lanes_;
 
   // The LIRTER environment used for creating the LLM context.
   ::litert::Environment* absl_nullable litert_env_;
 
-  // The thread pool with a single worker thread used for executing the tasks.
-  std::unique_ptr<ThreadPool> absl_nonnull execution_thread_pool_;
+  // The default decode quantum of the sessions, i.e. the number of tokens a
+  // decode task decodes per turn before yielding the execution thread. 0 means
+  // the decode task runs to completion.
+  const int decode_quantum_tokens_;
+
+  // The maximum number of tokens a text prefill task processes before yielding
+  // the execution thread. 0 means the prefill task runs to completion.
+  const int num_prefill_tokens_per_turn_;
+
+  // The number of tokens the executor prefills per chunk, i.e.
+  // CpuConfig::prefill_chunk_size, or 0 if it doesn't split the prefills.
+  const int prefill_chunk_size_;
 
   // The thread pool used for running the callbacks without blocking the
   // execution thread pool.
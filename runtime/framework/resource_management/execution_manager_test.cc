@@ -28,6 +28,7 @@
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
 #include "absl/time/time.h"  // from @com_google_absl
 #include "runtime/components/constrained_decoding/fake_constraint.h"
 #include "runtime/components/model_resources.h"
@@ -36,6 +37,8 @@
 #include "runtime/engine/io_types.h"
 #include "runtime/executor/executor_settings_base.h"
 #include "runtime/executor/fake_llm_executor.h"
+#include "runtime/executor/llm_executor.h"
+#include "runtime/executor/llm_executor_settings.h"
 #include "runtime/proto/token.pb.h"
 #include "runtime/util/status_macros.h"  // IWYU pragma: keep
 #include "runtime/util/test_utils.h"  // NOLINT
@@ -100,17 +103,20 @@ class ExecutionManagerTest : public ::testing::Test {
   };
 
   void CreateExecutionManager(
-      std::unique_ptr<FakeLlmExecutor> fake_llm_executor) {
+      std::unique_ptr<FakeLlmExecutor> fake_llm_executor,
+      std::vector<std::unique_ptr<LlmExecutor>> additional_llm_executors = {}) {
     // The objects are moved to execution_manager_ so we can't access them
     // after creation.
-    ASSERT_OK_AND_ASSIGN(execution_manager_,
-                         ExecutionManager::Create(
-                             /*tokenizer=*/tokenizer_.get(),
-                             /*model_resources=*/model_resources_.get(),
-                             /*llm_executor=*/std::move(fake_llm_executor),
-                             /*vision_executor_settings=*/nullptr,
-                             /*audio_executor_settings=*/nullptr,
-                             /*litert_env=*/nullptr));
+    ASSERT_OK_AND_ASSIGN(
+        execution_manager_,
+        ExecutionManager::Create(
+            /*tokenizer=*/tokenizer_.get(),
+            /*model_resources=*/model_resources_.get(),
+            /*llm_executor=*/std::move(fake_llm_executor),
+            /*vision_executor_settings=*/nullptr,
+            /*audio_executor_settings=*/nullptr,
+            /*litert_env=*/nullptr,
+            /*additional_llm_executors=*/std::move(additional_llm_executors)));
   }
 
   std::unique_ptr<FakeLlmExecutor> CreateDefaultFakeLlmExecutor(
@@ -328,6 +334,355 @@ TEST_F(ExecutionManagerTest, AddDecodeTaskWithInternalSampler) {
   EXPECT_THAT(responses_texts, ElementsAre("4", "5"));
 }
 
+TEST_F(ExecutionManagerTest, AddDecodeTaskRunsInTurns) {
+  auto fake_llm_executor = CreateDefaultFakeLlmExecutor();
+  ASSERT_OK_AND_ASSIGN(auto* executor_settings,
+                       fake_llm_executor->GetMutableExecutorSettings());
+  AdvancedSettings advanced_settings;
+  advanced_settings.decode_quantum_tokens = 1;
+  executor_settings->SetAdvancedSettings(advanced_settings);
+  CreateExecutionManager(std::move(fake_llm_executor));
+
+  ASSERT_OK_AND_ASSIGN(auto session_config, CreateDefaultSessionConfig());
+  ASSERT_OK_AND_ASSIGN(const SessionId session_id,
+                       execution_manager_->RegisterNewSession(session_config));
+
+  std::vector<TaskState> task_states;
+  std::vector<std::string> responses_texts;
+  absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback =
+      [&task_states, &responses_texts](absl::StatusOr<Responses> responses) {
+        ASSERT_OK(responses);
+        task_states.push_back(responses->GetTaskState());
+        if (!responses->GetTexts().empty()) {
+          responses_texts.push_back(responses->GetTexts()[0]);
+        }
+      };
+
+  std::vector<InputData> inputs;
+  ASSERT_OK_AND_ASSIGN(auto input_text,
+                       tokenizer_->TokenIdsToTensorBuffer({1, 2, 3}));
+  inputs.push_back(InputText(std::move(input_text)));
+  ASSERT_OK_AND_ASSIGN(const TaskId prefill_task_id,
+                       execution_manager_->GetNewTaskId());
+  ASSERT_OK(execution_manager_->AddPrefillTask(
+      session_id, prefill_task_id, std::move(inputs),
+      /*dependency_task_ids=*/{},
+      /*cancelled=*/std::make_shared<std::atomic<bool>>(false),
+      /*callback=*/[](absl::StatusOr<Responses> responses) {}));
+  ASSERT_OK(
+      execution_manager_->WaitUntilDone(prefill_task_id, absl::Seconds(3)));
+
+  ASSERT_OK_AND_ASSIGN(const TaskId decode_task_id,
+                       execution_manager_->GetNewTaskId());
+  ASSERT_OK(execution_manager_->AddDecodeTask(
+      session_id, decode_task_id,
+      /*dependency_task_ids=*/{},
+      /*constraint=*/nullptr,
+      /*cancelled=*/std::make_shared<std::atomic<bool>>(false),
+      std::move(callback)));
+
+  EXPECT_OK(
+      execution_manager_->WaitUntilDone(decode_task_id, absl::Seconds(3)));
+
+  // Running one decode step per turn yields the same responses as running the
+  // decode to completion.
+  EXPECT_THAT(task_states,
+              ElementsAre(TaskState::kCreated, TaskState::kQueued,
+                          TaskState::kProcessing, TaskState::kProcessing,
+                          TaskState::kProcessing, TaskState::kDone));
+
+  EXPECT_THAT(responses_texts, ElementsAre("4", "5"));
+}
+
+TEST_F(ExecutionManagerTest, AddDecodeTaskWithSessionDecodeQuantum) {
+  CreateExecutionManager(CreateDefaultFakeLlmExecutor());
+
+  // The session decodes one token per turn although the engine runs decodes to
+  // completion by default.
+  ASSERT_OK_AND_ASSIGN(auto session_config, CreateDefaultSessionConfig());
+  session_config.SetDecodeQuantum(1);
+  ASSERT_OK_AND_ASSIGN(const SessionId session_id,
+                       execution_manager_->RegisterNewSession(session_config));
+
+  std::vector<std::string> responses_texts;
+  absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback =
+      [&responses_texts](absl::StatusOr<Responses> responses) {
+        ASSERT_OK(responses);
+        if (!responses->GetTexts().empty()) {
+          responses_texts.push_back(responses->GetTexts()[0]);
+        }
+      };
+
+  std::vector<InputData> inputs;
+  ASSERT_OK_AND_ASSIGN(auto input_text,
+                       tokenizer_->TokenIdsToTensorBuffer({1, 2, 3}));
+  inputs.push_back(InputText(std::move(input_text)));
+  ASSERT_OK_AND_ASSIGN(const TaskId prefill_task_id,
+                       execution_manager_->GetNewTaskId());
+  ASSERT_OK(execution_manager_->AddPrefillTask(
+      session_id, prefill_task_id, std::move(inputs),
+      /*dependency_task_ids=*/{},
+      /*cancelled=*/std::make_shared<std::atomic<bool>>(false),
+      /*callback=*/[](absl::StatusOr<Responses> responses) {}));
+  ASSERT_OK_AND_ASSIGN(const TaskId decode_task_id,
+                       execution_manager_->GetNewTaskId());
+  ASSERT_OK(execution_manager_->AddDecodeTask(
+      session_id, decode_task_id,
+      /*dependency_task_ids=*/{prefill_task_id},
+      /*constraint=*/nullptr,
+      /*cancelled=*/std::make_shared<std::atomic<bool>>(false),
+      std::move(callback)));
+
+  EXPECT_OK(
+      execution_manager_->WaitUntilDone(decode_task_id, absl::Seconds(3)));
+  EXPECT_THAT(responses_texts, ElementsAre("4", "5"));
+
+  // Only the first task loads the context of the only session.
+  EXPECT_EQ(execution_manager_->GetContextSwitchStats().num_context_switches,
+            1);
+  ASSERT_OK_AND_ASSIGN(auto session_info,
+                       execution_manager_->GetSessionInfo(session_id));
+  EXPECT_EQ(session_info->decode_deficit, 0);
+}
+
+TEST_F(ExecutionManagerTest, SessionsRunOnSeparateExecutors) {
+  std::vector<std::unique_ptr<LlmExecutor>> additional_llm_executors;
+  additional_llm_executors.push_back(CreateDefaultFakeLlmExecutor());
+  CreateExecutionManager(CreateDefaultFakeLlmExecutor(),
+                         std::move(additional_llm_executors));
+  EXPECT_EQ(execution_manager_->num_executors(), 2);
+
+  ASSERT_OK_AND_ASSIGN(auto session_config, CreateDefaultSessionConfig());
+  std::vector<SessionId> session_ids;
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_OK_AND_ASSIGN(
+        const SessionId session_id,
+        execution_manager_->RegisterNewSession(session_config));
+    session_ids.push_back(session_id);
+  }
+
+  // Every session owns an executor, thus both decode the whole output of the
+  // fake executor, without any context switch between them.
+  absl::Mutex mutex;
+  std::vector<std::vector<std::string>> responses_texts(2);
+  std::vector<TaskId> decode_task_ids;
+  for (int i = 0; i < 2; ++i) {
+    std::vector<InputData> inputs;
+    ASSERT_OK_AND_ASSIGN(auto input_text,
+                         tokenizer_->TokenIdsToTensorBuffer({1, 2, 3}));
+    inputs.push_back(InputText(std::move(input_text)));
+    ASSERT_OK_AND_ASSIGN(const TaskId prefill_task_id,
+                         execution_manager_->GetNewTaskId());
+    ASSERT_OK(execution_manager_->AddPrefillTask(
+        session_ids[i], prefill_task_id, std::move(inputs),
+        /*dependency_task_ids=*/{},
+        /*cancelled=*/std::make_shared<std::atomic<bool>>(false),
+        /*callback=*/[](absl::StatusOr<Responses> responses) {}));
+    ASSERT_OK_AND_ASSIGN(const TaskId decode_task_id,
+                         execution_manager_->GetNewTaskId());
+    ASSERT_OK(execution_manager_->AddDecodeTask(
+        session_ids[i], decode_task_id,
+        /*dependency_task_ids=*/{prefill_task_id},
+        /*constraint=*/nullptr,
+        /*cancelled=*/std::make_shared<std::atomic<bool>>(false),
+        [&mutex, &texts = responses_texts[i]](
+            absl::StatusOr<Responses> responses) {
+          ASSERT_OK(responses);
+          if (!responses->GetTexts().empty()) {
+            absl::MutexLock lock(mutex);
+            texts.push_back(responses->GetTexts()[0]);
+          }
+        }));
+    decode_task_ids.push_back(decode_task_id);
+  }
+
+  for (const TaskId decode_task_id : decode_task_ids) {
+    EXPECT_OK(
+        execution_manager_->WaitUntilDone(decode_task_id, absl::Seconds(3)));
+  }
+  EXPECT_THAT(responses_texts[0], ElementsAre("4", "5"));
+  EXPECT_THAT(responses_texts[1], ElementsAre("4", "5"));
+
+  ASSERT_OK_AND_ASSIGN(auto first_session_info,
+                       execution_manager_->GetSessionInfo(session_ids[0]));
+  ASSERT_OK_AND_ASSIGN(auto second_session_info,
+                       execution_manager_->GetSessionInfo(session_ids[1]));
+  EXPECT_EQ(first_session_info->executor_index, 0);
+  EXPECT_EQ(second_session_info->executor_index, 1);
+  // Each executor only loads the context of its session once.
+  EXPECT_EQ(execution_manager_->GetContextSwitchStats().num_context_switches,
+            2);
+}
+
+TEST_F(ExecutionManagerTest, AddPrefillTaskRunsInTurns) {
+  // The fake executor checks that the prefill is split in two turns.
+  auto fake_llm_executor = CreateDefaultFakeLlmExecutor({{{1, 2}, {3}}});
+  ASSERT_OK_AND_ASSIGN(auto* executor_settings,
+                       fake_llm_executor->GetMutableExecutorSettings());
+  AdvancedSettings advanced_settings;
+  advanced_settings.num_prefill_tokens_per_turn = 2;
+  executor_settings->SetAdvancedSettings(advanced_settings);
+  CreateExecutionManager(std::move(fake_llm_executor));
+
+  ASSERT_OK_AND_ASSIGN(auto session_config, CreateDefaultSessionConfig());
+  ASSERT_OK_AND_ASSIGN(const SessionId session_id,
+                       execution_manager_->RegisterNewSession(session_config));
+
+  std::vector<TaskState> task_states;
+  absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback =
+      [&task_states](absl::StatusOr<Responses> responses) {
+        ASSERT_OK(responses);
+        task_states.push_back(responses->GetTaskState());
+      };
+
+  std::vector<InputData> inputs;
+  ASSERT_OK_AND_ASSIGN(auto input_text,
+                       tokenizer_->TokenIdsToTensorBuffer({1, 2, 3}));
+  inputs.push_back(InputText(std::move(input_text)));
+  ASSERT_OK_AND_ASSIGN(const TaskId task_id,
+                       execution_manager_->GetNewTaskId());
+  ASSERT_OK(execution_manager_->AddPrefillTask(
+      session_id, task_id, std::move(inputs), {},
+      std::make_shared<std::atomic<bool>>(false), std::move(callback)));
+
+  EXPECT_OK(execution_manager_->WaitUntilDone(task_id, absl::Seconds(3)));
+
+  EXPECT_THAT(task_states,
+              ElementsAre(TaskState::kCreated, TaskState::kQueued,
+                          TaskState::kProcessing, TaskState::kDone));
+  ASSERT_OK_AND_ASSIGN(auto session_info,
+                       execution_manager_->GetSessionInfo(session_id));
+  EXPECT_EQ(session_info->last_prefill_token_id, 3);
+}
+
+TEST_F(ExecutionManagerTest, AddPrefillTaskRunsInTurnsOfWholeChunks) {
+  // The turns of 3 tokens are rounded up to 2 chunks of 2 tokens.
+  auto fake_llm_executor =
+      CreateDefaultFakeLlmExecutor({{{1, 2, 3, 4}, {5}}});
+  ASSERT_OK_AND_ASSIGN(auto* executor_settings,
+                       fake_llm_executor->GetMutableExecutorSettings());
+  ASSERT_OK_AND_ASSIGN(auto cpu_config,
+                       executor_settings->MutableBackendConfig<CpuConfig>());
+  cpu_config.prefill_chunk_size = 2;
+  executor_settings->SetBackendConfig(cpu_config);
+  AdvancedSettings advanced_settings;
+  advanced_settings.num_prefill_tokens_per_turn = 3;
+  executor_settings->SetAdvancedSettings(advanced_settings);
+  CreateExecutionManager(std::move(fake_llm_executor));
+
+  ASSERT_OK_AND_ASSIGN(auto session_config, CreateDefaultSessionConfig());
+  ASSERT_OK_AND_ASSIGN(const SessionId session_id,
+                       execution_manager_->RegisterNewSession(session_config));
+
+  std::vector<InputData> inputs;
+  ASSERT_OK_AND_ASSIGN(auto input_text,
+                       tokenizer_->TokenIdsToTensorBuffer({1, 2, 3, 4, 5}));
+  inputs.push_back(InputText(std::move(input_text)));
+  ASSERT_OK_AND_ASSIGN(const TaskId task_id,
+                       execution_manager_->GetNewTaskId());
+  absl::Status final_status;
+  ASSERT_OK(execution_manager_->AddPrefillTask(
+      session_id, task_id, std::move(inputs), {},
+      std::make_shared<std::atomic<bool>>(false),
+      [&final_status](absl::StatusOr<Responses> responses) {
+        final_status = responses.status();
+      }));
+
+  EXPECT_OK(execution_manager_->WaitUntilDone(task_id, absl::Seconds(3)));
+  EXPECT_OK(final_status);
+  ASSERT_OK_AND_ASSIGN(auto session_info,
+                       execution_manager_->GetSessionInfo(session_id));
+  EXPECT_EQ(session_info->last_prefill_token_id, 5);
+}
+
+TEST_F(ExecutionManagerTest, AddPrefillTaskWithSessionPrefillQuantum) {
+  // The session prefills two tokens per turn although the engine runs
+  // prefills to completion by default.
+  CreateExecutionManager(CreateDefaultFakeLlmExecutor({{{1, 2}, {3}}}));
+  ASSERT_OK_AND_ASSIGN(auto session_config, CreateDefaultSessionConfig());
+  session_config.SetPrefillQuantum(2);
+  ASSERT_OK_AND_ASSIGN(const SessionId session_id,
+                       execution_manager_->RegisterNewSession(session_config));
+
+  std::vector<InputData> inputs;
+  ASSERT_OK_AND_ASSIGN(auto input_text,
+                       tokenizer_->TokenIdsToTensorBuffer({1, 2, 3}));
+  inputs.push_back(InputText(std::move(input_text)));
+  ASSERT_OK_AND_ASSIGN(const TaskId task_id,
+                       execution_manager_->GetNewTaskId());
+  absl::Status final_status;
+  ASSERT_OK(execution_manager_->AddPrefillTask(
+      session_id, task_id, std::move(inputs), {},
+      std::make_shared<std::atomic<bool>>(false),
+      [&final_status](absl::StatusOr<Responses> responses) {
+        final_status = responses.status();
+      }));
+
+  EXPECT_OK(execution_manager_->WaitUntilDone(task_id, absl::Seconds(3)));
+  EXPECT_OK(final_status);
+  ASSERT_OK_AND_ASSIGN(auto session_info,
+                       execution_manager_->GetSessionInfo(session_id));
+  EXPECT_EQ(session_info->last_prefill_token_id, 3);
+}
+
+TEST_F(ExecutionManagerTest, ReadyTasksRunByPriorityAndDeadline) {
+  CreateExecutionManager(CreateDefaultFakeLlmExecutor());
+  ASSERT_OK_AND_ASSIGN(auto session_config, CreateDefaultSessionConfig());
+  ASSERT_OK_AND_ASSIGN(const SessionId busy_session_id,
+                       execution_manager_->RegisterNewSession(session_config));
+
+  // The prefill keeps the execution thread busy while the other tasks get
+  // ready.
+  std::vector<InputData> inputs;
+  ASSERT_OK_AND_ASSIGN(auto input_text,
+                       tokenizer_->TokenIdsToTensorBuffer({1, 2, 3}));
+  inputs.push_back(InputText(std::move(input_text)));
+  ASSERT_OK_AND_ASSIGN(const TaskId busy_task_id,
+                       execution_manager_->GetNewTaskId());
+  ASSERT_OK(execution_manager_->AddPrefillTask(
+      busy_session_id, busy_task_id, std::move(inputs), {},
+      std::make_shared<std::atomic<bool>>(false), nullptr));
+
+  absl::Mutex mutex;
+  std::vector<std::string> started_tasks;
+  auto add_task = [&](absl::string_view name, SessionPriority priority,
+                      std::optional<absl::Duration> task_deadline)
+      -> absl::Status {
+    session_config.SetPriority(priority);
+    session_config.SetTaskDeadline(task_deadline);
+    ASSIGN_OR_RETURN(const SessionId session_id,
+                     execution_manager_->RegisterNewSession(session_config));
+    ASSIGN_OR_RETURN(const TaskId task_id, execution_manager_->GetNewTaskId());
+    // The tasks are cancelled before they start so that they don't run on the
+    // executor, only the order in which they start matters.
+    return execution_manager_->AddPrefillTask(
+        session_id, task_id, /*inputs=*/{}, /*dep_tasks=*/{},
+        std::make_shared<std::atomic<bool>>(true),
+        [&mutex, &started_tasks,
+         name = std::string(name)](absl::StatusOr<Responses> responses) {
+          if (responses.ok() &&
+              responses->GetTaskState() == TaskState::kProcessing) {
+            absl::MutexLock lock(mutex);
+            started_tasks.push_back(name);
+          }
+        });
+  };
+  ASSERT_OK(add_task("background", SessionPriority::kBackground, std::nullopt));
+  ASSERT_OK(add_task("normal", SessionPriority::kNormal, std::nullopt));
+  ASSERT_OK(add_task("late_deadline", SessionPriority::kNormal,
+                     absl::Seconds(20)));
+  ASSERT_OK(add_task("early_deadline", SessionPriority::kNormal,
+                     absl::Seconds(10)));
+  ASSERT_OK(add_task("interactive", SessionPriority::kInteractive,
+                     std::nullopt));
+
+  EXPECT_OK(execution_manager_->WaitUntilAllDone(absl::Seconds(3)));
+  absl::MutexLock lock(mutex);
+  EXPECT_THAT(started_tasks,
+              ElementsAre("interactive", "early_deadline", "late_deadline",
+                          "normal", "background"));
+}
+
 TEST_F(ExecutionManagerTest, AddDecodeTaskWithExternalSampler) {
   std::vector<std::vector<int>> prefill_tokens = {{1, 2, 3}, {6}};
   std::vector<std::vector<int>> decode_tokens = {{4}, {5}, {6}};
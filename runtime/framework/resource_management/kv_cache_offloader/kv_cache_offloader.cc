@@ -0,0 +1,176 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/framework/resource_management/kv_cache_offloader/kv_cache_offloader.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17) for std::filesystem::path
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <system_error>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"  // from @com_google_absl
+#include "absl/log/absl_log.h"  // from @com_google_absl
+#include "absl/memory/memory.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "runtime/executor/kv_cache_quantization.h"
+#include "runtime/executor/llm_executor_io_types.h"
+#include "runtime/framework/resource_management/context_handler/context_handler.h"
+#include "runtime/util/status_macros.h"  // IWYU pragma: keep
+
+namespace litert::lm {
+
+// static
+absl::StatusOr<std::unique_ptr<KvCacheOffloader>> KvCacheOffloader::Create(
+    uint64_t max_idle_kv_cache_size_bytes,
+    std::optional<KvCacheQuantization> quantization,
+    std::string spill_directory) {
+  if (spill_directory.empty() && !quantization.has_value()) {
+    return absl::InvalidArgumentError(
+        "Offloading idle kv-caches needs either a quantization or a spill "
+        "directory.");
+  }
+  if (!spill_directory.empty()) {
+    std::error_code error;
+    std::filesystem::create_directories(spill_directory, error);
+    if (error) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Failed to create the kv-cache spill directory ",
+                       spill_directory, ": ", error.message()));
+    }
+  }
+  std::random_device random_device;
+  const uint64_t id =
+      (static_cast<uint64_t>(random_device()) << 32) | random_device();
+  return absl::WrapUnique(new KvCacheOffloader(
+      max_idle_kv_cache_size_bytes, quantization, std::move(spill_directory),
+      absl::StrCat("kv_cache_", absl::Hex(id, absl::kZeroPad16))));
+}
+
+absl::Status KvCacheOffloader::MarkIdle(
+    std::shared_ptr<ContextHandler::SharedProcessedContext>
+        shared_processed_context) {
+  RET_CHECK_NE(shared_processed_context, nullptr)
+      << "The provided shared processed context should not be null.";
+  RemoveReleasedContexts();
+  entries_[shared_processed_context.get()] = Entry{
+      .shared_processed_context = shared_processed_context,
+      .idle_since = ++clock_,
+      .kv_cache_size_in_bytes =
+          shared_processed_context->GetKvCacheSizeInBytes(),
+  };
+  return OffloadLeastRecentlyIdle();
+}
+
+absl::Status KvCacheOffloader::MarkActive(
+    ContextHandler::SharedProcessedContext& shared_processed_context) {
+  auto it = entries_.find(&shared_processed_context);
+  if (it == entries_.end()) {
+    return absl::OkStatus();
+  }
+  if (it->second.offloaded) {
+    ASSIGN_OR_RETURN(const size_t num_bytes_reloaded,
+                     shared_processed_context.ReloadKvCache());
+    if (num_bytes_reloaded > 0) {
+      ++stats_.num_reloads;
+    }
+  }
+  entries_.erase(it);
+  return absl::OkStatus();
+}
+
+uint64_t KvCacheOffloader::GetIdleKvCacheSizeInBytes() {
+  RemoveReleasedContexts();
+  uint64_t size = 0;
+  for (const auto& [key, entry] : entries_) {
+    size += entry.kv_cache_size_in_bytes;
+  }
+  return size;
+}
+
+void KvCacheOffloader::RemoveReleasedContexts() {
+  absl::erase_if(entries_, [](const auto& key_and_entry) {
+    return key_and_entry.second.shared_processed_context.expired();
+  });
+}
+
+absl::Status KvCacheOffloader::OffloadLeastRecentlyIdle() {
+  uint64_t idle_kv_cache_size = GetIdleKvCacheSizeInBytes();
+  if (idle_kv_cache_size <= max_idle_kv_cache_size_bytes_) {
+    return absl::OkStatus();
+  }
+
+  std::vector<Entry*> candidates;
+  for (auto& [key, entry] : entries_) {
+    if (!entry.offloaded && entry.kv_cache_size_in_bytes > 0) {
+      candidates.push_back(&entry);
+    }
+  }
+  std::sort(candidates.begin(), candidates.end(),
+            [](const Entry* a, const Entry* b) {
+              return a->idle_since < b->idle_since;
+            });
+  for (Entry* entry : candidates) {
+    if (idle_kv_cache_size <= max_idle_kv_cache_size_bytes_) {
+      break;
+    }
+    auto shared_processed_context = entry->shared_processed_context.lock();
+    if (shared_processed_context == nullptr) {
+      continue;
+    }
+    // A kv-cache which failed to be offloaded is left in its buffers for
+    // good, rather than failing the context switch of another session.
+    entry->offloaded = true;
+    KvCacheOffloadOptions options{.quantization = quantization_,
+                                  .spill_path = NewSpillPath()};
+    auto num_bytes_offloaded =
+        shared_processed_context->OffloadKvCache(options);
+    if (!num_bytes_offloaded.ok()) {
+      ABSL_LOG(WARNING) << "Failed to offload an idle kv-cache: "
+                        << num_bytes_offloaded.status();
+      continue;
+    }
+    if (*num_bytes_offloaded == 0) {
+      continue;
+    }
+    // A quantized kv-cache still counts against the budget, only the memory
+    // released by the offload does not.
+    const size_t num_bytes_released =
+        std::min(entry->kv_cache_size_in_bytes, *num_bytes_offloaded);
+    entry->kv_cache_size_in_bytes -= num_bytes_released;
+    idle_kv_cache_size -= num_bytes_released;
+    ++stats_.num_offloads;
+    stats_.num_bytes_offloaded += num_bytes_released;
+  }
+  return absl::OkStatus();
+}
+
+std::string KvCacheOffloader::NewSpillPath() {
+  if (spill_directory_.empty()) {
+    return "";
+  }
+  return (std::filesystem::path(spill_directory_) /
+          absl::StrCat(spill_file_prefix_, "_", num_spill_files_++, ".bin"))
+      .string();
+}
+
+}  // namespace litert::lm
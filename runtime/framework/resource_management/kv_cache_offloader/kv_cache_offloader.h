@@ -0,0 +1,145 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_FRAMEWORK_RESOURCE_MANAGEMENT_KV_CACHE_OFFLOADER_KV_CACHE_OFFLOADER_H_
+#define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_FRAMEWORK_RESOURCE_MANAGEMENT_KV_CACHE_OFFLOADER_KV_CACHE_OFFLOADER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "runtime/executor/kv_cache_quantization.h"
+#include "runtime/framework/resource_management/context_handler/context_handler.h"
+
+namespace litert::lm {
+
+// The statistics of the kv-cache offloads of a KvCacheOffloader.
+struct KvCacheOffloadStats {
+  // The number of processed contexts whose kv-cache was offloaded.
+  int64_t num_offloads = 0;
+  // The number of offloaded kv-caches loaded back in their buffers.
+  int64_t num_reloads = 0;
+  // The number of bytes of memory released by the offloads, i.e. the size of
+  // the kv-cache buffers offloaded less the size of their quantized copies.
+  int64_t num_bytes_offloaded = 0;
+};
+
+// Keeps the kv-caches of the idle processed contexts of an executor, i.e. the
+// ones saved out of it, within a memory budget.
+//
+// The ResourceManager reports every processed context it saves out of the
+// executor as idle, and every idle one it is about to load as active again.
+// Once the idle processed contexts keep more bytes of kv-cache in memory, in
+// their buffers or quantized, than `max_idle_kv_cache_size_bytes`, the ones
+// idle for the longest time are offloaded with
+// ProcessedContext::OffloadKvCache(), either quantized in RAM or written to a
+// spill file in `spill_directory`. An offloaded kv-cache is loaded back in its
+// buffers when its processed context becomes active.
+//
+// The offloader only holds weak references to the processed contexts, so that
+// a context released by all its sessions is freed with its offloaded kv-cache
+// and forgotten.
+//
+// The offloader is not thread-safe, the ResourceManager uses it under its
+// executor mutex.
+class KvCacheOffloader {
+ public:
+  // Creates an offloader keeping at most `max_idle_kv_cache_size_bytes` bytes
+  // of idle kv-cache in memory. If `spill_directory` is not empty, the
+  // offloaded kv-caches are written as they are to spill files in that
+  // directory, which is created if needed. Otherwise the offloaded float
+  // kv-caches are quantized to `quantization` in RAM, which must then be set.
+  static absl::StatusOr<std::unique_ptr<KvCacheOffloader>> Create(
+      uint64_t max_idle_kv_cache_size_bytes,
+      std::optional<KvCacheQuantization> quantization,
+      std::string spill_directory);
+
+  // Marks the processed context of `shared_processed_context`, just saved out
+  // of the executor, as the most recently idle one, then offloads the kv-caches
+  // of the least recently idle ones until the idle kv-caches left in memory fit
+  // in the budget.
+  absl::Status MarkIdle(
+      std::shared_ptr<ContextHandler::SharedProcessedContext>
+          shared_processed_context);
+
+  // Marks the processed context of `shared_processed_context`, about to be
+  // loaded in the executor, as active, and loads its kv-cache back in its
+  // buffers if it was offloaded. No-op if the processed context is not idle.
+  absl::Status MarkActive(
+      ContextHandler::SharedProcessedContext& shared_processed_context);
+
+  // Returns the number of bytes of kv-cache the idle processed contexts keep
+  // in memory, in their buffers or quantized.
+  uint64_t GetIdleKvCacheSizeInBytes();
+
+  const KvCacheOffloadStats& stats() const { return stats_; }
+
+ private:
+  // An idle processed context.
+  struct Entry {
+    std::weak_ptr<ContextHandler::SharedProcessedContext>
+        shared_processed_context;
+    // The clock value of the time the context became idle.
+    uint64_t idle_since = 0;
+    // The size of the kv-cache the context keeps in memory, in its buffers or
+    // quantized.
+    size_t kv_cache_size_in_bytes = 0;
+    // Whether offloading the kv-cache of the context was already tried, in
+    // which case whatever is left in the buffers can't be offloaded.
+    bool offloaded = false;
+  };
+
+  KvCacheOffloader(uint64_t max_idle_kv_cache_size_bytes,
+                   std::optional<KvCacheQuantization> quantization,
+                   std::string spill_directory, std::string spill_file_prefix)
+      : max_idle_kv_cache_size_bytes_(max_idle_kv_cache_size_bytes),
+        quantization_(quantization),
+        spill_directory_(std::move(spill_directory)),
+        spill_file_prefix_(std::move(spill_file_prefix)) {}
+
+  // Forgets the processed contexts released by all their sessions.
+  void RemoveReleasedContexts();
+
+  // Offloads the kv-caches of the least recently idle processed contexts
+  // until the idle kv-caches left in memory fit in the budget.
+  absl::Status OffloadLeastRecentlyIdle();
+
+  // Returns the path of a new spill file, or an empty path if the kv-caches
+  // are kept in RAM.
+  std::string NewSpillPath();
+
+  const uint64_t max_idle_kv_cache_size_bytes_;
+  const std::optional<KvCacheQuantization> quantization_;
+  const std::string spill_directory_;
+  // Makes the names of the spill files of this offloader unique, even when
+  // several offloaders, e.g. of several processes, share the directory.
+  const std::string spill_file_prefix_;
+
+  absl::flat_hash_map<const ContextHandler::SharedProcessedContext*, Entry>
+      entries_;
+  // Monotonic clock used to order the idle contexts.
+  uint64_t clock_ = 0;
+  uint64_t num_spill_files_ = 0;
+  KvCacheOffloadStats stats_;
+};
+
+}  // namespace litert::lm
+
+#endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_FRAMEWORK_RESOURCE_MANAGEMENT_KV_CACHE_OFFLOADER_KV_CACHE_OFFLOADER_H_
@@ -0,0 +1,262 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/framework/resource_management/kv_cache_offloader/kv_cache_offloader.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT: Required for path manipulation.
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "runtime/executor/kv_cache_quantization.h"
+#include "runtime/executor/llm_executor_io_types.h"
+#include "runtime/executor/llm_executor_processed_tokens.h"
+#include "runtime/framework/resource_management/context_handler/context_handler.h"
+#include "runtime/util/test_utils.h"  // IWYU pragma: keep
+
+namespace litert::lm {
+namespace {
+
+using ::testing::IsEmpty;
+using ::testing::StartsWith;
+using ::testing::status::StatusIs;
+
+// A processed context whose kv-cache is only a size. Once offloaded, it keeps
+// `offloaded_kv_cache_size` bytes in memory, as a quantized kv-cache would.
+class FakeProcessedContext : public ProcessedContext {
+ public:
+  FakeProcessedContext(size_t kv_cache_size, bool can_offload,
+                       size_t offloaded_kv_cache_size)
+      : kv_cache_size_(kv_cache_size),
+        can_offload_(can_offload),
+        offloaded_kv_cache_size_(offloaded_kv_cache_size) {}
+
+  std::optional<uint32_t> lora_id() const override { return std::nullopt; }
+  void set_lora_id(std::optional<uint32_t> lora_id) override {}
+  ProcessedTokens& processed_tokens() override { return processed_tokens_; }
+
+  size_t GetKvCacheSizeInBytes() const override {
+    return offloaded_ ? 0 : kv_cache_size_;
+  }
+
+  absl::StatusOr<size_t> OffloadKvCache(
+      const KvCacheOffloadOptions& options) override {
+    if (!can_offload_ || offloaded_) {
+      return 0;
+    }
+    offloaded_ = true;
+    options_ = options;
+    return kv_cache_size_ - offloaded_kv_cache_size_;
+  }
+
+  absl::StatusOr<size_t> ReloadKvCache() override {
+    if (!offloaded_) {
+      return 0;
+    }
+    offloaded_ = false;
+    return kv_cache_size_;
+  }
+
+  bool offloaded() const { return offloaded_; }
+  const KvCacheOffloadOptions& options() const { return options_; }
+
+ private:
+  const size_t kv_cache_size_;
+  const bool can_offload_;
+  const size_t offloaded_kv_cache_size_;
+  bool offloaded_ = false;
+  KvCacheOffloadOptions options_;
+  ProcessedTokens processed_tokens_;
+};
+
+struct IdleContext {
+  std::shared_ptr<ContextHandler::SharedProcessedContext>
+      shared_processed_context;
+  // Owned by `shared_processed_context`.
+  FakeProcessedContext* processed_context;
+};
+
+IdleContext CreateIdleContext(size_t kv_cache_size, bool can_offload = true,
+                              size_t offloaded_kv_cache_size = 0) {
+  auto processed_context = std::make_unique<FakeProcessedContext>(
+      kv_cache_size, can_offload, offloaded_kv_cache_size);
+  FakeProcessedContext* processed_context_ptr = processed_context.get();
+  return IdleContext{
+      .shared_processed_context =
+          std::make_shared<ContextHandler::SharedProcessedContext>(
+              std::move(processed_context)),
+      .processed_context = processed_context_ptr,
+  };
+}
+
+TEST(KvCacheOffloaderTest, IdleContextsWithinBudgetStayInBuffers) {
+  ASSERT_OK_AND_ASSIGN(
+      auto offloader,
+      KvCacheOffloader::Create(/*max_idle_kv_cache_size_bytes=*/300,
+                               KvCacheQuantization::kInt8,
+                               /*spill_directory=*/""));
+  IdleContext context_1 = CreateIdleContext(100);
+  IdleContext context_2 = CreateIdleContext(200);
+  EXPECT_OK(offloader->MarkIdle(context_1.shared_processed_context));
+  EXPECT_OK(offloader->MarkIdle(context_2.shared_processed_context));
+
+  EXPECT_EQ(offloader->GetIdleKvCacheSizeInBytes(), 300);
+  EXPECT_FALSE(context_1.processed_context->offloaded());
+  EXPECT_FALSE(context_2.processed_context->offloaded());
+  EXPECT_EQ(offloader->stats().num_offloads, 0);
+}
+
+TEST(KvCacheOffloaderTest, OffloadsLeastRecentlyIdleContexts) {
+  ASSERT_OK_AND_ASSIGN(
+      auto offloader,
+      KvCacheOffloader::Create(/*max_idle_kv_cache_size_bytes=*/250,
+                               KvCacheQuantization::kFp8E4M3,
+                               /*spill_directory=*/""));
+  IdleContext context_1 = CreateIdleContext(100);
+  IdleContext context_2 = CreateIdleContext(100);
+  IdleContext context_3 = CreateIdleContext(100);
+  EXPECT_OK(offloader->MarkIdle(context_1.shared_processed_context));
+  EXPECT_OK(offloader->MarkIdle(context_2.shared_processed_context));
+  // Loading and saving the first context again makes it the most recently
+  // idle one.
+  EXPECT_OK(offloader->MarkActive(*context_1.shared_processed_context));
+  EXPECT_OK(offloader->MarkIdle(context_1.shared_processed_context));
+  EXPECT_OK(offloader->MarkIdle(context_3.shared_processed_context));
+
+  EXPECT_FALSE(context_1.processed_context->offloaded());
+  EXPECT_TRUE(context_2.processed_context->offloaded());
+  EXPECT_FALSE(context_3.processed_context->offloaded());
+  EXPECT_EQ(context_2.processed_context->options().quantization,
+            KvCacheQuantization::kFp8E4M3);
+  EXPECT_THAT(context_2.processed_context->options().spill_path, IsEmpty());
+  EXPECT_EQ(offloader->GetIdleKvCacheSizeInBytes(), 200);
+  EXPECT_EQ(offloader->stats().num_offloads, 1);
+  EXPECT_EQ(offloader->stats().num_bytes_offloaded, 100);
+
+  EXPECT_OK(offloader->MarkActive(*context_2.shared_processed_context));
+  EXPECT_FALSE(context_2.processed_context->offloaded());
+  EXPECT_EQ(offloader->stats().num_reloads, 1);
+  EXPECT_EQ(offloader->GetIdleKvCacheSizeInBytes(), 200);
+}
+
+TEST(KvCacheOffloaderTest, CountsQuantizedKvCachesAgainstBudget) {
+  ASSERT_OK_AND_ASSIGN(
+      auto offloader,
+      KvCacheOffloader::Create(/*max_idle_kv_cache_size_bytes=*/150,
+                               KvCacheQuantization::kInt8,
+                               /*spill_directory=*/""));
+  IdleContext context_1 = CreateIdleContext(100, /*can_offload=*/true,
+                                            /*offloaded_kv_cache_size=*/25);
+  IdleContext context_2 = CreateIdleContext(100, /*can_offload=*/true,
+                                            /*offloaded_kv_cache_size=*/25);
+  IdleContext context_3 = CreateIdleContext(100, /*can_offload=*/true,
+                                            /*offloaded_kv_cache_size=*/25);
+  EXPECT_OK(offloader->MarkIdle(context_1.shared_processed_context));
+  EXPECT_OK(offloader->MarkIdle(context_2.shared_processed_context));
+  EXPECT_TRUE(context_1.processed_context->offloaded());
+  EXPECT_EQ(offloader->GetIdleKvCacheSizeInBytes(), 125);
+
+  // The quantized first kv-cache still takes 25 bytes, so the second one has
+  // to be offloaded too.
+  EXPECT_OK(offloader->MarkIdle(context_3.shared_processed_context));
+  EXPECT_TRUE(context_2.processed_context->offloaded());
+  EXPECT_FALSE(context_3.processed_context->offloaded());
+  EXPECT_EQ(offloader->GetIdleKvCacheSizeInBytes(), 150);
+  EXPECT_EQ(offloader->stats().num_offloads, 2);
+  EXPECT_EQ(offloader->stats().num_bytes_offloaded, 150);
+}
+
+TEST(KvCacheOffloaderTest, SkipsContextsWhichCantBeOffloaded) {
+  ASSERT_OK_AND_ASSIGN(
+      auto offloader,
+      KvCacheOffloader::Create(/*max_idle_kv_cache_size_bytes=*/150,
+                               KvCacheQuantization::kInt8,
+                               /*spill_directory=*/""));
+  IdleContext pinned_context = CreateIdleContext(100, /*can_offload=*/false);
+  IdleContext context = CreateIdleContext(100);
+  EXPECT_OK(offloader->MarkIdle(pinned_context.shared_processed_context));
+  EXPECT_OK(offloader->MarkIdle(context.shared_processed_context));
+
+  EXPECT_FALSE(pinned_context.processed_context->offloaded());
+  EXPECT_TRUE(context.processed_context->offloaded());
+  EXPECT_EQ(offloader->GetIdleKvCacheSizeInBytes(), 100);
+  EXPECT_EQ(offloader->stats().num_offloads, 1);
+}
+
+TEST(KvCacheOffloaderTest, ForgetsReleasedContexts) {
+  ASSERT_OK_AND_ASSIGN(
+      auto offloader,
+      KvCacheOffloader::Create(/*max_idle_kv_cache_size_bytes=*/100,
+                               KvCacheQuantization::kInt8,
+                               /*spill_directory=*/""));
+  IdleContext released_context = CreateIdleContext(100);
+  EXPECT_OK(offloader->MarkIdle(released_context.shared_processed_context));
+  released_context.shared_processed_context.reset();
+  EXPECT_EQ(offloader->GetIdleKvCacheSizeInBytes(), 0);
+
+  // The released context no longer counts against the budget.
+  IdleContext context = CreateIdleContext(100);
+  EXPECT_OK(offloader->MarkIdle(context.shared_processed_context));
+  EXPECT_FALSE(context.processed_context->offloaded());
+}
+
+TEST(KvCacheOffloaderTest, SpillsToFilesInDirectory) {
+  const std::string spill_directory =
+      (std::filesystem::path(::testing::TempDir()) / "kv_cache_spill")
+          .string();
+  ASSERT_OK_AND_ASSIGN(auto offloader,
+                       KvCacheOffloader::Create(
+                           /*max_idle_kv_cache_size_bytes=*/0,
+                           KvCacheQuantization::kInt8, spill_directory));
+  EXPECT_TRUE(std::filesystem::is_directory(spill_directory));
+
+  IdleContext context_1 = CreateIdleContext(100);
+  IdleContext context_2 = CreateIdleContext(100);
+  EXPECT_OK(offloader->MarkIdle(context_1.shared_processed_context));
+  EXPECT_OK(offloader->MarkIdle(context_2.shared_processed_context));
+  ASSERT_TRUE(context_1.processed_context->offloaded());
+  ASSERT_TRUE(context_2.processed_context->offloaded());
+  EXPECT_THAT(context_1.processed_context->options().spill_path,
+              StartsWith(spill_directory));
+  EXPECT_NE(context_1.processed_context->options().spill_path,
+            context_2.processed_context->options().spill_path);
+}
+
+TEST(KvCacheOffloaderTest, NeedsQuantizationOrSpillDirectory) {
+  EXPECT_THAT(KvCacheOffloader::Create(/*max_idle_kv_cache_size_bytes=*/100,
+                                       /*quantization=*/std::nullopt,
+                                       /*spill_directory=*/""),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(KvCacheOffloaderTest, MarkActiveIgnoresUnknownContexts) {
+  ASSERT_OK_AND_ASSIGN(
+      auto offloader,
+      KvCacheOffloader::Create(/*max_idle_kv_cache_size_bytes=*/0,
+                               KvCacheQuantization::kInt8,
+                               /*spill_directory=*/""));
+  IdleContext context = CreateIdleContext(100);
+  EXPECT_OK(offloader->MarkActive(*context.shared_processed_context));
+  EXPECT_EQ(offloader->stats().num_reloads, 0);
+}
+
+}  // namespace
+}  // namespace litert::lm
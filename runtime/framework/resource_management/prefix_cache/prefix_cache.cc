@@ -0,0 +1,246 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/framework/resource_management/prefix_cache/prefix_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"  // from @com_google_absl
+#include "absl/memory/memory.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+#include "runtime/framework/resource_management/context_handler/context_handler.h"
+
+namespace litert::lm {
+
+// A node of the radix tree. The key of a node is the concatenation of the
+// edges from the root to the node. Apart from the root, every node either
+// holds an entry or has at least two children.
+struct PrefixCache::Node {
+  // The tokens between the parent and this node, never empty except for the
+  // root.
+  std::vector<int> edge;
+  Node* parent = nullptr;
+  // Children keyed by the first token of their edge.
+  absl::flat_hash_map<int, std::unique_ptr<Node>> children;
+  // The pinned handler if the node holds an entry.
+  std::shared_ptr<const ContextHandler> context_handler;
+  // The clock value of the last use of the entry.
+  uint64_t last_access = 0;
+};
+
+namespace {
+
+// Returns the number of leading tokens shared by `edge` and `token_ids`.
+int CommonPrefixLength(absl::Span<const int> edge,
+                       absl::Span<const int> token_ids) {
+  int length = 0;
+  while (length < static_cast<int>(edge.size()) &&
+         length < static_cast<int>(token_ids.size()) &&
+         edge[length] == token_ids[length]) {
+    ++length;
+  }
+  return length;
+}
+
+}  // namespace
+
+// static
+absl::StatusOr<std::unique_ptr<PrefixCache>> PrefixCache::Create(
+    int max_num_entries) {
+  if (max_num_entries <= 0) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Max number of entries must be positive, got ", max_num_entries));
+  }
+  return absl::WrapUnique(new PrefixCache(max_num_entries));
+}
+
+PrefixCache::PrefixCache(int max_num_entries)
+    : max_num_entries_(max_num_entries), root_(std::make_unique<Node>()) {}
+
+PrefixCache::~PrefixCache() = default;
+
+absl::Status PrefixCache::Insert(
+    absl::Span<const int> token_ids,
+    std::shared_ptr<const ContextHandler> context_handler) {
+  if (token_ids.empty()) {
+    return absl::InvalidArgumentError("Cannot cache an empty prefix.");
+  }
+  if (context_handler == nullptr) {
+    return absl::InvalidArgumentError("The context handler is null.");
+  }
+
+  absl::MutexLock lock(&mutex_);
+  Node* node = root_.get();
+  int pos = 0;
+  while (pos < static_cast<int>(token_ids.size())) {
+    auto it = node->children.find(token_ids[pos]);
+    if (it == node->children.end()) {
+      auto child = std::make_unique<Node>();
+      child->edge.assign(token_ids.begin() + pos, token_ids.end());
+      child->parent = node;
+      Node* child_ptr = child.get();
+      node->children[token_ids[pos]] = std::move(child);
+      node = child_ptr;
+      break;
+    }
+    Node* child = it->second.get();
+    const int length =
+        CommonPrefixLength(child->edge, token_ids.subspan(pos));
+    if (length < static_cast<int>(child->edge.size())) {
+      // Split the edge so that the inserted sequence ends on a node or
+      // branches off from one.
+      auto middle = std::make_unique<Node>();
+      middle->edge.assign(child->edge.begin(), child->edge.begin() + length);
+      middle->parent = node;
+      child->edge.erase(child->edge.begin(), child->edge.begin() + length);
+      child->parent = middle.get();
+      middle->children[child->edge[0]] = std::move(it->second);
+      it->second = std::move(middle);
+    }
+    node = it->second.get();
+    pos += length;
+  }
+
+  if (node->context_handler == nullptr) {
+    ++num_entries_;
+  }
+  node->context_handler = std::move(context_handler);
+  node->last_access = ++clock_;
+
+  while (num_entries_ > max_num_entries_ && EvictLeastRecentlyUsed()) {
+  }
+  return absl::OkStatus();
+}
+
+std::optional<PrefixCache::Match> PrefixCache::Lookup(
+    absl::Span<const int> token_ids) {
+  absl::MutexLock lock(&mutex_);
+  Node* node = root_.get();
+  int pos = 0;
+  while (pos < static_cast<int>(token_ids.size())) {
+    auto it = node->children.find(token_ids[pos]);
+    if (it == node->children.end()) {
+      break;
+    }
+    Node* child = it->second.get();
+    const int length =
+        CommonPrefixLength(child->edge, token_ids.subspan(pos));
+    node = child;
+    pos += length;
+    if (length < static_cast<int>(child->edge.size())) {
+      break;
+    }
+  }
+  if (pos == 0) {
+    return std::nullopt;
+  }
+
+  // Every entry below `node` covers the matched tokens, pick the most recently
+  // used one as it is the most likely to still be resident.
+  Node* entry = MostRecentlyUsedEntry(node);
+  if (entry == nullptr) {
+    return std::nullopt;
+  }
+  entry->last_access = ++clock_;
+  return Match{.num_matched_tokens = pos,
+               .context_handler = entry->context_handler};
+}
+
+int PrefixCache::num_entries() const {
+  absl::MutexLock lock(&mutex_);
+  return num_entries_;
+}
+
+void PrefixCache::Clear() {
+  std::unique_ptr<Node> old_root;
+  {
+    absl::MutexLock lock(&mutex_);
+    old_root = std::exchange(root_, std::make_unique<Node>());
+    num_entries_ = 0;
+  }
+  // The pinned handlers are released outside of the lock.
+}
+
+bool PrefixCache::EvictLeastRecentlyUsed() {
+  Node* entry = LeastRecentlyUsedEntry(root_.get());
+  if (entry == nullptr) {
+    return false;
+  }
+  entry->context_handler.reset();
+  --num_entries_;
+  Prune(entry);
+  return true;
+}
+
+// static
+PrefixCache::Node* PrefixCache::MostRecentlyUsedEntry(Node* node) {
+  Node* best = node->context_handler != nullptr ? node : nullptr;
+  for (auto& [token, child] : node->children) {
+    Node* candidate = MostRecentlyUsedEntry(child.get());
+    if (candidate != nullptr &&
+        (best == nullptr || candidate->last_access > best->last_access)) {
+      best = candidate;
+    }
+  }
+  return best;
+}
+
+// static
+PrefixCache::Node* PrefixCache::LeastRecentlyUsedEntry(Node* node) {
+  Node* best = node->context_handler != nullptr ? node : nullptr;
+  for (auto& [token, child] : node->children) {
+    Node* candidate = LeastRecentlyUsedEntry(child.get());
+    if (candidate != nullptr &&
+        (best == nullptr || candidate->last_access < best->last_access)) {
+      best = candidate;
+    }
+  }
+  return best;
+}
+
+void PrefixCache::Prune(Node* node) {
+  if (node == root_.get() || node->context_handler != nullptr) {
+    return;
+  }
+  if (node->children.empty()) {
+    Node* parent = node->parent;
+    parent->children.erase(node->edge[0]);
+    Prune(parent);
+    return;
+  }
+  if (node->children.size() == 1) {
+    // Merge the only child into this node so that the key of this node in
+    // its parent stays valid.
+    std::unique_ptr<Node> child = std::move(node->children.begin()->second);
+    node->children.clear();
+    node->edge.insert(node->edge.end(), child->edge.begin(),
+                      child->edge.end());
+    node->children = std::move(child->children);
+    for (auto& [token, grandchild] : node->children) {
+      grandchild->parent = node;
+    }
+    node->context_handler = std::move(child->context_handler);
+    node->last_access = child->last_access;
+  }
+}
+
+}  // namespace litert::lm
@@ -0,0 +1,110 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_FRAMEWORK_RESOURCE_MANAGEMENT_PREFIX_CACHE_PREFIX_CACHE_H_
+#define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_FRAMEWORK_RESOURCE_MANAGEMENT_PREFIX_CACHE_PREFIX_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include "absl/base/thread_annotations.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+#include "runtime/framework/resource_management/context_handler/context_handler.h"
+
+namespace litert::lm {
+
+// An engine-wide index of prefilled token sequences, shared by all the
+// sessions of a ResourceManager.
+//
+// Every entry maps a token sequence to a pinned ContextHandler whose runtime
+// state points right after the sequence. The pinned handler keeps its
+// SharedProcessedContext alive, and its time step makes the copy on write
+// logic of the ResourceManager fork the processed context before anyone
+// overwrites the cached tokens. A new session attaches to the entry sharing
+// the longest prefix with its input, so that only the remaining suffix has to
+// be prefilled.
+//
+// Entries are stored in a radix tree keyed by token ids and are evicted in
+// least recently used order once the cache holds more than `max_num_entries`.
+// Evicting an entry only drops the cache's reference; the processed context
+// stays alive as long as a session is still sharing it.
+//
+// The cache is thread-safe.
+class PrefixCache {
+ public:
+  // The result of a lookup.
+  struct Match {
+    // The number of leading input tokens covered by the entry.
+    int num_matched_tokens = 0;
+    // The pinned handler of the entry.
+    std::shared_ptr<const ContextHandler> context_handler;
+  };
+
+  // Creates a prefix cache holding at most `max_num_entries` entries.
+  static absl::StatusOr<std::unique_ptr<PrefixCache>> Create(
+      int max_num_entries);
+
+  ~PrefixCache();
+
+  // Inserts `context_handler` as the entry for `token_ids`, replacing the
+  // previous entry for the exact same sequence, if any. The least recently
+  // used entries are evicted if the cache is full.
+  absl::Status Insert(absl::Span<const int> token_ids,
+                      std::shared_ptr<const ContextHandler> context_handler);
+
+  // Returns the entry sharing the longest prefix with `token_ids`, or
+  // std::nullopt if no entry shares at least one token. When several entries
+  // share the same prefix, the most recently used one is returned. Only the
+  // returned entry is marked as used.
+  std::optional<Match> Lookup(absl::Span<const int> token_ids);
+
+  // Returns the number of entries in the cache.
+  int num_entries() const;
+
+  // Removes all the entries.
+  void Clear();
+
+ private:
+  struct Node;
+
+  explicit PrefixCache(int max_num_entries);
+
+  // Returns the most and least recently used entries in the subtree rooted at
+  // `node`, or nullptr if the subtree holds no entry.
+  static Node* MostRecentlyUsedEntry(Node* node);
+  static Node* LeastRecentlyUsedEntry(Node* node);
+
+  // Evicts the least recently used entry. Returns false if the cache is empty.
+  bool EvictLeastRecentlyUsed() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Removes `node` if it neither holds an entry nor has children, or merges it
+  // with its only child if it does not hold an entry.
+  void Prune(Node* node) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const int max_num_entries_;
+
+  mutable absl::Mutex mutex_;
+  std::unique_ptr<Node> root_ ABSL_GUARDED_BY(mutex_);
+  int num_entries_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Monotonic clock used to order the entries by last use.
+  uint64_t clock_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace litert::lm
+
+#endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_FRAMEWORK_RESOURCE_MANAGEMENT_PREFIX_CACHE_PREFIX_CACHE_H_
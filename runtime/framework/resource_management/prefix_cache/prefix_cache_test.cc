@@ -0,0 +1,170 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/framework/resource_management/prefix_cache/prefix_cache.h"
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"  // from @com_google_absl
+#include "runtime/executor/llm_executor_io_types.h"
+#include "runtime/executor/llm_executor_settings.h"
+#include "runtime/framework/resource_management/context_handler/context_handler.h"
+#include "runtime/util/test_utils.h"  // IWYU pragma: keep
+
+namespace litert::lm {
+namespace {
+
+using ::testing::status::StatusIs;
+
+std::shared_ptr<const ContextHandler> CreateHandler(int current_step) {
+  auto runtime_state = std::make_unique<RuntimeState>();
+  runtime_state->current_step = current_step;
+  auto handler = ContextHandler::Bundle(
+      std::make_shared<ContextHandler::SharedProcessedContext>(nullptr),
+      std::make_unique<RuntimeConfig>(), std::move(runtime_state));
+  EXPECT_OK(handler);
+  return std::move(*handler);
+}
+
+TEST(PrefixCacheTest, CreateFailsWithInvalidArguments) {
+  EXPECT_THAT(PrefixCache::Create(/*max_num_entries=*/0),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(PrefixCacheTest, InsertFailsWithInvalidArguments) {
+  ASSERT_OK_AND_ASSIGN(auto cache, PrefixCache::Create(/*max_num_entries=*/4));
+  EXPECT_THAT(cache->Insert({}, CreateHandler(0)),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(cache->Insert({1, 2}, nullptr),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_EQ(cache->num_entries(), 0);
+}
+
+TEST(PrefixCacheTest, LookupEmptyCache) {
+  ASSERT_OK_AND_ASSIGN(auto cache, PrefixCache::Create(/*max_num_entries=*/4));
+  EXPECT_EQ(cache->Lookup({1, 2, 3}), std::nullopt);
+}
+
+TEST(PrefixCacheTest, LookupReturnsLongestPrefix) {
+  ASSERT_OK_AND_ASSIGN(auto cache, PrefixCache::Create(/*max_num_entries=*/4));
+  auto short_handler = CreateHandler(2);
+  auto long_handler = CreateHandler(5);
+  EXPECT_OK(cache->Insert({1, 2}, short_handler));
+  EXPECT_OK(cache->Insert({1, 2, 3, 4, 5}, long_handler));
+  EXPECT_EQ(cache->num_entries(), 2);
+
+  auto match = cache->Lookup({1, 2, 3, 4, 5, 6, 7});
+  ASSERT_TRUE(match.has_value());
+  EXPECT_EQ(match->num_matched_tokens, 5);
+  EXPECT_EQ(match->context_handler, long_handler);
+
+  // A partial match of an edge still reuses the entry below it.
+  match = cache->Lookup({1, 2, 3, 9});
+  ASSERT_TRUE(match.has_value());
+  EXPECT_EQ(match->num_matched_tokens, 3);
+  EXPECT_EQ(match->context_handler, long_handler);
+
+  match = cache->Lookup({1, 2, 9});
+  ASSERT_TRUE(match.has_value());
+  EXPECT_EQ(match->num_matched_tokens, 2);
+
+  EXPECT_EQ(cache->Lookup({9, 1, 2}), std::nullopt);
+}
+
+TEST(PrefixCacheTest, LookupPrefersMostRecentlyUsedEntry) {
+  ASSERT_OK_AND_ASSIGN(auto cache, PrefixCache::Create(/*max_num_entries=*/4));
+  auto handler1 = CreateHandler(3);
+  auto handler2 = CreateHandler(3);
+  EXPECT_OK(cache->Insert({1, 2, 3}, handler1));
+  EXPECT_OK(cache->Insert({1, 2, 4}, handler2));
+
+  auto match = cache->Lookup({1, 2, 5});
+  ASSERT_TRUE(match.has_value());
+  EXPECT_EQ(match->num_matched_tokens, 2);
+  EXPECT_EQ(match->context_handler, handler2);
+
+  ASSERT_TRUE(cache->Lookup({1, 2, 3}).has_value());
+  match = cache->Lookup({1, 2, 5});
+  ASSERT_TRUE(match.has_value());
+  EXPECT_EQ(match->context_handler, handler1);
+}
+
+TEST(PrefixCacheTest, InsertReplacesExactMatch) {
+  ASSERT_OK_AND_ASSIGN(auto cache, PrefixCache::Create(/*max_num_entries=*/4));
+  auto handler1 = CreateHandler(2);
+  auto handler2 = CreateHandler(2);
+  EXPECT_OK(cache->Insert({1, 2}, handler1));
+  EXPECT_OK(cache->Insert({1, 2}, handler2));
+  EXPECT_EQ(cache->num_entries(), 1);
+  EXPECT_EQ(handler1.use_count(), 1);
+
+  auto match = cache->Lookup({1, 2});
+  ASSERT_TRUE(match.has_value());
+  EXPECT_EQ(match->context_handler, handler2);
+}
+
+TEST(PrefixCacheTest, EvictsLeastRecentlyUsedEntry) {
+  ASSERT_OK_AND_ASSIGN(auto cache, PrefixCache::Create(/*max_num_entries=*/2));
+  auto handler1 = CreateHandler(3);
+  auto handler2 = CreateHandler(3);
+  auto handler3 = CreateHandler(3);
+  EXPECT_OK(cache->Insert({1, 2, 3}, handler1));
+  EXPECT_OK(cache->Insert({1, 5, 6}, handler2));
+  // Touch the first entry so that the second one is evicted.
+  ASSERT_TRUE(cache->Lookup({1, 2, 3}).has_value());
+  EXPECT_OK(cache->Insert({7, 8}, handler3));
+
+  EXPECT_EQ(cache->num_entries(), 2);
+  EXPECT_EQ(handler2.use_count(), 1);
+  auto match = cache->Lookup({1, 5, 6});
+  ASSERT_TRUE(match.has_value());
+  EXPECT_EQ(match->num_matched_tokens, 1);
+  EXPECT_EQ(match->context_handler, handler1);
+  EXPECT_TRUE(cache->Lookup({7, 8}).has_value());
+}
+
+TEST(PrefixCacheTest, EvictionMergesNodes) {
+  ASSERT_OK_AND_ASSIGN(auto cache, PrefixCache::Create(/*max_num_entries=*/2));
+  auto handler1 = CreateHandler(2);
+  auto handler2 = CreateHandler(4);
+  auto handler3 = CreateHandler(2);
+  EXPECT_OK(cache->Insert({1, 2}, handler1));
+  EXPECT_OK(cache->Insert({1, 2, 3, 4}, handler2));
+  EXPECT_OK(cache->Insert({5, 6}, handler3));
+
+  // {1, 2} was evicted, {1, 2, 3, 4} must still be reachable.
+  EXPECT_EQ(handler1.use_count(), 1);
+  auto match = cache->Lookup({1, 2, 3, 4});
+  ASSERT_TRUE(match.has_value());
+  EXPECT_EQ(match->num_matched_tokens, 4);
+  EXPECT_EQ(match->context_handler, handler2);
+}
+
+TEST(PrefixCacheTest, ClearReleasesHandlers) {
+  ASSERT_OK_AND_ASSIGN(auto cache, PrefixCache::Create(/*max_num_entries=*/2));
+  auto handler = CreateHandler(2);
+  EXPECT_OK(cache->Insert({1, 2}, handler));
+  EXPECT_EQ(handler.use_count(), 2);
+  cache->Clear();
+  EXPECT_EQ(cache->num_entries(), 0);
+  EXPECT_EQ(handler.use_count(), 1);
+  EXPECT_EQ(cache->Lookup({1, 2}), std::nullopt);
+}
+
+}  // namespace
+}  // namespace litert::lm
@@ -14,6 +14,7 @@
 
 #include "runtime/framework/resource_management/resource_manager.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -27,6 +28,8 @@
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
 #include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "absl/time/clock.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
 #include "absl/types/span.h"  // from @com_google_absl
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
 #include "runtime/components/model_resources.h"
@@ -35,6 +38,7 @@
 #include "runtime/executor/audio_executor.h"
 #include "runtime/executor/audio_executor_settings.h"
 #include "runtime/executor/executor_settings_base.h"
+#include "runtime/executor/llm_context_snapshot.h"
 #include "runtime/executor/llm_executor.h"
 #include "runtime/executor/llm_executor_io_types.h"
 #include "runtime/executor/llm_executor_processed_tokens.h"
@@ -42,6 +46,8 @@
 #include "runtime/executor/vision_executor.h"
 #include "runtime/executor/vision_executor_settings.h"
 #include "runtime/framework/resource_management/context_handler/context_handler.h"
+#include "runtime/framework/resource_management/kv_cache_offloader/kv_cache_offloader.h"
+#include "runtime/framework/resource_management/prefix_cache/prefix_cache.h"
 #include "runtime/framework/resource_management/utils/movable_mutex_lock.h"
 #include "runtime/framework/resource_management/utils/resource_manager_utils.h"
 #include "runtime/util/convert_tensor_buffer.h"
@@ -57,10 +63,12 @@ namespace {
 // context_handler is assumed to be loaded in the llm_executor via the
 // AcquireWithContext method, meaning the context_handler should not own any
 // RuntimeState, RuntimeConfig and actual ProcessedContext within it, as they
-// are all owned by the llm_executor at this point.
+// are all owned by the llm_executor at this point. The saved processed context
+// is reported idle to `kv_cache_offloader`, if not null.
 absl::Status SaveProcessedContextAndSeparateLoadedHandler(
     std::shared_ptr<ContextHandler> context_handler,
-    std::shared_ptr<LlmExecutor> llm_executor) {
+    std::shared_ptr<LlmExecutor> llm_executor,
+    KvCacheOffloader* absl_nullable kv_cache_offloader) {
   RET_CHECK_EQ(
       context_handler->HasRuntimeConfig() ||
           context_handler->HasRuntimeState() ||
@@ -74,14 +82,42 @@ absl::Status SaveProcessedContextAndSeparateLoadedHandler(
   ASSIGN_OR_RETURN(auto llm_context, llm_executor->CloneContext());
   ASSIGN_OR_RETURN(auto current_processed_context,
                    llm_context->RetrieveProcessedContext());
-  RETURN_IF_ERROR(
-      context_handler->shared_processed_context()->SetProcessedContext(
-          std::move(current_processed_context)));
+  auto saved_shared_processed_context =
+      context_handler->shared_processed_context();
+  RETURN_IF_ERROR(saved_shared_processed_context->SetProcessedContext(
+      std::move(current_processed_context)));
 
   auto new_shared_processed_context =
       std::make_shared<ContextHandler::SharedProcessedContext>(nullptr);
   RETURN_IF_ERROR(context_handler->UpdateSharedProcessedContext(
       new_shared_processed_context));
+  if (kv_cache_offloader != nullptr) {
+    RETURN_IF_ERROR(kv_cache_offloader->MarkIdle(
+        std::move(saved_shared_processed_context)));
+  }
+  return absl::OkStatus();
+}
+
+// Moves the runtime config, runtime state and processed context of
+// `llm_context` into `context_handler`. The saved processed context is
+// reported idle to `kv_cache_offloader`, if not null.
+absl::Status SaveLlmContextToHandler(
+    std::unique_ptr<LlmContext> llm_context, ContextHandler& context_handler,
+    KvCacheOffloader* absl_nullable kv_cache_offloader) {
+  ASSIGN_OR_RETURN(auto runtime_config, llm_context->RetrieveRuntimeConfig());
+  ASSIGN_OR_RETURN(auto runtime_state, llm_context->RetrieveRuntimeState());
+  ASSIGN_OR_RETURN(auto processed_context,
+                   llm_context->RetrieveProcessedContext());
+
+  RETURN_IF_ERROR(context_handler.SetRuntimeConfig(std::move(runtime_config)));
+  RETURN_IF_ERROR(context_handler.SetRuntimeState(std::move(runtime_state)));
+  RETURN_IF_ERROR(
+      context_handler.shared_processed_context()->SetProcessedContext(
+          std::move(processed_context)));
+  if (kv_cache_offloader != nullptr) {
+    RETURN_IF_ERROR(kv_cache_offloader->MarkIdle(
+        context_handler.shared_processed_context()));
+  }
   return absl::OkStatus();
 }
 
@@ -160,13 +196,17 @@ class LockedAudioExecutor : public AudioExecutor {
 class LockedLlmExecutor : public LlmExecutor {
  public:
   // LockedLlmExecutor takes ownership of the mutex lock and holds the
-  // shared_ptr to the executor.
-  LockedLlmExecutor(std::shared_ptr<LlmExecutor> executor,
-                    MovableMutexLock lock,
-                    std::shared_ptr<ContextHandler> current_handler = nullptr)
+  // shared_ptr to the executor. The processed contexts saved by the copy on
+  // write logic are reported idle to `kv_cache_offloader`, if not null, which
+  // the lock guards.
+  LockedLlmExecutor(
+      std::shared_ptr<LlmExecutor> executor, MovableMutexLock lock,
+      std::shared_ptr<ContextHandler> current_handler = nullptr,
+      KvCacheOffloader* absl_nullable kv_cache_offloader = nullptr)
       : current_handler_(current_handler),
         llm_executor_(std::move(executor)),
-        lock_(std::move(lock)) {}
+        lock_(std::move(lock)),
+        kv_cache_offloader_(kv_cache_offloader) {}
 
   absl::string_view ExecutorBackendName() const override {
     return llm_executor_->ExecutorBackendName();
@@ -295,7 +335,7 @@ class LockedLlmExecutor : public LlmExecutor {
       // processed_context for the previous handler, and update the current
       // handler's shared_processed_context.
       RETURN_IF_ERROR(SaveProcessedContextAndSeparateLoadedHandler(
-          current_handler_, llm_executor_));
+          current_handler_, llm_executor_, kv_cache_offloader_));
     }
     // Update the current step since the new processed context (set above)
     // might not match the executor's current step, and the processed
@@ -348,6 +388,28 @@ class LockedLlmExecutor : public LlmExecutor {
     return llm_executor_->RestoreContext(std::move(llm_context));
   }
 
+  bool CanSwapContext() const override {
+    return llm_executor_->CanSwapContext();
+  }
+
+  uint64_t GetNumKvCacheBytesCopied() const override {
+    return llm_executor_->GetNumKvCacheBytesCopied();
+  }
+
+  absl::StatusOr<std::unique_ptr<LlmContext>> SwapContext(
+      std::unique_ptr<LlmContext> llm_context) override {
+    return llm_executor_->SwapContext(std::move(llm_context));
+  }
+
+  absl::Status SaveContextSnapshot(LlmContextSnapshotWriter& writer) override {
+    return llm_executor_->SaveContextSnapshot(writer);
+  }
+
+  absl::Status LoadContextSnapshot(
+      std::shared_ptr<LlmContextSnapshot> snapshot) override {
+    return llm_executor_->LoadContextSnapshot(std::move(snapshot));
+  }
+
   absl::Status UpdateRuntimeConfig(
       const RuntimeConfig& runtime_config) override {
     return llm_executor_->UpdateRuntimeConfig(runtime_config);
@@ -416,7 +478,7 @@ class LockedLlmExecutor : public LlmExecutor {
       // processed_context for the previous handler, and update the current
       // handler's shared_processed_context.
       RETURN_IF_ERROR(SaveProcessedContextAndSeparateLoadedHandler(
-          current_handler_, llm_executor_));
+          current_handler_, llm_executor_, kv_cache_offloader_));
     }
     // Update the current step since the new processed context (set above)
     // might not match the executor's current step, and the processed
@@ -434,6 +496,9 @@ class LockedLlmExecutor : public LlmExecutor {
 
   // The mutex lock.
   MovableMutexLock lock_;
+
+  // The offloader of the idle kv-caches, null if disabled.
+  KvCacheOffloader* absl_nullable kv_cache_offloader_;
 };
 
 std::optional<uint32_t> ResourceManager::AssignLoraId(
@@ -603,6 +668,63 @@ ResourceManager::CloneContextHandler(
       std::make_unique<RuntimeState>(runtime_state), std::move(audio_context));
 }
 
+bool ResourceManager::HasPrefixCache() {
+  MovableMutexLock lock(&executor_mutex_);
+  return prefix_cache_ != nullptr;
+}
+
+absl::StatusOr<int> ResourceManager::AttachToCachedPrefix(
+    std::shared_ptr<ContextHandler> context_handler,
+    absl::Span<const int> token_ids) {
+  RET_CHECK_NE(context_handler, nullptr)
+      << "The provided context handler should not be null.";
+  if (token_ids.empty()) {
+    return 0;
+  }
+
+  MovableMutexLock lock(&executor_mutex_);
+  if (prefix_cache_ == nullptr) {
+    return 0;
+  }
+  // A loaded handler or a handler that already processed some tokens owns a
+  // processed context that must not be replaced.
+  if (context_handler == current_handler_ ||
+      !context_handler->HasRuntimeState()) {
+    return 0;
+  }
+  ASSIGN_OR_RETURN(auto runtime_state, context_handler->GetRuntimeState());
+  if (runtime_state.current_step != 0) {
+    return 0;
+  }
+
+  auto match = prefix_cache_->Lookup(token_ids);
+  if (!match.has_value()) {
+    return 0;
+  }
+  RETURN_IF_ERROR(context_handler->UpdateSharedProcessedContext(
+      match->context_handler->shared_processed_context()));
+  return match->num_matched_tokens;
+}
+
+absl::Status ResourceManager::CachePrefix(
+    std::shared_ptr<const ContextHandler> context_handler,
+    absl::Span<const int> token_ids) {
+  if (!HasPrefixCache()) {
+    return absl::OkStatus();
+  }
+  // The clone shares the processed context and keeps its own time step, which
+  // protects the cached tokens from being overwritten by the copy on write
+  // logic.
+  ASSIGN_OR_RETURN(std::shared_ptr<const ContextHandler> pinned_handler,
+                   CloneContextHandler(std::move(context_handler)));
+  ASSIGN_OR_RETURN(auto runtime_state, pinned_handler->GetRuntimeState());
+  RET_CHECK_EQ(runtime_state.current_step,
+               static_cast<int>(token_ids.size()))
+      << "The token ids do not match the processed tokens of the handler.";
+  MovableMutexLock lock(&executor_mutex_);
+  return prefix_cache_->Insert(token_ids, std::move(pinned_handler));
+}
+
 absl::StatusOr<std::unique_ptr<LlmExecutor>>
 ResourceManager::AcquireExecutor() {
   MovableMutexLock lock(&executor_mutex_);
@@ -633,8 +755,10 @@ ResourceManager::AcquireExecutorWithContextHandler(
   // executor directly.
   if (new_context_handler == current_handler_) {
     return std::make_unique<LockedLlmExecutor>(llm_executor_, std::move(lock),
-                                               current_handler_);
+                                               current_handler_,
+                                               kv_cache_offloader_.get());
   }
+  const absl::Time switch_start = absl::Now();
 
   // If both handler are sharing the same processed context, save the
   // runtime config and runtime state back to the current handler. Then
@@ -657,26 +781,31 @@ ResourceManager::AcquireExecutorWithContextHandler(
                      new_context_handler->RetrieveRuntimeState());
     RETURN_IF_ERROR(llm_executor_->UpdateRuntimeConfig(*new_runtime_config));
     RETURN_IF_ERROR(llm_executor_->UpdateRuntimeState(*new_runtime_state));
+    ++context_switch_stats_.num_zero_copy_switches;
   } else {
     // If the new handler is not sharing the same processed context with the
-    // current handler, clone the processed context to the new handler. Then
-    // restore the executor with the new LlmContext.
-    if (current_handler_ != nullptr) {
+    // current handler, swap the new LlmContext into the executor, so that
+    // only the buffer handles change hands. Executors which can't swap
+    // contexts clone the loaded context back to the current handler before
+    // restoring the new one instead, which copies the kv-cache.
+    //
+    // The kv-cache of the new context may have been offloaded while it was
+    // idle. Reload it first, so that it is not offloaded again when the
+    // current context goes idle, and so that a failed reload leaves the new
+    // handler as it was.
+    if (kv_cache_offloader_ != nullptr) {
+      RETURN_IF_ERROR(kv_cache_offloader_->MarkActive(
+          *new_context_handler->shared_processed_context()));
+    }
+
+    const bool can_swap_context = llm_executor_->CanSwapContext();
+    if (!can_swap_context && current_handler_ != nullptr) {
       ASSIGN_OR_RETURN(auto current_llm_context, llm_executor_->CloneContext());
-      ASSIGN_OR_RETURN(auto current_runtime_config,
-                       current_llm_context->RetrieveRuntimeConfig());
-      ASSIGN_OR_RETURN(auto current_runtime_state,
-                       current_llm_context->RetrieveRuntimeState());
-      ASSIGN_OR_RETURN(auto current_processed_context,
-                       current_llm_context->RetrieveProcessedContext());
-
-      RETURN_IF_ERROR(current_handler_->SetRuntimeConfig(
-          std::move(current_runtime_config)));
-      RETURN_IF_ERROR(
-          current_handler_->SetRuntimeState(std::move(current_runtime_state)));
-      RETURN_IF_ERROR(
-          current_handler_->shared_processed_context()->SetProcessedContext(
-              std::move(current_processed_context)));
+      context_switch_stats_.num_bytes_copied +=
+          current_llm_context->processed_context().GetKvCacheSizeInBytes();
+      RETURN_IF_ERROR(SaveLlmContextToHandler(std::move(current_llm_context),
+                                              *current_handler_,
+                                              kv_cache_offloader_.get()));
     }
 
     ASSIGN_OR_RETURN(auto new_runtime_config,
@@ -689,7 +818,19 @@ ResourceManager::AcquireExecutorWithContextHandler(
     auto llm_context = std::make_unique<LlmContext>(
         std::move(new_processed_context), std::move(new_runtime_config),
         std::move(new_runtime_state));
-    RETURN_IF_ERROR(llm_executor_->RestoreContext(std::move(llm_context)));
+
+    if (can_swap_context) {
+      ASSIGN_OR_RETURN(auto current_llm_context,
+                       llm_executor_->SwapContext(std::move(llm_context)));
+      ++context_switch_stats_.num_zero_copy_switches;
+      if (current_handler_ != nullptr) {
+        RETURN_IF_ERROR(SaveLlmContextToHandler(std::move(current_llm_context),
+                                                *current_handler_,
+                                                kv_cache_offloader_.get()));
+      }
+    } else {
+      RETURN_IF_ERROR(llm_executor_->RestoreContext(std::move(llm_context)));
+    }
   }
 
   // If the current handler has an audio context, update and save the audio
@@ -716,9 +857,27 @@ ResourceManager::AcquireExecutorWithContextHandler(
   }
 
   current_handler_ = new_context_handler;
+  ++context_switch_stats_.num_context_switches;
+  const absl::Duration switch_duration = absl::Now() - switch_start;
+  context_switch_stats_.total_duration += switch_duration;
+  context_switch_stats_.max_duration =
+      std::max(context_switch_stats_.max_duration, switch_duration);
 
   return std::make_unique<LockedLlmExecutor>(llm_executor_, std::move(lock),
-                                             current_handler_);
+                                             current_handler_,
+                                             kv_cache_offloader_.get());
+}
+
+ContextSwitchStats ResourceManager::GetContextSwitchStats() {
+  MovableMutexLock lock(&executor_mutex_);
+  ContextSwitchStats stats = context_switch_stats_;
+  if (kv_cache_offloader_ != nullptr) {
+    const KvCacheOffloadStats& offload_stats = kv_cache_offloader_->stats();
+    stats.num_kv_cache_offloads = offload_stats.num_offloads;
+    stats.num_kv_cache_reloads = offload_stats.num_reloads;
+    stats.num_kv_cache_bytes_offloaded = offload_stats.num_bytes_offloaded;
+  }
+  return stats;
 }
 
 absl::Status ResourceManager::TryLoadingVisionExecutor() {
@@ -783,10 +942,37 @@ absl::StatusOr<std::unique_ptr<ResourceManager>> ResourceManager::Create(
   if (llm_executor == nullptr) {
     return absl::InvalidArgumentError("Llm executor is null.");
   }
+  // Not all the executors expose their settings, the prefix cache and the
+  // kv-cache offloader stay disabled for those.
+  std::optional<AdvancedSettings> advanced_settings;
+  auto executor_settings = llm_executor->GetExecutorSettings();
+  if (executor_settings.ok()) {
+    advanced_settings = executor_settings->GetAdvancedSettings();
+  }
+  const int prefix_cache_max_num_entries =
+      advanced_settings.has_value()
+          ? advanced_settings->prefix_cache_max_num_entries
+          : 0;
   auto llm_resource_manager = std::make_unique<ResourceManager>(
       model_resources, std::move(llm_executor),
       std::move(vision_executor_settings), std::move(audio_executor_settings),
       litert_env);
+  if (prefix_cache_max_num_entries > 0) {
+    ASSIGN_OR_RETURN(auto prefix_cache,
+                     PrefixCache::Create(prefix_cache_max_num_entries));
+    absl::MutexLock lock(llm_resource_manager->executor_mutex_);
+    llm_resource_manager->prefix_cache_ = std::move(prefix_cache);
+  }
+  if (advanced_settings.has_value() &&
+      advanced_settings->max_idle_kv_cache_size_bytes > 0) {
+    ASSIGN_OR_RETURN(auto kv_cache_offloader,
+                     KvCacheOffloader::Create(
+                         advanced_settings->max_idle_kv_cache_size_bytes,
+                         advanced_settings->idle_kv_cache_quantization,
+                         advanced_settings->idle_kv_cache_spill_directory));
+    absl::MutexLock lock(llm_resource_manager->executor_mutex_);
+    llm_resource_manager->kv_cache_offloader_ = std::move(kv_cache_offloader);
+  }
   return llm_resource_manager;
 }
 
@@ -27,6 +27,8 @@
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "litert/cc/litert_environment.h"  // from @litert
 #include "runtime/components/model_resources.h"
 #include "runtime/engine/engine_settings.h"
@@ -36,9 +38,35 @@
 #include "runtime/executor/vision_executor.h"
 #include "runtime/executor/vision_executor_settings.h"
 #include "runtime/framework/resource_management/context_handler/context_handler.h"
+#include "runtime/framework/resource_management/kv_cache_offloader/kv_cache_offloader.h"
+#include "runtime/framework/resource_management/prefix_cache/prefix_cache.h"
 
 namespace litert::lm {
 
+// The statistics of the context switches of the executor, i.e. of the
+// acquisitions of the executor with another context than the loaded one.
+struct ContextSwitchStats {
+  // The number of context switches.
+  int64_t num_context_switches = 0;
+  // The number of context switches which copied no kv-cache, i.e. between
+  // contexts sharing the processed context, or swapped by the executor.
+  int64_t num_zero_copy_switches = 0;
+  // The number of kv-cache bytes copied to save the loaded contexts, as
+  // reported by the processed contexts.
+  int64_t num_bytes_copied = 0;
+  // The total time spent saving the loaded context and loading the new one.
+  absl::Duration total_duration = absl::ZeroDuration();
+  // The longest context switch.
+  absl::Duration max_duration = absl::ZeroDuration();
+  // The number of idle kv-caches offloaded to keep the idle sessions within
+  // AdvancedSettings::max_idle_kv_cache_size_bytes, and loaded back, see
+  // KvCacheOffloader.
+  int64_t num_kv_cache_offloads = 0;
+  int64_t num_kv_cache_reloads = 0;
+  // The number of bytes of memory released by the offloads.
+  int64_t num_kv_cache_bytes_offloaded = 0;
+};
+
 // The ResourceManager provides thread-safe access to shared resources such
 // as the LlmExecutor, enabling multiple sessions to utilize it concurrently.
 class ResourceManager {
@@ -99,6 +127,32 @@ class ResourceManager {
   absl::StatusOr<std::unique_ptr<ContextHandler>> CloneContextHandler(
       std::shared_ptr<const ContextHandler> llm_context_handler);
 
+  // Returns true if the prefix cache of this resource manager is enabled, i.e.
+  // AdvancedSettings::prefix_cache_max_num_entries of the llm executor is
+  // positive.
+  bool HasPrefixCache() ABSL_LOCKS_EXCLUDED(executor_mutex_);
+
+  // Attaches the provided context handler to the cached prefix sharing the
+  // longest prefix with `token_ids`. The following prefill of `token_ids` then
+  // only processes the tokens after the shared prefix, and the copy on write
+  // logic forks the cached processed context if needed.
+  // Only handlers which have not processed any token yet and are not loaded
+  // in the executor are attached.
+  // Returns the number of tokens shared with the cached prefix, 0 if the
+  // handler is not attached.
+  absl::StatusOr<int> AttachToCachedPrefix(
+      std::shared_ptr<ContextHandler> context_handler,
+      absl::Span<const int> token_ids) ABSL_LOCKS_EXCLUDED(executor_mutex_);
+
+  // Adds the processed context of the provided context handler to the prefix
+  // cache, so that other sessions can reuse it. `token_ids` must be the tokens
+  // processed by the handler so far. The cache pins a clone of the handler,
+  // thus the handler itself can keep going. No-op if the prefix cache is
+  // disabled.
+  absl::Status CachePrefix(
+      std::shared_ptr<const ContextHandler> context_handler,
+      absl::Span<const int> token_ids) ABSL_LOCKS_EXCLUDED(executor_mutex_);
+
   // Acquires the executor without any context handler. This function should
   // only be called when the usage of the returned executor does not involve any
   // state updates, e.g. CreateContext, GetCurrentStep(), etc.
@@ -119,6 +173,12 @@ class ResourceManager {
       ABSL_LOCKS_EXCLUDED(executor_mutex_)
           ABSL_LOCKS_EXCLUDED(audio_executor_mutex_);
 
+  // Returns the statistics of the context switches done by
+  // AcquireExecutorWithContextHandler() so far, e.g. to weigh the cost of
+  // interleaving the sessions.
+  ContextSwitchStats GetContextSwitchStats()
+      ABSL_LOCKS_EXCLUDED(executor_mutex_);
+
   // Try to load the vision executor if the vision executor is not loaded.
   absl::Status TryLoadingVisionExecutor()
       ABSL_LOCKS_EXCLUDED(vision_executor_mutex_);
@@ -149,6 +209,19 @@ class ResourceManager {
   std::shared_ptr<ContextHandler> current_handler_
       ABSL_GUARDED_BY(executor_mutex_);
 
+  // The statistics of the context switches of the executor.
+  ContextSwitchStats context_switch_stats_ ABSL_GUARDED_BY(executor_mutex_);
+
+  // The prefix cache shared by the sessions of this resource manager, i.e. of
+  // its llm executor, null if disabled. The cached contexts hold kv-cache
+  // buffers of that executor, so each executor of a pool has its own cache.
+  std::unique_ptr<PrefixCache> prefix_cache_ ABSL_GUARDED_BY(executor_mutex_);
+
+  // Offloads the kv-caches of the contexts saved out of the executor beyond
+  // the idle kv-cache budget, null if disabled.
+  std::unique_ptr<KvCacheOffloader> kv_cache_offloader_
+      ABSL_GUARDED_BY(executor_mutex_);
+
   // Map lora id from hash. If lora is provided by lora path, lora path will be
   // treated as the hash key.
   absl::flat_hash_map<std::string, uint32_t> lora_hash_to_id_;
@@ -22,11 +22,31 @@
 
 namespace litert::lm {
 
+// Scheduling policies of a thread, see sched(7). Only supported on Linux.
+enum class SchedulingPolicy {
+  // Inherits the policy of the creating thread.
+  kDefault,
+  // SCHED_OTHER, the standard time-sharing policy.
+  kOther,
+  // SCHED_BATCH, for CPU-bound threads which may wait longer to be scheduled.
+  kBatch,
+  // SCHED_IDLE, for threads which only run when nothing else is runnable.
+  kIdle,
+  // SCHED_FIFO and SCHED_RR, the real-time policies. They usually require
+  // CAP_SYS_NICE.
+  kFifo,
+  kRoundRobin,
+};
+
 // Options to configure a thread.  Default values are listed in
 // the field descriptions.
 class ThreadOptions {
  public:
-  ThreadOptions() : stack_size_(0), nice_priority_level_(0) {}
+  ThreadOptions()
+      : stack_size_(0),
+        nice_priority_level_(0),
+        scheduling_policy_(SchedulingPolicy::kDefault),
+        realtime_priority_(0) {}
 
   // Set the thread stack size (in bytes).  Passing stack_size==0 resets
   // the stack size to the default value for the system. The system default
@@ -46,6 +66,15 @@ class ThreadOptions {
     return *this;
   }
 
+  // The policy and, for kFifo and kRoundRobin, the static priority in
+  // [1, 99] the thread is scheduled with.
+  ThreadOptions& set_scheduling_policy(SchedulingPolicy scheduling_policy,
+                                       int realtime_priority = 0) {
+    scheduling_policy_ = scheduling_policy;
+    realtime_priority_ = realtime_priority;
+    return *this;
+  }
+
   ThreadOptions& set_name_prefix(const std::string& name_prefix) {
     name_prefix_ = name_prefix;
     return *this;
@@ -57,13 +86,19 @@ class ThreadOptions {
 
   const std::set<int>& cpu_set() const { return cpu_set_; }
 
+  SchedulingPolicy scheduling_policy() const { return scheduling_policy_; }
+
+  int realtime_priority() const { return realtime_priority_; }
+
   std::string name_prefix() const { return name_prefix_; }
 
  private:
-  size_t stack_size_;        // Size of thread stack
-  int nice_priority_level_;  // Nice priority level of the workers
-  std::set<int> cpu_set_;    // CPU set for affinity setting
-  std::string name_prefix_;  // Name of the thread
+  size_t stack_size_;                   // Size of thread stack
+  int nice_priority_level_;             // Nice priority level of the workers
+  std::set<int> cpu_set_;               // CPU set for affinity setting
+  SchedulingPolicy scheduling_policy_;  // Scheduling policy of the workers
+  int realtime_priority_;               // Priority of the real-time policies
+  std::string name_prefix_;             // Name of the thread
 };
 
 }  // namespace litert::lm
@@ -0,0 +1,145 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Contention micro-benchmark of the thread pools.
+//
+// Compares ThreadPool, where all the callbacks go through a single locked
+// queue, with WorkStealingThreadPool on tiny callbacks scheduled by many
+// threads, by the workers themselves, and split by ParallelFor, e.g.
+//
+//   threadpool_benchmark --num_threads=8 --num_tasks=100000
+
+#include <cstdint>
+#include <iostream>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/flags/flag.h"  // from @com_google_absl
+#include "absl/flags/parse.h"  // from @com_google_absl
+#include "absl/log/absl_check.h"  // from @com_google_absl
+#include "absl/strings/str_format.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "runtime/framework/threadpool.h"
+#include "runtime/framework/work_stealing_threadpool.h"
+#include "runtime/util/benchmark_utils.h"
+
+ABSL_FLAG(int, num_threads, 8, "Number of threads of the pools.");
+ABSL_FLAG(int, num_producers, 8,
+          "Number of threads scheduling callbacks concurrently.");
+ABSL_FLAG(int, num_tasks, 100000, "Number of callbacks per run.");
+ABSL_FLAG(int, iterations, 10, "Number of timed runs of every benchmark.");
+
+namespace litert::lm {
+namespace {
+
+// A callback small enough for the scheduling to dominate.
+void TinyTask(int i) {
+  int64_t x = i;
+  for (int j = 0; j < 16; ++j) {
+    x = x * 6364136223846793005 + 1442695040888963407;
+  }
+  AddToChecksum(x & 1);
+}
+
+// `num_producers` threads schedule `num_tasks` callbacks in total.
+template <typename Pool>
+void ManyProducers(Pool& pool, int num_producers, int num_tasks) {
+  std::vector<std::thread> producers;
+  for (int p = 0; p < num_producers; ++p) {
+    producers.emplace_back([&pool, p, num_producers, num_tasks]() {
+      for (int i = p; i < num_tasks; i += num_producers) {
+        ABSL_CHECK_OK(pool.Schedule([i]() { TinyTask(i); }));
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  ABSL_CHECK_OK(pool.WaitUntilDone(absl::Minutes(1)));
+}
+
+// A callback of the pool schedules `num_tasks` callbacks.
+template <typename Pool>
+void Nested(Pool& pool, int num_tasks) {
+  ABSL_CHECK_OK(pool.Schedule([&pool, num_tasks]() {
+    for (int i = 0; i < num_tasks; ++i) {
+      ABSL_CHECK_OK(pool.Schedule([i]() { TinyTask(i); }));
+    }
+  }));
+  ABSL_CHECK_OK(pool.WaitUntilDone(absl::Minutes(1)));
+}
+
+// What callers of ThreadPool do for lack of a ParallelFor: one callback per
+// iteration.
+void ScheduleAll(ThreadPool& pool, int num_tasks) {
+  for (int i = 0; i < num_tasks; ++i) {
+    ABSL_CHECK_OK(pool.Schedule([i]() { TinyTask(i); }));
+  }
+  ABSL_CHECK_OK(pool.WaitUntilDone(absl::Minutes(1)));
+}
+
+void Run() {
+  const int num_threads = absl::GetFlag(FLAGS_num_threads);
+  const int num_producers = absl::GetFlag(FLAGS_num_producers);
+  const int num_tasks = absl::GetFlag(FLAGS_num_tasks);
+  const int iterations = absl::GetFlag(FLAGS_iterations);
+
+  ThreadPool pool("benchmark", num_threads);
+  WorkStealingThreadPool work_stealing_pool("benchmark", num_threads);
+
+  std::cout << absl::StrFormat(
+      "num_threads=%d num_producers=%d num_tasks=%d iterations=%d\n",
+      num_threads, num_producers, num_tasks, iterations);
+  PrintSpeedupHeader("pool");
+
+  const double many_producers = TimeMicros(
+      [&] { ManyProducers(pool, num_producers, num_tasks); }, iterations);
+  ReportSpeedup("many_producers", "threadpool", many_producers, many_producers);
+  ReportSpeedup("many_producers", "work_stealing",
+                TimeMicros(
+                    [&] {
+                      ManyProducers(work_stealing_pool, num_producers,
+                                    num_tasks);
+                    },
+                    iterations),
+                many_producers);
+
+  const double nested =
+      TimeMicros([&] { Nested(pool, num_tasks); }, iterations);
+  ReportSpeedup("nested", "threadpool", nested, nested);
+  ReportSpeedup(
+      "nested", "work_stealing",
+      TimeMicros([&] { Nested(work_stealing_pool, num_tasks); }, iterations),
+      nested);
+
+  const double parallel_for =
+      TimeMicros([&] { ScheduleAll(pool, num_tasks); }, iterations);
+  ReportSpeedup("parallel_for", "threadpool", parallel_for, parallel_for);
+  ReportSpeedup(
+      "parallel_for", "work_stealing",
+      TimeMicros([&] { work_stealing_pool.ParallelFor(num_tasks, TinyTask); },
+                 iterations),
+      parallel_for);
+
+  PrintChecksum();
+}
+
+}  // namespace
+}  // namespace litert::lm
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+  litert::lm::Run();
+  return 0;
+}
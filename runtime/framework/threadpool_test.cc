@@ -113,6 +113,21 @@ TEST(ThreadPoolTest, CreateWithCPUAffinity) {
   EXPECT_EQ(thread_pool.thread_options().cpu_set().size(), 1);
 }
 
+TEST(ThreadPoolTest, CreateWithSchedulingPolicy) {
+  ThreadOptions thread_options =
+      ThreadOptions().set_scheduling_policy(SchedulingPolicy::kBatch);
+  std::atomic<int> n = 10;
+  {
+    ThreadPool thread_pool("testpool", 1, thread_options);
+    EXPECT_EQ(thread_pool.thread_options().scheduling_policy(),
+              SchedulingPolicy::kBatch);
+    for (int i = 0; i < 10; ++i) {
+      EXPECT_OK(thread_pool.Schedule([&n]() { --n; }));
+    }
+  }
+  EXPECT_EQ(n, 0);
+}
+
 TEST(ThreadPoolTest, WaitUntilIdle) {
   ThreadPool thread_pool("testpool", 1);
   EXPECT_EQ(thread_pool.max_num_threads(), 1);
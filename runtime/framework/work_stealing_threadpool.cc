@@ -0,0 +1,371 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/framework/work_stealing_threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/functional/any_invocable.h"  // from @com_google_absl
+#include "absl/functional/function_ref.h"  // from @com_google_absl
+#include "absl/log/absl_check.h"  // from @com_google_absl
+#include "absl/log/absl_log.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "absl/synchronization/notification.h"  // from @com_google_absl
+#include "absl/time/clock.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "runtime/framework/thread_options.h"
+#include "runtime/framework/worker_thread.h"
+
+namespace litert::lm {
+namespace {
+
+// The pool and the index of the worker running on the current thread, if any.
+thread_local const WorkStealingThreadPool* current_pool = nullptr;
+thread_local int current_worker = -1;
+
+}  // namespace
+
+WorkStealingThreadPool::TaskDeque::TaskDeque()
+    : tasks_(std::make_unique<std::atomic<Task*>[]>(kCapacity)) {}
+
+bool WorkStealingThreadPool::TaskDeque::Push(Task* task) {
+  const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+  const int64_t top = top_.load(std::memory_order_acquire);
+  if (bottom - top >= kCapacity) {
+    return false;
+  }
+  tasks_[bottom % kCapacity].store(task, std::memory_order_relaxed);
+  bottom_.store(bottom + 1, std::memory_order_release);
+  return true;
+}
+
+WorkStealingThreadPool::Task* WorkStealingThreadPool::TaskDeque::Pop() {
+  const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+  // Claim the bottom task before looking at the top, as a concurrent Steal()
+  // may take it.
+  bottom_.store(bottom, std::memory_order_seq_cst);
+  int64_t top = top_.load(std::memory_order_seq_cst);
+  if (top > bottom) {
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  Task* task = tasks_[bottom % kCapacity].load(std::memory_order_relaxed);
+  if (top == bottom) {
+    // The last task: race against the thieves for it.
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      task = nullptr;
+    }
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+  }
+  return task;
+}
+
+WorkStealingThreadPool::Task* WorkStealingThreadPool::TaskDeque::Steal() {
+  int64_t top = top_.load(std::memory_order_seq_cst);
+  const int64_t bottom = bottom_.load(std::memory_order_seq_cst);
+  if (top >= bottom) {
+    return nullptr;
+  }
+  Task* task = tasks_[top % kCapacity].load(std::memory_order_acquire);
+  if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                    std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  return task;
+}
+
+bool WorkStealingThreadPool::TaskDeque::Empty() const {
+  return bottom_.load(std::memory_order_acquire) <=
+         top_.load(std::memory_order_acquire);
+}
+
+WorkStealingThreadPool::WorkStealingThreadPool(const std::string& name_prefix,
+                                               size_t max_num_threads,
+                                               ThreadOptions thread_options)
+    : name_prefix_(name_prefix),
+      max_num_threads_(max_num_threads == 0 ? 1 : max_num_threads),
+      thread_options_(std::move(thread_options)) {
+  workers_.reserve(max_num_threads_);
+  for (size_t i = 0; i < max_num_threads_; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  ABSL_LOG(INFO) << "WorkStealingThreadPool '" << name_prefix_
+                 << "': Running up to " << max_num_threads_ << " threads.";
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  ABSL_LOG(INFO) << "WorkStealingThreadPool '" << name_prefix_
+                 << "': Shutting down...";
+
+  std::vector<std::unique_ptr<WorkerThread>> threads_to_join;
+  {
+    absl::MutexLock lock(mutex_);
+    stopped_.store(true, std::memory_order_seq_cst);
+    wake_up_.SignalAll();
+    threads_to_join.swap(threads_);
+  }
+
+  for (auto& thread_ptr : threads_to_join) {
+    // Wait for each worker thread to finish.
+    ABSL_CHECK_OK(thread_ptr->Join());
+  }
+
+  ABSL_CHECK_EQ(num_unfinished_tasks_.load(), 0);
+  ABSL_LOG(INFO) << "WorkStealingThreadPool '" << name_prefix_
+                 << "': Shutdown complete.";
+}
+
+absl::Status WorkStealingThreadPool::Schedule(
+    absl::AnyInvocable<void() &&> callback) {
+  if (stopped_.load(std::memory_order_acquire)) {
+    ABSL_LOG(WARNING) << "WorkStealingThreadPool '" << name_prefix_
+                      << "': Schedule called on a stopped pool.";
+    return absl::FailedPreconditionError(
+        absl::StrCat("ThreadPool '", name_prefix_, "' is stopped."));
+  }
+  absl::Status status = MaybeSpawnWorker();
+  if (!status.ok()) {
+    return status;
+  }
+
+  auto* task = new Task(std::move(callback));
+  num_unfinished_tasks_.fetch_add(1, std::memory_order_seq_cst);
+  num_pending_tasks_.fetch_add(1, std::memory_order_seq_cst);
+  if (current_pool != this || !workers_[current_worker]->deque.Push(task)) {
+    // Spread the callbacks of other threads over the workers.
+    const int index =
+        current_pool == this
+            ? current_worker
+            : next_injected_.fetch_add(1, std::memory_order_relaxed) %
+                  num_threads();
+    Worker& worker = *workers_[index];
+    absl::MutexLock lock(worker.mutex);
+    worker.injected.push_back(task);
+    worker.num_injected.fetch_add(1, std::memory_order_release);
+  }
+  WakeUpWorker();
+  return absl::OkStatus();
+}
+
+void WorkStealingThreadPool::ParallelFor(int num_iterations,
+                                         absl::FunctionRef<void(int)> fn) {
+  if (num_iterations <= 0) {
+    return;
+  }
+  struct State {
+    State(int num_iterations, absl::FunctionRef<void(int)> fn)
+        : num_iterations(num_iterations), fn(fn) {}
+
+    const int num_iterations;
+    const absl::FunctionRef<void(int)> fn;
+    std::atomic<int> next_iteration{0};
+    std::atomic<int> num_done_iterations{0};
+    absl::Notification done;
+  };
+  // Helpers which start after all the iterations are claimed return without
+  // calling `fn`, so they may outlive this call.
+  auto state = std::make_shared<State>(num_iterations, fn);
+  auto run_iterations = [](State& state) {
+    for (int i = state.next_iteration.fetch_add(1); i < state.num_iterations;
+         i = state.next_iteration.fetch_add(1)) {
+      state.fn(i);
+      if (state.num_done_iterations.fetch_add(1) + 1 == state.num_iterations) {
+        state.done.Notify();
+      }
+    }
+  };
+
+  const int num_helpers =
+      std::min<size_t>(num_iterations - 1, max_num_threads_);
+  for (int i = 0; i < num_helpers; ++i) {
+    if (!Schedule([state, run_iterations]() { run_iterations(*state); })
+             .ok()) {
+      // The calling thread runs the remaining iterations.
+      break;
+    }
+  }
+  run_iterations(*state);
+  state->done.WaitForNotification();
+}
+
+absl::Status WorkStealingThreadPool::WaitUntilIdle(absl::Duration timeout) {
+  absl::MutexLock lock(mutex_);
+  auto is_idle = [this]() { return num_pending_tasks_.load() == 0; };
+  if (mutex_.AwaitWithDeadline(absl::Condition(&is_idle),
+                               absl::Now() + timeout)) {
+    return absl::OkStatus();
+  }
+  return absl::DeadlineExceededError(absl::StrCat(
+      "Timeout waiting for task queue to become idle in pool '", name_prefix_,
+      "'. Tasks still in queue: ", num_pending_tasks_.load()));
+}
+
+absl::Status WorkStealingThreadPool::WaitUntilDone(absl::Duration timeout) {
+  absl::MutexLock lock(mutex_);
+  auto is_done = [this]() { return num_unfinished_tasks_.load() == 0; };
+  if (mutex_.AwaitWithDeadline(absl::Condition(&is_done),
+                               absl::Now() + timeout)) {
+    return absl::OkStatus();
+  }
+  const int64_t num_pending_tasks = num_pending_tasks_.load();
+  return absl::DeadlineExceededError(absl::StrCat(
+      "Timeout waiting for all tasks to be done in pool '", name_prefix_,
+      "'. Tasks still in queue: ", num_pending_tasks, ", Active tasks: ",
+      num_unfinished_tasks_.load() - num_pending_tasks));
+}
+
+absl::Status WorkStealingThreadPool::MaybeSpawnWorker() {
+  // Like ThreadPool, only spawn a worker if all the others are (supposed to
+  // be) busy.
+  size_t num_threads = this->num_threads();
+  if (num_threads >= max_num_threads_ ||
+      (num_threads > 0 &&
+       num_unfinished_tasks_.load(std::memory_order_relaxed) <
+           static_cast<int64_t>(num_threads))) {
+    return absl::OkStatus();
+  }
+
+  absl::MutexLock lock(mutex_);
+  if (stopped_.load()) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("ThreadPool '", name_prefix_, "' is stopped."));
+  }
+  num_threads = threads_.size();
+  if (num_threads >= max_num_threads_) {
+    return absl::OkStatus();
+  }
+  const int index = num_threads;
+  auto thread = WorkerThread::Create(name_prefix_, thread_options_,
+                                     [this, index]() { RunWorker(index); });
+  if (thread.ok()) {
+    threads_.push_back(std::move(*thread));
+    num_threads_.store(threads_.size(), std::memory_order_release);
+    ABSL_LOG(INFO) << "WorkStealingThreadPool '" << name_prefix_
+                   << "': Created a worker thread since all " << num_threads
+                   << " worker threads are (supposed to be) busy.";
+  } else if (num_threads == 0) {
+    ABSL_LOG(ERROR) << "WorkStealingThreadPool '" << name_prefix_
+                    << "': Failed to create the first worker thread: "
+                    << thread.status();
+    // Return the error to the caller since it would be fatal.
+    return thread.status();
+  } else {
+    ABSL_LOG(WARNING) << "WorkStealingThreadPool '" << name_prefix_
+                      << "': Failed to create a worker thread when all "
+                      << num_threads
+                      << " worker threads are (supposed to be) busy: "
+                      << thread.status();
+    // Ignore the error since tasks can still be run by existing worker
+    // threads.
+  }
+  return absl::OkStatus();
+}
+
+WorkStealingThreadPool::Task* WorkStealingThreadPool::PopInjected(
+    Worker& worker) {
+  // Skip the lock of empty queues.
+  if (worker.num_injected.load(std::memory_order_acquire) == 0) {
+    return nullptr;
+  }
+  absl::MutexLock lock(worker.mutex);
+  if (worker.injected.empty()) {
+    return nullptr;
+  }
+  Task* task = worker.injected.front();
+  worker.injected.pop_front();
+  worker.num_injected.fetch_sub(1, std::memory_order_relaxed);
+  return task;
+}
+
+WorkStealingThreadPool::Task* WorkStealingThreadPool::FindTask(int index) {
+  Worker& self = *workers_[index];
+  if (Task* task = self.deque.Pop(); task != nullptr) {
+    return task;
+  }
+  if (Task* task = PopInjected(self); task != nullptr) {
+    return task;
+  }
+  const size_t num_threads = this->num_threads();
+  for (size_t i = 1; i < num_threads; ++i) {
+    Worker& victim = *workers_[(index + i) % num_threads];
+    if (Task* task = victim.deque.Steal(); task != nullptr) {
+      return task;
+    }
+    if (Task* task = PopInjected(victim); task != nullptr) {
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+void WorkStealingThreadPool::RunTask(Task* task) {
+  // Releasing the mutex makes WaitUntilIdle() and WaitUntilDone() check their
+  // conditions again.
+  if (num_pending_tasks_.fetch_sub(1, std::memory_order_seq_cst) == 1) {
+    absl::MutexLock lock(mutex_);
+  }
+  std::move(*task)();
+  delete task;
+  if (num_unfinished_tasks_.fetch_sub(1, std::memory_order_seq_cst) == 1) {
+    absl::MutexLock lock(mutex_);
+  }
+}
+
+void WorkStealingThreadPool::WakeUpWorker() {
+  // Pairs with the parking in RunWorker(): either the worker sees the new
+  // pending task, or this sees the parked worker.
+  if (num_parked_workers_.load(std::memory_order_seq_cst) > 0) {
+    absl::MutexLock lock(mutex_);
+    wake_up_.Signal();
+  }
+}
+
+void WorkStealingThreadPool::RunWorker(int index) {
+  current_pool = this;
+  current_worker = index;
+  while (true) {
+    if (Task* task = FindTask(index); task != nullptr) {
+      RunTask(task);
+      continue;
+    }
+
+    absl::MutexLock lock(mutex_);
+    num_parked_workers_.fetch_add(1, std::memory_order_seq_cst);
+    while (num_pending_tasks_.load(std::memory_order_seq_cst) == 0 &&
+           !stopped_.load(std::memory_order_seq_cst)) {
+      wake_up_.Wait(&mutex_);
+    }
+    num_parked_workers_.fetch_sub(1, std::memory_order_seq_cst);
+    // Another worker may have taken the task this one was woken up for.
+    if (stopped_.load() && num_pending_tasks_.load() == 0) {
+      ABSL_LOG(INFO) << "WorkStealingThreadPool '" << name_prefix_
+                     << "': Worker thread stopped.";
+      break;
+    }
+  }
+  current_pool = nullptr;
+  current_worker = -1;
+}
+
+}  // namespace litert::lm
@@ -0,0 +1,184 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_LITERT_LM_RUNTIME_FRAMEWORK_WORK_STEALING_THREADPOOL_H_
+#define THIRD_PARTY_LITERT_LM_RUNTIME_FRAMEWORK_WORK_STEALING_THREADPOOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"  // from @com_google_absl
+#include "absl/functional/any_invocable.h"  // from @com_google_absl
+#include "absl/functional/function_ref.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "runtime/framework/thread_options.h"
+
+namespace litert::lm {
+
+class WorkerThread;
+
+// A thread pool with the same API as ThreadPool, where every worker owns a
+// queue of callbacks and idle workers steal callbacks from the others.
+//
+// Callbacks scheduled by a worker go to a lock-free deque owned by that worker,
+// which runs the most recent one first and lets the other workers steal the
+// oldest ones. Callbacks scheduled by other threads are spread round-robin over
+// one queue per worker, so that concurrent callers do not contend on a single
+// lock. Workers with nothing to run or steal are parked until a callback is
+// scheduled.
+//
+// Unlike ThreadPool, callbacks run in no particular order even with a single
+// thread, so this pool must not be used to serialize work.
+//
+// Sample usage:
+//
+// {
+//   WorkStealingThreadPool pool("testpool", max_num_workers);
+//   pool.ParallelFor(num_images, [&](int i) { Preprocess(images[i]); });
+// }
+//
+class WorkStealingThreadPool {
+ public:
+  // Creates a thread pool that creates and can use up to "max_num_threads"
+  // threads.  Any standard thread options, such as stack size, should
+  // be passed via "thread_options".  "name_prefix" specifies the
+  // thread name prefix.
+  WorkStealingThreadPool(const std::string& name_prefix,
+                         size_t max_num_threads,
+                         ThreadOptions thread_options = ThreadOptions());
+
+  // Waits for closures (if any) to complete.
+  ~WorkStealingThreadPool();
+
+  // Adds specified callback to the queue of the calling worker, or to one of
+  // the queues of the pool if called from another thread. Eventually a thread
+  // will pull this callback off the queue and execute it.
+  absl::Status Schedule(absl::AnyInvocable<void() &&> callback);
+
+  // Runs `fn(i)` for every i in [0, num_iterations), on the workers and on the
+  // calling thread, and returns when all of them are done. May be called from
+  // a callback of the pool.
+  void ParallelFor(int num_iterations, absl::FunctionRef<void(int)> fn);
+
+  // Waits until no callback is waiting to be run. The function will return an
+  // error if the timeout is reached before the queues are empty.
+  // Like ThreadPool::WaitUntilIdle(), this does not guarantee that all
+  // scheduled callbacks have finished executing.
+  absl::Status WaitUntilIdle(absl::Duration timeout);
+
+  // Waits until all the scheduled callbacks are executed and finished. The
+  // function will return an error if the timeout is reached before all the
+  // callbacks are finished.
+  absl::Status WaitUntilDone(absl::Duration timeout);
+
+  // Maximum number of threads in the pool.
+  size_t max_num_threads() const { return max_num_threads_; }
+
+  // Number of threads in the pool spawned actually.
+  size_t num_threads() const {
+    return num_threads_.load(std::memory_order_acquire);
+  }
+
+  // Standard thread options.  Use this accessor to get them.
+  const ThreadOptions& thread_options() const { return thread_options_; }
+
+ private:
+  using Task = absl::AnyInvocable<void() &&>;
+
+  // A fixed capacity Chase-Lev deque. Only the owner pushes and pops at the
+  // bottom, any thread may steal from the top.
+  class TaskDeque {
+   public:
+    TaskDeque();
+
+    // Returns false if the deque is full. Owner only.
+    bool Push(Task* task);
+    // Returns the most recently pushed task, or nullptr. Owner only.
+    Task* Pop();
+    // Returns the oldest task, or nullptr if the deque is empty or another
+    // thread took it first.
+    Task* Steal();
+    bool Empty() const;
+
+   private:
+    static constexpr int64_t kCapacity = 1024;
+    std::atomic<int64_t> top_{0};
+    std::atomic<int64_t> bottom_{0};
+    std::unique_ptr<std::atomic<Task*>[]> tasks_;
+  };
+
+  // The queues of a worker.
+  struct Worker {
+    TaskDeque deque;
+    // Callbacks scheduled from outside of the pool, or beyond the capacity of
+    // the deque.
+    absl::Mutex mutex;
+    std::deque<Task*> injected ABSL_GUARDED_BY(mutex);
+    std::atomic<int> num_injected{0};
+  };
+
+  // The main function of the worker thread `index`.
+  void RunWorker(int index);
+
+  // Spawns a worker if all the spawned ones are (supposed to be) busy.
+  absl::Status MaybeSpawnWorker();
+
+  // Returns a task for the worker `index`, or for a thread outside of the pool
+  // if `index` is negative, or nullptr if there is none.
+  Task* FindTask(int index);
+  Task* PopInjected(Worker& worker);
+
+  void RunTask(Task* task);
+
+  // Wakes up a parked worker, if any.
+  void WakeUpWorker();
+
+  const std::string name_prefix_;
+  // The number of threads in the pool.
+  const size_t max_num_threads_;
+  // Thread options.
+  const ThreadOptions thread_options_;
+
+  // One entry per thread, allocated upfront so that workers can steal from
+  // each other without locking.
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<size_t> num_threads_{0};
+  // The next queue for callbacks scheduled from outside of the pool.
+  std::atomic<size_t> next_injected_{0};
+
+  // Callbacks scheduled and not started yet.
+  std::atomic<int64_t> num_pending_tasks_{0};
+  // Callbacks scheduled and not finished yet.
+  std::atomic<int64_t> num_unfinished_tasks_{0};
+  // Workers waiting for a callback.
+  std::atomic<int> num_parked_workers_{0};
+  std::atomic<bool> stopped_{false};
+
+  // Guards the spawning of workers and the parking of idle ones, and is
+  // notified when the pool becomes idle or done.
+  mutable absl::Mutex mutex_;
+  absl::CondVar wake_up_;
+  std::vector<std::unique_ptr<WorkerThread>> threads_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace litert::lm
+
+#endif  // THIRD_PARTY_LITERT_LM_RUNTIME_FRAMEWORK_WORK_STEALING_THREADPOOL_H_
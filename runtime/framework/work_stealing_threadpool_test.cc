@@ -0,0 +1,165 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/framework/work_stealing_threadpool.h"
+
+#include <atomic>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/synchronization/notification.h"  // from @com_google_absl
+#include "absl/time/clock.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "runtime/framework/thread_options.h"
+#include "runtime/util/test_utils.h"  // NOLINT
+
+namespace litert::lm {
+namespace {
+
+TEST(WorkStealingThreadPoolTest, DestroyWithoutStart) {
+  WorkStealingThreadPool thread_pool("testpool", 10);
+  EXPECT_EQ(thread_pool.max_num_threads(), 10);
+  EXPECT_EQ(thread_pool.num_threads(), 0);
+}
+
+TEST(WorkStealingThreadPoolTest, EmptyThread) {
+  WorkStealingThreadPool thread_pool("testpool", 0);
+  EXPECT_EQ(thread_pool.max_num_threads(), 1);
+  EXPECT_EQ(thread_pool.num_threads(), 0);
+}
+
+TEST(WorkStealingThreadPoolTest, CreateWithThreadOptions) {
+  ThreadOptions thread_options = ThreadOptions().set_nice_priority_level(-10);
+  WorkStealingThreadPool thread_pool("testpool", 10, thread_options);
+  EXPECT_EQ(thread_pool.thread_options().nice_priority_level(), -10);
+}
+
+TEST(WorkStealingThreadPoolTest, SingleThread) {
+  std::atomic<int> n = 100;
+  {
+    WorkStealingThreadPool thread_pool("testpool", 1);
+    for (int i = 0; i < 100; ++i) {
+      EXPECT_OK(thread_pool.Schedule([&n]() { --n; }));
+    }
+    EXPECT_EQ(thread_pool.num_threads(), 1);
+  }
+  EXPECT_EQ(n, 0);
+}
+
+TEST(WorkStealingThreadPoolTest, MultiThreadsScheduledFast) {
+  std::atomic<int> n = 100;
+  {
+    WorkStealingThreadPool thread_pool("testpool", 10);
+    absl::Notification start;
+    for (int i = 0; i < 100; ++i) {
+      EXPECT_OK(thread_pool.Schedule([&n, &start]() {
+        start.WaitForNotification();
+        --n;
+      }));
+    }
+    // Need more workers up to max, 10.
+    EXPECT_EQ(thread_pool.num_threads(), 10);
+    start.Notify();
+  }
+  EXPECT_EQ(n, 0);
+}
+
+TEST(WorkStealingThreadPoolTest, ScheduleFromManyThreads) {
+  std::atomic<int> n = 0;
+  WorkStealingThreadPool thread_pool("testpool", 4);
+  std::vector<std::thread> producers;
+  for (int i = 0; i < 8; ++i) {
+    producers.emplace_back([&thread_pool, &n]() {
+      for (int j = 0; j < 1000; ++j) {
+        EXPECT_OK(thread_pool.Schedule([&n]() { ++n; }));
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  EXPECT_OK(thread_pool.WaitUntilDone(absl::Seconds(50)));
+  EXPECT_EQ(n, 8000);
+}
+
+TEST(WorkStealingThreadPoolTest, ScheduleFromWorkers) {
+  std::atomic<int> n = 0;
+  WorkStealingThreadPool thread_pool("testpool", 4);
+  // More nested callbacks than a worker deque holds.
+  EXPECT_OK(thread_pool.Schedule([&thread_pool, &n]() {
+    for (int i = 0; i < 5000; ++i) {
+      EXPECT_OK(thread_pool.Schedule([&n]() { ++n; }));
+    }
+  }));
+  EXPECT_OK(thread_pool.WaitUntilDone(absl::Seconds(50)));
+  EXPECT_EQ(n, 5000);
+}
+
+TEST(WorkStealingThreadPoolTest, IdleWorkersStealCallbacks) {
+  WorkStealingThreadPool thread_pool("testpool", 2);
+  absl::Notification stolen;
+  // The first worker blocks until the callback it scheduled is run by the
+  // other worker.
+  EXPECT_OK(thread_pool.Schedule([&thread_pool, &stolen]() {
+    EXPECT_OK(thread_pool.Schedule([&stolen]() { stolen.Notify(); }));
+    EXPECT_TRUE(stolen.WaitForNotificationWithTimeout(absl::Seconds(50)));
+  }));
+  EXPECT_OK(thread_pool.Schedule([]() {}));
+  EXPECT_OK(thread_pool.WaitUntilDone(absl::Seconds(50)));
+  EXPECT_TRUE(stolen.HasBeenNotified());
+}
+
+TEST(WorkStealingThreadPoolTest, ParallelFor) {
+  WorkStealingThreadPool thread_pool("testpool", 4);
+  std::vector<int> v(1000, 0);
+  thread_pool.ParallelFor(v.size(), [&v](int i) { v[i] += i; });
+  for (int i = 0; i < static_cast<int>(v.size()); ++i) {
+    EXPECT_EQ(v[i], i);
+  }
+}
+
+TEST(WorkStealingThreadPoolTest, NestedParallelFor) {
+  WorkStealingThreadPool thread_pool("testpool", 4);
+  std::atomic<int> n = 0;
+  thread_pool.ParallelFor(8, [&thread_pool, &n](int /*i*/) {
+    thread_pool.ParallelFor(100, [&n](int /*j*/) { ++n; });
+  });
+  EXPECT_EQ(n, 800);
+}
+
+TEST(WorkStealingThreadPoolTest, WaitUntilIdle) {
+  WorkStealingThreadPool thread_pool("testpool", 1);
+  absl::Notification finish;
+  std::atomic<int> n = 0;
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_OK(thread_pool.Schedule([&n, &finish]() {
+      if (++n == 10) {
+        finish.WaitForNotification();
+      }
+    }));
+  }
+  // The last callback is still running when the queues are empty.
+  EXPECT_OK(thread_pool.WaitUntilIdle(absl::Seconds(50)));
+  EXPECT_THAT(thread_pool.WaitUntilDone(absl::Milliseconds(10)),
+              testing::status::StatusIs(absl::StatusCode::kDeadlineExceeded));
+  finish.Notify();
+  EXPECT_OK(thread_pool.WaitUntilDone(absl::Seconds(50)));
+  EXPECT_EQ(n, 10);
+}
+
+}  // namespace
+}  // namespace litert::lm
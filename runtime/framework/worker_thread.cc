@@ -14,18 +14,85 @@
 
 #include "runtime/framework/worker_thread.h"
 
+#include <errno.h>
+#include <string.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // defined(__linux__) || defined(__APPLE__)
+
+#include <algorithm>
+#include <memory>
+#include <ostream>
+#include <set>
 #include <string>
+#include <utility>
 
 #include "absl/base/nullability.h"  // from @com_google_absl
+#include "absl/functional/any_invocable.h"  // from @com_google_absl
 #include "absl/log/absl_check.h"  // from @com_google_absl
+#include "absl/log/absl_log.h"  // from @com_google_absl
 #include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/strings/str_join.h"  // from @com_google_absl
+#include "runtime/framework/thread_options.h"
 #include "runtime/framework/threadpool.h"
 
 namespace litert::lm {
+namespace {
+
+// Create a thread name from the given prefix and thread id.
+// - thread_id is not portable
+// - the 16-byte limit is Linux-specific
+// - why do we even need the thread id in the name? any thread list should show
+//   the id too.
+std::string CreateThreadName(const std::string& prefix, int thread_id) {
+  std::string name = absl::StrCat(prefix, "/", thread_id);
+  // 16 is the limit allowed by `pthread_setname_np`, including
+  // the terminating null byte ('\0')
+  constexpr size_t kMaxThreadNameLength = 15;
+  name.resize(std::min(name.length(), kMaxThreadNameLength));
+  return name;
+}
+
+#if defined(__linux__)
+int ToSchedPolicy(SchedulingPolicy scheduling_policy) {
+  switch (scheduling_policy) {
+    case SchedulingPolicy::kBatch:
+      return SCHED_BATCH;
+    case SchedulingPolicy::kIdle:
+      return SCHED_IDLE;
+    case SchedulingPolicy::kFifo:
+      return SCHED_FIFO;
+    case SchedulingPolicy::kRoundRobin:
+      return SCHED_RR;
+    case SchedulingPolicy::kDefault:
+    case SchedulingPolicy::kOther:
+      return SCHED_OTHER;
+  }
+  return SCHED_OTHER;
+}
+#endif  // __linux__
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<WorkerThread>> WorkerThread::Create(
+    ThreadPool* absl_nonnull pool, const std::string& name_prefix) {
+  return Create(name_prefix, pool->thread_options(),
+                [pool]() { pool->RunWorker(); });
+}
 
-WorkerThread::WorkerThread(ThreadPool* absl_nonnull pool,
-                           const std::string& name_prefix)
-    : pool_(*pool), name_prefix_(name_prefix), joined_(false) {}
+WorkerThread::WorkerThread(const std::string& name_prefix,
+                           const ThreadOptions& thread_options,
+                           absl::AnyInvocable<void() &&> body)
+    : name_prefix_(name_prefix),
+      thread_options_(thread_options),
+      joined_(false),
+      body_(std::move(body)) {}
 
 WorkerThread::~WorkerThread() { ABSL_CHECK(joined_); }
 
@@ -38,6 +105,81 @@ absl::Status WorkerThread::Join() {
   return JoinImpl();
 }
 
-void WorkerThread::RunWorker() { pool_.RunWorker(); }
+void WorkerThread::ApplyThreadOptions() {
+  const int nice_priority_level = thread_options_.nice_priority_level();
+  const std::set<int>& selected_cpus = thread_options_.cpu_set();
+  const SchedulingPolicy scheduling_policy =
+      thread_options_.scheduling_policy();
+#if defined(__linux__)
+  const std::string name = CreateThreadName(name_prefix_, syscall(SYS_gettid));
+  if (scheduling_policy != SchedulingPolicy::kDefault) {
+    // Only the real-time policies take a static priority.
+    sched_param param = {};
+    if (scheduling_policy == SchedulingPolicy::kFifo ||
+        scheduling_policy == SchedulingPolicy::kRoundRobin) {
+      param.sched_priority = thread_options_.realtime_priority();
+    }
+    int error = pthread_setschedparam(
+        pthread_self(), ToSchedPolicy(scheduling_policy), &param);
+    if (error == 0) {
+      ABSL_LOG(INFO) << "Changed the scheduling policy to "
+                     << ToSchedPolicy(scheduling_policy) << " with priority "
+                     << param.sched_priority;
+    } else {
+      ABSL_LOG(ERROR) << "Error : " << strerror(error) << std::endl
+                      << "Could not change the scheduling policy to "
+                      << ToSchedPolicy(scheduling_policy);
+    }
+  }
+  if (nice_priority_level != 0) {
+    if (nice(nice_priority_level) != -1 || errno == 0) {
+      ABSL_LOG(INFO) << "Changed the nice priority level by "
+                     << nice_priority_level;
+    } else {
+      ABSL_LOG(ERROR) << "Error : " << strerror(errno) << std::endl
+                      << "Could not change the nice priority level by "
+                      << nice_priority_level;
+    }
+  }
+  if (!selected_cpus.empty()) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (const int cpu : selected_cpus) {
+      CPU_SET(cpu, &cpu_set);
+    }
+    if (sched_setaffinity(syscall(SYS_gettid), sizeof(cpu_set_t), &cpu_set) !=
+            -1 ||
+        errno == 0) {
+      ABSL_LOG(INFO) << "Pinned the thread pool executor to processor "
+                     << absl::StrJoin(selected_cpus, ", processor ") << ".";
+    } else {
+      ABSL_LOG(ERROR) << "Error : " << strerror(errno) << std::endl
+                      << "Failed to set processor affinity. Ignore processor "
+                         "affinity setting for now.";
+    }
+  }
+  int error = pthread_setname_np(pthread_self(), name.c_str());
+  if (error != 0) {
+    ABSL_LOG(ERROR) << "Error : " << strerror(error) << std::endl
+                    << "Failed to set name for thread: " << name;
+  }
+#else
+  const std::string name = CreateThreadName(name_prefix_, 0);
+  if (nice_priority_level != 0 || !selected_cpus.empty() ||
+      scheduling_policy != SchedulingPolicy::kDefault) {
+    ABSL_LOG(ERROR) << "Thread priority and processor affinity feature aren't "
+                       "supported on the current platform.";
+  }
+#if __APPLE__
+  int error = pthread_setname_np(name.c_str());
+  if (error != 0) {
+    ABSL_LOG(ERROR) << "Error : " << strerror(error) << std::endl
+                    << "Failed to set name for thread: " << name;
+  }
+#endif  // __APPLE__
+#endif  // __linux__
+}
+
+void WorkerThread::RunWorker() { std::move(body_)(); }
 
 }  // namespace litert::lm
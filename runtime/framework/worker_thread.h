@@ -20,8 +20,10 @@
 #include <string>
 
 #include "absl/base/nullability.h"  // from @com_google_absl
+#include "absl/functional/any_invocable.h"  // from @com_google_absl
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
+#include "runtime/framework/thread_options.h"
 #include "runtime/framework/threadpool.h"
 
 namespace litert::lm {
@@ -32,6 +34,12 @@ class WorkerThread {
   static absl::StatusOr<std::unique_ptr<WorkerThread>> Create(
       ThreadPool* absl_nonnull pool, const std::string& name_prefix);
 
+  // Creates and starts a thread that runs `body`, with the priority and the
+  // processor affinity of `thread_options`.
+  static absl::StatusOr<std::unique_ptr<WorkerThread>> Create(
+      const std::string& name_prefix, const ThreadOptions& thread_options,
+      absl::AnyInvocable<void() &&> body);
+
   // REQUIRES: Join() must have been called.
   virtual ~WorkerThread();
 
@@ -39,19 +47,30 @@ class WorkerThread {
   absl::Status Join();
 
  protected:
-  WorkerThread(ThreadPool* absl_nonnull pool, const std::string& name_prefix);
+  WorkerThread(const std::string& name_prefix,
+               const ThreadOptions& thread_options,
+               absl::AnyInvocable<void() &&> body);
 
   // The implementation of Join().
   virtual absl::Status JoinImpl() = 0;
 
-  // For the visibility from WorkerThread subclasses.
+  // Applies the name, the priority and the processor affinity of
+  // `thread_options_` to the calling thread. Called by the subclasses on the
+  // new thread before RunWorker().
+  void ApplyThreadOptions();
+
+  // Runs the body of the thread. For the visibility from WorkerThread
+  // subclasses.
   void RunWorker();
 
-  ThreadPool& pool_;
   const std::string name_prefix_;
+  const ThreadOptions thread_options_;
 
   // Track if this thread is joined.
   std::atomic<bool> joined_;
+
+ private:
+  absl::AnyInvocable<void() &&> body_;
 };
 
 }  // namespace litert::lm
@@ -16,11 +16,12 @@
 #include <memory>
 #include <string>
 #include <thread>  // NOLINT(build/c++11)
+#include <utility>
 
-#include "absl/base/nullability.h"  // from @com_google_absl
+#include "absl/functional/any_invocable.h"  // from @com_google_absl
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
-#include "runtime/framework/threadpool.h"
+#include "runtime/framework/thread_options.h"
 #include "runtime/framework/worker_thread.h"
 
 namespace litert::lm {
@@ -28,8 +29,9 @@ namespace {
 
 class WorkerThreadStdThread : public WorkerThread {
  public:
-  WorkerThreadStdThread(ThreadPool* absl_nonnull pool,
-                        const std::string& name_prefix);
+  WorkerThreadStdThread(const std::string& name_prefix,
+                        const ThreadOptions& thread_options,
+                        absl::AnyInvocable<void() &&> body);
 
  private:
   absl::Status JoinImpl() override;
@@ -41,9 +43,10 @@ class WorkerThreadStdThread : public WorkerThread {
   std::atomic<bool> joined_;
 };
 
-WorkerThreadStdThread::WorkerThreadStdThread(ThreadPool* absl_nonnull pool,
-                                             const std::string& name_prefix)
-    : WorkerThread(pool, name_prefix) {
+WorkerThreadStdThread::WorkerThreadStdThread(
+    const std::string& name_prefix, const ThreadOptions& thread_options,
+    absl::AnyInvocable<void() &&> body)
+    : WorkerThread(name_prefix, thread_options, std::move(body)) {
   thread_ = std::thread(ThreadBody, this);
 }
 
@@ -54,6 +57,7 @@ absl::Status WorkerThreadStdThread::JoinImpl() {
 
 void* WorkerThreadStdThread::ThreadBody(void* arg) {
   auto thread = reinterpret_cast<WorkerThreadStdThread*>(arg);
+  thread->ApplyThreadOptions();
   thread->RunWorker();
   return nullptr;
 }
@@ -61,8 +65,10 @@ void* WorkerThreadStdThread::ThreadBody(void* arg) {
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<WorkerThread>> WorkerThread::Create(
-    ThreadPool* absl_nonnull pool, const std::string& name_prefix) {
-  return std::make_unique<WorkerThreadStdThread>(pool, name_prefix);
+    const std::string& name_prefix, const ThreadOptions& thread_options,
+    absl::AnyInvocable<void() &&> body) {
+  return std::make_unique<WorkerThreadStdThread>(name_prefix, thread_options,
+                                                 std::move(body));
 }
 
 }  // namespace litert::lm
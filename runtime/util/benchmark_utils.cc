@@ -0,0 +1,60 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/util/benchmark_utils.h"
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+
+#include "absl/functional/function_ref.h"  // from @com_google_absl
+#include "absl/strings/str_format.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/time/clock.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+
+namespace litert::lm {
+namespace {
+
+std::atomic<int64_t> checksum = 0;
+
+}  // namespace
+
+double TimeMicros(absl::FunctionRef<void()> fn, int iterations) {
+  fn();  // Warm up.
+  const absl::Time start = absl::Now();
+  for (int i = 0; i < iterations; ++i) {
+    fn();
+  }
+  return absl::ToDoubleMicroseconds(absl::Now() - start) / iterations;
+}
+
+void PrintSpeedupHeader(absl::string_view variant) {
+  std::cout << absl::StrFormat("%-24s %-14s %15s %9s\n", "benchmark", variant,
+                               "time", "speedup");
+}
+
+void ReportSpeedup(absl::string_view benchmark, absl::string_view variant,
+                   double micros, double baseline_micros) {
+  std::cout << absl::StrFormat("%-24s %-14s %12.2f us %8.2fx\n", benchmark,
+                               variant, micros, baseline_micros / micros);
+}
+
+void AddToChecksum(int64_t value) {
+  checksum.fetch_add(value, std::memory_order_relaxed);
+}
+
+void PrintChecksum() { std::cout << "checksum: " << checksum.load() << "\n"; }
+
+}  // namespace litert::lm
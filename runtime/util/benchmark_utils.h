@@ -0,0 +1,50 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_UTIL_BENCHMARK_UTILS_H_
+#define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_UTIL_BENCHMARK_UTILS_H_
+
+#include <cstdint>
+
+#include "absl/functional/function_ref.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+
+// Helpers shared by the micro-benchmark binaries.
+
+namespace litert::lm {
+
+// Returns the average duration of `fn` over `iterations` runs in
+// microseconds. `fn` is run once more beforehand to warm up the caches.
+double TimeMicros(absl::FunctionRef<void()> fn, int iterations);
+
+// Prints the header of the table of ReportSpeedup() rows. `variant` names the
+// column of the compared implementations, e.g. "kernels".
+void PrintSpeedupHeader(absl::string_view variant);
+
+// Prints the average duration of `variant` on `benchmark`, and its speedup
+// over the baseline which took `baseline_micros`.
+void ReportSpeedup(absl::string_view benchmark, absl::string_view variant,
+                   double micros, double baseline_micros);
+
+// Adds `value` to the checksum of the benchmark. The benchmarks add the
+// results of the timed code to it and print it at the end, so that the
+// compiler cannot drop that code. Thread-safe.
+void AddToChecksum(int64_t value);
+
+// Prints the checksum of the benchmark.
+void PrintChecksum();
+
+}  // namespace litert::lm
+
+#endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_UTIL_BENCHMARK_UTILS_H_